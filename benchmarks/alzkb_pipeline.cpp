@@ -0,0 +1,505 @@
+// End-to-end replay of the AlzKB build (examples/projects/alzkb/alzkb.yaml,
+// the declarative form of alzkb.py) against synthetic source files.
+//
+//   alzkb_pipeline [--nodes N] [--degree D] [--seed N] [--threads N] [--dir DIR]
+//                  [--json FILE] [--python] [--manifest YAML]
+//
+// Every flat file the manifest reads is generated under DIR/data: --nodes
+// rows per node type and --degree rows per subject node for each
+// relationship step, with key columns written so that merges and
+// relationship lookups hit after the step's data_transforms. Files shared by
+// several steps (hetionet's node and edge tables) get one block of rows per
+// filter value. The native build then runs with per-step timing; --python
+// also replays the steps through FlatFileDatabaseParser and owlready2 with
+// benchmarks/alzkb_pipeline.py, which appends its run to the same JSON and
+// prints both side by side.
+//
+// Steps run one at a time by default so their times and peak RSS do not
+// overlap; --threads N measures the parallel build instead.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+#include "build/engine.hpp"
+#include "build/manifest.hpp"
+#include "io/file_io.hpp"
+#include "util/hash.hpp"
+#include "util/json_writer.hpp"
+#include "util/resource_usage.hpp"
+
+using namespace ista;
+using Clock = std::chrono::steady_clock;
+namespace fs = std::filesystem;
+
+#ifndef ISTA_SOURCE_DIR
+#define ISTA_SOURCE_DIR "."
+#endif
+
+namespace
+{
+
+// Node keys are decimal numbers, distinct across classes, so they survive
+// int, lower, upper and strip and never match another class's keys.
+constexpr std::uint64_t CLASS_STRIDE = 100000000;
+
+// The kernel's high-water mark, reset between steps so each gets its own.
+std::uint64_t peakRss()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+        if (line.starts_with("VmHWM:"))
+            return std::stoull(line.substr(6)) * 1024;
+    return util::peakRssBytes();
+}
+
+void resetPeakRss()
+{
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+const std::vector<build::Transform>* transformsOf(const build::Step& step, const std::string& column)
+{
+    for (const auto& [name, transforms] : step.table.data_transforms)
+        if (name == column)
+            return &transforms;
+    return nullptr;
+}
+
+void applyForward(const std::vector<build::Transform>* transforms, std::string& v)
+{
+    if (!transforms)
+        return;
+    for (const build::Transform& tr : *transforms) {
+        switch (tr.op) {
+        case build::Transform::Op::SplitLast:
+            if (std::size_t pos = v.rfind(tr.arg); pos != std::string::npos)
+                v.erase(0, pos + tr.arg.size());
+            break;
+        case build::Transform::Op::SplitFirst:
+            if (std::size_t pos = v.find(tr.arg); pos != std::string::npos)
+                v.erase(pos);
+            break;
+        case build::Transform::Op::Prefix:
+            v.insert(0, tr.arg);
+            break;
+        case build::Transform::Op::StripPrefix:
+            if (v.starts_with(tr.arg))
+                v.erase(0, tr.arg.size());
+            break;
+        default:
+            // Strip, case changes and int leave decimal keys alone.
+            break;
+        }
+    }
+}
+
+// A raw cell that `transforms` turn into `value`.
+std::string invert(const std::vector<build::Transform>* transforms, std::string value)
+{
+    if (!transforms)
+        return value;
+    for (auto it = transforms->rbegin(); it != transforms->rend(); ++it) {
+        switch (it->op) {
+        case build::Transform::Op::SplitLast:
+            value = "src" + it->arg + value;
+            break;
+        case build::Transform::Op::SplitFirst:
+            value += it->arg + "src";
+            break;
+        case build::Transform::Op::Prefix:
+            if (value.starts_with(it->arg))
+                value.erase(0, it->arg.size());
+            break;
+        case build::Transform::Op::StripPrefix:
+            value.insert(0, it->arg);
+            break;
+        default:
+            break;
+        }
+    }
+    return value;
+}
+
+
+class SourceGenerator
+{
+public:
+    SourceGenerator(const build::Manifest& manifest, std::uint64_t nodes, double degree, std::uint64_t seed)
+        : manifest_(manifest), nodes_(nodes), degree_(degree), seed_(seed)
+    {
+        for (const build::Step& step : manifest.steps) {
+            if (step.kind == build::StepKind::Node) {
+                classIndex(step.node_type);
+                // The first step to write a property decides how its values
+                // look once transformed.
+                for (const auto& [column, property] : step.data_property_map)
+                    value_transforms_.emplace(step.node_type + "\n" + property, transformsOf(step, column));
+            } else {
+                classIndex(step.subject_node_type);
+                classIndex(step.object_node_type);
+            }
+        }
+    }
+
+    // Writes every input file; returns the bytes written.
+    std::uint64_t write()
+    {
+        std::map<std::string, std::vector<const build::Step*>> files;
+        std::vector<std::string> order;
+        for (const build::Step& step : manifest_.steps) {
+            auto& steps = files[step.table.path];
+            if (steps.empty())
+                order.push_back(step.table.path);
+            steps.push_back(&step);
+        }
+        std::uint64_t bytes = 0;
+        for (const std::string& path : order)
+            bytes += writeFile(path, files[path]);
+        return bytes;
+    }
+
+private:
+    std::size_t classIndex(const std::string& name)
+    {
+        auto [it, inserted] = classes_.emplace(name, classes_.size());
+        return it->second;
+    }
+
+    std::string key(const std::string& class_name, std::uint64_t j) const
+    {
+        return std::to_string((classes_.at(class_name) + 1) * CLASS_STRIDE + j);
+    }
+
+    // The transformed value of `property` on node j of a class, as the
+    // KeyIndex will hold it.
+    std::string propertyValue(const std::string& class_name, const std::string& property, std::uint64_t j) const
+    {
+        auto it = value_transforms_.find(class_name + "\n" + property);
+        const std::vector<build::Transform>* transforms = it == value_transforms_.end() ? nullptr : it->second;
+        std::string v = invert(transforms, key(class_name, j));
+        applyForward(transforms, v);
+        return v;
+    }
+
+    std::uint64_t rowsOf(const build::Step& step) const
+    {
+        if (step.kind == build::StepKind::Node)
+            return nodes_;
+        return static_cast<std::uint64_t>(degree_ * static_cast<double>(nodes_));
+    }
+
+    static std::vector<std::string> referenced(const build::Step& step)
+    {
+        std::vector<std::string> columns;
+        if (step.kind == build::StepKind::Node) {
+            columns.push_back(step.iri_column_name);
+            if (step.merge)
+                columns.push_back(step.merge_column);
+            for (const auto& entry : step.data_property_map)
+                columns.push_back(entry.first);
+        } else {
+            columns.push_back(step.subject_column_name);
+            columns.push_back(step.object_column_name);
+        }
+        for (const build::CompoundField& cf : step.table.compound_fields)
+            columns.push_back(cf.column);
+        if (!step.table.filter_column.empty())
+            columns.push_back(step.table.filter_column);
+        return columns;
+    }
+
+    // The raw cell of `column` in row r of a block produced for `step`.
+    std::string cell(const build::Step& step, const std::string& column, std::uint64_t r) const
+    {
+        const build::TableConfig& t = step.table;
+        if (column == t.filter_column)
+            return t.filter_value;
+        for (const build::CompoundField& cf : t.compound_fields) {
+            if (column != cf.column)
+                continue;
+            std::string out;
+            for (const auto& entry : step.data_property_map) {
+                if (entry.first == cf.column)
+                    continue;
+                if (!out.empty())
+                    out += cf.delimiter;
+                out += entry.first + cf.field_split_prefix + cell(step, entry.first, r);
+            }
+            return out;
+        }
+        if (step.kind == build::StepKind::Node) {
+            std::uint64_t j = r % nodes_;
+            const std::vector<build::Transform>* transforms = transformsOf(step, column);
+            if (step.merge && column == step.merge_column)
+                return invert(transforms, propertyValue(step.node_type, step.merge_property, j));
+            for (const auto& [mapped, property] : step.data_property_map)
+                if (mapped == column)
+                    return invert(transforms, propertyValue(step.node_type, property, j));
+            return invert(transforms, key(step.node_type, j));
+        }
+        // Relationship rows pick endpoints uniformly, from a stream per row.
+        bool subject = column == step.subject_column_name;
+        std::uint64_t h = util::mix64(seed_ ^ util::mix64(r * 2 + (subject ? 0 : 1)) ^ util::hashBytes(step.name));
+        const std::string& class_name = subject ? step.subject_node_type : step.object_node_type;
+        const std::string& property = subject ? step.subject_match_property : step.object_match_property;
+        return invert(transformsOf(step, column), propertyValue(class_name, property, h % nodes_));
+    }
+
+    std::uint64_t writeFile(const std::string& path, const std::vector<const build::Step*>& steps)
+    {
+        const build::TableConfig& table = steps.front()->table;
+        std::vector<std::string> columns = table.headers;
+        if (columns.empty()) {
+            std::set<std::string> seen;
+            for (const build::Step* step : steps)
+                for (const std::string& c : referenced(*step))
+                    if (seen.insert(c).second)
+                        columns.push_back(c);
+        }
+
+        // Steps with a filter get their own block of rows; the rest read one
+        // shared block, each column filled by the first step that reads it.
+        std::vector<std::vector<const build::Step*>> blocks;
+        std::vector<const build::Step*> unfiltered;
+        for (const build::Step* step : steps) {
+            if (step->table.filter_column.empty())
+                unfiltered.push_back(step);
+            else
+                blocks.push_back({step});
+        }
+        if (!unfiltered.empty())
+            blocks.insert(blocks.begin(), unfiltered);
+
+        fs::create_directories(fs::path(path).parent_path());
+        io::OutputFile out(path);
+        char delimiter = table.delimiter;
+        std::string line;
+        auto emit = [&](const std::vector<std::string>& cells) {
+            line.clear();
+            for (std::size_t i = 0; i < cells.size(); ++i) {
+                if (i)
+                    line += delimiter;
+                if (cells[i].find(delimiter) != std::string::npos || cells[i].find('"') != std::string::npos) {
+                    line += '"';
+                    for (char c : cells[i]) {
+                        if (c == '"')
+                            line += '"';
+                        line += c;
+                    }
+                    line += '"';
+                } else {
+                    line += cells[i];
+                }
+            }
+            line += '\n';
+            out.write(line);
+        };
+        if (table.headers_in_file)
+            emit(columns);
+        for (unsigned i = 0; i < table.skip_n_lines; ++i)
+            emit(std::vector<std::string>(columns.size()));
+
+        std::vector<std::string> cells(columns.size());
+        for (const auto& block : blocks) {
+            std::vector<const build::Step*> owners(columns.size(), nullptr);
+            std::uint64_t rows = 0;
+            for (const build::Step* step : block) {
+                rows = std::max(rows, rowsOf(*step));
+                std::vector<std::string> used = referenced(*step);
+                for (std::size_t c = 0; c < columns.size(); ++c)
+                    if (!owners[c] && std::find(used.begin(), used.end(), columns[c]) != used.end())
+                        owners[c] = step;
+            }
+            for (std::uint64_t r = 0; r < rows; ++r) {
+                for (std::size_t c = 0; c < columns.size(); ++c)
+                    cells[c] = owners[c] ? cell(*owners[c], columns[c], r) : std::string();
+                emit(cells);
+            }
+        }
+        std::uint64_t bytes = out.bytesWritten();
+        out.close();
+        return bytes;
+    }
+
+    const build::Manifest& manifest_;
+    std::uint64_t nodes_;
+    double degree_;
+    std::uint64_t seed_;
+    std::map<std::string, std::size_t> classes_;
+    std::map<std::string, const std::vector<build::Transform>*> value_transforms_;
+};
+
+
+struct StepTiming
+{
+    std::string name;
+    std::string kind;
+    std::uint64_t rows = 0;
+    std::uint64_t triples = 0;
+    double seconds = 0.0;
+    std::uint64_t peak_rss = 0;
+};
+
+void printTable(const std::vector<StepTiming>& steps)
+{
+    std::printf("%-52s %10s %10s %10s %12s %11s\n", "step", "rows", "triples", "seconds", "rows/s", "peak RSS");
+    for (const StepTiming& s : steps)
+        std::printf("%-52s %10llu %10llu %10.3f %12.0f %11s\n", s.name.c_str(), static_cast<unsigned long long>(s.rows),
+                    static_cast<unsigned long long>(s.triples), s.seconds, s.seconds > 0 ? s.rows / s.seconds : 0.0,
+                    util::formatBytes(s.peak_rss).c_str());
+}
+
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::string manifest_path = std::string(ISTA_SOURCE_DIR) + "/examples/projects/alzkb/alzkb.yaml";
+    std::string dir = (fs::temp_directory_path() / "ista_alzkb_pipeline").string();
+    std::string json_path;
+    std::uint64_t nodes = 20000, seed = 1;
+    double degree = 5.0;
+    unsigned threads = 1;
+    bool python = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--nodes" && i + 1 < argc)
+            nodes = std::stoull(argv[++i]);
+        else if (arg == "--degree" && i + 1 < argc)
+            degree = std::stod(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = std::stoull(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (arg == "--dir" && i + 1 < argc)
+            dir = argv[++i];
+        else if (arg == "--json" && i + 1 < argc)
+            json_path = argv[++i];
+        else if (arg == "--manifest" && i + 1 < argc)
+            manifest_path = argv[++i];
+        else if (arg == "--python")
+            python = true;
+        else {
+            std::fprintf(stderr, "usage: alzkb_pipeline [--nodes N] [--degree D] [--seed N] [--threads N] [--dir DIR]\n"
+                                 "                      [--json FILE] [--python] [--manifest YAML]\n");
+            return 1;
+        }
+    }
+    if (nodes == 0 || nodes >= CLASS_STRIDE) {
+        std::fprintf(stderr, "--nodes must be between 1 and %llu\n", static_cast<unsigned long long>(CLASS_STRIDE - 1));
+        return 1;
+    }
+    fs::create_directories(dir);
+    if (json_path.empty())
+        json_path = (fs::path(dir) / "results.json").string();
+
+    // The manifest again, reading from DIR/data and writing N-Triples to
+    // DIR, so the Python replay sees exactly the same inputs.
+    YAML::Node root = YAML::LoadFile(manifest_path);
+    root["ontology"] = fs::absolute(fs::path(manifest_path).parent_path() / root["ontology"].as<std::string>()).string();
+    root["data_dir"] = "data";
+    root["output"] = "alzkb-native.nt";
+    root["cache_dir"] = ".ista-cache";
+    std::string replay_path = (fs::path(dir) / "alzkb.yaml").string();
+    std::ofstream(replay_path) << root << "\n";
+    build::Manifest manifest = build::loadManifest(replay_path);
+
+    auto start = Clock::now();
+    std::uint64_t bytes = SourceGenerator(manifest, nodes, degree, seed).write();
+    std::fprintf(stderr, "generated %s of source files for %zu steps in %.3f s\n", util::formatBytes(bytes).c_str(),
+                 manifest.steps.size(), std::chrono::duration<double>(Clock::now() - start).count());
+
+    std::map<std::string, std::uint64_t> peaks;
+    build::BuildOptions options;
+    options.threads = threads;
+    options.force = true;
+    auto last_step = Clock::now();
+    options.on_step = [&](const build::StepReport& step) {
+        peaks[step.name] = peakRss();
+        resetPeakRss();
+        last_step = Clock::now();
+    };
+    resetPeakRss();
+    start = Clock::now();
+    build::BuildReport report = build::runBuild(manifest, options);
+    double total = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<StepTiming> steps;
+    for (std::size_t i = 0; i < report.steps.size(); ++i) {
+        const build::StepReport& r = report.steps[i];
+        bool node = manifest.steps[i].kind == build::StepKind::Node;
+        steps.push_back({r.name, node ? "node" : "relationship", r.rows, r.triples, r.seconds, peaks[r.name]});
+    }
+    // Everything after the last step: merging step outputs and the save.
+    steps.push_back({"assemble and save", "save", report.output_triples, report.output_triples,
+                     std::chrono::duration<double>(Clock::now() - last_step).count(), peakRss()});
+
+    std::printf("native build, %llu nodes per type, degree %.1f, %u threads\n", static_cast<unsigned long long>(nodes),
+                degree, threads);
+    printTable(steps);
+    std::printf("total %.3f s, %llu triples, peak RSS %s\n", total, static_cast<unsigned long long>(report.output_triples),
+                util::formatBytes(util::peakRssBytes()).c_str());
+
+    {
+        std::ofstream out(json_path);
+        util::JsonWriter json(out);
+        json.beginObject();
+        json.key("config");
+        json.beginObject();
+        json.field("manifest", manifest_path);
+        json.field("nodes_per_type", nodes);
+        json.field("degree", degree);
+        json.field("seed", seed);
+        json.field("threads", threads);
+        json.field("source_bytes", bytes);
+        json.endObject();
+        json.key("runs");
+        json.beginArray();
+        json.beginObject();
+        json.field("path", "native");
+        json.field("total_seconds", total);
+        json.field("triples", report.output_triples);
+        json.field("peak_rss", util::peakRssBytes());
+        json.key("steps");
+        json.beginArray();
+        for (const StepTiming& s : steps) {
+            json.beginObject();
+            json.field("name", s.name);
+            json.field("kind", s.kind);
+            json.field("rows", s.rows);
+            json.field("triples", s.triples);
+            json.field("seconds", s.seconds);
+            json.field("rows_per_second", s.seconds > 0 ? s.rows / s.seconds : 0.0);
+            json.field("peak_rss", s.peak_rss);
+            json.endObject();
+        }
+        json.endArray();
+        json.endObject();
+        json.endArray();
+        json.endObject();
+        out << "\n";
+    }
+    std::fprintf(stderr, "wrote %s\n", json_path.c_str());
+
+    if (python) {
+        std::string command = "python3 \"" + std::string(ISTA_SOURCE_DIR) + "/benchmarks/alzkb_pipeline.py\" --json \""
+            + json_path + "\" \"" + replay_path + "\"";
+        std::fflush(stdout);
+        if (int status = std::system(command.c_str()); status != 0) {
+            std::fprintf(stderr, "python replay failed (status %d)\n", status);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,239 @@
+#!/usr/bin/env python3
+"""Replay an `ista build` manifest through FlatFileDatabaseParser and owlready2.
+
+    python3 benchmarks/alzkb_pipeline.py [--json FILE] [--output FILE] manifest.yaml
+
+This is the Python half of benchmarks/alzkb_pipeline.cpp, which generates the
+synthetic sources and the manifest it runs on and calls this script when given
+--python. Each step becomes the parse_node_type or parse_relationship_type call
+alzkb.py would make, timed on its own; the save is timed last. The run is
+appended to the "runs" list of FILE (created if missing), and every run in the
+file is printed side by side per step.
+"""
+
+import argparse
+import contextlib
+import io
+import json
+import os
+import resource
+import sys
+import time
+
+import yaml
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), ".."))
+
+
+def peak_rss():
+    """The kernel's high-water mark for this process, in bytes."""
+    try:
+        with open("/proc/self/status") as f:
+            for line in f:
+                if line.startswith("VmHWM:"):
+                    return int(line.split()[1]) * 1024
+    except OSError:
+        pass
+    return resource.getrusage(resource.RUSAGE_SELF).ru_maxrss * 1024
+
+
+def reset_peak_rss():
+    with contextlib.suppress(OSError), open("/proc/self/clear_refs", "w") as f:
+        f.write("5")
+
+
+TRANSFORMS = {
+    "split_last": lambda arg: lambda x: x.split(arg)[-1],
+    "split_first": lambda arg: lambda x: x.split(arg)[0],
+    "strip": lambda arg: lambda x: x.strip(),
+    "lower": lambda arg: lambda x: x.lower(),
+    "upper": lambda arg: lambda x: x.upper(),
+    "prefix": lambda arg: lambda x: arg + x,
+    "strip_prefix": lambda arg: lambda x: x[len(arg):] if x.startswith(arg) else x,
+    "int": lambda arg: lambda x: str(int(x)),
+}
+
+
+def make_transform(spec):
+    """The lambda a manifest's named transforms stand for."""
+    if isinstance(spec, str):
+        return TRANSFORMS[spec](None)
+    if isinstance(spec, dict):
+        fns = [TRANSFORMS[op](arg) for op, arg in spec.items()]
+    else:
+        fns = [make_transform(s) for s in spec]
+
+    def apply(x):
+        for fn in fns:
+            x = fn(x)
+        return x
+
+    return apply
+
+
+def step_name(step, names):
+    """Same naming as build::loadManifest, so runs line up per step."""
+    name = step.get("name") or "{0}:{1}".format(step["source"], step.get("node_type") or step["relationship_type"])
+    n = names.get(name, 0)
+    names[name] = n + 1
+    return name if n == 0 else "{0}#{1}".format(name, n + 1)
+
+
+def python_config(onto, config):
+    """parse_config with property names resolved and transforms as callables."""
+    out = dict(config)
+    if "data_property_map" in out:
+        out["data_property_map"] = {k: getattr(onto, v) for k, v in out["data_property_map"].items()}
+    if "merge_column" in out:
+        merge = dict(out["merge_column"])
+        merge["data_property"] = getattr(onto, merge["data_property"])
+        out["merge_column"] = merge
+    for key in ("subject_match_property", "object_match_property"):
+        if key in out:
+            out[key] = getattr(onto, out[key])
+    if "data_transforms" in out:
+        out["data_transforms"] = {k: make_transform(v) for k, v in out["data_transforms"].items()}
+    return out
+
+
+def count_rows(path, config):
+    with open(path, "rb") as f:
+        rows = sum(1 for _ in f)
+    if config.get("headers") is True:
+        rows -= 1
+    return rows - config.get("skip_n_lines", 0)
+
+
+def replay(manifest_path, output):
+    import owlready2
+    from ista import FlatFileDatabaseParser
+
+    with open(manifest_path) as f:
+        manifest = yaml.safe_load(f)
+    base = os.path.dirname(os.path.abspath(manifest_path))
+    data_dir = os.path.join(base, manifest.get("data_dir", "."))
+    ontology = os.path.join(base, manifest["ontology"])
+
+    steps = []
+    reset_peak_rss()
+    start = time.perf_counter()
+    onto = owlready2.get_ontology("file://" + ontology).load()
+    steps.append({"name": "load ontology", "kind": "load", "rows": 0, "triples": 0,
+                  "seconds": time.perf_counter() - start, "peak_rss": peak_rss()})
+
+    parsers = {}
+    names = {}
+    for step in manifest["steps"]:
+        if step.get("skip"):
+            continue
+        source = step["source"]
+        parser = parsers.setdefault(source, FlatFileDatabaseParser(source, onto, data_dir))
+        config = python_config(onto, step.get("parse_config", {}))
+        name = step_name(step, names)
+        rows = count_rows(os.path.join(data_dir, source, step["source_filename"]), config)
+        reset_peak_rss()
+        t = time.perf_counter()
+        # The parsers print progress per row; keep it out of the timings.
+        with contextlib.redirect_stdout(io.StringIO()), contextlib.redirect_stderr(io.StringIO()):
+            if "node_type" in step:
+                parser.parse_node_type(
+                    node_type=step["node_type"],
+                    source_filename=step["source_filename"],
+                    fmt=step["fmt"],
+                    parse_config=config,
+                    merge=step.get("merge", False),
+                    append_class=step.get("append_class", False),
+                    existing_class=step.get("existing_class"),
+                    skip_create_new_node=step.get("skip_create_new_node", False),
+                )
+                kind = "node"
+            else:
+                inverse = step.get("inverse_relationship_type")
+                parser.parse_relationship_type(
+                    relationship_type=getattr(onto, step["relationship_type"]),
+                    source_filename=step["source_filename"],
+                    fmt=step["fmt"],
+                    parse_config=config,
+                    inverse_relationship_type=getattr(onto, inverse) if inverse else None,
+                    merge=step.get("merge", False),
+                )
+                kind = "relationship"
+        steps.append({"name": name, "kind": kind, "rows": rows, "triples": 0,
+                      "seconds": time.perf_counter() - t, "peak_rss": peak_rss()})
+
+    reset_peak_rss()
+    t = time.perf_counter()
+    onto.save(file=output, format="ntriples")
+    triples = len(onto.graph)
+    steps.append({"name": "assemble and save", "kind": "save", "rows": triples, "triples": triples,
+                  "seconds": time.perf_counter() - t, "peak_rss": peak_rss()})
+    for s in steps:
+        s["rows_per_second"] = s["rows"] / s["seconds"] if s["seconds"] > 0 else 0.0
+    return {
+        "path": "python",
+        "total_seconds": time.perf_counter() - start,
+        "triples": triples,
+        "peak_rss": resource.getrusage(resource.RUSAGE_SELF).ru_maxrss * 1024,
+        "steps": steps,
+    }
+
+
+def format_bytes(n):
+    for unit in ("B", "KiB", "MiB", "GiB"):
+        if n < 1024 or unit == "GiB":
+            return "{0:.0f} {1}".format(n, unit) if unit == "B" else "{0:.1f} {1}".format(n, unit)
+        n /= 1024.0
+
+
+def print_runs(runs):
+    """Seconds and peak RSS per step for every run, in first-seen step order."""
+    order = []
+    for run in runs:
+        for s in run["steps"]:
+            if s["name"] not in order:
+                order.append(s["name"])
+    header = "{0:<52}".format("step") + "".join(
+        " {0:>10} {1:>11}".format(run["path"] + " s", "peak RSS") for run in runs)
+    print(header)
+    for name in order:
+        line = "{0:<52}".format(name)
+        for run in runs:
+            s = next((s for s in run["steps"] if s["name"] == name), None)
+            if s is None:
+                line += " {0:>10} {1:>11}".format("-", "-")
+            else:
+                line += " {0:>10.3f} {1:>11}".format(s["seconds"], format_bytes(s["peak_rss"]))
+        print(line)
+    print("{0:<52}".format("total") + "".join(
+        " {0:>10.3f} {1:>11}".format(run["total_seconds"], format_bytes(run["peak_rss"])) for run in runs))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("manifest")
+    ap.add_argument("--json", help="results file to append this run to")
+    ap.add_argument("--output", help="where to save the populated KB (default: next to the manifest)")
+    args = ap.parse_args()
+
+    try:
+        import owlready2  # noqa: F401
+    except ImportError:
+        sys.exit("owlready2 is not installed; cannot replay the Python path")
+
+    output = args.output or os.path.join(os.path.dirname(os.path.abspath(args.manifest)), "alzkb-python.nt")
+    run = replay(args.manifest, output)
+
+    results = {"runs": []}
+    if args.json and os.path.exists(args.json):
+        with open(args.json) as f:
+            results = json.load(f)
+    results["runs"] = [r for r in results.get("runs", []) if r["path"] != "python"] + [run]
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(results, f, indent=2)
+            f.write("\n")
+    print_runs(results["runs"])
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,157 @@
+#ifndef BENCH_FIXTURES_HPP
+#define BENCH_FIXTURES_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <unistd.h>
+
+#include "io/triple.hpp"
+#include "owl2/ontology.hpp"
+#include "owl2/vocabulary.hpp"
+
+
+namespace ista
+{
+
+namespace bench
+{
+
+
+// Inputs shared by the ista_bench suites. Everything is generated once per
+// process into a scratch directory that is removed at exit.
+class Fixtures
+{
+public:
+    static Fixtures& instance()
+    {
+        static Fixtures fixtures;
+        return fixtures;
+    }
+
+    // One of the KBs shipped with the repository ("comptox" or "alzkb"),
+    // scaled to `scale` copies and written as `format`. Each copy renames
+    // its non-builtin IRIs and blank nodes, so interning and indexing see
+    // `scale` times the distinct terms, not just more duplicates.
+    const std::string& dataset(const std::string& name, unsigned scale, io::Format format)
+    {
+        auto key = std::make_tuple(name, scale, format);
+        auto it = datasets_.find(key);
+        if (it != datasets_.end())
+            return it->second;
+        std::string path = (dir_ / (name + "_x" + std::to_string(scale) + "." + io::formatName(format))).string();
+        auto reader = io::openReader(sourcePath(name), io::Format::RdfXml);
+        std::vector<io::Triple> triples;
+        io::Triple t;
+        while (reader->next(t))
+            triples.push_back(t);
+        auto writer = io::openWriter(path, format);
+        for (unsigned copy = 0; copy < scale; ++copy) {
+            for (io::Triple triple : triples) {
+                rename(triple.subject, copy);
+                rename(triple.object, copy);
+                writer->write(triple);
+            }
+        }
+        writer->close();
+        return datasets_.emplace(key, path).first->second;
+    }
+
+    // A file path in the scratch directory, for writers under test.
+    std::string scratch(const std::string& name) const { return (dir_ / name).string(); }
+
+private:
+    Fixtures()
+    {
+        dir_ = std::filesystem::temp_directory_path() / ("ista_bench_" + std::to_string(::getpid()));
+        std::filesystem::create_directories(dir_);
+    }
+    ~Fixtures()
+    {
+        std::error_code ignored;
+        std::filesystem::remove_all(dir_, ignored);
+    }
+
+    static std::string sourcePath(const std::string& name)
+    {
+        if (name == "comptox")
+            return std::string(ISTA_SOURCE_DIR) + "/ista/tests/data/comptox.rdf";
+        return std::string(ISTA_SOURCE_DIR) + "/examples/projects/alzkb/alzkb.rdf";
+    }
+
+    static void rename(io::Term& term, unsigned copy)
+    {
+        if (copy == 0 || term.kind == io::TermKind::Literal)
+            return;
+        if (term.kind == io::TermKind::Iri && owl2::vocab::isBuiltin(term.value))
+            return;
+        term.value += "_" + std::to_string(copy);
+    }
+
+    std::filesystem::path dir_;
+    std::map<std::tuple<std::string, unsigned, io::Format>, std::string> datasets_;
+};
+
+
+// An Ontology whose ObjectPropertyAssertions form a uniform random graph.
+inline owl2::Ontology randomGraph(std::uint64_t vertices, std::uint64_t edges, std::uint64_t seed = 7)
+{
+    owl2::Ontology onto;
+    std::vector<owl2::TermId> ids(vertices);
+    for (std::uint64_t v = 0; v < vertices; ++v)
+        ids[v] = onto.internIri("http://jdr.bio/ontologies/alzkb.owl#v" + std::to_string(v));
+    owl2::TermId predicate = onto.internIri("http://jdr.bio/ontologies/alzkb.owl#linksTo");
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<std::uint64_t> pick(0, vertices - 1);
+    for (std::uint64_t e = 0; e < edges; ++e)
+        onto.addAxiom(owl2::AxiomKind::ObjectPropertyAssertion, {ids[pick(rng)], predicate, ids[pick(rng)]});
+    return onto;
+}
+
+// An Ontology whose ObjectPropertyAssertions link each vertex to others at
+// most `reach` steps away along a hidden ring, plus one random shortcut in
+// sixteen so that its diameter stays small, with IRIs interned in random
+// order: a graph with good locality hidden by ingestion order, which is
+// what the vertex reorderings are meant to recover.
+inline owl2::Ontology shuffledLocalGraph(std::uint64_t vertices, std::uint64_t edges, std::uint64_t reach = 64,
+                                         std::uint64_t seed = 7)
+{
+    owl2::Ontology onto;
+    std::vector<std::uint64_t> position(vertices);
+    for (std::uint64_t v = 0; v < vertices; ++v)
+        position[v] = v;
+    std::mt19937_64 rng(seed);
+    std::shuffle(position.begin(), position.end(), rng);
+    std::vector<owl2::TermId> ids(vertices);
+    for (std::uint64_t p : position)
+        ids[p] = onto.internIri("http://jdr.bio/ontologies/alzkb.owl#v" + std::to_string(p));
+    owl2::TermId predicate = onto.internIri("http://jdr.bio/ontologies/alzkb.owl#linksTo");
+    std::uniform_int_distribution<std::uint64_t> pick(0, vertices - 1), step(1, reach);
+    for (std::uint64_t e = 0; e < edges; ++e) {
+        std::uint64_t from = pick(rng);
+        std::uint64_t to = e % 16 == 0 ? pick(rng) : (from + step(rng)) % vertices;
+        onto.addAxiom(owl2::AxiomKind::ObjectPropertyAssertion, {ids[from], predicate, ids[to]});
+    }
+    return onto;
+}
+
+// Distinct IRIs in the comptox.owl namespace.
+inline std::vector<std::string> syntheticIris(std::size_t count)
+{
+    std::vector<std::string> iris;
+    iris.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+        iris.push_back("http://jdr.bio/ontologies/comptox.owl#chemical_dtxsid" + std::to_string(10000 + i));
+    return iris;
+}
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,169 @@
+// CSR construction and the streaming graph algorithms over a random graph.
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "bench_fixtures.hpp"
+#include "graph/algorithms.hpp"
+#include "graph/csr.hpp"
+#include "graph/reorder.hpp"
+#include "perf_counters.hpp"
+#include "util/parallel.hpp"
+
+using namespace ista;
+
+namespace
+{
+
+// vertices = range(0), edges = 8 * vertices.
+const owl2::Ontology& graphKb(std::int64_t vertices)
+{
+    static std::map<std::int64_t, std::unique_ptr<owl2::Ontology>> kbs;
+    auto& kb = kbs[vertices];
+    if (!kb)
+        kb = std::make_unique<owl2::Ontology>(bench::randomGraph(vertices, 8 * vertices));
+    return *kb;
+}
+
+const graph::MappedCsr& graphCsr(std::int64_t vertices)
+{
+    static std::map<std::int64_t, std::unique_ptr<graph::MappedCsr>> graphs;
+    auto& g = graphs[vertices];
+    if (!g) {
+        std::string path = bench::Fixtures::instance().scratch("graph_" + std::to_string(vertices) + ".csr");
+        graph::buildCsr(graphKb(vertices), path);
+        g = std::make_unique<graph::MappedCsr>(path);
+    }
+    return *g;
+}
+
+// shuffledLocalGraph(vertices, 8 * vertices) renumbered by `order`, with
+// compressed targets if `compress`.
+const graph::MappedCsr& orderedCsr(std::int64_t vertices, graph::VertexOrder order, bool compress)
+{
+    static std::map<std::tuple<std::int64_t, graph::VertexOrder, bool>, std::unique_ptr<graph::MappedCsr>> graphs;
+    auto& g = graphs[{vertices, order, compress}];
+    if (!g) {
+        auto& fixtures = bench::Fixtures::instance();
+        std::string base = fixtures.scratch("local_" + std::to_string(vertices) + ".csr");
+        if (!std::filesystem::exists(base))
+            graph::buildCsr(bench::shuffledLocalGraph(vertices, 8 * vertices), base);
+        std::string path = fixtures.scratch("local_" + std::to_string(vertices) + "_"
+                                            + graph::vertexOrderName(order) + (compress ? "_packed" : "") + ".csr");
+        graph::CsrBuildOptions options;
+        options.compress = compress;
+        graph::reorderCsr(graph::MappedCsr(base), path, order, options);
+        g = std::make_unique<graph::MappedCsr>(path);
+    }
+    return *g;
+}
+
+graph::StreamOptions streamOptions()
+{
+    graph::StreamOptions options;
+    options.threads = util::defaultThreadCount();
+    return options;
+}
+
+// The ordered benchmarks' graph, labelled with its order and target size.
+const graph::MappedCsr& orderedCsr(benchmark::State& state)
+{
+    const graph::MappedCsr& g = orderedCsr(state.range(0), static_cast<graph::VertexOrder>(state.range(1)),
+                                           state.range(2) != 0);
+    state.counters["target_bytes/edge"] = static_cast<double>(g.targetsSize()) / static_cast<double>(g.edgeCount());
+    state.SetLabel(std::string(graph::vertexOrderName(g.order())) + (g.compressed() ? " compressed" : ""));
+    return g;
+}
+
+}
+
+
+static void BM_CsrBuild(benchmark::State& state)
+{
+    const owl2::Ontology& kb = graphKb(state.range(0));
+    std::string path = bench::Fixtures::instance().scratch("build.csr");
+    graph::CsrBuildOptions options;
+    options.threads = util::defaultThreadCount();
+    bench::PerfRegion perf(state);
+    for (auto _ : state)
+        graph::buildCsr(kb, path, options);
+    state.SetItemsProcessed(state.iterations() * 8 * state.range(0));
+}
+BENCHMARK(BM_CsrBuild)->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+static void BM_Bfs(benchmark::State& state)
+{
+    const graph::MappedCsr& g = graphCsr(state.range(0));
+    owl2::TermId source = graphKb(state.range(0)).findIri("http://jdr.bio/ontologies/alzkb.owl#v0");
+    std::uint64_t scanned = 0;
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        graph::BfsResult r = graph::bfs(g, source, streamOptions());
+        scanned = r.edges_scanned;
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(scanned));
+}
+BENCHMARK(BM_Bfs)->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+// Ten fixed iterations, so runs of different sizes do the same passes.
+static void BM_PageRank(benchmark::State& state)
+{
+    const graph::MappedCsr& g = graphCsr(state.range(0));
+    graph::PageRankOptions pr;
+    pr.max_iterations = 10;
+    pr.tolerance = 0.0;
+    bench::PerfRegion perf(state);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(graph::pageRank(g, pr, streamOptions()).delta);
+    state.SetItemsProcessed(state.iterations() * 10 * static_cast<std::int64_t>(g.edgeCount()));
+}
+BENCHMARK(BM_PageRank)->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+static void BM_ConnectedComponents(benchmark::State& state)
+{
+    const graph::MappedCsr& g = graphCsr(state.range(0));
+    bench::PerfRegion perf(state);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(graph::connectedComponents(g, streamOptions()).count);
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(g.edgeCount()));
+}
+BENCHMARK(BM_ConnectedComponents)->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+// The same traversals over a graph with hidden locality, by vertex order
+// (range(1): 0 original, 1 degree, 2 bfs, 3 rcm) and with plain or
+// compressed targets (range(2)). The per-vertex state is what the order
+// changes: at 2^20 vertices it no longer fits in cache. Compression trades
+// decoding for a smaller edge section, and shrinks most under an order that
+// keeps neighbor ids close.
+static void BM_BfsOrdered(benchmark::State& state)
+{
+    const graph::MappedCsr& g = orderedCsr(state);
+    owl2::TermId source = g.findVertex("http://jdr.bio/ontologies/alzkb.owl#v0");
+    std::uint64_t scanned = 0;
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        graph::BfsResult r = graph::bfs(g, source, streamOptions());
+        scanned = r.edges_scanned;
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(scanned));
+}
+BENCHMARK(BM_BfsOrdered)->ArgsProduct({{1 << 20}, {0, 1, 2, 3}, {0, 1}})->Unit(benchmark::kMillisecond);
+
+static void BM_PageRankOrdered(benchmark::State& state)
+{
+    const graph::MappedCsr& g = orderedCsr(state);
+    graph::PageRankOptions pr;
+    pr.max_iterations = 10;
+    pr.tolerance = 0.0;
+    bench::PerfRegion perf(state);
+    for (auto _ : state)
+        benchmark::DoNotOptimize(graph::pageRank(g, pr, streamOptions()).delta);
+    state.SetItemsProcessed(state.iterations() * 10 * static_cast<std::int64_t>(g.edgeCount()));
+}
+BENCHMARK(BM_PageRankOrdered)->ArgsProduct({{1 << 20}, {0, 1, 2, 3}, {0, 1}})->Unit(benchmark::kMillisecond);
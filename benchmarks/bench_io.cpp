@@ -0,0 +1,83 @@
+// Parsing, loading and serialization throughput of the repository's sample
+// KBs, scaled up by Fixtures::dataset().
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <string>
+
+#include "bench_fixtures.hpp"
+#include "io/triple.hpp"
+#include "perf_counters.hpp"
+
+using namespace ista;
+
+namespace
+{
+
+const io::Format FORMATS[] = {io::Format::RdfXml, io::Format::Turtle, io::Format::NTriples, io::Format::Functional,
+                              io::Format::Snapshot};
+const char* DATASETS[] = {"comptox", "alzkb"};
+const unsigned SCALES[] = {1, 16};
+
+void setThroughput(benchmark::State& state, const std::string& path, std::uint64_t triples)
+{
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(std::filesystem::file_size(path)));
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(triples));
+}
+
+// Reader only: triples out of the file, nothing interned.
+void parse(benchmark::State& state, std::string name, unsigned scale, io::Format format)
+{
+    const std::string& path = bench::Fixtures::instance().dataset(name, scale, format);
+    std::uint64_t triples = 0;
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        auto reader = io::openReader(path, format);
+        io::Triple t;
+        triples = 0;
+        while (reader->next(t))
+            ++triples;
+    }
+    setThroughput(state, path, triples);
+}
+
+// Reader plus interning into a new Ontology.
+void load(benchmark::State& state, std::string name, unsigned scale, io::Format format)
+{
+    const std::string& path = bench::Fixtures::instance().dataset(name, scale, format);
+    std::uint64_t triples = 0;
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        owl2::Ontology onto = io::readOntology(path, format);
+        triples = onto.axiomCount();
+    }
+    setThroughput(state, path, triples);
+}
+
+void write(benchmark::State& state, std::string name, unsigned scale, io::Format format)
+{
+    const std::string& source = bench::Fixtures::instance().dataset(name, scale, io::Format::NTriples);
+    owl2::Ontology onto = io::readOntology(source, io::Format::NTriples);
+    std::string path = bench::Fixtures::instance().scratch(name + "_out." + io::formatName(format));
+    bench::PerfRegion perf(state);
+    for (auto _ : state)
+        io::writeOntology(onto, path, format);
+    setThroughput(state, path, onto.axiomCount());
+}
+
+const bool registered = [] {
+    for (const char* name : DATASETS) {
+        for (unsigned scale : SCALES) {
+            for (io::Format format : FORMATS) {
+                std::string suffix = std::string(name) + "/x" + std::to_string(scale) + "/" + io::formatName(format);
+                benchmark::RegisterBenchmark(("BM_Parse/" + suffix).c_str(), parse, name, scale, format);
+                benchmark::RegisterBenchmark(("BM_Load/" + suffix).c_str(), load, name, scale, format);
+                benchmark::RegisterBenchmark(("BM_Write/" + suffix).c_str(), write, name, scale, format);
+            }
+        }
+    }
+    return true;
+}();
+
+}
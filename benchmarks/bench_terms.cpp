@@ -0,0 +1,288 @@
+// Term construction, interning, axiom insertion and index lookups.
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench_fixtures.hpp"
+#include "build/step.hpp"
+#include "owl2/concurrent_iri_pool.hpp"
+#include "owl2/iri.hpp"
+#include "owl2/iri_dictionary.hpp"
+#include "owl2/iri_pool.hpp"
+#include "owl2/literal_pool.hpp"
+#include "owl2/ontology.hpp"
+#include "owl2/vocabulary.hpp"
+#include "perf_counters.hpp"
+#include "util/bloom_filter.hpp"
+#include "util/perfect_hash.hpp"
+
+using namespace ista;
+
+
+static void BM_IriConstruct(benchmark::State& state)
+{
+    auto iris = bench::syntheticIris(static_cast<std::size_t>(state.range(0)));
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        for (const std::string& s : iris)
+            benchmark::DoNotOptimize(IRI(s));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(iris.size()));
+}
+BENCHMARK(BM_IriConstruct)->Arg(1 << 14);
+
+// Every IRI is new: the cost of growing the pool and its hash table.
+static void BM_IriPoolInternNew(benchmark::State& state)
+{
+    auto iris = bench::syntheticIris(static_cast<std::size_t>(state.range(0)));
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        owl2::IriPool pool;
+        for (const std::string& s : iris)
+            benchmark::DoNotOptimize(pool.intern(s));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(iris.size()));
+}
+BENCHMARK(BM_IriPoolInternNew)->Arg(1 << 14)->Arg(1 << 20);
+
+// Every IRI is already present, as for the predicates and classes that
+// repeat on most triples.
+static void BM_IriPoolInternHit(benchmark::State& state)
+{
+    auto iris = bench::syntheticIris(static_cast<std::size_t>(state.range(0)));
+    owl2::IriPool pool;
+    for (const std::string& s : iris)
+        pool.intern(s);
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        for (const std::string& s : iris)
+            benchmark::DoNotOptimize(pool.intern(s));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(iris.size()));
+}
+BENCHMARK(BM_IriPoolInternHit)->Arg(1 << 14)->Arg(1 << 20);
+
+// All threads intern the same stream into one shared pool.
+static void BM_ConcurrentIriPoolIntern(benchmark::State& state)
+{
+    static std::unique_ptr<owl2::ConcurrentIriPool> pool;
+    static std::vector<std::string> iris;
+    if (state.thread_index() == 0) {
+        pool = std::make_unique<owl2::ConcurrentIriPool>();
+        iris = bench::syntheticIris(1 << 18);
+    }
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        for (std::size_t i = static_cast<std::size_t>(state.thread_index()); i < iris.size();
+             i += static_cast<std::size_t>(state.threads()))
+            benchmark::DoNotOptimize(pool->intern(iris[i]));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(iris.size() / state.threads()));
+    if (state.thread_index() == 0)
+        pool.reset();
+}
+BENCHMARK(BM_ConcurrentIriPoolIntern)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_LiteralIntern(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::vector<std::string> values;
+    for (std::size_t i = 0; i < n; ++i)
+        values.push_back(std::to_string(i * 7919 % 100003) + ".25");
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        owl2::LiteralPool pool;
+        for (const std::string& v : values)
+            benchmark::DoNotOptimize(pool.intern(v, 1));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_LiteralIntern)->Arg(1 << 16);
+
+// Ontology::addAxiom with the ids already interned: classification plus
+// the append to the matching table.
+static void BM_AxiomInsert(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    owl2::Ontology proto;
+    std::vector<owl2::TermId> subjects;
+    for (const std::string& s : bench::syntheticIris(4096))
+        subjects.push_back(proto.internIri(s));
+    owl2::TermId predicates[] = {
+        proto.internIri(owl2::vocab::RDF_TYPE),
+        proto.internIri("http://jdr.bio/ontologies/comptox.owl#chemicalHasActiveAssay"),
+        proto.internIri("http://jdr.bio/ontologies/comptox.owl#xrefDTXSID"),
+    };
+    owl2::TermId classes[] = {proto.internIri("http://jdr.bio/ontologies/comptox.owl#Chemical")};
+    owl2::TermId literal = proto.internLiteral("DTXSID7020182", proto.xsdString());
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        state.PauseTiming();
+        owl2::Ontology onto = proto;
+        state.ResumeTiming();
+        for (std::size_t i = 0; i < n; ++i) {
+            owl2::TermId s = subjects[i % subjects.size()];
+            switch (i % 3) {
+            case 0: onto.addAxiom(s, predicates[0], classes[0]); break;
+            case 1: onto.addAxiom(s, predicates[1], subjects[(i * 31) % subjects.size()]); break;
+            default: onto.addAxiom(s, predicates[2], literal); break;
+            }
+        }
+        benchmark::DoNotOptimize(onto.axiomCount());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_AxiomInsert)->Arg(1 << 20);
+
+// Half hits, half misses.
+static void BM_IriPoolFind(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    auto iris = bench::syntheticIris(2 * n);
+    owl2::IriPool pool;
+    for (std::size_t i = 0; i < n; ++i)
+        pool.intern(iris[2 * i]);
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        for (const std::string& s : iris)
+            benchmark::DoNotOptimize(pool.find(s));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(iris.size()));
+}
+BENCHMARK(BM_IriPoolFind)->Arg(1 << 14)->Arg(1 << 20);
+
+// The same lookups against the front-coded dictionary a snapshot carries,
+// which trades a binary search for a fraction of the pool's bytes.
+static void BM_IriDictionaryFind(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    auto iris = bench::syntheticIris(2 * n);
+    owl2::IriPool pool;
+    for (std::size_t i = 0; i < n; ++i)
+        pool.intern(iris[2 * i]);
+    owl2::IriDictionary::Parts parts = owl2::IriDictionary::build(pool);
+    owl2::IriDictionary dictionary(parts);
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        for (const std::string& s : iris)
+            benchmark::DoNotOptimize(dictionary.find(s));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(iris.size()));
+    state.counters["dictionary_bytes/iri"] = static_cast<double>(parts.bytes.size()) / static_cast<double>(n);
+    state.counters["pool_bytes/iri"] = static_cast<double>(pool.byteSize()) / static_cast<double>(n);
+}
+BENCHMARK(BM_IriDictionaryFind)->Arg(1 << 14)->Arg(1 << 20);
+
+static void BM_IriDictionaryAt(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    owl2::IriPool pool;
+    for (const std::string& s : bench::syntheticIris(n))
+        pool.intern(s);
+    owl2::IriDictionary::Parts parts = owl2::IriDictionary::build(pool);
+    owl2::IriDictionary dictionary(parts);
+    std::string buffer;
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        for (owl2::TermId id = 0; id < n; ++id)
+            benchmark::DoNotOptimize(dictionary.at(id, buffer).size());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_IriDictionaryAt)->Arg(1 << 14)->Arg(1 << 20);
+
+// The same lookups against a snapshot's perfect hash: a pilot and a slot,
+// with misses caught by the slot's fingerprint.
+static void BM_IriHashFind(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    auto iris = bench::syntheticIris(2 * n);
+    std::vector<std::pair<std::string_view, std::uint32_t>> entries;
+    for (std::size_t i = 0; i < n; ++i)
+        entries.emplace_back(iris[2 * i], static_cast<std::uint32_t>(i));
+    std::vector<char> bytes = util::PerfectHashIndex::build(entries);
+    util::PerfectHashIndex hash(bytes);
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        for (const std::string& s : iris)
+            benchmark::DoNotOptimize(hash.find(s).data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(iris.size()));
+    state.counters["hash_bytes/iri"] = static_cast<double>(bytes.size()) / static_cast<double>(n);
+}
+BENCHMARK(BM_IriHashFind)->Arg(1 << 14)->Arg(1 << 20);
+
+// The (property, value) -> individuals index that ista build resolves
+// relationship endpoints through.
+static void BM_KeyIndexFind(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    build::KeyIndex keys;
+    const std::string property = "http://jdr.bio/ontologies/alzkb.owl#geneSymbol";
+    std::vector<std::string> values;
+    for (std::size_t i = 0; i < n; ++i) {
+        values.push_back("G" + std::to_string(i));
+        keys.add(property, values.back(), "http://jdr.bio/ontologies/alzkb.owl#gene_" + std::to_string(i));
+    }
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        for (const std::string& v : values)
+            benchmark::DoNotOptimize(keys.find(property, v));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_KeyIndexFind)->Arg(1 << 16);
+
+// Relationship rows naming identifiers the KB lacks, looked up straight in
+// the map (0) or through the property's Bloom filter first (1), as steps do.
+static void BM_KeyIndexMiss(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    bool filtered = state.range(1) != 0;
+    build::KeyIndex keys;
+    const std::string property = "http://jdr.bio/ontologies/alzkb.owl#geneSymbol";
+    std::vector<std::string> missing;
+    for (std::size_t i = 0; i < n; ++i) {
+        keys.add(property, "G" + std::to_string(i), "http://jdr.bio/ontologies/alzkb.owl#gene_" + std::to_string(i));
+        missing.push_back("X" + std::to_string(i));
+    }
+    const util::BloomFilter& filter = keys.filter(property);
+    std::int64_t passed = 0;
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        for (const std::string& v : missing) {
+            if (filtered && !filter.mayContain(v))
+                continue;
+            ++passed;
+            benchmark::DoNotOptimize(keys.find(property, v));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+    state.counters["probed"] = static_cast<double>(passed) / static_cast<double>(state.iterations() * n);
+    state.counters["filter_bytes/key"] = static_cast<double>(filter.byteSize()) / static_cast<double>(n);
+}
+BENCHMARK(BM_KeyIndexMiss)->Args({1 << 16, 0})->Args({1 << 16, 1});
+
+// The key index a snapshot carries for the same property.
+static void BM_KeyHashFind(benchmark::State& state)
+{
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::vector<std::string> values;
+    for (std::size_t i = 0; i < n; ++i)
+        values.push_back("G" + std::to_string(i));
+    std::vector<std::pair<std::string_view, std::uint32_t>> entries;
+    for (std::size_t i = 0; i < n; ++i)
+        entries.emplace_back(values[i], static_cast<std::uint32_t>(i));
+    std::vector<char> bytes = util::PerfectHashIndex::build(entries);
+    util::PerfectHashIndex hash(bytes);
+    bench::PerfRegion perf(state);
+    for (auto _ : state) {
+        for (const std::string& v : values)
+            benchmark::DoNotOptimize(hash.find(v).data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_KeyHashFind)->Arg(1 << 16);
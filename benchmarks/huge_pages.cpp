@@ -0,0 +1,106 @@
+// Measures what huge pages buy random access over a large array, the access
+// pattern of a CSR gather or a term-id lookup into a multi-GB column. The
+// array comes from util::mapHuge() in each mode and is read at hashed
+// indices, so nearly every load lands on a different 4 KiB page.
+//
+//   huge_pages [--size BYTES] [--loads N]
+//
+// dTLB load misses come from perf_event_open when the kernel exposes the
+// counter (perf_event_paranoid <= 2 and a PMU, which many VMs lack); the
+// "huge" column is how much of the block the kernel actually backed with
+// 2 MiB pages, from /proc/self/smaps_rollup and /proc/meminfo.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string>
+
+#include "perf_counters.hpp"
+#include "util/hash.hpp"
+#include "util/huge_pages.hpp"
+#include "util/resource_usage.hpp"
+
+using namespace ista;
+
+// A "Key:   123 kB" field of a /proc file, in bytes.
+static std::uint64_t procField(const char* path, const std::string& key, std::uint64_t unit = 1024)
+{
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, key.size(), key) == 0 && line.size() > key.size() && line[key.size()] == ':')
+            return std::stoull(line.substr(key.size() + 1)) * unit;
+    }
+    return 0;
+}
+
+static std::uint64_t hugeBytesInUse()
+{
+    std::uint64_t anon = procField("/proc/self/smaps_rollup", "AnonHugePages");
+    std::uint64_t page = procField("/proc/meminfo", "Hugepagesize");
+    std::uint64_t reserved = procField("/proc/meminfo", "HugePages_Total", 1)
+                           - procField("/proc/meminfo", "HugePages_Free", 1);
+    return anon + reserved * page;
+}
+
+int main(int argc, char* argv[])
+{
+    std::uint64_t size = std::uint64_t(1) << 30;
+    std::uint64_t loads = 50000000;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc) {
+            size = util::parseBytes(argv[++i]);
+        } else if (arg == "--loads" && i + 1 < argc) {
+            loads = std::stoull(argv[++i]);
+        } else {
+            std::fprintf(stderr, "usage: huge_pages [--size BYTES] [--loads N]\n");
+            return 1;
+        }
+    }
+    // A power of two, so an index is a mask of a hash.
+    std::uint64_t count = 1;
+    while (count * 2 * sizeof(std::uint32_t) <= size)
+        count *= 2;
+    std::uint64_t mask = count - 1;
+    std::printf("array: %s, %llu random loads\n", util::formatBytes(count * sizeof(std::uint32_t)).c_str(),
+                static_cast<unsigned long long>(loads));
+
+    std::printf("%-8s %12s %10s %10s %12s %14s\n", "mode", "huge", "fill s", "Mloads/s", "speedup", "dTLB miss/load");
+    double base = 0.0;
+    for (util::HugePages mode : {util::HugePages::Off, util::HugePages::Transparent, util::HugePages::Explicit}) {
+        std::uint64_t huge_before = hugeBytesInUse();
+        auto start = std::chrono::steady_clock::now();
+        auto* a = static_cast<std::uint32_t*>(util::mapHuge(count * sizeof(std::uint32_t), mode));
+        for (std::uint64_t i = 0; i < count; ++i)
+            a[i] = static_cast<std::uint32_t>(i);
+        double fill = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::uint64_t huge = hugeBytesInUse() - huge_before;
+
+        bench::PerfCounters counters;
+        std::uint64_t sum = 0;
+        counters.start();
+        start = std::chrono::steady_clock::now();
+        for (std::uint64_t i = 0; i < loads; ++i)
+            sum += a[util::mix64(i) & mask];
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        counters.stop();
+        std::optional<std::uint64_t> missed = counters.value(bench::PerfEvent::DtlbMisses);
+        util::unmapHuge(a, count * sizeof(std::uint32_t));
+
+        double rate = loads / seconds / 1e6;
+        if (base == 0.0)
+            base = rate;
+        char tlb[32] = "n/a";
+        if (missed)
+            std::snprintf(tlb, sizeof(tlb), "%.3f", static_cast<double>(*missed) / loads);
+        std::printf("%-8s %12s %10.3f %10.2f %11.2fx %14s\n", util::hugePagesName(mode),
+                    util::formatBytes(huge).c_str(), fill, rate, rate / base, tlb);
+        if (sum == 42)
+            std::printf("\n");
+    }
+    return 0;
+}
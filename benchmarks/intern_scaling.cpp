@@ -0,0 +1,127 @@
+// Measures how IRI interning scales with threads: ConcurrentIriPool against
+// an IriPool behind one mutex, on the same stream of IRIs split into
+// contiguous per-thread chunks as a parallel parser would see them.
+//
+//   intern_scaling [--threads N] [--triples N] [kb]
+//
+// With a KB file the stream is every IRI term in it, in file order.
+// Without one it is a synthetic CompTox-style stream: chemicals, assays and
+// genes under the comptox.owl namespace with skewed reuse.
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "io/triple.hpp"
+#include "owl2/concurrent_iri_pool.hpp"
+#include "owl2/iri_pool.hpp"
+#include "util/parallel.hpp"
+
+using namespace ista;
+
+static std::vector<std::string> readIris(const std::string& path)
+{
+    std::vector<std::string> iris;
+    auto reader = io::openReader(path, io::formatFromPath(path));
+    io::Triple t;
+    while (reader->next(t)) {
+        for (const io::Term* term : {&t.subject, &t.predicate, &t.object})
+            if (term->kind == io::TermKind::Iri)
+                iris.push_back(term->value);
+    }
+    return iris;
+}
+
+static std::vector<std::string> syntheticIris(std::size_t triples)
+{
+    const std::string ns = "http://jdr.bio/ontologies/comptox.owl#";
+    const char* predicates[] = {"chemicalHasActiveAssay", "chemicalHasInactiveAssay", "assayTargetsGene",
+                                "chemicalIncreasesExpression", "chemicalDecreasesExpression", "geneInteractsWithGene"};
+    std::mt19937_64 rng(42);
+    // Power-law reuse: most triples mention a few popular entities.
+    auto pick = [&](std::size_t n) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        return static_cast<std::size_t>(n * u * u * u);
+    };
+    std::size_t chemicals = triples / 4 + 1, assays = triples / 40 + 1, genes = 20000;
+    std::vector<std::string> iris;
+    iris.reserve(triples * 3);
+    for (std::size_t i = 0; i < triples; ++i) {
+        iris.push_back(ns + "chemical_dtxsid" + std::to_string(pick(chemicals) + 10000));
+        iris.push_back(ns + predicates[i % 6]);
+        if (i % 3 == 2)
+            iris.push_back(ns + "gene_" + std::to_string(pick(genes)));
+        else
+            iris.push_back(ns + "assay_tox21_" + std::to_string(pick(assays)));
+    }
+    return iris;
+}
+
+template <typename Fn>
+static double timeChunks(const std::vector<std::string>& iris, unsigned threads, Fn&& fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    std::size_t chunk = (iris.size() + threads - 1) / threads;
+    for (unsigned t = 0; t < threads; ++t) {
+        std::size_t begin = std::min(iris.size(), t * chunk);
+        std::size_t end = std::min(iris.size(), begin + chunk);
+        workers.emplace_back([&, begin, end] {
+            for (std::size_t i = begin; i < end; ++i)
+                fn(iris[i]);
+        });
+    }
+    for (auto& w : workers)
+        w.join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned max_threads = util::defaultThreadCount();
+    std::size_t triples = 2000000;
+    std::string input;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc)
+            max_threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (arg == "--triples" && i + 1 < argc)
+            triples = std::stoul(argv[++i]);
+        else
+            input = arg;
+    }
+
+    std::vector<std::string> iris = input.empty() ? syntheticIris(triples) : readIris(input);
+    std::cout << "iri terms: " << iris.size() << "\n";
+
+    std::vector<unsigned> counts;
+    for (unsigned n = 1; n < max_threads; n *= 2)
+        counts.push_back(n);
+    counts.push_back(max_threads);
+
+    std::printf("%8s %12s %12s %9s %12s\n", "threads", "distinct", "Mops/s", "speedup", "mutex Mops/s");
+    double base = 0.0;
+    for (unsigned threads : counts) {
+        owl2::ConcurrentIriPool pool;
+        double seconds = timeChunks(iris, threads, [&](const std::string& s) { pool.intern(s); });
+
+        owl2::IriPool locked;
+        std::mutex mutex;
+        double locked_seconds = timeChunks(iris, threads, [&](const std::string& s) {
+            std::lock_guard<std::mutex> lock(mutex);
+            locked.intern(s);
+        });
+
+        double mops = iris.size() / seconds / 1e6;
+        if (base == 0.0)
+            base = mops;
+        std::printf("%8u %12zu %12.2f %8.2fx %12.2f\n", threads, pool.size(), mops, mops / base,
+                    iris.size() / locked_seconds / 1e6);
+    }
+    return 0;
+}
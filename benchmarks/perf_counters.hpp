@@ -0,0 +1,243 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+namespace ista
+{
+
+namespace bench
+{
+
+
+enum class PerfEvent
+{
+    Cycles,
+    Instructions,
+    LlcMisses,
+    BranchMisses,
+    DtlbMisses,
+};
+
+constexpr std::size_t PERF_EVENT_COUNT = 5;
+
+inline const char* perfEventName(PerfEvent event)
+{
+    switch (event) {
+    case PerfEvent::Cycles: return "cycles";
+    case PerfEvent::Instructions: return "instructions";
+    case PerfEvent::LlcMisses: return "llc_misses";
+    case PerfEvent::BranchMisses: return "branch_misses";
+    case PerfEvent::DtlbMisses: return "dtlb_misses";
+    }
+    return "unknown";
+}
+
+
+// User-space hardware counters of this process from perf_event_open, for
+// a region between start() and stop(). Each event is opened on its own, so
+// an event the PMU lacks does not take the others with it, and multiplexed
+// counts are scaled up by the time they ran. By default the events follow
+// every thread alive at construction (the scheduler's workers included) and
+// the threads they create later; `this_thread` counts the caller alone.
+// Containers and VMs often expose no PMU, or forbid access through
+// perf_event_paranoid; then nothing opens, available() is false, every
+// value() is empty and error() says why.
+class PerfCounters
+{
+public:
+    explicit PerfCounters(bool this_thread = false)
+    {
+        std::vector<int> tids;
+        std::error_code ec;
+        if (!this_thread)
+            for (const auto& entry : std::filesystem::directory_iterator("/proc/self/task", ec))
+                tids.push_back(std::atoi(entry.path().filename().c_str()));
+        if (tids.empty())
+            tids.push_back(0);
+        for (std::size_t k = 0; k < PERF_EVENT_COUNT; ++k) {
+            for (int tid : tids) {
+                int fd = open(static_cast<PerfEvent>(k), tid);
+                if (fd >= 0)
+                    fds_[k].push_back(fd);
+                else if (error_.empty())
+                    error_ = std::string("perf_event_open: ") + std::strerror(errno);
+            }
+        }
+    }
+    ~PerfCounters()
+    {
+        for (auto& fds : fds_)
+            for (int fd : fds)
+                ::close(fd);
+    }
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const
+    {
+        for (const auto& fds : fds_)
+            if (!fds.empty())
+                return true;
+        return false;
+    }
+    const std::string& error() const { return error_; }
+
+    void start()
+    {
+        for (auto& fds : fds_) {
+            for (int fd : fds) {
+                ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+    }
+
+    void stop()
+    {
+        for (std::size_t k = 0; k < PERF_EVENT_COUNT; ++k) {
+            values_[k].reset();
+            for (int fd : fds_[k]) {
+                ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                // value, time enabled, time running
+                std::uint64_t data[3];
+                if (::read(fd, data, sizeof(data)) != sizeof(data))
+                    continue;
+                double scaled = static_cast<double>(data[0]);
+                if (data[2] > 0 && data[2] < data[1])
+                    scaled *= static_cast<double>(data[1]) / static_cast<double>(data[2]);
+                values_[k] = values_[k].value_or(0) + static_cast<std::uint64_t>(scaled);
+            }
+        }
+    }
+
+    // The count since start(), or nothing when the event could not be read.
+    std::optional<std::uint64_t> value(PerfEvent event) const { return values_[static_cast<std::size_t>(event)]; }
+
+private:
+    static int open(PerfEvent event, int tid)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        switch (event) {
+        case PerfEvent::Cycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerfEvent::Instructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerfEvent::LlcMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case PerfEvent::BranchMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case PerfEvent::DtlbMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        }
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attr, tid, -1, -1, 0));
+    }
+
+    std::array<std::vector<int>, PERF_EVENT_COUNT> fds_;
+    std::array<std::optional<std::uint64_t>, PERF_EVENT_COUNT> values_;
+    std::string error_;
+};
+
+
+// Whether ISTA_PERF_COUNTERS=1 asks the benchmarks to count.
+inline bool perfCountersRequested()
+{
+    const char* env = std::getenv("ISTA_PERF_COUNTERS");
+    return env && *env && *env != '0';
+}
+
+// Counts the benchmark loop of a Google Benchmark `state` when
+// ISTA_PERF_COUNTERS=1, and on destruction adds each event per processed
+// item ("cycles/item", ...) and the instructions per cycle to the
+// benchmark's counters. Declare it right before the loop, after the
+// setup, and call SetItemsProcessed() before it goes out of scope. In a
+// multi-threaded benchmark each thread counts itself and the rates are
+// averaged. Where counters are unavailable it says so once and adds
+// nothing.
+template <typename State>
+class PerfRegion
+{
+public:
+    explicit PerfRegion(State& state) : state_(state)
+    {
+        if (!perfCountersRequested())
+            return;
+        counters_.emplace(state.threads() > 1);
+        if (!counters_->available()) {
+            static std::atomic<bool> warned{false};
+            if (!warned.exchange(true))
+                std::fprintf(stderr, "hardware counters unavailable (%s); reporting times only\n",
+                             counters_->error().c_str());
+            counters_.reset();
+            return;
+        }
+        counters_->start();
+    }
+    ~PerfRegion()
+    {
+        if (!counters_)
+            return;
+        counters_->stop();
+        using Counter = typename std::decay_t<decltype(state_.counters)>::mapped_type;
+        double items = static_cast<double>(state_.items_processed());
+        for (std::size_t k = 0; k < PERF_EVENT_COUNT; ++k) {
+            std::optional<std::uint64_t> v = counters_->value(static_cast<PerfEvent>(k));
+            if (v && items > 0)
+                state_.counters[std::string(perfEventName(static_cast<PerfEvent>(k))) + "/item"] =
+                    Counter(static_cast<double>(*v) / items, Counter::kAvgThreads);
+        }
+        auto cycles = counters_->value(PerfEvent::Cycles);
+        auto instructions = counters_->value(PerfEvent::Instructions);
+        if (cycles && instructions && *cycles > 0)
+            state_.counters["ipc"] =
+                Counter(static_cast<double>(*instructions) / static_cast<double>(*cycles), Counter::kAvgThreads);
+    }
+    PerfRegion(const PerfRegion&) = delete;
+    PerfRegion& operator=(const PerfRegion&) = delete;
+
+private:
+    State& state_;
+    std::optional<PerfCounters> counters_;
+};
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,61 @@
+import os
+import shutil
+import subprocess
+
+THREADS_ENV = "ISTA_NUM_THREADS"
+PIN_ENV = "ISTA_PIN_THREADS"
+NUMA_ENV = "ISTA_NUMA"
+
+
+def set_max_threads(n: int, pin: bool = False):
+    """Cap the number of cores the native `ista` tool may use.
+
+    libista runs all of its parallel work on one shared scheduler whose size
+    is read from the environment when the tool starts, so the cap applies to
+    every command launched from this process afterwards (including through
+    `run`). Pass 0 to remove the cap and use every core.
+    """
+    if n < 0:
+        raise ValueError("thread count must be non-negative")
+    if n == 0:
+        os.environ.pop(THREADS_ENV, None)
+    else:
+        os.environ[THREADS_ENV] = str(n)
+    if pin:
+        os.environ[PIN_ENV] = "1"
+    else:
+        os.environ.pop(PIN_ENV, None)
+
+
+def set_numa_placement(on: bool):
+    """Spread the native tool's workers and data over NUMA nodes.
+
+    Workers are bound to their node's CPUs, axiom tables are split across
+    nodes and the term pools interleaved. On a single-node machine this
+    only binds the workers, which is harmless.
+    """
+    if on:
+        os.environ[NUMA_ENV] = "1"
+    else:
+        os.environ.pop(NUMA_ENV, None)
+
+
+def get_max_threads():
+    """Return the current cap, or None if the tool may use every core."""
+    value = os.environ.get(THREADS_ENV)
+    return int(value) if value else None
+
+
+def run(*args, threads: int = None, executable: str = None, check: bool = True):
+    """Run a native `ista` subcommand, e.g. `run("stats", "--json", "kb.ista")`.
+
+    `threads` overrides the cap for this call only. The executable defaults
+    to the C++ `ista` binary found on PATH.
+    """
+    exe = executable or shutil.which("ista")
+    if exe is None:
+        raise FileNotFoundError("native ista executable not found on PATH")
+    env = dict(os.environ)
+    if threads is not None:
+        env[THREADS_ENV] = str(threads)
+    return subprocess.run([exe, *args], env=env, check=check, capture_output=True, text=True)
@@ -72,6 +72,10 @@ def safe_make_individual_name(
 
 def print_onto_stats(onto: owlready2.Ontology):
     """Print summary statistics for an OWL2 ontology loaded into `owlready2`.
+
+    For large knowledge bases, prefer the native `ista stats <kb>` command,
+    which also reports degree distributions and literal coverage (and can
+    emit JSON with `--json`).
     """
 
     print()
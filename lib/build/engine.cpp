@@ -0,0 +1,536 @@
+#include "engine.hpp"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "build/step.hpp"
+#include "io/snapshot.hpp"
+#include "owl2/vocabulary.hpp"
+#include "util/external_sort.hpp"
+#include "util/hash.hpp"
+#include "util/scheduler.hpp"
+#include "util/trace.hpp"
+
+namespace ista
+{
+
+namespace build
+{
+
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+using Clock = std::chrono::steady_clock;
+
+// Size and modification time, the same staleness test make and ninja use.
+// Hashing file contents would cost as much as parsing them.
+std::string fileStamp(const std::string& path)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0)
+        throw std::runtime_error("cannot stat " + path + ": " + std::strerror(errno));
+    return std::to_string(st.st_size) + ":" + std::to_string(st.st_mtim.tv_sec) + "." + std::to_string(st.st_mtim.tv_nsec);
+}
+
+std::string hashKey(const std::string& text)
+{
+    char buf[33];
+    std::snprintf(buf, sizeof buf, "%016llx%016llx",
+                  static_cast<unsigned long long>(util::hashBytes(text)),
+                  static_cast<unsigned long long>(util::hashBytes(text, 0x6a09e667f3bcc909ULL)));
+    return buf;
+}
+
+
+class Build
+{
+public:
+    Build(const Manifest& manifest, const BuildOptions& options)
+        : manifest_(manifest), options_(options), step_dir_(fs::path(manifest.cache_dir) / "steps")
+    {
+    }
+
+    BuildReport run()
+    {
+        auto start = Clock::now();
+        start_ = start;
+        BuildReport report;
+        std::string tbox_stamp = fileStamp(manifest_.ontology);
+
+        std::string build_text = "output=" + manifest_.output + "\nformat=" + io::formatName(manifest_.output_format)
+            + "\ntbox=" + tbox_stamp + "\n";
+        for (const Step& step : manifest_.steps) {
+            std::string text = "ista-build-step-1\n" + describeStep(step) + "input=" + fileStamp(step.table.path)
+                + "\ntbox=" + tbox_stamp + "\n";
+            for (std::size_t dep : step.dependencies)
+                text += "dep=" + keys_[dep] + "\n";
+            keys_.push_back(hashKey(text));
+            build_text += keys_.back() + "\n";
+        }
+        std::string build_key = hashKey(build_text);
+        fs::path stamp_path = fs::path(manifest_.cache_dir) / "build.stamp";
+
+        if (!options_.force && fs::exists(manifest_.output) && readStamp(stamp_path) == build_key + " " + fileStamp(manifest_.output)) {
+            report.up_to_date = true;
+            report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            return report;
+        }
+
+        fs::create_directories(step_dir_);
+        {
+            ISTA_TRACE_SCOPE("tbox");
+            auto stage_start = Clock::now();
+            tbox_ = io::readOntology(manifest_.ontology, io::formatFromPath(manifest_.ontology));
+            schema_ = std::make_unique<Schema>(tbox_);
+            finishStage("tbox", tbox_.axiomCount(), stage_start);
+        }
+
+        reports_.resize(manifest_.steps.size());
+        schedule();
+
+        report.output_triples = assemble();
+        report.duplicates = duplicates_;
+        report.functional_replaced = functional_replaced_;
+        report.spilled_bytes = spilled_bytes_;
+        std::ofstream(stamp_path) << build_key << " " << fileStamp(manifest_.output) << "\n";
+        pruneStale();
+        report.steps = std::move(reports_);
+        report.stages = std::move(stages_);
+        report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return report;
+    }
+
+private:
+    std::string outputPath(std::size_t i) const { return (step_dir_ / (keys_[i] + ".nt")).string(); }
+    // The counters of the run that wrote outputPath(i).
+    std::string countersPath(std::size_t i) const { return (step_dir_ / (keys_[i] + ".counters")).string(); }
+
+    double sinceStart() const { return std::chrono::duration<double>(Clock::now() - start_).count(); }
+
+    void finishStage(const char* name, std::uint64_t rows, Clock::time_point started)
+    {
+        stages_.push_back(StageReport{name, rows, std::chrono::duration<double>(Clock::now() - started).count()});
+        if (options_.on_stage)
+            options_.on_stage(stages_.back());
+    }
+
+    static std::string readStamp(const fs::path& path)
+    {
+        std::ifstream in(path);
+        std::string line;
+        std::getline(in, line);
+        return line;
+    }
+
+    // Drops cached outputs no step of this manifest refers to any more, so the
+    // cache stays the size of one build.
+    void pruneStale() const
+    {
+        std::unordered_set<std::string> live;
+        for (std::size_t i = 0; i < keys_.size(); ++i) {
+            live.insert(fs::path(outputPath(i)).filename().string());
+            live.insert(fs::path(countersPath(i)).filename().string());
+        }
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(step_dir_, ec))
+            if (!live.contains(entry.path().filename().string()))
+                fs::remove(entry.path(), ec);
+    }
+
+    // Topological execution: a step becomes ready once every step it depends
+    // on has finished, and ready steps are taken in manifest order.
+    void schedule()
+    {
+        std::size_t n = manifest_.steps.size();
+        std::vector<std::size_t> waiting(n);
+        std::vector<std::vector<std::size_t>> dependents(n);
+        std::deque<std::size_t> ready;
+        for (std::size_t i = 0; i < n; ++i) {
+            waiting[i] = manifest_.steps[i].dependencies.size();
+            for (std::size_t dep : manifest_.steps[i].dependencies)
+                dependents[dep].push_back(i);
+            if (waiting[i] == 0)
+                ready.push_back(i);
+        }
+
+        // Ready steps run as tasks on the shared scheduler, at most
+        // options_.threads at a time; a finishing step releases its
+        // dependents. The first failure cancels everything not yet started.
+        std::mutex mutex;
+        std::size_t running = 0;
+        unsigned threads = std::max(1u, options_.threads);
+        util::TaskGroup group;
+        std::function<void()> launch = [&] {
+            while (running < threads && !ready.empty() && !group.cancelled()) {
+                std::size_t i = ready.front();
+                ready.pop_front();
+                ++running;
+                StepReport& started = reports_[i];
+                started.name = manifest_.steps[i].name;
+                started.started = sinceStart();
+                started.running = running;
+                started.queued = ready.size();
+                if (options_.on_step_start)
+                    options_.on_step_start(started);
+                group.run([&, i] {
+                    try {
+                        runOne(i);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        --running;
+                        throw;
+                    }
+                    std::lock_guard<std::mutex> lock(mutex);
+                    --running;
+                    if (options_.on_step)
+                        options_.on_step(reports_[i]);
+                    for (std::size_t d : dependents[i])
+                        if (--waiting[d] == 0)
+                            ready.push_back(d);
+                    launch();
+                });
+            }
+        };
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            launch();
+        }
+        group.wait();
+    }
+
+    void runOne(std::size_t i)
+    {
+        ISTA_TRACE_SCOPE("build step");
+        const Step& step = manifest_.steps[i];
+        StepReport& report = reports_[i];
+        report.name = step.name;
+        std::string path = outputPath(i);
+        if (!options_.force && fs::exists(path)) {
+            report.cached = true;
+            readCounters(i, report);
+            return;
+        }
+
+        auto start = Clock::now();
+        KeyIndex keys = loadKeys(step);
+        std::string tmp = path + ".tmp" + std::to_string(i);
+        try {
+            auto out = io::openWriter(tmp, io::Format::NTriples);
+            StepResult result = runStep(step, *schema_, keys, *out);
+            out->close();
+            fs::rename(tmp, path);
+            report.counters = result;
+            report.rows = result.rows;
+            report.triples = result.triples;
+            writeCounters(i, result);
+            setWarning(step, report);
+        } catch (const std::exception& e) {
+            std::error_code ec;
+            fs::remove(tmp, ec);
+            throw std::runtime_error("step '" + step.name + "': " + e.what());
+        }
+        report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    static constexpr std::uint64_t StepResult::*COUNTERS[] = {
+        &StepResult::rows, &StepResult::used, &StepResult::triples, &StepResult::filtered, &StepResult::merge_hits,
+        &StepResult::merge_misses, &StepResult::ambiguous, &StepResult::unmatched, &StepResult::edges,
+    };
+
+    void writeCounters(std::size_t i, const StepResult& result) const
+    {
+        std::ofstream out(countersPath(i));
+        for (auto counter : COUNTERS)
+            out << result.*counter << ' ';
+        out << '\n';
+    }
+
+    // Outputs cached before counters were kept report none.
+    void readCounters(std::size_t i, StepReport& report) const
+    {
+        std::ifstream in(countersPath(i));
+        StepResult result;
+        for (auto counter : COUNTERS)
+            in >> result.*counter;
+        if (!in)
+            return;
+        report.counters = result;
+        report.rows = result.rows;
+        report.triples = result.triples;
+        setWarning(manifest_.steps[i], report);
+    }
+
+    // The NO_RELATIONSHIPS_ADDED / no-nodes cases the Python parsers only
+    // print, surfaced so a regression in a source can be alerted on.
+    static void setWarning(const Step& step, StepReport& report)
+    {
+        if (step.kind == StepKind::Relationship && report.counters.edges == 0)
+            report.warning = "no relationships added";
+        else if (step.kind == StepKind::Node && report.counters.used == 0)
+            report.warning = "no nodes added";
+    }
+
+    // Snapshots carry a key index for each property the steps merge or match
+    // on, so the deployed KB answers the same lookups (`ista lookup --key`).
+    io::SnapshotOptions snapshotOptions() const
+    {
+        io::SnapshotOptions options;
+        auto add = [&](const std::string& name) {
+            const std::string& iri = schema_->propertyIri(name);
+            if (std::find(options.key_properties.begin(), options.key_properties.end(), iri)
+                == options.key_properties.end())
+                options.key_properties.push_back(iri);
+        };
+        for (const Step& step : manifest_.steps) {
+            if (step.kind == StepKind::Node && step.merge)
+                add(step.merge_property);
+            if (step.kind == StepKind::Relationship) {
+                add(step.subject_match_property);
+                add(step.object_match_property);
+            }
+        }
+        return options;
+    }
+
+    // Collects the property values a step looks individuals up by, from the
+    // TBox and from the outputs of its dependencies in manifest order. A
+    // functional property keeps only its last value per individual, matching
+    // safe_add_property.
+    KeyIndex loadKeys(const Step& step) const
+    {
+        ISTA_TRACE_SCOPE("loadKeys");
+        std::vector<std::string> wanted_names;
+        if (step.kind == StepKind::Node && step.merge)
+            wanted_names.push_back(step.merge_property);
+        if (step.kind == StepKind::Relationship) {
+            wanted_names.push_back(step.subject_match_property);
+            wanted_names.push_back(step.object_match_property);
+        }
+        std::unordered_set<std::string> wanted;
+        for (const std::string& name : wanted_names)
+            wanted.insert(schema_->propertyIri(name));
+
+        KeyIndex keys;
+        if (wanted.empty())
+            return keys;
+
+        std::vector<std::pair<std::string, std::string>> latest;     // (subject \0 property, value)
+        std::unordered_map<std::string, std::size_t> latest_slot;
+        auto add = [&](std::string_view s, std::string_view p, std::string_view value) {
+            if (!schema_->isFunctional(p)) {
+                keys.add(p, value, s);
+                return;
+            }
+            std::string k = std::string(s) + '\0' + std::string(p);
+            auto [it, inserted] = latest_slot.emplace(k, latest.size());
+            if (inserted)
+                latest.emplace_back(std::move(k), value);
+            else
+                latest[it->second].second.assign(value);
+        };
+
+        for (const owl2::TripleRow& row : tbox_.axioms(owl2::AxiomKind::DataPropertyAssertion)) {
+            std::string_view p = tbox_.iri(row.predicate);
+            if (wanted.contains(std::string(p)))
+                add(tbox_.iri(row.subject), p, tbox_.literal(row.object).lexical);
+        }
+
+        io::Triple triple;
+        for (std::size_t dep : step.dependencies) {
+            const Step& earlier = manifest_.steps[dep];
+            bool relevant = false;
+            for (const std::string& name : wanted_names)
+                relevant = relevant || earlier.writesProperty(name);
+            if (!relevant)
+                continue;
+            auto reader = io::openReader(outputPath(dep), io::Format::NTriples);
+            while (reader->next(triple)) {
+                if (triple.object.kind == io::TermKind::Literal && wanted.contains(triple.predicate.value))
+                    add(triple.subject.value, triple.predicate.value, triple.object.value);
+            }
+        }
+
+        for (const auto& [k, value] : latest) {
+            std::size_t sep = k.find('\0');
+            keys.add(std::string_view(k).substr(sep + 1), value, std::string_view(k).substr(0, sep));
+        }
+        return keys;
+    }
+
+    // One triple on its way through assembly. `seq` is its position in the
+    // merged input (TBox first, then each step output in manifest order), so
+    // sorting by it restores first-seen order after deduplication.
+    struct SpillRow
+    {
+        owl2::TripleRow row;
+        std::uint32_t kind;
+        std::uint64_t seq;
+    };
+
+    struct ByTriple
+    {
+        bool operator()(const SpillRow& a, const SpillRow& b) const
+        {
+            return std::tie(a.row.subject, a.row.predicate, a.row.object, a.seq)
+                < std::tie(b.row.subject, b.row.predicate, b.row.object, b.seq);
+        }
+    };
+
+    struct BySubjectPredicate
+    {
+        bool operator()(const SpillRow& a, const SpillRow& b) const
+        {
+            return std::tie(a.row.subject, a.row.predicate, a.seq) < std::tie(b.row.subject, b.row.predicate, b.seq);
+        }
+    };
+
+    struct ByKind
+    {
+        bool operator()(const SpillRow& a, const SpillRow& b) const
+        {
+            return std::tie(a.kind, a.seq) < std::tie(b.kind, b.seq);
+        }
+    };
+
+    // Merges the step outputs into the TBox in manifest order, so the result
+    // does not depend on the order steps happened to finish in. Rows go
+    // through external sorts rather than hash sets, so with a memory budget
+    // only the term dictionaries stay resident:
+    //   1. functional (subject, predicate) groups keep their last object and
+    //      are placed after all other rows, at their first appearance;
+    //   2. duplicate triples keep their earliest position;
+    //   3. rows are emitted per axiom table in that order, as writeOntology
+    //      would have written them.
+    std::uint64_t assemble()
+    {
+        ISTA_TRACE_SCOPE("assemble");
+        auto stage_start = Clock::now();
+        owl2::Ontology& kb = tbox_;
+        // The three sorters share the budget.
+        std::uint64_t budget = options_.memory_budget;
+        std::uint64_t share = budget == 0 ? 0 : std::max<std::uint64_t>(1, budget / 3);
+        std::string spill_dir = (fs::path(manifest_.cache_dir) / "spill").string();
+        unsigned threads = std::max(1u, options_.threads);
+
+        util::ExternalSorter<SpillRow, ByTriple> rows(share, spill_dir, threads);
+        util::ExternalSorter<SpillRow, BySubjectPredicate> functional_rows(share, spill_dir, threads);
+        std::uint64_t seq = 0;
+        for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k) {
+            auto& table = kb.axioms(static_cast<owl2::AxiomKind>(k));
+            for (const owl2::TripleRow& row : table)
+                rows.push(SpillRow{row, 0, seq++});
+            table.clear();
+            table.shrink_to_fit();
+        }
+
+        std::unordered_map<owl2::TermId, bool> functional;
+        io::Triple triple;
+        for (std::size_t i = 0; i < manifest_.steps.size(); ++i) {
+            auto reader = io::openReader(outputPath(i), io::Format::NTriples);
+            while (reader->next(triple)) {
+                owl2::TripleRow row{io::internTerm(kb, triple.subject), io::internTerm(kb, triple.predicate),
+                                    io::internTerm(kb, triple.object)};
+                auto [f, is_new] = functional.try_emplace(row.predicate, false);
+                if (is_new)
+                    f->second = schema_->isFunctional(triple.predicate.value);
+                if (f->second)
+                    functional_rows.push(SpillRow{row, 0, seq++});
+                else
+                    rows.push(SpillRow{row, 0, seq++});
+            }
+        }
+
+        const std::uint64_t functional_base = std::uint64_t(1) << 62;
+        std::optional<SpillRow> group;
+        functional_rows.merge([&](const SpillRow& r) {
+            if (group && group->row.subject == r.row.subject && group->row.predicate == r.row.predicate) {
+                group->row.object = r.row.object;
+                ++functional_replaced_;
+                return;
+            }
+            if (group)
+                rows.push(*group);
+            group = SpillRow{r.row, 0, functional_base + r.seq};
+        });
+        if (group)
+            rows.push(*group);
+
+        util::ExternalSorter<SpillRow, ByKind> ordered(share, spill_dir, threads);
+        std::optional<owl2::TripleRow> last;
+        rows.merge([&](const SpillRow& r) {
+            if (last && *last == r.row) {
+                ++duplicates_;
+                return;
+            }
+            last = r.row;
+            ordered.push(SpillRow{r.row, static_cast<std::uint32_t>(kb.classify(r.row.predicate, r.row.object)), r.seq});
+        });
+        finishStage("assemble", seq, stage_start);
+        stage_start = Clock::now();
+
+        std::uint64_t count = 0;
+        if (manifest_.output_format == io::Format::Snapshot) {
+            ordered.merge([&](const SpillRow& r) {
+                kb.addAxiom(r.row.subject, r.row.predicate, r.row.object);
+                ++count;
+            });
+            io::writeSnapshot(kb, manifest_.output, snapshotOptions());
+        } else {
+            auto writer = io::openWriter(manifest_.output, manifest_.output_format);
+            ordered.merge([&](const SpillRow& r) {
+                io::rowToTriple(kb, r.row, triple);
+                writer->write(triple);
+                ++count;
+            });
+            writer->close();
+        }
+        spilled_bytes_ = rows.spilledBytes() + functional_rows.spilledBytes() + ordered.spilledBytes();
+        finishStage("write", count, stage_start);
+        return count;
+    }
+
+    const Manifest& manifest_;
+    const BuildOptions& options_;
+    fs::path step_dir_;
+    std::vector<std::string> keys_;
+    std::vector<StepReport> reports_;
+    std::vector<StageReport> stages_;
+    owl2::Ontology tbox_;
+    std::unique_ptr<Schema> schema_;
+    Clock::time_point start_;
+    std::uint64_t spilled_bytes_ = 0;
+    std::uint64_t duplicates_ = 0;
+    std::uint64_t functional_replaced_ = 0;
+};
+
+}
+
+
+BuildReport runBuild(const Manifest& manifest, const BuildOptions& options)
+{
+    return Build(manifest, options).run();
+}
+
+
+}
+
+}
@@ -0,0 +1,95 @@
+#ifndef ENGINE_HPP
+#define ENGINE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "build/manifest.hpp"
+#include "build/step.hpp"
+#include "util/parallel.hpp"
+
+
+namespace ista
+{
+
+namespace build
+{
+
+
+struct StepReport
+{
+    std::string name;
+    bool cached = false;
+    std::uint64_t rows = 0;
+    std::uint64_t triples = 0;
+    double seconds = 0.0;
+    // The step's counters; a cached step reports those of the run that
+    // produced its output.
+    StepResult counters;
+    // Seconds since the build started at which the step started, and the
+    // steps that were running and ready but waiting for a thread then.
+    double started = 0.0;
+    std::size_t running = 0;
+    std::size_t queued = 0;
+    // Set when the step ran but added nothing, e.g. no relationship matched.
+    std::string warning;
+};
+
+// A phase of the build outside the steps: reading the TBox ("tbox"),
+// merging and deduplicating step outputs ("assemble") and writing the KB
+// ("write").
+struct StageReport
+{
+    std::string name;
+    std::uint64_t rows = 0;
+    double seconds = 0.0;
+};
+
+struct BuildOptions
+{
+    unsigned threads = util::defaultThreadCount();
+    // Ignore cached step outputs and rebuild everything.
+    bool force = false;
+    // Bytes the assembly stage may buffer before spilling sorted runs to the
+    // cache directory; 0 keeps everything in memory.
+    std::uint64_t memory_budget = 0;
+    // Called (serialized) as each step starts, and as it finishes or is
+    // found in the cache.
+    std::function<void(const StepReport&)> on_step_start;
+    std::function<void(const StepReport&)> on_step;
+    // Called as each stage finishes.
+    std::function<void(const StageReport&)> on_stage;
+};
+
+struct BuildReport
+{
+    bool up_to_date = false;
+    std::vector<StepReport> steps;
+    std::vector<StageReport> stages;
+    std::uint64_t output_triples = 0;
+    // Rows the assembly dropped: repeated triples, and earlier values of
+    // functional properties.
+    std::uint64_t duplicates = 0;
+    std::uint64_t functional_replaced = 0;
+    std::uint64_t spilled_bytes = 0;
+    double seconds = 0.0;
+};
+
+// Runs the steps of a manifest and writes the populated KB.
+//
+// Each step's output is cached under the manifest's cache directory, keyed by
+// a hash of the step's configuration, the size and modification time of its
+// input file and of the TBox, and the keys of the steps it depends on.
+// Steps whose dependencies are satisfied run concurrently on up to
+// `options.threads` threads. When every key matches the last build and the
+// output file is unchanged, nothing is read at all.
+BuildReport runBuild(const Manifest& manifest, const BuildOptions& options = {});
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,339 @@
+#include "manifest.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <stdexcept>
+
+#include <yaml-cpp/yaml.h>
+
+namespace ista
+{
+
+namespace build
+{
+
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+struct Context
+{
+    std::string where;
+
+    [[noreturn]] void fail(const std::string& message) const
+    {
+        throw std::runtime_error(where + ": " + message);
+    }
+};
+
+std::string scalar(const YAML::Node& node, const Context& ctx, const char* key)
+{
+    if (!node.IsScalar())
+        ctx.fail(std::string("'") + key + "' must be a string");
+    return node.Scalar();
+}
+
+std::string required(const YAML::Node& map, const Context& ctx, const char* key)
+{
+    YAML::Node node = map[key];
+    if (!node)
+        ctx.fail(std::string("missing '") + key + "'");
+    return scalar(node, ctx, key);
+}
+
+std::string optional(const YAML::Node& map, const Context& ctx, const char* key, std::string fallback = {})
+{
+    YAML::Node node = map[key];
+    return node ? scalar(node, ctx, key) : fallback;
+}
+
+bool flag(const YAML::Node& map, const Context& ctx, const char* key)
+{
+    YAML::Node node = map[key];
+    if (!node)
+        return false;
+    try {
+        return node.as<bool>();
+    } catch (const YAML::Exception&) {
+        ctx.fail(std::string("'") + key + "' must be true or false");
+    }
+}
+
+std::string resolvePath(const fs::path& base, const std::string& path)
+{
+    fs::path p(path);
+    return (p.is_absolute() ? p : base / p).lexically_normal().string();
+}
+
+Transform parseTransform(const std::string& op, const std::string& arg, const Context& ctx)
+{
+    static const std::map<std::string, std::pair<Transform::Op, bool>, std::less<>> ops = {
+        {"split_last", {Transform::Op::SplitLast, true}},
+        {"split_first", {Transform::Op::SplitFirst, true}},
+        {"strip", {Transform::Op::Strip, false}},
+        {"lower", {Transform::Op::Lower, false}},
+        {"upper", {Transform::Op::Upper, false}},
+        {"prefix", {Transform::Op::Prefix, true}},
+        {"strip_prefix", {Transform::Op::StripPrefix, true}},
+        {"int", {Transform::Op::Integer, false}},
+    };
+    auto it = ops.find(op);
+    if (it == ops.end())
+        ctx.fail("unknown transform '" + op + "'");
+    if (it->second.second && arg.empty())
+        ctx.fail("transform '" + op + "' needs an argument");
+    return {it->second.first, arg};
+}
+
+void parseTransforms(const YAML::Node& node, std::vector<Transform>& out, const Context& ctx)
+{
+    if (node.IsScalar()) {
+        out.push_back(parseTransform(node.Scalar(), {}, ctx));
+    } else if (node.IsMap()) {
+        for (const auto& entry : node)
+            out.push_back(parseTransform(entry.first.Scalar(), entry.second.IsNull() ? std::string() : scalar(entry.second, ctx, "transform"), ctx));
+    } else if (node.IsSequence()) {
+        for (const auto& item : node)
+            parseTransforms(item, out, ctx);
+    } else {
+        ctx.fail("malformed data_transforms entry");
+    }
+}
+
+void parseTable(const YAML::Node& config, const std::string& fmt, TableConfig& table, const Context& ctx)
+{
+    if (fmt == "csv")
+        table.delimiter = ',';
+    else if (fmt == "tsv" || fmt == "tsv-pandas")
+        table.delimiter = '\t';
+    else
+        ctx.fail("unsupported flat file format '" + fmt + "' (expected csv or tsv)");
+
+    YAML::Node headers = config["headers"];
+    if (headers && headers.IsSequence()) {
+        table.headers_in_file = false;
+        for (const auto& h : headers)
+            table.headers.push_back(scalar(h, ctx, "headers"));
+    } else {
+        table.headers_in_file = !headers || flag(config, ctx, "headers");
+        if (!table.headers_in_file)
+            ctx.fail("'headers' must be true or a list of column names");
+    }
+    if (YAML::Node skip = config["skip_n_lines"])
+        table.skip_n_lines = skip.as<unsigned>();
+
+    table.filter_column = optional(config, ctx, "filter_column");
+    table.filter_value = optional(config, ctx, "filter_value");
+    if (config["filter_column"] && !config["filter_value"])
+        ctx.fail("'filter_column' needs a 'filter_value'");
+
+    if (YAML::Node compound = config["compound_fields"]) {
+        for (const auto& entry : compound) {
+            CompoundField cf;
+            cf.column = entry.first.Scalar();
+            cf.delimiter = required(entry.second, ctx, "delimiter");
+            cf.field_split_prefix = required(entry.second, ctx, "field_split_prefix");
+            table.compound_fields.push_back(std::move(cf));
+        }
+    }
+    if (YAML::Node transforms = config["data_transforms"]) {
+        for (const auto& entry : transforms) {
+            table.data_transforms.emplace_back(entry.first.Scalar(), std::vector<Transform>{});
+            parseTransforms(entry.second, table.data_transforms.back().second, ctx);
+        }
+    }
+}
+
+Step parseStep(const YAML::Node& node, const fs::path& data_dir, const Context& ctx)
+{
+    Step step;
+    step.source = required(node, ctx, "source");
+    YAML::Node config = node["parse_config"];
+    if (!config || !config.IsMap())
+        ctx.fail("missing 'parse_config'");
+    step.table.path = resolvePath(data_dir / step.source, required(node, ctx, "source_filename"));
+    parseTable(config, required(node, ctx, "fmt"), step.table, ctx);
+
+    if (node["node_type"]) {
+        step.kind = StepKind::Node;
+        step.node_type = required(node, ctx, "node_type");
+        step.iri_column_name = required(config, ctx, "iri_column_name");
+        if (YAML::Node map = config["data_property_map"]) {
+            for (const auto& entry : map)
+                step.data_property_map.emplace_back(entry.first.Scalar(), scalar(entry.second, ctx, "data_property_map"));
+        }
+        step.merge = flag(node, ctx, "merge");
+        if (step.merge) {
+            YAML::Node merge = config["merge_column"];
+            if (!merge)
+                ctx.fail("'merge: true' needs a 'merge_column'");
+            step.merge_column = required(merge, ctx, "source_column_name");
+            step.merge_property = required(merge, ctx, "data_property");
+        }
+        step.existing_class = optional(node, ctx, "existing_class");
+        step.skip_create_new_node = flag(node, ctx, "skip_create_new_node");
+        step.name = optional(node, ctx, "name", step.source + ":" + step.node_type);
+    } else if (node["relationship_type"]) {
+        step.kind = StepKind::Relationship;
+        step.relationship_type = required(node, ctx, "relationship_type");
+        step.inverse_relationship_type = optional(node, ctx, "inverse_relationship_type");
+        step.subject_node_type = required(config, ctx, "subject_node_type");
+        step.subject_column_name = required(config, ctx, "subject_column_name");
+        step.subject_match_property = required(config, ctx, "subject_match_property");
+        step.object_node_type = required(config, ctx, "object_node_type");
+        step.object_column_name = required(config, ctx, "object_column_name");
+        step.object_match_property = required(config, ctx, "object_match_property");
+        step.name = optional(node, ctx, "name", step.source + ":" + step.relationship_type);
+    } else {
+        ctx.fail("a step needs either 'node_type' or 'relationship_type'");
+    }
+    return step;
+}
+
+// A step that looks individuals up by property value (merges and relationship
+// matching) runs after every earlier node step that assigns the property, so
+// it sees what sequential execution of the manifest would have seen.
+// Relationship steps additionally follow the node steps for their subject and
+// object classes.
+void resolveDependencies(std::vector<Step>& steps)
+{
+    for (std::size_t j = 0; j < steps.size(); ++j) {
+        Step& step = steps[j];
+        for (std::size_t i = 0; i < j; ++i) {
+            const Step& earlier = steps[i];
+            if (earlier.kind != StepKind::Node)
+                continue;
+            bool depends = false;
+            if (step.kind == StepKind::Node)
+                depends = step.merge && earlier.writesProperty(step.merge_property);
+            else
+                depends = earlier.writesProperty(step.subject_match_property)
+                    || earlier.writesProperty(step.object_match_property)
+                    || earlier.node_type == step.subject_node_type
+                    || earlier.node_type == step.object_node_type;
+            if (depends)
+                step.dependencies.push_back(i);
+        }
+    }
+}
+
+void appendField(std::string& out, const char* key, const std::string& value)
+{
+    out += key;
+    out += '=';
+    out += std::to_string(value.size());
+    out += ':';
+    out += value;
+    out += '\n';
+}
+
+}
+
+
+bool Step::writesProperty(const std::string& property) const
+{
+    return kind == StepKind::Node
+        && std::any_of(data_property_map.begin(), data_property_map.end(),
+                       [&](const auto& entry) { return entry.second == property; });
+}
+
+
+Manifest loadManifest(const std::string& path)
+{
+    YAML::Node root;
+    try {
+        root = YAML::LoadFile(path);
+    } catch (const YAML::BadFile&) {
+        throw std::runtime_error("cannot open manifest " + path);
+    } catch (const YAML::Exception& e) {
+        throw std::runtime_error(path + ": " + e.what());
+    }
+    Context ctx{path};
+    if (!root.IsMap())
+        ctx.fail("expected a mapping at the top level");
+
+    fs::path base = fs::path(path).parent_path();
+    Manifest manifest;
+    manifest.path = path;
+    try {
+        manifest.ontology = resolvePath(base, required(root, ctx, "ontology"));
+        manifest.output = resolvePath(base, required(root, ctx, "output"));
+        std::string format = optional(root, ctx, "output_format");
+        manifest.output_format = format.empty() ? io::formatFromPath(manifest.output) : io::parseFormat(format);
+        fs::path data_dir = resolvePath(base, optional(root, ctx, "data_dir", "."));
+        manifest.cache_dir = resolvePath(base, optional(root, ctx, "cache_dir", ".ista-cache"));
+
+        YAML::Node steps = root["steps"];
+        if (!steps || !steps.IsSequence())
+            ctx.fail("missing 'steps' list");
+        std::map<std::string, unsigned> names;
+        for (std::size_t i = 0; i < steps.size(); ++i) {
+            Context step_ctx{path + ": steps[" + std::to_string(i) + "]"};
+            if (flag(steps[i], step_ctx, "skip"))
+                continue;
+            Step step = parseStep(steps[i], data_dir, step_ctx);
+            if (unsigned n = names[step.name]++)
+                step.name += "#" + std::to_string(n + 1);
+            manifest.steps.push_back(std::move(step));
+        }
+    } catch (const YAML::Exception& e) {
+        throw std::runtime_error(path + ": " + e.what());
+    }
+    resolveDependencies(manifest.steps);
+    return manifest;
+}
+
+std::string describeStep(const Step& step)
+{
+    const TableConfig& t = step.table;
+    std::string out;
+    appendField(out, "kind", step.kind == StepKind::Node ? "node" : "relationship");
+    appendField(out, "path", t.path);
+    appendField(out, "delimiter", std::string(1, t.delimiter));
+    appendField(out, "headers_in_file", t.headers_in_file ? "1" : "0");
+    for (const auto& h : t.headers)
+        appendField(out, "header", h);
+    appendField(out, "skip_n_lines", std::to_string(t.skip_n_lines));
+    appendField(out, "filter_column", t.filter_column);
+    appendField(out, "filter_value", t.filter_value);
+    for (const auto& cf : t.compound_fields) {
+        appendField(out, "compound", cf.column);
+        appendField(out, "delimiter", cf.delimiter);
+        appendField(out, "prefix", cf.field_split_prefix);
+    }
+    for (const auto& [column, transforms] : t.data_transforms) {
+        appendField(out, "transform", column);
+        for (const auto& tr : transforms) {
+            appendField(out, "op", std::to_string(static_cast<int>(tr.op)));
+            appendField(out, "arg", tr.arg);
+        }
+    }
+    appendField(out, "node_type", step.node_type);
+    appendField(out, "iri_column_name", step.iri_column_name);
+    for (const auto& [column, property] : step.data_property_map) {
+        appendField(out, "column", column);
+        appendField(out, "property", property);
+    }
+    appendField(out, "merge", step.merge ? "1" : "0");
+    appendField(out, "merge_column", step.merge_column);
+    appendField(out, "merge_property", step.merge_property);
+    appendField(out, "existing_class", step.existing_class);
+    appendField(out, "skip_create_new_node", step.skip_create_new_node ? "1" : "0");
+    appendField(out, "relationship_type", step.relationship_type);
+    appendField(out, "inverse_relationship_type", step.inverse_relationship_type);
+    appendField(out, "subject_node_type", step.subject_node_type);
+    appendField(out, "subject_column_name", step.subject_column_name);
+    appendField(out, "subject_match_property", step.subject_match_property);
+    appendField(out, "object_node_type", step.object_node_type);
+    appendField(out, "object_column_name", step.object_column_name);
+    appendField(out, "object_match_property", step.object_match_property);
+    return out;
+}
+
+
+}
+
+}
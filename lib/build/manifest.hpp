@@ -0,0 +1,128 @@
+#ifndef MANIFEST_HPP
+#define MANIFEST_HPP
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "io/triple.hpp"
+
+
+namespace ista
+{
+
+namespace build
+{
+
+
+// One entry of a `data_transforms` list. Transforms take the place of the
+// Python lambdas used with FlatFileDatabaseParser and are applied in order.
+struct Transform
+{
+    enum class Op
+    {
+        SplitLast,      // x.split(arg)[-1]
+        SplitFirst,     // x.split(arg)[0]
+        Strip,
+        Lower,
+        Upper,
+        Prefix,         // arg + x
+        StripPrefix,    // x without a leading arg
+        Integer,        // str(int(x)); drops whitespace and leading zeros
+    };
+
+    Op op;
+    std::string arg;
+};
+
+struct CompoundField
+{
+    std::string column;
+    std::string delimiter;
+    std::string field_split_prefix;
+};
+
+// How to read one flat file, with the same meaning as the `parse_config` keys
+// of FlatFileDatabaseParser.
+struct TableConfig
+{
+    std::string path;
+    char delimiter = ',';
+    bool headers_in_file = true;
+    std::vector<std::string> headers;
+    unsigned skip_n_lines = 0;
+    std::string filter_column;
+    std::string filter_value;
+    std::vector<CompoundField> compound_fields;
+    std::vector<std::pair<std::string, std::vector<Transform>>> data_transforms;
+};
+
+enum class StepKind
+{
+    Node,
+    Relationship,
+};
+
+// A single parse_node_type or parse_relationship_type call. Classes and
+// properties are named by their local name in the TBox.
+struct Step
+{
+    std::string name;
+    StepKind kind = StepKind::Node;
+    std::string source;
+    TableConfig table;
+
+    // Node steps.
+    std::string node_type;
+    std::string iri_column_name;
+    std::vector<std::pair<std::string, std::string>> data_property_map;
+    bool merge = false;
+    std::string merge_column;
+    std::string merge_property;
+    std::string existing_class;
+    bool skip_create_new_node = false;
+
+    // Relationship steps.
+    std::string relationship_type;
+    std::string inverse_relationship_type;
+    std::string subject_node_type;
+    std::string subject_column_name;
+    std::string subject_match_property;
+    std::string object_node_type;
+    std::string object_column_name;
+    std::string object_match_property;
+
+    // Indices of earlier steps whose output this step reads or must follow.
+    std::vector<std::size_t> dependencies;
+
+    // True if this node step assigns `property` to the individuals it writes.
+    bool writesProperty(const std::string& property) const;
+};
+
+struct Manifest
+{
+    std::string path;
+    std::string ontology;
+    std::string output;
+    io::Format output_format = io::Format::RdfXml;
+    std::string cache_dir;
+    std::vector<Step> steps;
+};
+
+
+// Parses a YAML build manifest. Relative paths are resolved against the
+// manifest's directory; steps marked `skip: true` are dropped, and the
+// dependencies of the remaining steps are filled in.
+Manifest loadManifest(const std::string& path);
+
+// A canonical rendering of everything that determines a step's output apart
+// from its input files. Used as part of the step's cache key.
+std::string describeStep(const Step& step);
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,215 @@
+#include "metrics.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+#include "util/json_writer.hpp"
+#include "util/resource_usage.hpp"
+
+namespace ista
+{
+
+namespace build
+{
+
+
+namespace
+{
+
+struct Counter
+{
+    const char* name;
+    const char* help;
+    std::uint64_t StepResult::*field;
+};
+
+const Counter STEP_COUNTERS[] = {
+    {"rows", "Records read from the step's input file.", &StepResult::rows},
+    {"rows_filtered", "Records dropped by the step's filter_column.", &StepResult::filtered},
+    {"rows_used", "Records that passed the filter and produced output.", &StepResult::used},
+    {"triples", "Triples the step wrote.", &StepResult::triples},
+    {"merge_hits", "Merge records that found an existing individual.", &StepResult::merge_hits},
+    {"merge_misses", "Merge records that found no existing individual.", &StepResult::merge_misses},
+    {"ambiguous_matches", "Lookups that matched more than one individual.", &StepResult::ambiguous},
+    {"unmatched", "Relationship records whose subject or object matched nothing.", &StepResult::unmatched},
+    {"edges", "Relationship assertions added, inverses included.", &StepResult::edges},
+};
+
+double since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Label values escape backslash, double quote and newline.
+std::string label(std::string_view value)
+{
+    std::string out;
+    for (char c : value) {
+        if (c == '\\' || c == '"')
+            out += '\\';
+        if (c == '\n') {
+            out += "\\n";
+            continue;
+        }
+        out += c;
+    }
+    return out;
+}
+
+void header(std::ostream& out, const std::string& name, const char* help, const char* type)
+{
+    out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+}
+
+}
+
+
+MetricsLog::MetricsLog(const std::string& path) : out_(path, std::ios::app)
+{
+    if (!out_)
+        throw std::runtime_error("cannot write " + path);
+}
+
+void MetricsLog::attach(BuildOptions& options)
+{
+    // The engine serializes its callbacks, but the log's own lock keeps it
+    // safe to share between builds.
+    auto start = std::chrono::steady_clock::now();
+    auto chain = [&, start](auto previous, auto member) {
+        return [this, previous, member, start](const auto& report) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                util::JsonWriter json(out_, false);
+                json.beginObject();
+                json.field("t", since(start));
+                (this->*member)(json, report);
+                json.endObject();
+                out_ << '\n';
+                out_.flush();
+            }
+            if (previous)
+                previous(report);
+        };
+    };
+    options.on_step_start = chain(options.on_step_start, &MetricsLog::stepStarted);
+    options.on_step = chain(options.on_step, &MetricsLog::stepFinished);
+    options.on_stage = chain(options.on_stage, &MetricsLog::stage);
+}
+
+// Each writer below fills in the object attach() opened with the time.
+void MetricsLog::stepStarted(util::JsonWriter& json, const StepReport& step)
+{
+    json.field("event", "step_start");
+    json.field("step", step.name);
+    json.field("running", static_cast<std::uint64_t>(step.running));
+    json.field("queued", static_cast<std::uint64_t>(step.queued));
+}
+
+void MetricsLog::stepFinished(util::JsonWriter& json, const StepReport& step)
+{
+    json.field("event", "step_end");
+    json.field("step", step.name);
+    json.field("cached", step.cached);
+    json.field("seconds", step.seconds);
+    for (const Counter& c : STEP_COUNTERS)
+        json.field(c.name, step.counters.*c.field);
+    if (!step.warning.empty())
+        json.field("warning", step.warning);
+}
+
+void MetricsLog::stage(util::JsonWriter& json, const StageReport& stage)
+{
+    json.field("event", "stage");
+    json.field("stage", stage.name);
+    json.field("rows", stage.rows);
+    json.field("seconds", stage.seconds);
+}
+
+void MetricsLog::build(const BuildReport& report)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    util::JsonWriter json(out_, false);
+    json.beginObject();
+    json.field("event", "build");
+    json.field("up_to_date", report.up_to_date);
+    json.field("seconds", report.seconds);
+    json.field("steps", static_cast<std::uint64_t>(report.steps.size()));
+    std::uint64_t warnings = 0;
+    for (const StepReport& step : report.steps)
+        warnings += !step.warning.empty();
+    json.field("warnings", warnings);
+    json.field("output_triples", report.output_triples);
+    json.field("duplicates", report.duplicates);
+    json.field("functional_replaced", report.functional_replaced);
+    json.field("spilled_bytes", report.spilled_bytes);
+    json.field("peak_rss", util::peakRssBytes());
+    json.endObject();
+    out_ << '\n';
+    out_.flush();
+}
+
+
+void writePrometheus(std::ostream& out, const BuildReport& report)
+{
+    for (const Counter& c : STEP_COUNTERS) {
+        std::string name = std::string("ista_build_step_") + c.name + "_total";
+        header(out, name, c.help, "counter");
+        for (const StepReport& step : report.steps)
+            out << name << "{step=\"" << label(step.name) << "\"} " << step.counters.*c.field << '\n';
+    }
+    header(out, "ista_build_step_seconds", "Wall time of the step.", "gauge");
+    for (const StepReport& step : report.steps)
+        out << "ista_build_step_seconds{step=\"" << label(step.name) << "\"} " << step.seconds << '\n';
+    header(out, "ista_build_step_cached", "1 if the step's output came from the cache.", "gauge");
+    for (const StepReport& step : report.steps)
+        out << "ista_build_step_cached{step=\"" << label(step.name) << "\"} " << (step.cached ? 1 : 0) << '\n';
+    header(out, "ista_build_step_queued", "Ready steps waiting for a thread when the step started.", "gauge");
+    for (const StepReport& step : report.steps)
+        out << "ista_build_step_queued{step=\"" << label(step.name) << "\"} " << step.queued << '\n';
+    header(out, "ista_build_step_warning", "1 if the step added nothing (see the JSON log for why).", "gauge");
+    for (const StepReport& step : report.steps)
+        out << "ista_build_step_warning{step=\"" << label(step.name) << "\"} " << (step.warning.empty() ? 0 : 1) << '\n';
+
+    header(out, "ista_build_stage_seconds", "Wall time of a build stage outside the steps.", "gauge");
+    for (const StageReport& stage : report.stages)
+        out << "ista_build_stage_seconds{stage=\"" << label(stage.name) << "\"} " << stage.seconds << '\n';
+    header(out, "ista_build_stage_rows_total", "Rows a build stage processed.", "counter");
+    for (const StageReport& stage : report.stages)
+        out << "ista_build_stage_rows_total{stage=\"" << label(stage.name) << "\"} " << stage.rows << '\n';
+
+    header(out, "ista_build_seconds", "Wall time of the whole build.", "gauge");
+    out << "ista_build_seconds " << report.seconds << '\n';
+    header(out, "ista_build_up_to_date", "1 if nothing needed rebuilding.", "gauge");
+    out << "ista_build_up_to_date " << (report.up_to_date ? 1 : 0) << '\n';
+    header(out, "ista_build_output_triples", "Triples in the written KB.", "gauge");
+    out << "ista_build_output_triples " << report.output_triples << '\n';
+    header(out, "ista_build_duplicates_dropped_total", "Repeated triples dropped while assembling.", "counter");
+    out << "ista_build_duplicates_dropped_total " << report.duplicates << '\n';
+    header(out, "ista_build_functional_replaced_total",
+           "Functional property values replaced by a later one while assembling.", "counter");
+    out << "ista_build_functional_replaced_total " << report.functional_replaced << '\n';
+    header(out, "ista_build_spilled_bytes", "Bytes spilled to disk while assembling.", "gauge");
+    out << "ista_build_spilled_bytes " << report.spilled_bytes << '\n';
+    header(out, "ista_build_peak_rss_bytes", "Peak resident set size of the build.", "gauge");
+    out << "ista_build_peak_rss_bytes " << util::peakRssBytes() << '\n';
+}
+
+void writePrometheus(const std::string& path, const BuildReport& report)
+{
+    // Written aside and renamed, so a collector never reads half a file.
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp);
+        if (!out)
+            throw std::runtime_error("cannot write " + tmp);
+        writePrometheus(out, report);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("cannot rename " + tmp + " to " + path);
+}
+
+
+}
+
+}
@@ -0,0 +1,52 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include "build/engine.hpp"
+#include "util/json_writer.hpp"
+
+
+namespace ista
+{
+
+namespace build
+{
+
+
+// A JSON-lines event log of builds, appended to: one object per step start,
+// step end, stage and build, flushed as each happens so a long build can
+// be tailed for stalls (a step_start with no step_end) while it runs.
+class MetricsLog
+{
+public:
+    explicit MetricsLog(const std::string& path);
+
+    // Chains the log in front of whatever callbacks `options` already has.
+    void attach(BuildOptions& options);
+    void build(const BuildReport& report);
+
+private:
+    void stepStarted(util::JsonWriter& json, const StepReport& step);
+    void stepFinished(util::JsonWriter& json, const StepReport& step);
+    void stage(util::JsonWriter& json, const StageReport& stage);
+
+    std::ofstream out_;
+    std::mutex mutex_;
+};
+
+
+// The counters of a finished build in the Prometheus text exposition
+// format, for a node_exporter textfile collector or a push gateway.
+void writePrometheus(std::ostream& out, const BuildReport& report);
+void writePrometheus(const std::string& path, const BuildReport& report);
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,505 @@
+#include "step.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+#include <tuple>
+
+#include "io/csv_reader.hpp"
+#include "owl2/vocabulary.hpp"
+
+namespace ista
+{
+
+namespace build
+{
+
+
+namespace vocab = owl2::vocab;
+
+
+Schema::Schema(const owl2::Ontology& tbox)
+{
+    base_ = tbox.ontology_iri.baseIRI;
+    if (!base_.empty() && base_.back() != '#' && base_.back() != '/')
+        base_ += '#';
+
+    auto remember = [this](std::unordered_map<std::string, std::string>& map, std::string_view iri) {
+        std::string name(vocab::localName(iri));
+        auto [it, inserted] = map.emplace(name, iri);
+        if (!inserted && it->second != iri)
+            ambiguous_.insert(name);
+    };
+
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k) {
+        for (const owl2::TripleRow& row : tbox.axioms(static_cast<owl2::AxiomKind>(k))) {
+            if (owl2::isLiteral(row.object))
+                continue;
+            std::string_view s = tbox.iri(row.subject);
+            std::string_view p = tbox.iri(row.predicate);
+            std::string_view o = tbox.iri(row.object);
+            if (p == vocab::RDF_TYPE) {
+                if (o == vocab::OWL_CLASS)
+                    remember(classes_, s);
+                else if (o == vocab::OWL_OBJECT_PROPERTY || o == vocab::OWL_DATATYPE_PROPERTY)
+                    remember(properties_, s);
+                else if (o == vocab::OWL_FUNCTIONAL_PROPERTY)
+                    functional_.emplace(s);
+            } else if (p == vocab::RDFS_RANGE && o.starts_with(vocab::XSD) && o != vocab::XSD_STRING) {
+                datatypes_.emplace(s, o);
+            }
+        }
+    }
+}
+
+const std::string& Schema::lookup(const std::unordered_map<std::string, std::string>& map,
+                                  const std::string& name, const char* what) const
+{
+    if (ambiguous_.contains(name))
+        throw std::runtime_error(std::string("more than one ") + what + " named '" + name + "' in the ontology");
+    auto it = map.find(name);
+    if (it == map.end())
+        throw std::runtime_error(std::string(what) + " '" + name + "' not found in the ontology");
+    return it->second;
+}
+
+const std::string& Schema::classIri(const std::string& name) const
+{
+    return lookup(classes_, name, "class");
+}
+
+const std::string& Schema::propertyIri(const std::string& name) const
+{
+    return lookup(properties_, name, "property");
+}
+
+const std::string& Schema::datatypeOf(const std::string& property_iri) const
+{
+    static const std::string none;
+    auto it = datatypes_.find(property_iri);
+    return it == datatypes_.end() ? none : it->second;
+}
+
+bool Schema::isFunctional(std::string_view property_iri) const
+{
+    return functional_.contains(std::string(property_iri));
+}
+
+std::string Schema::individualIri(const std::string& class_name, std::string_view value) const
+{
+    while (!value.empty() && std::isspace(static_cast<unsigned char>(value.front())))
+        value.remove_prefix(1);
+    while (!value.empty() && std::isspace(static_cast<unsigned char>(value.back())))
+        value.remove_suffix(1);
+
+    std::string iri = base_;
+    for (char c : class_name)
+        iri.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+    iri.push_back('_');
+    for (char c : value)
+        iri.push_back(c == ' ' ? '_' : static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+    return iri;
+}
+
+
+std::pmr::string KeyIndex::key(std::string_view property, std::string_view value) const
+{
+    std::pmr::string k(map_.get_allocator());
+    k.reserve(property.size() + value.size() + 1);
+    k.append(property);
+    k.push_back('\0');
+    k.append(value);
+    return k;
+}
+
+void KeyIndex::add(std::string_view property, std::string_view value, std::string_view individual)
+{
+    Matches& matches = map_[key(property, value)];
+    if (matches.empty()) {
+        auto it = std::find_if(filters_.begin(), filters_.end(), [&](const auto& f) { return f.first == property; });
+        if (it == filters_.end()) {
+            filters_.emplace_back(std::piecewise_construct, std::forward_as_tuple(property),
+                                  std::forward_as_tuple(0, filters_.get_allocator().resource()));
+            it = filters_.end() - 1;
+        }
+        if (it->second.size() >= it->second.capacity())
+            growFilter(property, it->second);
+        else
+            it->second.insert(value);
+    }
+    for (const std::pmr::string& m : matches)
+        if (m == individual)
+            return;
+    matches.emplace_back(individual);
+}
+
+const KeyIndex::Matches* KeyIndex::find(std::string_view property, std::string_view value) const
+{
+    auto it = map_.find(key(property, value));
+    return it == map_.end() ? nullptr : &it->second;
+}
+
+const util::BloomFilter& KeyIndex::filter(std::string_view property) const
+{
+    static const util::BloomFilter none;
+    for (const auto& [p, filter] : filters_)
+        if (p == property)
+            return filter;
+    return none;
+}
+
+void KeyIndex::growFilter(std::string_view property, util::BloomFilter& filter)
+{
+    // The value being added is already in the map, with no matches yet.
+    util::BloomFilter grown(std::max<std::size_t>(1024, 2 * (filter.size() + 1)), filters_.get_allocator().resource());
+    for (const auto& [k, matches] : map_) {
+        std::string_view ks = k;
+        if (ks.size() > property.size() && ks[property.size()] == '\0' && ks.starts_with(property))
+            grown.insert(ks.substr(property.size() + 1));
+    }
+    filter = std::move(grown);
+}
+
+
+namespace
+{
+
+// The columns of one record, addressed by slot. Only columns a step refers to
+// get a slot, so records are never copied into a per-row dictionary.
+class RowReader
+{
+public:
+    RowReader(const TableConfig& table, const std::vector<std::string>& referenced)
+        : table_(table), csv_(table.path, table.delimiter)
+    {
+        for (const std::string& name : referenced)
+            slotOf(name);
+        for (const CompoundField& cf : table.compound_fields)
+            compound_slots_.push_back(slotOf(cf.column));
+        for (const auto& [column, transforms] : table.data_transforms)
+            transform_slots_.push_back(slotOf(column));
+        filter_slot_ = table.filter_column.empty() ? -1 : slotOf(table.filter_column);
+
+        std::vector<std::string> headers = table.headers;
+        if (table.headers_in_file && !csv_.next(headers))
+            throw io::ParseError(csv_.path(), csv_.line(), "missing header row");
+        for (const std::string& h : headers) {
+            auto it = slots_.find(h);
+            columns_.push_back(it == slots_.end() ? -1 : it->second);
+        }
+        for (unsigned i = 0; i < table.skip_n_lines && csv_.next(record_); ++i) {
+        }
+        values_.resize(slots_.size());
+        present_.resize(slots_.size());
+    }
+
+    int slotOf(const std::string& name)
+    {
+        auto [it, inserted] = slots_.emplace(name, static_cast<int>(slots_.size()));
+        return it->second;
+    }
+
+    // Advances to the next record that passes the filter, then expands
+    // compound fields and applies transforms.
+    bool next()
+    {
+        while (csv_.next(record_)) {
+            ++rows_;
+            std::fill(present_.begin(), present_.end(), false);
+            // dict(zip(headers, row)): later duplicate headers win, missing
+            // trailing columns are absent.
+            std::size_t n = std::min(record_.size(), columns_.size());
+            for (std::size_t i = 0; i < n; ++i) {
+                if (int slot = columns_[i]; slot >= 0) {
+                    values_[slot].swap(record_[i]);
+                    present_[slot] = true;
+                }
+            }
+            if (filter_slot_ >= 0
+                && (!present_[filter_slot_] || values_[filter_slot_].find(table_.filter_value) == std::string::npos)) {
+                ++filtered_;
+                continue;
+            }
+            for (std::size_t c = 0; c < compound_slots_.size(); ++c)
+                expand(table_.compound_fields[c], compound_slots_[c]);
+            for (std::size_t t = 0; t < transform_slots_.size(); ++t) {
+                int slot = transform_slots_[t];
+                if (present_[slot])
+                    for (const Transform& tr : table_.data_transforms[t].second)
+                        apply(tr, values_[slot]);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    const std::string* get(int slot) const { return present_[slot] ? &values_[slot] : nullptr; }
+    std::uint64_t rows() const { return rows_; }
+    std::uint64_t filtered() const { return filtered_; }
+
+private:
+    void expand(const CompoundField& cf, int slot)
+    {
+        if (!present_[slot])
+            return;
+        std::string_view rest = values_[slot];
+        std::string whole;
+        while (true) {
+            std::size_t d = rest.find(cf.delimiter);
+            std::string_view sub = rest.substr(0, d);
+            std::size_t first = sub.find(cf.field_split_prefix);
+            std::size_t last = sub.rfind(cf.field_split_prefix);
+            std::string_view name = sub.substr(0, first);
+            std::string_view value = last == std::string_view::npos ? sub : sub.substr(last + cf.field_split_prefix.size());
+            auto it = slots_.find(std::string(name));
+            if (it != slots_.end() && it->second != slot) {
+                values_[it->second].assign(value);
+                present_[it->second] = true;
+            }
+            if (d == std::string_view::npos)
+                break;
+            rest.remove_prefix(d + cf.delimiter.size());
+        }
+    }
+
+    void apply(const Transform& tr, std::string& v) const
+    {
+        switch (tr.op) {
+        case Transform::Op::SplitLast: {
+            std::size_t pos = v.rfind(tr.arg);
+            if (pos != std::string::npos)
+                v.erase(0, pos + tr.arg.size());
+            break;
+        }
+        case Transform::Op::SplitFirst: {
+            std::size_t pos = v.find(tr.arg);
+            if (pos != std::string::npos)
+                v.erase(pos);
+            break;
+        }
+        case Transform::Op::Strip: {
+            std::size_t b = v.find_first_not_of(" \t\r\n\f\v");
+            if (b == std::string::npos) {
+                v.clear();
+                break;
+            }
+            v.erase(v.find_last_not_of(" \t\r\n\f\v") + 1);
+            v.erase(0, b);
+            break;
+        }
+        case Transform::Op::Lower:
+            for (char& c : v)
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            break;
+        case Transform::Op::Upper:
+            for (char& c : v)
+                c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            break;
+        case Transform::Op::Prefix:
+            v.insert(0, tr.arg);
+            break;
+        case Transform::Op::StripPrefix:
+            if (v.starts_with(tr.arg))
+                v.erase(0, tr.arg.size());
+            break;
+        case Transform::Op::Integer: {
+            std::size_t b = v.find_first_not_of(" \t\r\n");
+            std::size_t e = v.find_last_not_of(" \t\r\n");
+            long long x = 0;
+            const char* first = b == std::string::npos ? v.data() : v.data() + b;
+            const char* last = b == std::string::npos ? v.data() : v.data() + e + 1;
+            if (first != last && *first == '+')
+                ++first;
+            auto [ptr, ec] = std::from_chars(first, last, x);
+            if (ec != std::errc() || ptr != last || first == last)
+                throw io::ParseError(csv_.path(), csv_.line(), "invalid literal for int(): '" + v + "'");
+            v = std::to_string(x);
+            break;
+        }
+        }
+    }
+
+    const TableConfig& table_;
+    io::CsvReader csv_;
+    std::unordered_map<std::string, int> slots_;
+    std::vector<int> columns_;
+    std::vector<int> compound_slots_;
+    std::vector<int> transform_slots_;
+    int filter_slot_ = -1;
+    std::vector<std::string> record_;
+    std::vector<std::string> values_;
+    std::vector<bool> present_;
+    std::uint64_t rows_ = 0;
+    std::uint64_t filtered_ = 0;
+};
+
+
+class Emitter
+{
+public:
+    explicit Emitter(io::TripleWriter& out) : out_(out) {}
+
+    void iri(std::string_view s, std::string_view p, std::string_view o)
+    {
+        triple_.subject.setIri(s);
+        triple_.predicate.setIri(p);
+        triple_.object.setIri(o);
+        out_.write(triple_);
+        ++count_;
+    }
+
+    void literal(std::string_view s, std::string_view p, std::string_view value, std::string_view datatype)
+    {
+        triple_.subject.setIri(s);
+        triple_.predicate.setIri(p);
+        triple_.object.setLiteral(value, datatype);
+        out_.write(triple_);
+        ++count_;
+    }
+
+    std::uint64_t count() const { return count_; }
+
+private:
+    io::TripleWriter& out_;
+    io::Triple triple_;
+    std::uint64_t count_ = 0;
+};
+
+
+StepResult runNodeStep(const Step& step, const Schema& schema, const KeyIndex& keys, io::TripleWriter& out)
+{
+    const std::string& class_name = step.merge && !step.existing_class.empty() ? step.existing_class : step.node_type;
+    const std::string& class_iri = schema.classIri(class_name);
+    const std::string& node_type_iri = schema.classIri(step.node_type);
+
+    struct Property
+    {
+        int slot;
+        const std::string* iri;
+        const std::string* datatype;
+        bool is_merge_column;
+    };
+    std::vector<std::string> referenced{step.iri_column_name};
+    if (step.merge)
+        referenced.push_back(step.merge_column);
+    for (const auto& entry : step.data_property_map)
+        referenced.push_back(entry.first);
+    RowReader rows(step.table, referenced);
+
+    int iri_slot = rows.slotOf(step.iri_column_name);
+    int merge_slot = step.merge ? rows.slotOf(step.merge_column) : -1;
+    const std::string* merge_iri = step.merge ? &schema.propertyIri(step.merge_property) : nullptr;
+    std::vector<Property> properties;
+    for (const auto& [column, name] : step.data_property_map) {
+        const std::string& iri = schema.propertyIri(name);
+        properties.push_back({rows.slotOf(column), &iri, &schema.datatypeOf(iri), step.merge && column == step.merge_column});
+    }
+
+    const util::BloomFilter* merge_filter = merge_iri ? &keys.filter(*merge_iri) : nullptr;
+
+    Emitter emit(out);
+    StepResult result;
+    std::string individual;
+    while (rows.next()) {
+        const std::string* name = rows.get(iri_slot);
+        if (!name)
+            continue;
+
+        const KeyIndex::Matches* match = nullptr;
+        if (step.merge) {
+            const std::string* key = rows.get(merge_slot);
+            if (key && merge_filter->mayContain(*key))
+                match = keys.find(*merge_iri, *key);
+            ++(match ? result.merge_hits : result.merge_misses);
+        }
+        if (match) {
+            if (match->size() > 1)
+                ++result.ambiguous;
+            // Ambiguous merges take the first match, as _merge_node does.
+            individual.assign(match->front());
+            if (!step.existing_class.empty())
+                emit.iri(individual, vocab::RDF_TYPE, node_type_iri);
+        } else {
+            if (step.merge && step.skip_create_new_node)
+                continue;
+            individual = schema.individualIri(class_name, *name);
+            emit.iri(individual, vocab::RDF_TYPE, vocab::OWL_NAMED_INDIVIDUAL);
+            emit.iri(individual, vocab::RDF_TYPE, class_iri);
+        }
+        for (const Property& p : properties) {
+            if (p.is_merge_column)
+                continue;
+            if (const std::string* value = rows.get(p.slot))
+                emit.literal(individual, *p.iri, *value, *p.datatype);
+        }
+        ++result.used;
+    }
+    result.rows = rows.rows();
+    result.filtered = rows.filtered();
+    result.triples = emit.count();
+    return result;
+}
+
+StepResult runRelationshipStep(const Step& step, const Schema& schema, const KeyIndex& keys, io::TripleWriter& out)
+{
+    const std::string& relation = schema.propertyIri(step.relationship_type);
+    const std::string* inverse = step.inverse_relationship_type.empty()
+        ? nullptr : &schema.propertyIri(step.inverse_relationship_type);
+    const std::string& subject_property = schema.propertyIri(step.subject_match_property);
+    const std::string& object_property = schema.propertyIri(step.object_match_property);
+
+    RowReader rows(step.table, {step.subject_column_name, step.object_column_name});
+    int subject_slot = rows.slotOf(step.subject_column_name);
+    int object_slot = rows.slotOf(step.object_column_name);
+    const util::BloomFilter& subject_filter = keys.filter(subject_property);
+    const util::BloomFilter& object_filter = keys.filter(object_property);
+
+    Emitter emit(out);
+    StepResult result;
+    while (rows.next()) {
+        const std::string* sid = rows.get(subject_slot);
+        const std::string* oid = rows.get(object_slot);
+        if (!sid || !oid)
+            continue;
+        // Unknown identifiers are the common case; the filters reject most
+        // of them without building a key.
+        const KeyIndex::Matches* subjects = subject_filter.mayContain(*sid) ? keys.find(subject_property, *sid) : nullptr;
+        const KeyIndex::Matches* objects = subjects && object_filter.mayContain(*oid)
+            ? keys.find(object_property, *oid) : nullptr;
+        if (!objects) {
+            ++result.unmatched;
+            continue;
+        }
+        if (subjects->size() > 1 || objects->size() > 1)
+            ++result.ambiguous;
+        for (const std::pmr::string& s : *subjects) {
+            for (const std::pmr::string& o : *objects) {
+                emit.iri(s, relation, o);
+                if (inverse)
+                    emit.iri(o, *inverse, s);
+            }
+        }
+        ++result.used;
+    }
+    result.rows = rows.rows();
+    result.filtered = rows.filtered();
+    result.triples = emit.count();
+    result.edges = result.triples;
+    return result;
+}
+
+}
+
+
+StepResult runStep(const Step& step, const Schema& schema, const KeyIndex& keys, io::TripleWriter& out)
+{
+    if (step.kind == StepKind::Node)
+        return runNodeStep(step, schema, keys, out);
+    return runRelationshipStep(step, schema, keys, out);
+}
+
+
+}
+
+}
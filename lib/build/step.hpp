@@ -0,0 +1,119 @@
+#ifndef STEP_HPP
+#define STEP_HPP
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "build/manifest.hpp"
+#include "io/triple.hpp"
+#include "owl2/ontology.hpp"
+#include "util/bloom_filter.hpp"
+#include "util/memory.hpp"
+
+
+namespace ista
+{
+
+namespace build
+{
+
+
+// What steps need to know about the TBox: entity IRIs by local name (as
+// owlready2 exposes them on `onto`), the datatype of each data property, and
+// the namespace new individuals are minted in.
+class Schema
+{
+public:
+    explicit Schema(const owl2::Ontology& tbox);
+
+    const std::string& classIri(const std::string& name) const;
+    const std::string& propertyIri(const std::string& name) const;
+    // Datatype for values of a data property; empty means xsd:string.
+    const std::string& datatypeOf(const std::string& property_iri) const;
+    bool isFunctional(std::string_view property_iri) const;
+
+    // Same naming as ista.util.safe_make_individual_name: the lower-cased
+    // class name, '_', then the value stripped, lower-cased and with spaces
+    // replaced by underscores.
+    std::string individualIri(const std::string& class_name, std::string_view value) const;
+
+private:
+    const std::string& lookup(const std::unordered_map<std::string, std::string>& map,
+                              const std::string& name, const char* what) const;
+
+    std::string base_;
+    std::unordered_map<std::string, std::string> classes_;
+    std::unordered_map<std::string, std::string> properties_;
+    std::unordered_map<std::string, std::string> datatypes_;
+    std::unordered_set<std::string> functional_;
+    std::unordered_set<std::string> ambiguous_;
+};
+
+
+// Individuals by (property IRI, value). Stands in for owlready2's
+// `onto.search(prop=value)` and is filled from the outputs of the steps the
+// current step depends on. Each property's values also go into a Bloom
+// filter; most relationship rows name identifiers the KB lacks, and the
+// filter turns those lookups away before a key is built and the map probed.
+class KeyIndex
+{
+public:
+    using Matches = std::pmr::vector<std::pmr::string>;
+
+    explicit KeyIndex(std::pmr::memory_resource* resource = &util::subsystemResource(util::Subsystem::Build))
+        : map_(resource), filters_(resource) {}
+
+    void add(std::string_view property, std::string_view value, std::string_view individual);
+    // Matches in insertion order, or nullptr.
+    const Matches* find(std::string_view property, std::string_view value) const;
+    bool empty() const { return map_.empty(); }
+
+    // The values of `property`, approximately: a value the filter rejects
+    // has no matches. Look it up once per step and check it before find().
+    const util::BloomFilter& filter(std::string_view property) const;
+
+private:
+    std::pmr::string key(std::string_view property, std::string_view value) const;
+    // Resizes the filter of `property` to twice its values, from the map.
+    void growFilter(std::string_view property, util::BloomFilter& filter);
+
+    std::pmr::unordered_map<std::pmr::string, Matches> map_;
+    // A handful of properties per step, so a list.
+    std::pmr::vector<std::pair<std::pmr::string, util::BloomFilter>> filters_;
+};
+
+
+struct StepResult
+{
+    std::uint64_t rows = 0;         // records read from the file
+    std::uint64_t used = 0;         // records that passed the filter and matched
+    std::uint64_t triples = 0;
+    std::uint64_t filtered = 0;     // records dropped by filter_column
+    // Node steps with merge: records that found an existing individual, and
+    // those that did not (and created one unless skip_create_new_node).
+    std::uint64_t merge_hits = 0;
+    std::uint64_t merge_misses = 0;
+    // Lookups that matched more than one individual.
+    std::uint64_t ambiguous = 0;
+    // Relationship steps: records whose subject or object matched nothing,
+    // and the assertions added, inverses included.
+    std::uint64_t unmatched = 0;
+    std::uint64_t edges = 0;
+};
+
+// Runs a node or relationship step over its flat file, writing the triples it
+// adds to the KB. Lookups go to `keys`, which must hold the outputs of the
+// step's dependencies.
+StepResult runStep(const Step& step, const Schema& schema, const KeyIndex& keys, io::TripleWriter& out);
+
+
+}
+
+}
+
+#endif
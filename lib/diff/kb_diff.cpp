@@ -0,0 +1,544 @@
+#include "kb_diff.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <compare>
+#include <cstdio>
+#include <numeric>
+#include <unordered_map>
+
+#include "io/snapshot.hpp"
+#include "io/triple.hpp"
+#include "owl2/ontology.hpp"
+#include "owl2/vocabulary.hpp"
+#include "util/hash.hpp"
+#include "util/json_writer.hpp"
+#include "util/parallel.hpp"
+
+namespace ista
+{
+
+namespace diff
+{
+
+using owl2::AxiomKind;
+using owl2::TermId;
+using owl2::TripleRow;
+
+
+namespace
+{
+
+// Marks an origin entry as an id in the new KB rather than the old one.
+constexpr std::uint32_t FROM_NEW = 0x80000000u;
+
+// A triple over shared ranks; literal objects keep LITERAL_BIT.
+struct Key
+{
+    std::uint32_t s;
+    std::uint32_t p;
+    std::uint32_t o;
+
+    friend auto operator<=>(const Key&, const Key&) = default;
+};
+
+// The sorted union of one term space (IRIs or literals) of both KBs. Equal
+// terms get equal ranks, so ranks compare across KBs the way strings would.
+struct Ranking
+{
+    std::vector<std::uint32_t> old_rank;
+    std::vector<std::uint32_t> new_rank;
+    std::vector<std::uint32_t> origin;     // per rank: old id, or new id | FROM_NEW
+};
+
+template <typename Less>
+std::vector<std::uint32_t> sortedIds(std::size_t n, unsigned threads, Less less)
+{
+    std::vector<std::uint32_t> ids(n);
+    std::iota(ids.begin(), ids.end(), 0u);
+    util::parallelSort(ids, threads, less);
+    return ids;
+}
+
+// `compare(old_id, new_id)` orders a term of the old KB against one of the
+// new; `old_equal` and `new_equal` say when two adjacent ids of one KB stand
+// for the same term, which then share a rank.
+template <typename Compare, typename OldEqual, typename NewEqual>
+Ranking rankUnion(const std::vector<std::uint32_t>& a, const std::vector<std::uint32_t>& b, Compare compare,
+                  OldEqual old_equal, NewEqual new_equal)
+{
+    Ranking r;
+    r.old_rank.resize(a.size());
+    r.new_rank.resize(b.size());
+    r.origin.reserve(std::max(a.size(), b.size()));
+    std::size_t i = 0, j = 0;
+    for (std::uint32_t rank = 0; i < a.size() || j < b.size(); ++rank) {
+        int c = i == a.size() ? 1 : j == b.size() ? -1 : compare(a[i], b[j]);
+        if (c <= 0) {
+            std::uint32_t first = a[i];
+            r.origin.push_back(first);
+            do
+                r.old_rank[a[i++]] = rank;
+            while (i < a.size() && old_equal(first, a[i]));
+        }
+        if (c >= 0) {
+            std::uint32_t first = b[j];
+            if (c > 0)
+                r.origin.push_back(first | FROM_NEW);
+            do
+                r.new_rank[b[j++]] = rank;
+            while (j < b.size() && new_equal(first, b[j]));
+        }
+    }
+    return r;
+}
+
+// Blank node labels are local to a document: the same restriction gets a
+// different genid in every serialization, and one added early renumbers all
+// later ones. Blank nodes are compared by these labels instead: a hash of
+// their outgoing triples, with each blank object standing in by its own
+// label, computed bottom up. A triple closing a cycle of blank nodes hashes
+// its object as a constant. Blank nodes with the same outgoing triples get
+// the same label and count as one term.
+template <typename Kb>
+std::unordered_map<TermId, std::string> canonicalBlankLabels(const Kb& kb)
+{
+    std::unordered_map<TermId, std::uint32_t> index;
+    std::vector<TermId> blanks;
+    for (TermId id = 0; id < kb.iriCount(); ++id) {
+        if (owl2::vocab::isBlank(kb.iri(id))) {
+            index.emplace(id, static_cast<std::uint32_t>(blanks.size()));
+            blanks.push_back(id);
+        }
+    }
+    if (blanks.empty())
+        return {};
+
+    // Outgoing triples of blank nodes by subject, with everything but blank
+    // objects hashed up front.
+    struct Edge
+    {
+        std::uint32_t subject;
+        std::uint32_t blank_object;    // NO_BLANK unless the object is a blank node
+        std::uint64_t predicate;
+        std::uint64_t object;
+    };
+    constexpr std::uint32_t NO_BLANK = ~0u;
+    auto termHash = [&](TermId id) {
+        if (!owl2::isLiteral(id))
+            return util::hashBytes(kb.iri(id));
+        owl2::LiteralRef l = kb.literal(id);
+        return util::hashBytes(l.lexical, util::hashBytes(kb.iri(l.datatype), util::hashBytes(l.language)));
+    };
+    std::vector<Edge> edges;
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k) {
+        for (const TripleRow& row : kb.axioms(static_cast<AxiomKind>(k))) {
+            auto subject = index.find(row.subject);
+            if (subject == index.end())
+                continue;
+            auto object = owl2::isLiteral(row.object) ? index.end() : index.find(row.object);
+            bool blank = object != index.end();
+            edges.push_back(Edge{subject->second, blank ? object->second : NO_BLANK, termHash(row.predicate),
+                                 blank ? 0 : termHash(row.object)});
+        }
+    }
+    std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) { return a.subject < b.subject; });
+    std::vector<std::size_t> first(blanks.size() + 1, 0);
+    for (const Edge& e : edges)
+        ++first[e.subject + 1];
+    for (std::size_t b = 0; b < blanks.size(); ++b)
+        first[b + 1] += first[b];
+
+    // Post-order over the blank objects, without recursion: lists nest as
+    // deep as they are long.
+    enum : std::uint8_t { Unvisited, Open, Done };
+    std::vector<std::uint8_t> state(blanks.size(), Unvisited);
+    std::vector<std::uint64_t> hash(blanks.size(), 0);
+    std::vector<std::uint32_t> stack;
+    std::vector<std::uint64_t> parts;
+    for (std::uint32_t root = 0; root < blanks.size(); ++root) {
+        if (state[root] != Unvisited)
+            continue;
+        stack.push_back(root);
+        while (!stack.empty()) {
+            std::uint32_t b = stack.back();
+            if (state[b] == Unvisited) {
+                state[b] = Open;
+                for (std::size_t i = first[b]; i < first[b + 1]; ++i)
+                    if (edges[i].blank_object != NO_BLANK && state[edges[i].blank_object] == Unvisited)
+                        stack.push_back(edges[i].blank_object);
+                continue;
+            }
+            stack.pop_back();
+            if (state[b] == Done)
+                continue;
+            parts.clear();
+            for (std::size_t i = first[b]; i < first[b + 1]; ++i) {
+                const Edge& e = edges[i];
+                std::uint64_t object = e.object;
+                if (e.blank_object != NO_BLANK)
+                    object = state[e.blank_object] == Done ? hash[e.blank_object] : 0x5bd1e995u;
+                parts.push_back(util::mix64(e.predicate ^ util::mix64(object)));
+            }
+            std::sort(parts.begin(), parts.end());
+            std::uint64_t h = parts.size();
+            for (std::uint64_t part : parts)
+                h = util::mix64(h ^ part) * 0x9fb21c651e98df25ULL;
+            hash[b] = h;
+            state[b] = Done;
+        }
+    }
+
+    std::unordered_map<TermId, std::string> labels;
+    labels.reserve(blanks.size());
+    char label[24];
+    for (std::size_t b = 0; b < blanks.size(); ++b) {
+        std::snprintf(label, sizeof(label), "_:c%016llx", static_cast<unsigned long long>(hash[b]));
+        labels.emplace(blanks[b], label);
+    }
+    return labels;
+}
+
+// The string an IRI id is ranked by: its canonical label for a blank node.
+template <typename Kb>
+std::string_view rankedIri(const Kb& kb, const std::unordered_map<TermId, std::string>& blanks, TermId id)
+{
+    std::string_view iri = kb.iri(id);
+    if (!blanks.empty() && owl2::vocab::isBlank(iri))
+        return blanks.find(id)->second;
+    return iri;
+}
+
+template <typename Kb>
+std::vector<Key> rankedTable(const Kb& kb, AxiomKind kind, const std::vector<std::uint32_t>& iri_rank,
+                             const std::vector<std::uint32_t>& literal_rank, unsigned threads)
+{
+    const auto& rows = kb.axioms(kind);
+    std::vector<Key> keys(rows.size());
+    auto rank = [&](TermId id) {
+        return owl2::isLiteral(id) ? owl2::makeLiteralId(literal_rank[owl2::literalIndex(id)]) : iri_rank[id];
+    };
+    util::parallelChunks(rows.size(), threads, [&](std::size_t begin, std::size_t end, unsigned) {
+        for (std::size_t i = begin; i < end; ++i)
+            keys[i] = Key{rank(rows[i].subject), rank(rows[i].predicate), rank(rows[i].object)};
+    });
+    util::parallelSort(keys, threads);
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+// Splits `a` into one chunk per thread; the matching range of `b` is found
+// by binary search on the chunk's first key, so chunks merge independently.
+void setDifferences(const std::vector<Key>& a, const std::vector<Key>& b, unsigned threads,
+                    std::vector<Key>& removed, std::vector<Key>& added)
+{
+    if (a.empty()) {
+        added = b;
+        return;
+    }
+    std::vector<std::vector<Key>> removed_parts(threads), added_parts(threads);
+    util::parallelChunks(a.size(), threads, [&](std::size_t begin, std::size_t end, unsigned t) {
+        auto b_begin = begin == 0 ? b.begin() : std::lower_bound(b.begin(), b.end(), a[begin]);
+        auto b_end = end == a.size() ? b.end() : std::lower_bound(b.begin(), b.end(), a[end]);
+        std::set_difference(a.begin() + begin, a.begin() + end, b_begin, b_end, std::back_inserter(removed_parts[t]));
+        std::set_difference(b_begin, b_end, a.begin() + begin, a.begin() + end, std::back_inserter(added_parts[t]));
+    });
+    for (auto& part : removed_parts)
+        removed.insert(removed.end(), part.begin(), part.end());
+    for (auto& part : added_parts)
+        added.insert(added.end(), part.begin(), part.end());
+}
+
+// Subjects of class assertions plus endpoints of object property assertions,
+// the same notion of individual `ista stats` uses.
+std::vector<std::uint32_t> individuals(const std::vector<Key>& classes, const std::vector<Key>& edges, unsigned threads)
+{
+    std::vector<std::uint32_t> ids;
+    ids.reserve(classes.size() + 2 * edges.size());
+    for (const Key& k : classes)
+        ids.push_back(k.s);
+    for (const Key& k : edges) {
+        ids.push_back(k.s);
+        ids.push_back(k.o);
+    }
+    util::parallelSort(ids, threads);
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+std::uint64_t countMissing(const std::vector<std::uint32_t>& from, const std::vector<std::uint32_t>& in)
+{
+    std::uint64_t n = 0;
+    auto it = in.begin();
+    for (std::uint32_t id : from) {
+        it = std::lower_bound(it, in.end(), id);
+        if (it == in.end() || *it != id)
+            ++n;
+    }
+    return n;
+}
+
+template <typename KeyFn>
+void tally(std::unordered_map<std::uint32_t, TermChange>& changes, const std::vector<Key>& keys,
+           std::uint64_t TermChange::*field, KeyFn key)
+{
+    for (const Key& k : keys)
+        ++(changes[key(k)].*field);
+}
+
+// Counts (subject, property) pairs that lost a value and gained another.
+void tallyReplaced(std::unordered_map<std::uint32_t, TermChange>& changes, const std::vector<Key>& removed,
+                   const std::vector<Key>& added)
+{
+    auto pair = [](const Key& k) { return std::pair(k.s, k.p); };
+    std::size_t i = 0, j = 0;
+    while (i < removed.size() && j < added.size()) {
+        auto a = pair(removed[i]), b = pair(added[j]);
+        if (a < b) {
+            ++i;
+        } else if (b < a) {
+            ++j;
+        } else {
+            ++changes[a.second].changed;
+            while (i < removed.size() && pair(removed[i]) == a)
+                ++i;
+            while (j < added.size() && pair(added[j]) == b)
+                ++j;
+        }
+    }
+}
+
+}
+
+
+bool KbDiff::empty() const
+{
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k)
+        if (added[k] || removed[k])
+            return false;
+    return true;
+}
+
+
+template <typename OldKb, typename NewKb>
+KbDiff diffKbs(const OldKb& old_kb, const NewKb& new_kb, unsigned threads, io::PatchWriter* patch)
+{
+    auto start = std::chrono::steady_clock::now();
+    threads = std::max(1u, threads);
+
+    auto old_blanks = canonicalBlankLabels(old_kb);
+    auto new_blanks = canonicalBlankLabels(new_kb);
+    auto oldIri = [&](TermId id) { return rankedIri(old_kb, old_blanks, id); };
+    auto newIri = [&](TermId id) { return rankedIri(new_kb, new_blanks, id); };
+    auto old_iris = sortedIds(old_kb.iriCount(), threads, [&](TermId a, TermId b) { return oldIri(a) < oldIri(b); });
+    auto new_iris = sortedIds(new_kb.iriCount(), threads, [&](TermId a, TermId b) { return newIri(a) < newIri(b); });
+    // Only blank nodes can share a label within one KB.
+    Ranking iris = rankUnion(
+        old_iris, new_iris, [&](TermId a, TermId b) { return oldIri(a).compare(newIri(b)); },
+        [&](TermId a, TermId b) { return !old_blanks.empty() && oldIri(a) == oldIri(b); },
+        [&](TermId a, TermId b) { return !new_blanks.empty() && newIri(a) == newIri(b); });
+    old_iris = {};
+    new_iris = {};
+
+    auto literalLess = [](const auto& kb) {
+        return [&kb](TermId a, TermId b) {
+            owl2::LiteralRef x = kb.literal(owl2::makeLiteralId(a));
+            owl2::LiteralRef y = kb.literal(owl2::makeLiteralId(b));
+            if (int c = x.lexical.compare(y.lexical))
+                return c < 0;
+            if (x.datatype != y.datatype)
+                return kb.iri(x.datatype) < kb.iri(y.datatype);
+            return x.language < y.language;
+        };
+    };
+    auto old_literals = sortedIds(old_kb.literalCount(), threads, literalLess(old_kb));
+    auto new_literals = sortedIds(new_kb.literalCount(), threads, literalLess(new_kb));
+    Ranking literals = rankUnion(old_literals, new_literals, [&](TermId a, TermId b) {
+        owl2::LiteralRef x = old_kb.literal(owl2::makeLiteralId(a));
+        owl2::LiteralRef y = new_kb.literal(owl2::makeLiteralId(b));
+        if (int c = x.lexical.compare(y.lexical))
+            return c;
+        if (int c = old_kb.iri(x.datatype).compare(new_kb.iri(y.datatype)))
+            return c;
+        return x.language.compare(y.language);
+    }, [](TermId, TermId) { return false; }, [](TermId, TermId) { return false; });
+    old_literals = {};
+    new_literals = {};
+
+    KbDiff d;
+    std::array<std::vector<Key>, owl2::AXIOM_KIND_COUNT> removed, added;
+    std::vector<Key> old_classes, new_classes;
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k) {
+        AxiomKind kind = static_cast<AxiomKind>(k);
+        std::vector<Key> a = rankedTable(old_kb, kind, iris.old_rank, literals.old_rank, threads);
+        std::vector<Key> b = rankedTable(new_kb, kind, iris.new_rank, literals.new_rank, threads);
+        setDifferences(a, b, threads, removed[k], added[k]);
+        d.removed[k] = removed[k].size();
+        d.added[k] = added[k].size();
+        if (kind == AxiomKind::ClassAssertion) {
+            old_classes = std::move(a);
+            new_classes = std::move(b);
+        } else if (kind == AxiomKind::ObjectPropertyAssertion) {
+            auto before = individuals(old_classes, a, threads);
+            auto after = individuals(new_classes, b, threads);
+            d.individuals_removed = countMissing(before, after);
+            d.individuals_added = countMissing(after, before);
+            old_classes = {};
+            new_classes = {};
+        }
+    }
+
+    auto name = [&](std::uint32_t rank) {
+        std::uint32_t o = iris.origin[rank];
+        return std::string((o & FROM_NEW) ? new_kb.iri(o & ~FROM_NEW) : old_kb.iri(o));
+    };
+    auto collect = [&](std::unordered_map<std::uint32_t, TermChange>& changes) {
+        std::vector<TermChange> result;
+        result.reserve(changes.size());
+        for (auto& [rank, change] : changes) {
+            change.iri = name(rank);
+            result.push_back(std::move(change));
+        }
+        std::sort(result.begin(), result.end(), [](const TermChange& a, const TermChange& b) {
+            std::uint64_t x = a.added + a.removed, y = b.added + b.removed;
+            return x != y ? x > y : a.iri < b.iri;
+        });
+        return result;
+    };
+
+    const std::size_t ca = static_cast<std::size_t>(AxiomKind::ClassAssertion);
+    const std::size_t opa = static_cast<std::size_t>(AxiomKind::ObjectPropertyAssertion);
+    const std::size_t dpa = static_cast<std::size_t>(AxiomKind::DataPropertyAssertion);
+    std::unordered_map<std::uint32_t, TermChange> classes, relations, data_properties;
+    tally(classes, added[ca], &TermChange::added, [](const Key& k) { return k.o; });
+    tally(classes, removed[ca], &TermChange::removed, [](const Key& k) { return k.o; });
+    tally(relations, added[opa], &TermChange::added, [](const Key& k) { return k.p; });
+    tally(relations, removed[opa], &TermChange::removed, [](const Key& k) { return k.p; });
+    tally(data_properties, added[dpa], &TermChange::added, [](const Key& k) { return k.p; });
+    tally(data_properties, removed[dpa], &TermChange::removed, [](const Key& k) { return k.p; });
+    tallyReplaced(data_properties, removed[dpa], added[dpa]);
+    d.classes = collect(classes);
+    d.relations = collect(relations);
+    d.data_properties = collect(data_properties);
+
+    if (patch) {
+        auto term = [&](std::uint32_t x, io::Term& t) {
+            bool literal = owl2::isLiteral(x);
+            std::uint32_t o = (literal ? literals : iris).origin[literal ? owl2::literalIndex(x) : x];
+            TermId id = literal ? owl2::makeLiteralId(o & ~FROM_NEW) : (o & ~FROM_NEW);
+            if (o & FROM_NEW)
+                io::rowToTerm(new_kb, id, t);
+            else
+                io::rowToTerm(old_kb, id, t);
+        };
+        io::Triple triple;
+        auto fill = [&](const Key& k) {
+            term(k.s, triple.subject);
+            term(k.p, triple.predicate);
+            term(k.o, triple.object);
+        };
+        for (const auto& keys : removed)
+            for (const Key& k : keys) {
+                fill(k);
+                patch->remove(triple);
+            }
+        for (const auto& keys : added)
+            for (const Key& k : keys) {
+                fill(k);
+                patch->add(triple);
+            }
+    }
+
+    d.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return d;
+}
+
+template KbDiff diffKbs(const owl2::Ontology&, const owl2::Ontology&, unsigned, io::PatchWriter*);
+template KbDiff diffKbs(const owl2::Ontology&, const io::Snapshot&, unsigned, io::PatchWriter*);
+template KbDiff diffKbs(const io::Snapshot&, const owl2::Ontology&, unsigned, io::PatchWriter*);
+template KbDiff diffKbs(const io::Snapshot&, const io::Snapshot&, unsigned, io::PatchWriter*);
+
+
+static std::string_view shortName(const std::string& iri)
+{
+    return owl2::vocab::localName(iri);
+}
+
+static void printChanges(const char* title, const std::vector<TermChange>& changes, bool with_changed, std::ostream& out)
+{
+    out << "\n" << title << ":\n";
+    if (changes.empty())
+        out << "(none)\n";
+    for (const auto& c : changes) {
+        out << shortName(c.iri) << ": +" << c.added << " -" << c.removed;
+        if (with_changed)
+            out << " (" << c.changed << " changed)";
+        out << "\n";
+    }
+}
+
+void printDiff(const KbDiff& d, std::ostream& out)
+{
+    out << "\n*************\n"
+        << "ONTOLOGY DIFF\n"
+        << "*************\n\n";
+
+    out << "Individuals: +" << d.individuals_added << " -" << d.individuals_removed << "\n";
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k)
+        out << owl2::axiomKindName(static_cast<AxiomKind>(k)) << " axioms: +" << d.added[k] << " -" << d.removed[k] << "\n";
+
+    printChanges("Class assertions", d.classes, false, out);
+    printChanges("Relationships", d.relations, false, out);
+    printChanges("Literal values", d.data_properties, true, out);
+
+    char line[64];
+    std::snprintf(line, sizeof(line), "\nComputed in %.3f s\n", d.seconds);
+    out << line;
+}
+
+static void writeChanges(util::JsonWriter& json, const char* name, const std::vector<TermChange>& changes, bool with_changed)
+{
+    json.key(name);
+    json.beginObject();
+    for (const auto& c : changes) {
+        json.key(c.iri);
+        json.beginObject();
+        json.field("added", c.added);
+        json.field("removed", c.removed);
+        if (with_changed)
+            json.field("changed", c.changed);
+        json.endObject();
+    }
+    json.endObject();
+}
+
+void writeDiffJson(const KbDiff& d, std::ostream& out)
+{
+    util::JsonWriter json(out);
+    json.beginObject();
+    json.key("individuals");
+    json.beginObject();
+    json.field("added", d.individuals_added);
+    json.field("removed", d.individuals_removed);
+    json.endObject();
+    json.key("axioms");
+    json.beginObject();
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k) {
+        json.key(owl2::axiomKindName(static_cast<AxiomKind>(k)));
+        json.beginObject();
+        json.field("added", d.added[k]);
+        json.field("removed", d.removed[k]);
+        json.endObject();
+    }
+    json.endObject();
+    writeChanges(json, "classes", d.classes, false);
+    writeChanges(json, "relations", d.relations, false);
+    writeChanges(json, "data_properties", d.data_properties, true);
+    json.field("seconds", d.seconds);
+    json.endObject();
+}
+
+
+}
+
+}
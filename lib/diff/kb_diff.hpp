@@ -0,0 +1,64 @@
+#ifndef KB_DIFF_HPP
+#define KB_DIFF_HPP
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "io/patch.hpp"
+#include "owl2/term.hpp"
+
+
+namespace ista
+{
+
+namespace diff
+{
+
+
+struct TermChange
+{
+    std::string iri;
+    std::uint64_t added = 0;
+    std::uint64_t removed = 0;
+    std::uint64_t changed = 0;     // data properties only: subjects whose value was replaced
+};
+
+struct KbDiff
+{
+    std::array<std::uint64_t, owl2::AXIOM_KIND_COUNT> added{};
+    std::array<std::uint64_t, owl2::AXIOM_KIND_COUNT> removed{};
+    std::uint64_t individuals_added = 0;
+    std::uint64_t individuals_removed = 0;
+    std::vector<TermChange> classes;          // class assertions per class
+    std::vector<TermChange> relations;        // object property assertions per property
+    std::vector<TermChange> data_properties;  // literal values per data property
+    double seconds = 0.0;
+
+    bool empty() const;
+};
+
+// Compares two KBs as sets of triples. Both KBs' terms are ranked into one
+// shared sorted dictionary, every axiom table is rewritten over those ranks
+// and sorted, and the sorted tables are merged chunk by chunk in parallel.
+// Instantiated for every pairing of owl2::Ontology and io::Snapshot. When
+// `patch` is given, removed and then added triples are written to it.
+//
+// Blank node labels are document-local, so blank nodes are matched by a
+// hash of their outgoing triples (blank objects included, recursively)
+// rather than by label. Blank nodes with the same outgoing triples count as
+// one, and one that differs anywhere below it counts as removed and added.
+template <typename OldKb, typename NewKb>
+KbDiff diffKbs(const OldKb& old_kb, const NewKb& new_kb, unsigned threads, io::PatchWriter* patch = nullptr);
+
+void printDiff(const KbDiff& diff, std::ostream& out);
+void writeDiffJson(const KbDiff& diff, std::ostream& out);
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,284 @@
+#include "algorithms.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <span>
+
+#include "util/numa.hpp"
+#include "util/scheduler.hpp"
+#include "util/trace.hpp"
+
+namespace ista
+{
+
+namespace graph
+{
+
+using owl2::TermId;
+using Clock = std::chrono::steady_clock;
+
+
+namespace
+{
+
+// Calls fn(vertex_begin, vertex_end) for consecutive vertex ranges whose
+// adjacency spans about one window of targets, in parallel within a window,
+// managing the page cache around them. `wanted(begin, end)` lets a pass skip
+// windows it has no work in.
+template <typename Wanted, typename Fn>
+void streamWindows(const MappedCsr& g, const StreamOptions& options, Wanted&& wanted, Fn&& fn)
+{
+    const std::uint64_t* offsets = g.offsets();
+    std::uint64_t n = g.vertexCount();
+    std::uint64_t edges_per_window = std::max<std::uint64_t>(1, options.window_bytes / 4);
+    const util::MappedFile& file = g.file();
+    bool by_node = options.threads > 1 && util::Scheduler::instance().byNode();
+
+    auto windowEnd = [&](std::uint64_t begin) {
+        std::uint64_t limit = offsets[begin] + edges_per_window;
+        std::uint64_t end = static_cast<std::uint64_t>(std::upper_bound(offsets + begin + 1, offsets + n + 1, limit) - offsets) - 1;
+        return std::max(end, begin + 1);
+    };
+    auto targetBytes = [&](std::uint64_t begin, std::uint64_t end) { return g.adjacencyRange(begin, end); };
+
+    for (std::uint64_t begin = 0; begin < n;) {
+        std::uint64_t end = windowEnd(begin);
+        if (!wanted(begin, end)) {
+            begin = end;
+            continue;
+        }
+        // With NUMA placement the next window is not read ahead: each node's
+        // workers fault in their own slice, so its page cache lands locally.
+        if (end < n && !by_node) {
+            auto [pos, len] = targetBytes(end, windowEnd(end));
+            file.adviseWillNeed(pos, len);
+        }
+        ISTA_TRACE_SCOPE("window");
+        std::uint64_t grain = std::max<std::uint64_t>(1024, (end - begin) / (std::uint64_t(options.threads) * 4));
+        if (options.threads <= 1)
+            fn(begin, end);
+        else
+            util::parallelForByNode(begin, end, fn, grain);
+        auto [pos, len] = targetBytes(begin, end);
+        file.release(pos, len);
+        begin = end;
+    }
+}
+
+// Per-vertex state is updated at random targets, so under NUMA placement no
+// node owns it; spread it over all of them.
+template <typename T>
+void interleave(const std::vector<T>& state)
+{
+    if (util::Scheduler::instance().byNode())
+        util::interleaveMemory(state.data(), state.size() * sizeof(T));
+}
+
+bool anyBit(const std::vector<std::uint64_t>& bits, std::uint64_t begin, std::uint64_t end)
+{
+    for (std::uint64_t w = begin / 64; w <= (end - 1) / 64; ++w) {
+        std::uint64_t word = bits[w];
+        if (w == begin / 64)
+            word &= ~std::uint64_t(0) << (begin % 64);
+        if (w == (end - 1) / 64 && end % 64 != 0)
+            word &= ~(~std::uint64_t(0) << (end % 64));
+        if (word)
+            return true;
+    }
+    return false;
+}
+
+TermId findRoot(std::vector<TermId>& parent, TermId x)
+{
+    while (true) {
+        TermId p = std::atomic_ref<TermId>(parent[x]).load(std::memory_order_relaxed);
+        if (p == x)
+            return x;
+        TermId gp = std::atomic_ref<TermId>(parent[p]).load(std::memory_order_relaxed);
+        // Path halving; losing the race only skips a shortcut.
+        std::atomic_ref<TermId>(parent[x]).compare_exchange_weak(p, gp, std::memory_order_relaxed);
+        x = gp;
+    }
+}
+
+void unite(std::vector<TermId>& parent, TermId a, TermId b)
+{
+    while (true) {
+        a = findRoot(parent, a);
+        b = findRoot(parent, b);
+        if (a == b)
+            return;
+        // Link the larger root under the smaller, so labels end up minimal.
+        if (a < b)
+            std::swap(a, b);
+        TermId expected = a;
+        if (std::atomic_ref<TermId>(parent[a]).compare_exchange_strong(expected, b, std::memory_order_relaxed))
+            return;
+    }
+}
+
+}
+
+
+BfsResult bfs(const MappedCsr& g, TermId source, const StreamOptions& options)
+{
+    ISTA_TRACE_SCOPE("bfs");
+    auto start = Clock::now();
+    std::uint64_t n = g.vertexCount();
+    BfsResult r;
+    r.depth.assign(n, UNREACHED);
+    if (source >= n) {
+        r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return r;
+    }
+
+    std::vector<std::uint64_t> frontier((n + 63) / 64, 0), next(frontier.size(), 0);
+    r.depth[source] = 0;
+    frontier[source / 64] |= std::uint64_t(1) << (source % 64);
+    interleave(r.depth);
+    interleave(frontier);
+    interleave(next);
+    r.level_sizes.push_back(1);
+    r.reached = 1;
+
+    for (std::uint32_t level = 0;; ++level) {
+        ISTA_TRACE_SCOPE("bfs level");
+        std::atomic<std::uint64_t> found{0}, scanned{0};
+        streamWindows(g, options, [&](std::uint64_t b, std::uint64_t e) { return anyBit(frontier, b, e); },
+                      [&](std::uint64_t b, std::uint64_t e) {
+            std::uint64_t local_found = 0, local_scanned = 0;
+            NeighborCursor cursor(g, static_cast<TermId>(b));
+            for (std::uint64_t u = b; u < e; ++u) {
+                if (!(frontier[u / 64] >> (u % 64) & 1)) {
+                    cursor.skip();
+                    continue;
+                }
+                std::span<const TermId> targets = cursor.next();
+                local_scanned += targets.size();
+                for (TermId v : targets) {
+                    std::uint32_t expected = UNREACHED;
+                    if (std::atomic_ref<std::uint32_t>(r.depth[v]).compare_exchange_strong(expected, level + 1,
+                                                                                            std::memory_order_relaxed)) {
+                        std::atomic_ref<std::uint64_t>(next[v / 64]).fetch_or(std::uint64_t(1) << (v % 64),
+                                                                              std::memory_order_relaxed);
+                        ++local_found;
+                    }
+                }
+            }
+            found += local_found;
+            scanned += local_scanned;
+        });
+        r.edges_scanned += scanned;
+        if (found == 0)
+            break;
+        r.level_sizes.push_back(found);
+        r.reached += found;
+        frontier.swap(next);
+        std::fill(next.begin(), next.end(), 0);
+    }
+    r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return r;
+}
+
+PageRankResult pageRank(const MappedCsr& g, const PageRankOptions& pr, const StreamOptions& options)
+{
+    ISTA_TRACE_SCOPE("pageRank");
+    auto start = Clock::now();
+    std::uint64_t n = g.vertexCount();
+    PageRankResult r;
+    if (n == 0)
+        return r;
+    const std::uint64_t* offsets = g.offsets();
+    r.rank.assign(n, 1.0 / n);
+    std::vector<double> next(n);
+    interleave(r.rank);
+    interleave(next);
+    auto all = [](std::uint64_t, std::uint64_t) { return true; };
+
+    for (r.iterations = 0; r.iterations < pr.max_iterations;) {
+        ISTA_TRACE_SCOPE("pageRank iteration");
+        double dangling = 0.0;
+        for (std::uint64_t u = 0; u < n; ++u)
+            if (offsets[u + 1] == offsets[u])
+                dangling += r.rank[u];
+        std::fill(next.begin(), next.end(), 0.0);
+
+        streamWindows(g, options, all, [&](std::uint64_t b, std::uint64_t e) {
+            NeighborCursor cursor(g, static_cast<TermId>(b));
+            for (std::uint64_t u = b; u < e; ++u) {
+                std::span<const TermId> targets = cursor.next();
+                if (targets.empty())
+                    continue;
+                double share = r.rank[u] / static_cast<double>(targets.size());
+                for (TermId v : targets) {
+                    if (options.threads <= 1)
+                        next[v] += share;
+                    else
+                        std::atomic_ref<double>(next[v]).fetch_add(share, std::memory_order_relaxed);
+                }
+            }
+        });
+
+        double base = (1.0 - pr.damping) / n + pr.damping * dangling / n;
+        double delta = 0.0;
+        for (std::uint64_t v = 0; v < n; ++v) {
+            double value = base + pr.damping * next[v];
+            delta += std::fabs(value - r.rank[v]);
+            r.rank[v] = value;
+        }
+        ++r.iterations;
+        r.delta = delta;
+        if (delta < pr.tolerance)
+            break;
+    }
+    r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return r;
+}
+
+ComponentsResult connectedComponents(const MappedCsr& g, const StreamOptions& options)
+{
+    ISTA_TRACE_SCOPE("connectedComponents");
+    auto start = Clock::now();
+    std::uint64_t n = g.vertexCount();
+    ComponentsResult r;
+    std::vector<TermId> parent(n);
+    std::vector<std::uint8_t> touched(n, 0);
+    for (std::uint64_t v = 0; v < n; ++v)
+        parent[v] = static_cast<TermId>(v);
+    interleave(parent);
+    interleave(touched);
+
+    streamWindows(g, options, [](std::uint64_t, std::uint64_t) { return true; },
+                  [&](std::uint64_t b, std::uint64_t e) {
+        NeighborCursor cursor(g, static_cast<TermId>(b));
+        for (std::uint64_t u = b; u < e; ++u) {
+            std::span<const TermId> targets = cursor.next();
+            if (targets.empty())
+                continue;
+            std::atomic_ref<std::uint8_t>(touched[u]).store(1, std::memory_order_relaxed);
+            for (TermId v : targets) {
+                std::atomic_ref<std::uint8_t>(touched[v]).store(1, std::memory_order_relaxed);
+                unite(parent, static_cast<TermId>(u), v);
+            }
+        }
+    });
+
+    r.component.resize(n);
+    for (std::uint64_t v = 0; v < n; ++v) {
+        TermId root = findRoot(parent, static_cast<TermId>(v));
+        r.component[v] = root;
+        if (!touched[v])
+            ++r.isolated;
+        else if (root == v)
+            ++r.count;
+    }
+    r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return r;
+}
+
+
+}
+
+}
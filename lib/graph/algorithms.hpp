@@ -0,0 +1,86 @@
+#ifndef GRAPH_ALGORITHMS_HPP
+#define GRAPH_ALGORITHMS_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "csr.hpp"
+
+
+namespace ista
+{
+
+namespace graph
+{
+
+
+// Every algorithm here reads the CSR in ascending vertex order, one window
+// of adjacency at a time: the next window is prefetched with MADV_WILLNEED
+// and the finished one released with MADV_DONTNEED. Only per-vertex state is
+// kept in memory, so a graph whose edges exceed RAM costs one sequential
+// read of the edge section per pass instead of random page faults. The
+// neighbor lists of compressed graphs are decoded one at a time as they
+// stream past, by a NeighborCursor per worker.
+//
+// Under NUMA placement (util::numaPlacement()) each window is split by node
+// and faulted in by that node's workers instead of read ahead, and the
+// per-vertex state is interleaved across nodes.
+struct StreamOptions
+{
+    std::uint64_t window_bytes = 64 << 20;   // of plain targets per window; compressed ones take fewer
+    unsigned threads = 1;
+};
+
+constexpr std::uint32_t UNREACHED = 0xFFFFFFFFu;
+
+struct BfsResult
+{
+    std::vector<std::uint32_t> depth;          // UNREACHED if not reachable
+    std::vector<std::uint64_t> level_sizes;    // vertices first reached at each depth
+    std::uint64_t reached = 0;
+    std::uint64_t edges_scanned = 0;
+    double seconds = 0.0;
+};
+
+// Directed breadth-first search from `source`. Each level scans only the
+// windows that contain frontier vertices.
+BfsResult bfs(const MappedCsr& g, owl2::TermId source, const StreamOptions& options = {});
+
+
+struct PageRankOptions
+{
+    double damping = 0.85;
+    unsigned max_iterations = 50;
+    double tolerance = 1e-9;   // L1 change between iterations
+};
+
+struct PageRankResult
+{
+    std::vector<double> rank;
+    unsigned iterations = 0;
+    double delta = 0.0;
+    double seconds = 0.0;
+};
+
+// Push-style PageRank; dangling vertices spread their rank uniformly. Each
+// iteration is one pass over the edges.
+PageRankResult pageRank(const MappedCsr& g, const PageRankOptions& pr = {}, const StreamOptions& options = {});
+
+
+struct ComponentsResult
+{
+    std::vector<std::uint32_t> component;   // smallest vertex id in the component
+    std::uint64_t count = 0;                // components with at least one edge
+    std::uint64_t isolated = 0;             // vertices with no edges at all
+    double seconds = 0.0;
+};
+
+// Weakly connected components by union-find over a single edge pass.
+ComponentsResult connectedComponents(const MappedCsr& g, const StreamOptions& options = {});
+
+
+}
+
+}
+
+#endif
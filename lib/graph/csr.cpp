@@ -0,0 +1,303 @@
+#include "csr.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "io/file_io.hpp"
+#include "io/snapshot.hpp"
+#include "owl2/ontology.hpp"
+#include "reorder.hpp"
+#include "util/external_sort.hpp"
+#include "util/huge_pages.hpp"
+#include "util/stream_vbyte.hpp"
+#include "util/trace.hpp"
+
+namespace ista
+{
+
+namespace graph
+{
+
+
+namespace
+{
+
+struct Edge
+{
+    owl2::TermId source;
+    owl2::TermId target;
+    owl2::TermId label;
+};
+
+struct BySource
+{
+    bool operator()(const Edge& a, const Edge& b) const
+    {
+        return std::tie(a.source, a.target, a.label) < std::tie(b.source, b.target, b.label);
+    }
+};
+
+std::uint64_t align8(std::uint64_t n)
+{
+    return (n + 7) & ~std::uint64_t(7);
+}
+
+template <typename T>
+std::string_view asBytes(const T* data, std::size_t count)
+{
+    return std::string_view(reinterpret_cast<const char*>(data), count * sizeof(T));
+}
+
+void pad(io::OutputFile& out)
+{
+    static const char zeros[8] = {};
+    out.write(std::string_view(zeros, align8(out.bytesWritten()) - out.bytesWritten()));
+}
+
+// Wrapping, so the first target may lie on either side of its vertex.
+std::uint32_t zigzag(std::uint32_t delta)
+{
+    return (delta << 1) ^ static_cast<std::uint32_t>(static_cast<std::int32_t>(delta) >> 31);
+}
+
+std::uint32_t unzigzag(std::uint32_t z)
+{
+    return (z >> 1) ^ (0u - (z & 1));
+}
+
+// Entries of the target chunks section.
+std::uint64_t chunkCount(std::uint64_t vertex_count)
+{
+    return (vertex_count + CSR_CHUNK - 1) / CSR_CHUNK + 1;
+}
+
+}
+
+
+const char* vertexOrderName(VertexOrder order)
+{
+    switch (order) {
+    case VertexOrder::Original: return "original";
+    case VertexOrder::Degree: return "degree";
+    case VertexOrder::Bfs: return "bfs";
+    case VertexOrder::Rcm: return "rcm";
+    }
+    return "unknown";
+}
+
+VertexOrder parseVertexOrder(std::string_view name)
+{
+    for (VertexOrder order : {VertexOrder::Original, VertexOrder::Degree, VertexOrder::Bfs, VertexOrder::Rcm})
+        if (name == vertexOrderName(order))
+            return order;
+    throw std::invalid_argument("unknown vertex order '" + std::string(name) + "'");
+}
+
+template <typename Kb>
+void buildCsr(const Kb& kb, const std::string& path, const CsrBuildOptions& options)
+{
+    ISTA_TRACE_SCOPE("buildCsr");
+    if (options.compress) {
+        CsrBuildOptions plain = options;
+        plain.compress = false;
+        std::string built = path + ".plain";
+        buildCsr(kb, built, plain);
+        reorderCsr(MappedCsr(built), path, VertexOrder::Original, options);
+        std::filesystem::remove(built);
+        return;
+    }
+    const auto& rows = kb.axioms(owl2::AxiomKind::ObjectPropertyAssertion);
+    std::uint64_t vertex_count = kb.iriCount();
+    std::uint64_t edge_count = rows.size();
+
+    std::pmr::vector<std::uint64_t> offsets(vertex_count + 1, 0, options.resource);
+    util::ExternalSorter<Edge, BySource> edges(options.memory_budget, options.spill_dir, options.threads);
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        const owl2::TripleRow& row = rows[i];
+        ++offsets[row.subject + 1];
+        edges.push(Edge{row.subject, row.object, row.predicate});
+    }
+    for (std::uint64_t v = 0; v < vertex_count; ++v)
+        offsets[v + 1] += offsets[v];
+
+    CsrHeader header{};
+    std::memcpy(header.magic, CSR_MAGIC, sizeof(header.magic));
+    header.vertex_count = vertex_count;
+    header.edge_count = edge_count;
+    header.offsets_pos = align8(sizeof(CsrHeader));
+    header.targets_pos = align8(header.offsets_pos + (vertex_count + 1) * 8);
+    header.targets_size = edge_count * 4;
+    header.labels_pos = align8(header.targets_pos + edge_count * 4);
+    header.name_offsets_pos = align8(header.labels_pos + edge_count * 4);
+    header.name_bytes_pos = align8(header.name_offsets_pos + (vertex_count + 1) * 8);
+    std::pmr::vector<std::uint64_t> name_offsets(vertex_count + 1, 0, options.resource);
+    for (std::uint64_t v = 0; v < vertex_count; ++v)
+        name_offsets[v + 1] = name_offsets[v] + kb.iri(static_cast<owl2::TermId>(v)).size();
+    header.name_bytes_size = name_offsets[vertex_count];
+
+    io::OutputFile out(path);
+    out.write(asBytes(&header, 1));
+    pad(out);
+    out.write(asBytes(offsets.data(), offsets.size()));
+    offsets.clear();
+    offsets.shrink_to_fit();
+    pad(out);
+
+    // Targets go straight to the file; labels wait in a spill file so both
+    // sections come out of one merge.
+    util::SpillFile labels(options.spill_dir);
+    std::vector<owl2::TermId> label_block;
+    label_block.reserve(1 << 16);
+    edges.merge([&](const Edge& e) {
+        out.write(asBytes(&e.target, 1));
+        label_block.push_back(e.label);
+        if (label_block.size() == label_block.capacity()) {
+            labels.write(label_block.data(), label_block.size() * sizeof(owl2::TermId));
+            label_block.clear();
+        }
+    });
+    labels.write(label_block.data(), label_block.size() * sizeof(owl2::TermId));
+    pad(out);
+    labels.rewind();
+    std::vector<char> buffer(1 << 20);
+    while (std::size_t got = labels.read(buffer.data(), buffer.size()))
+        out.write(std::string_view(buffer.data(), got));
+    pad(out);
+
+    out.write(asBytes(name_offsets.data(), name_offsets.size()));
+    pad(out);
+    for (std::uint64_t v = 0; v < vertex_count; ++v)
+        out.write(kb.iri(static_cast<owl2::TermId>(v)));
+    out.close();
+}
+
+template void buildCsr<owl2::Ontology>(const owl2::Ontology&, const std::string&, const CsrBuildOptions&);
+template void buildCsr<io::Snapshot>(const io::Snapshot&, const std::string&, const CsrBuildOptions&);
+
+
+MappedCsr::MappedCsr(const std::string& path)
+    : file_(path)
+{
+    if (file_.size() < sizeof(CsrHeader))
+        throw std::runtime_error("'" + path + "' is not an ista CSR graph");
+    std::memcpy(&header_, file_.data(), sizeof(header_));
+    if (std::memcmp(header_.magic, CSR_MAGIC, 7) != 0)
+        throw std::runtime_error("'" + path + "' is not an ista CSR graph");
+    if (header_.magic[7] != CSR_MAGIC[7])
+        throw std::runtime_error("'" + path + "' was written by another version of ista; rebuild it");
+    vertex_count_ = header_.vertex_count;
+    edge_count_ = header_.edge_count;
+    bool packed = (header_.flags & CSR_COMPRESSED) != 0;
+    std::uint64_t chunks_end = header_.offsets_pos + (vertex_count_ + 1) * 8;
+    if (packed)
+        chunks_end = header_.target_chunks_pos + chunkCount(vertex_count_) * 8;
+    if (header_.name_bytes_pos + header_.name_bytes_size > file_.size()
+        || (packed ? header_.target_chunks_pos < header_.offsets_pos + (vertex_count_ + 1) * 8
+                   : header_.targets_size != edge_count_ * 4)
+        || header_.targets_pos < chunks_end
+        || header_.labels_pos < header_.targets_pos + header_.targets_size + (packed ? util::STREAM_VBYTE_PADDING : 0)
+        || header_.name_offsets_pos < header_.labels_pos + edge_count_ * 4
+        || header_.name_bytes_pos < header_.name_offsets_pos + (vertex_count_ + 1) * 8
+        || (header_.original_ids_pos != 0
+            && (header_.original_ids_pos < header_.name_bytes_pos + header_.name_bytes_size
+                || header_.original_ids_pos + vertex_count_ * 4 > file_.size())))
+        throw std::runtime_error("'" + path + "' is truncated or corrupt");
+
+    const char* base = file_.data();
+    offsets_ = reinterpret_cast<const std::uint64_t*>(base + header_.offsets_pos);
+    if (packed) {
+        packed_targets_ = reinterpret_cast<const std::uint8_t*>(base + header_.targets_pos);
+        target_chunks_ = reinterpret_cast<const std::uint64_t*>(base + header_.target_chunks_pos);
+    } else
+        targets_ = reinterpret_cast<const std::uint32_t*>(base + header_.targets_pos);
+    labels_ = reinterpret_cast<const std::uint32_t*>(base + header_.labels_pos);
+    name_offsets_ = reinterpret_cast<const std::uint64_t*>(base + header_.name_offsets_pos);
+    name_bytes_ = base + header_.name_bytes_pos;
+    if (header_.original_ids_pos != 0)
+        original_ids_ = reinterpret_cast<const std::uint32_t*>(base + header_.original_ids_pos);
+    if (util::hugePageMode() != util::HugePages::Off)
+        file_.adviseHugePages();
+}
+
+util::MemoryUsage MappedCsr::memoryUsage() const
+{
+    return util::MemoryUsage{
+        file_.memory("csr offsets", header_.offsets_pos, (vertex_count_ + 1) * 8),
+        file_.memory("csr target chunks", header_.target_chunks_pos,
+                     target_chunks_ ? chunkCount(vertex_count_) * 8 : 0),
+        file_.memory("csr targets", header_.targets_pos, header_.targets_size),
+        file_.memory("csr labels", header_.labels_pos, edge_count_ * 4),
+        file_.memory("csr name offsets", header_.name_offsets_pos, (vertex_count_ + 1) * 8),
+        file_.memory("csr names", header_.name_bytes_pos, header_.name_bytes_size),
+        file_.memory("csr original ids", header_.original_ids_pos, original_ids_ ? vertex_count_ * 4 : 0),
+    };
+}
+
+owl2::TermId MappedCsr::findVertex(std::string_view iri) const
+{
+    for (std::uint64_t v = 0; v < vertex_count_; ++v)
+        if (name(static_cast<owl2::TermId>(v)) == iri)
+            return static_cast<owl2::TermId>(v);
+    return owl2::NO_TERM;
+}
+
+std::pair<std::uint64_t, std::uint64_t> MappedCsr::adjacencyRange(std::uint64_t begin, std::uint64_t end) const
+{
+    if (!packed_targets_)
+        return {header_.targets_pos + offsets_[begin] * 4, (offsets_[end] - offsets_[begin]) * 4};
+    std::uint64_t first = target_chunks_[begin / CSR_CHUNK];
+    std::uint64_t last = target_chunks_[(end + CSR_CHUNK - 1) / CSR_CHUNK];
+    return {header_.targets_pos + first, last - first};
+}
+
+
+void NeighborCursor::decode(std::uint64_t chunk)
+{
+    std::uint64_t first = chunk * CSR_CHUNK;
+    std::uint64_t last = std::min(first + CSR_CHUNK, g_.vertex_count_);
+    const std::uint64_t* offsets = g_.offsets_;
+    std::uint64_t count = offsets[last] - offsets[first];
+    if (buffer_.size() < count)
+        buffer_.resize(count);
+    owl2::TermId* out = buffer_.data();
+    util::streamVByteDecode(g_.packed_targets_ + g_.target_chunks_[chunk], count, out);
+    for (std::uint64_t v = first; v < last; ++v) {
+        owl2::TermId* list = out + (offsets[v] - offsets[first]);
+        std::uint64_t degree = offsets[v + 1] - offsets[v];
+        if (degree == 0)
+            continue;
+        list[0] = static_cast<owl2::TermId>(v) + unzigzag(list[0]);
+        for (std::uint64_t i = 1; i < degree; ++i)
+            list[i] += list[i - 1];
+    }
+    chunk_ = chunk;
+    base_ = offsets[first];
+}
+
+
+void encodeTargetChunk(owl2::TermId first, std::uint64_t count, const std::uint64_t* offsets,
+                       const owl2::TermId* targets, std::vector<std::uint8_t>& out)
+{
+    std::uint64_t edges = offsets[count] - offsets[0];
+    thread_local std::vector<std::uint32_t> gaps;
+    gaps.resize(edges);
+    for (std::uint64_t k = 0; k < count; ++k) {
+        std::uint64_t begin = offsets[k] - offsets[0], end = offsets[k + 1] - offsets[0];
+        if (begin == end)
+            continue;
+        gaps[begin] = zigzag(targets[begin] - static_cast<owl2::TermId>(first + k));
+        for (std::uint64_t i = begin + 1; i < end; ++i)
+            gaps[i] = targets[i] - targets[i - 1];
+    }
+    std::size_t at = out.size();
+    out.resize(at + util::streamVByteMaxBytes(edges));
+    out.resize(at + util::streamVByteEncode(gaps.data(), edges, out.data() + at));
+}
+
+}
+
+}
@@ -0,0 +1,209 @@
+#ifndef CSR_HPP
+#define CSR_HPP
+
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "owl2/term.hpp"
+#include "util/mapped_file.hpp"
+#include "util/memory.hpp"
+
+
+namespace ista
+{
+
+namespace graph
+{
+
+
+// On-disk compressed sparse row layout of the object-property graph. Every
+// IRI of the source KB is a vertex (most with no edges) and the vertex names
+// double as the edge label dictionary. buildCsr() numbers vertices by KB IRI
+// id; reorderCsr() renumbers them for locality and records each vertex's KB
+// id in `original ids`. Each neighbor list is sorted by target. Sections are
+// 8-byte aligned and laid out in the order a pass reads them:
+//
+//   header | offsets u64[V+1] | target chunks u64[C+1] | targets
+//          | labels u32[E] | name offsets u64[V+1] | name bytes
+//          | original ids u32[V]
+//
+// Targets are plain u32[E], or with CSR_COMPRESSED one Stream VByte block
+// (util/stream_vbyte.hpp) per chunk of CSR_CHUNK vertices, padded for the
+// SIMD decoder. A block holds the lists of its vertices in turn, each as the
+// zigzagged distance from the vertex to its first target followed by the
+// gaps between targets. Target chunks, present only then, hold the byte
+// position of each of the C = ceil(V / CSR_CHUNK) blocks and the end. Read
+// targets through a NeighborCursor, which handles both.
+constexpr char CSR_MAGIC[8] = {'I', 'S', 'T', 'A', 'C', 'S', 'R', '3'};
+
+constexpr std::uint32_t CSR_COMPRESSED = 1;
+constexpr std::uint64_t CSR_CHUNK = 64;
+
+// How a CSR file numbers its vertices.
+enum class VertexOrder : std::uint32_t
+{
+    Original,   // KB IRI ids, as buildCsr() writes them
+    Degree,     // by total degree, highest first
+    Bfs,        // breadth-first from the highest-degree vertex of each component
+    Rcm,        // reverse Cuthill-McKee
+};
+
+const char* vertexOrderName(VertexOrder order);
+// Accepts original, degree, bfs and rcm.
+VertexOrder parseVertexOrder(std::string_view name);
+
+struct CsrHeader
+{
+    char magic[8];
+    std::uint64_t vertex_count;
+    std::uint64_t edge_count;
+    std::uint64_t offsets_pos;
+    std::uint64_t targets_pos;
+    std::uint64_t labels_pos;
+    std::uint64_t name_offsets_pos;
+    std::uint64_t name_bytes_pos;
+    std::uint64_t name_bytes_size;
+    std::uint64_t original_ids_pos;   // 0 when the order is Original
+    std::uint32_t order;              // a VertexOrder
+    std::uint32_t flags;              // CSR_COMPRESSED
+    std::uint64_t targets_size;       // bytes, padding excluded
+    std::uint64_t target_chunks_pos;  // 0 unless compressed
+};
+
+struct CsrBuildOptions
+{
+    // Edges are sorted by source with util::ExternalSorter under this budget
+    // (0 = in memory), spilling into spill_dir (empty = the system temp dir).
+    std::uint64_t memory_budget = 0;
+    std::string spill_dir;
+    unsigned threads = 1;
+    // Write compressed targets: about 55-70% of the plain size, the least
+    // under a locality order, decoded as the algorithms read them.
+    bool compress = false;
+    // Per-vertex arrays built in memory before they are written out.
+    std::pmr::memory_resource* resource = &util::subsystemResource(util::Subsystem::Graph);
+};
+
+// Writes the ObjectPropertyAssertion rows of `kb` as a CSR file. Resident
+// memory is the per-vertex offsets plus the sort budget. A compressed graph
+// is built plain beside `path` and then converted. Instantiated for
+// owl2::Ontology and io::Snapshot.
+template <typename Kb>
+void buildCsr(const Kb& kb, const std::string& path, const CsrBuildOptions& options = {});
+
+
+// Read-only mapping of a CSR file. Nothing is read until it is touched, so
+// graphs larger than RAM open instantly; algorithms stream over it window
+// by window (see algorithms.hpp).
+class MappedCsr
+{
+public:
+    explicit MappedCsr(const std::string& path);
+
+    std::uint64_t vertexCount() const { return vertex_count_; }
+    std::uint64_t edgeCount() const { return edge_count_; }
+
+    bool compressed() const { return (header_.flags & CSR_COMPRESSED) != 0; }
+    const std::uint64_t* offsets() const { return offsets_; }
+    // Null for a compressed graph; NeighborCursor reads either kind.
+    const std::uint32_t* targets() const { return targets_; }
+    const std::uint32_t* labels() const { return labels_; }
+    std::uint64_t degree(owl2::TermId v) const { return offsets_[v + 1] - offsets_[v]; }
+
+    std::string_view name(owl2::TermId v) const
+    {
+        return std::string_view(name_bytes_ + name_offsets_[v], name_offsets_[v + 1] - name_offsets_[v]);
+    }
+    // Linear scan; meant for looking up a handful of start vertices.
+    owl2::TermId findVertex(std::string_view iri) const;
+
+    VertexOrder order() const { return static_cast<VertexOrder>(header_.order); }
+    // The KB IRI id of vertex v, to carry per-vertex results back to the KB.
+    owl2::TermId originalId(owl2::TermId v) const { return original_ids_ ? original_ids_[v] : v; }
+
+    // The file range (position, length) holding the neighbor lists of
+    // [begin, end), widened to whole chunks when compressed, for range
+    // madvise calls.
+    std::pair<std::uint64_t, std::uint64_t> adjacencyRange(std::uint64_t begin, std::uint64_t end) const;
+    std::uint64_t labelsPos() const { return header_.labels_pos; }
+    // Bytes of the targets section, padding excluded.
+    std::uint64_t targetsSize() const { return header_.targets_size; }
+    const util::MappedFile& file() const { return file_; }
+
+    // Each mapped section, with how much of it is resident.
+    util::MemoryUsage memoryUsage() const;
+
+private:
+    util::MappedFile file_;
+    CsrHeader header_;
+    std::uint64_t vertex_count_ = 0;
+    std::uint64_t edge_count_ = 0;
+    const std::uint64_t* offsets_ = nullptr;
+    const std::uint32_t* targets_ = nullptr;
+    const std::uint32_t* labels_ = nullptr;
+    const std::uint64_t* name_offsets_ = nullptr;
+    const char* name_bytes_ = nullptr;
+    const std::uint32_t* original_ids_ = nullptr;
+    const std::uint8_t* packed_targets_ = nullptr;
+    const std::uint64_t* target_chunks_ = nullptr;
+
+    friend class NeighborCursor;
+};
+
+
+// Walks the neighbor lists of vertices, best in ascending order. Plain lists
+// are handed out in place; compressed ones are decoded a chunk at a time,
+// when a list of the chunk is first asked for, into a buffer the cursor
+// owns. A span stays valid until the cursor moves to another chunk.
+class NeighborCursor
+{
+public:
+    explicit NeighborCursor(const MappedCsr& g, owl2::TermId v = 0) : g_(g), vertex_(v) {}
+
+    void seek(owl2::TermId v) { vertex_ = v; }
+    owl2::TermId vertex() const { return vertex_; }
+
+    // The targets of the current vertex, ascending; moves to the next one.
+    std::span<const owl2::TermId> next()
+    {
+        owl2::TermId v = vertex_++;
+        std::uint64_t degree = g_.degree(v);
+        if (g_.targets_)
+            return std::span<const owl2::TermId>(g_.targets_ + g_.offsets_[v], degree);
+        if (degree == 0)
+            return {};
+        if (v / CSR_CHUNK != chunk_)
+            decode(v / CSR_CHUNK);
+        return std::span<const owl2::TermId>(buffer_.data() + (g_.offsets_[v] - base_), degree);
+    }
+    // Moves to the next vertex without decoding anything.
+    void skip() { ++vertex_; }
+
+private:
+    void decode(std::uint64_t chunk);
+
+    const MappedCsr& g_;
+    owl2::TermId vertex_;
+    std::uint64_t chunk_ = ~std::uint64_t(0);
+    std::uint64_t base_ = 0;   // offset of the chunk's first edge
+    std::vector<owl2::TermId> buffer_;
+};
+
+// Appends the compressed block of the chunk of vertices starting at
+// `first`: `offsets` are the graph's offsets from offsets[first] to
+// offsets[first + count], and `targets` the chunk's lists, each ascending,
+// from edge offsets[first] on. The section padding is not added.
+void encodeTargetChunk(owl2::TermId first, std::uint64_t count, const std::uint64_t* offsets,
+                       const owl2::TermId* targets, std::vector<std::uint8_t>& out);
+
+
+}
+
+}
+
+#endif
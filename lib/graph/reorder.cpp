@@ -0,0 +1,320 @@
+#include "reorder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <utility>
+
+#include "io/file_io.hpp"
+#include "util/external_sort.hpp"
+#include "util/stream_vbyte.hpp"
+#include "util/trace.hpp"
+
+namespace ista
+{
+
+namespace graph
+{
+
+using owl2::TermId;
+
+
+namespace
+{
+
+std::uint64_t align8(std::uint64_t n)
+{
+    return (n + 7) & ~std::uint64_t(7);
+}
+
+template <typename T>
+std::string_view asBytes(const T* data, std::size_t count)
+{
+    return std::string_view(reinterpret_cast<const char*>(data), count * sizeof(T));
+}
+
+void pad(io::OutputFile& out)
+{
+    static const char zeros[8] = {};
+    out.write(std::string_view(zeros, align8(out.bytesWritten()) - out.bytesWritten()));
+}
+
+// Both directions of every edge, self loops dropped, neighbors ascending.
+struct Undirected
+{
+    std::vector<std::uint64_t> offsets;
+    std::vector<TermId> neighbors;
+
+    std::uint64_t degree(TermId v) const { return offsets[v + 1] - offsets[v]; }
+};
+
+Undirected undirected(const MappedCsr& g)
+{
+    std::uint64_t n = g.vertexCount();
+    Undirected a;
+    a.offsets.assign(n + 1, 0);
+    NeighborCursor edges(g);
+    for (std::uint64_t u = 0; u < n; ++u) {
+        for (TermId v : edges.next()) {
+            if (v == u)
+                continue;
+            ++a.offsets[u + 1];
+            ++a.offsets[v + 1];
+        }
+    }
+    std::partial_sum(a.offsets.begin(), a.offsets.end(), a.offsets.begin());
+    a.neighbors.resize(a.offsets[n]);
+    std::vector<std::uint64_t> cursor(a.offsets.begin(), a.offsets.end() - 1);
+    edges.seek(0);
+    for (std::uint64_t u = 0; u < n; ++u) {
+        for (TermId v : edges.next()) {
+            if (v == u)
+                continue;
+            a.neighbors[cursor[u]++] = v;
+            a.neighbors[cursor[v]++] = static_cast<TermId>(u);
+        }
+    }
+    // The reverse halves arrive out of order.
+    for (std::uint64_t v = 0; v < n; ++v)
+        std::sort(a.neighbors.begin() + a.offsets[v], a.neighbors.begin() + a.offsets[v + 1]);
+    return a;
+}
+
+// Appends each unvisited vertex of `roots`, in that order, and everything
+// reachable from it breadth first. Cuthill-McKee enqueues the neighbors of
+// a vertex by ascending degree; plain BFS takes them in id order.
+void breadthFirst(const Undirected& a, const std::vector<TermId>& roots, bool by_degree, std::vector<TermId>& order)
+{
+    std::vector<bool> seen(a.offsets.size() - 1, false);
+    std::vector<TermId> children;
+    for (TermId root : roots) {
+        if (seen[root])
+            continue;
+        std::size_t head = order.size();
+        order.push_back(root);
+        seen[root] = true;
+        while (head < order.size()) {
+            TermId u = order[head++];
+            children.clear();
+            for (std::uint64_t i = a.offsets[u]; i < a.offsets[u + 1]; ++i) {
+                TermId v = a.neighbors[i];
+                if (!seen[v]) {
+                    seen[v] = true;
+                    children.push_back(v);
+                }
+            }
+            if (by_degree)
+                std::stable_sort(children.begin(), children.end(),
+                                 [&](TermId x, TermId y) { return a.degree(x) < a.degree(y); });
+            order.insert(order.end(), children.begin(), children.end());
+        }
+    }
+}
+
+}
+
+
+std::vector<TermId> vertexPermutation(const MappedCsr& g, VertexOrder order)
+{
+    ISTA_TRACE_SCOPE("vertexPermutation");
+    std::uint64_t n = g.vertexCount();
+    std::vector<TermId> new_to_old(n);
+    if (order == VertexOrder::Original) {
+        for (std::uint64_t v = 0; v < n; ++v)
+            new_to_old[g.originalId(static_cast<TermId>(v))] = static_cast<TermId>(v);
+        return new_to_old;
+    }
+
+    std::vector<std::uint64_t> degree(n, 0);
+    NeighborCursor edges(g);
+    for (std::uint64_t u = 0; u < n; ++u) {
+        degree[u] += g.degree(static_cast<TermId>(u));
+        for (TermId v : edges.next())
+            ++degree[v];
+    }
+    std::vector<TermId> by_degree;
+    std::vector<TermId> isolated;
+    for (std::uint64_t v = 0; v < n; ++v)
+        (degree[v] != 0 ? by_degree : isolated).push_back(static_cast<TermId>(v));
+
+    std::vector<TermId> connected;
+    connected.reserve(by_degree.size());
+    if (order == VertexOrder::Degree) {
+        std::stable_sort(by_degree.begin(), by_degree.end(), [&](TermId a, TermId b) { return degree[a] > degree[b]; });
+        connected = std::move(by_degree);
+    } else {
+        Undirected a = undirected(g);
+        if (order == VertexOrder::Bfs) {
+            std::stable_sort(by_degree.begin(), by_degree.end(),
+                             [&](TermId x, TermId y) { return degree[x] > degree[y]; });
+            breadthFirst(a, by_degree, false, connected);
+        } else {
+            // Cuthill-McKee starts each component at a vertex of least
+            // degree, a cheap stand-in for a peripheral one.
+            std::stable_sort(by_degree.begin(), by_degree.end(),
+                             [&](TermId x, TermId y) { return degree[x] < degree[y]; });
+            breadthFirst(a, by_degree, true, connected);
+            std::reverse(connected.begin(), connected.end());
+        }
+    }
+    std::copy(connected.begin(), connected.end(), new_to_old.begin());
+    std::copy(isolated.begin(), isolated.end(), new_to_old.begin() + connected.size());
+    return new_to_old;
+}
+
+void reorderCsr(const MappedCsr& g, const std::string& path, VertexOrder order, const CsrBuildOptions& options)
+{
+    ISTA_TRACE_SCOPE("reorderCsr");
+    std::uint64_t n = g.vertexCount();
+    std::uint64_t edge_count = g.edgeCount();
+    std::vector<TermId> new_to_old = vertexPermutation(g, order);
+    std::vector<TermId> old_to_new(n);
+    for (std::uint64_t k = 0; k < n; ++k)
+        old_to_new[new_to_old[k]] = static_cast<TermId>(k);
+
+    std::pmr::vector<std::uint64_t> offsets(n + 1, 0, options.resource);
+    std::pmr::vector<std::uint64_t> name_offsets(n + 1, 0, options.resource);
+    for (std::uint64_t k = 0; k < n; ++k) {
+        offsets[k + 1] = offsets[k] + g.degree(new_to_old[k]);
+        name_offsets[k + 1] = name_offsets[k] + g.name(new_to_old[k]).size();
+    }
+
+    CsrHeader header{};
+    std::memcpy(header.magic, CSR_MAGIC, sizeof(header.magic));
+    header.vertex_count = n;
+    header.edge_count = edge_count;
+    header.order = static_cast<std::uint32_t>(order);
+    header.flags = options.compress ? CSR_COMPRESSED : 0;
+    header.targets_size = edge_count * 4;
+    std::vector<std::uint64_t> chunks;
+    // Positions follow from the size of the targets, known up front only
+    // when they are plain.
+    auto layout = [&] {
+        header.offsets_pos = align8(sizeof(CsrHeader));
+        header.targets_pos = align8(header.offsets_pos + (n + 1) * 8);
+        if (options.compress) {
+            header.target_chunks_pos = header.targets_pos;
+            header.targets_pos = align8(header.target_chunks_pos + chunks.size() * 8);
+        }
+        std::uint64_t targets_end = header.targets_pos + header.targets_size;
+        header.labels_pos = align8(options.compress ? targets_end + util::STREAM_VBYTE_PADDING : targets_end);
+        header.name_offsets_pos = align8(header.labels_pos + edge_count * 4);
+        header.name_bytes_pos = align8(header.name_offsets_pos + (n + 1) * 8);
+        header.name_bytes_size = name_offsets[n];
+        if (order != VertexOrder::Original)
+            header.original_ids_pos = align8(header.name_bytes_pos + header.name_bytes_size);
+    };
+    io::OutputFile out(path);
+    auto writeHead = [&] {
+        layout();
+        out.write(asBytes(&header, 1));
+        pad(out);
+        out.write(asBytes(offsets.data(), offsets.size()));
+        pad(out);
+        if (options.compress) {
+            out.write(asBytes(chunks.data(), chunks.size()));
+            pad(out);
+        }
+    };
+    auto copy = [&](util::SpillFile& from) {
+        from.rewind();
+        std::vector<char> buffer(1 << 20);
+        while (std::size_t got = from.read(buffer.data(), buffer.size()))
+            out.write(std::string_view(buffer.data(), got));
+    };
+
+    // As in buildCsr(), labels wait in a spill file while the targets are
+    // written, so each list is renumbered and re-sorted once. Compressed
+    // targets wait in another until their size, and so the layout, is known.
+    const std::uint64_t* old_offsets = g.offsets();
+    const std::uint32_t* old_labels = g.labels();
+    util::SpillFile labels(options.spill_dir);
+    std::optional<util::SpillFile> packed;
+    if (options.compress) {
+        packed.emplace(options.spill_dir);
+        chunks.resize((n + CSR_CHUNK - 1) / CSR_CHUNK + 1);
+    } else
+        writeHead();
+    NeighborCursor cursor(g);
+    std::vector<std::pair<TermId, TermId>> list;
+    std::vector<TermId> targets;
+    std::vector<TermId> block;
+    std::vector<std::uint8_t> bytes;
+    block.reserve(1 << 16);
+    auto flush = [&] {
+        labels.write(block.data(), block.size() * sizeof(TermId));
+        block.clear();
+    };
+    std::uint64_t packed_size = 0;
+    for (std::uint64_t k = 0; k < n; ++k) {
+        TermId u = new_to_old[k];
+        if (cursor.vertex() != u)
+            cursor.seek(u);
+        std::span<const TermId> old_targets = cursor.next();
+        list.clear();
+        for (std::size_t j = 0; j < old_targets.size(); ++j)
+            list.emplace_back(old_to_new[old_targets[j]], old_to_new[old_labels[old_offsets[u] + j]]);
+        std::sort(list.begin(), list.end());
+        for (const auto& [target, label] : list) {
+            block.push_back(label);
+            if (block.size() == block.capacity())
+                flush();
+        }
+        if (!options.compress) {
+            for (const auto& [target, label] : list)
+                out.write(asBytes(&target, 1));
+            continue;
+        }
+        for (const auto& [target, label] : list)
+            targets.push_back(target);
+        if ((k + 1) % CSR_CHUNK != 0 && k + 1 != n)
+            continue;
+        std::uint64_t first = k / CSR_CHUNK * CSR_CHUNK;
+        chunks[k / CSR_CHUNK] = packed_size + bytes.size();
+        encodeTargetChunk(static_cast<TermId>(first), k + 1 - first, offsets.data() + first, targets.data(), bytes);
+        targets.clear();
+        if (bytes.size() >= (1 << 20)) {
+            packed->write(bytes.data(), bytes.size());
+            packed_size += bytes.size();
+            bytes.clear();
+        }
+    }
+    flush();
+    if (options.compress) {
+        packed->write(bytes.data(), bytes.size());
+        packed_size += bytes.size();
+        chunks.back() = packed_size;
+        header.targets_size = packed_size;
+        writeHead();
+        copy(*packed);
+        static const char slack[util::STREAM_VBYTE_PADDING] = {};
+        out.write(std::string_view(slack, sizeof(slack)));
+    }
+    pad(out);
+    copy(labels);
+    pad(out);
+
+    out.write(asBytes(name_offsets.data(), name_offsets.size()));
+    pad(out);
+    for (std::uint64_t k = 0; k < n; ++k)
+        out.write(g.name(new_to_old[k]));
+    if (header.original_ids_pos != 0) {
+        pad(out);
+        block.clear();
+        for (std::uint64_t k = 0; k < n; ++k) {
+            block.push_back(g.originalId(new_to_old[k]));
+            if (block.size() == block.capacity()) {
+                out.write(asBytes(block.data(), block.size()));
+                block.clear();
+            }
+        }
+        out.write(asBytes(block.data(), block.size()));
+    }
+    out.close();
+}
+
+}
+
+}
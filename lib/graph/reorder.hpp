@@ -0,0 +1,47 @@
+#ifndef GRAPH_REORDER_HPP
+#define GRAPH_REORDER_HPP
+
+#include <string>
+#include <vector>
+
+#include "csr.hpp"
+
+
+namespace ista
+{
+
+namespace graph
+{
+
+
+// KB IRI ids follow ingestion order, so the neighbors of a vertex land all
+// over the per-vertex arrays a pass updates (depth, rank, parent). These
+// orders renumber the vertices so that neighbors get nearby ids:
+//
+//   Degree   hubs first, so the entries touched most share cache lines;
+//   Bfs      each component in breadth-first order from its largest hub;
+//   Rcm      reverse Cuthill-McKee, which keeps the id distance along
+//            every edge (the bandwidth) small, for meshes and chains.
+//
+// Edge direction is ignored when ordering. Vertices without edges keep
+// their relative order after all the others.
+
+// new_to_old[k] is the vertex of `g` that becomes vertex k. Builds an
+// undirected copy of the adjacency in memory (8 bytes per edge) for the
+// Bfs and Rcm orders.
+std::vector<owl2::TermId> vertexPermutation(const MappedCsr& g, VertexOrder order);
+
+// Writes `g` to `path` with its vertices renumbered by `order`: offsets,
+// targets, labels (which are vertex ids too) and names are all permuted,
+// and each vertex's KB IRI id is kept in the original ids section, so
+// reordering a reordered graph, or back to Original, composes correctly.
+// Either kind of graph may go in; options.compress picks what comes out, so
+// VertexOrder::Original converts between plain and compressed.
+void reorderCsr(const MappedCsr& g, const std::string& path, VertexOrder order, const CsrBuildOptions& options = {});
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+#include "csv_reader.hpp"
+
+#include "triple.hpp"
+
+namespace ista
+{
+
+namespace io
+{
+
+
+CsvReader::CsvReader(const std::string& path, char delimiter)
+    : in_(path), delimiter_(delimiter)
+{
+}
+
+bool CsvReader::next(std::vector<std::string>& fields)
+{
+    std::size_t count = 0;
+    auto field = [&]() -> std::string& {
+        if (count == fields.size())
+            fields.emplace_back();
+        std::string& f = fields[count++];
+        f.clear();
+        return f;
+    };
+
+    while (true) {
+        int c = in_.peek();
+        if (c < 0)
+            return false;
+        ++line_;
+        if (c == '\n' || c == '\r') {
+            // Blank line; Python yields an empty record, which no step can use.
+            in_.get();
+            if (c == '\r' && in_.peek() == '\n')
+                in_.get();
+            continue;
+        }
+
+        std::string* current = &field();
+        bool quoted = false;
+        bool at_start = true;
+        while (true) {
+            c = in_.get();
+            if (c < 0) {
+                if (quoted)
+                    throw ParseError(path(), line_, "unterminated quoted field");
+                break;
+            }
+            if (quoted) {
+                if (c == '"') {
+                    if (in_.peek() == '"') {
+                        in_.get();
+                        current->push_back('"');
+                    } else {
+                        quoted = false;
+                    }
+                } else {
+                    if (c == '\n')
+                        ++line_;
+                    current->push_back(static_cast<char>(c));
+                }
+                continue;
+            }
+            if (c == delimiter_) {
+                current = &field();
+                at_start = true;
+                continue;
+            }
+            if (c == '\n')
+                break;
+            if (c == '\r') {
+                if (in_.peek() == '\n')
+                    in_.get();
+                break;
+            }
+            if (c == '"' && at_start) {
+                quoted = true;
+                at_start = false;
+                continue;
+            }
+            at_start = false;
+            current->push_back(static_cast<char>(c));
+        }
+        fields.resize(count);
+        return true;
+    }
+}
+
+
+}
+
+}
@@ -0,0 +1,45 @@
+#ifndef CSV_READER_HPP
+#define CSV_READER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "file_io.hpp"
+
+
+namespace ista
+{
+
+namespace io
+{
+
+
+// Streaming reader for comma- or tab-separated tables, following the quoting
+// rules of Python's csv module: a field may be enclosed in double quotes,
+// quotes inside it are doubled, and a quoted field may span lines.
+class CsvReader
+{
+public:
+    CsvReader(const std::string& path, char delimiter);
+
+    // Fills `fields` with the next non-empty record, reusing its strings.
+    // Returns false at end of input.
+    bool next(std::vector<std::string>& fields);
+
+    const std::string& path() const { return in_.path(); }
+    std::uint64_t line() const { return line_; }
+    std::uint64_t bytesRead() const { return in_.bytesRead(); }
+
+private:
+    InputFile in_;
+    char delimiter_;
+    std::uint64_t line_ = 0;
+};
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,140 @@
+#include "file_io.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ista
+{
+
+namespace io
+{
+
+
+static std::runtime_error ioError(const std::string& what, const std::string& path)
+{
+    return std::runtime_error(what + " '" + path + "': " + std::strerror(errno));
+}
+
+
+InputFile::InputFile(const std::string& path, std::size_t buffer_size)
+    : path_(path), buffer_(buffer_size)
+{
+    fd_ = path == "-" ? 0 : ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0)
+        throw ioError("cannot open", path);
+#ifdef POSIX_FADV_SEQUENTIAL
+    ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+InputFile::~InputFile()
+{
+    if (fd_ > 0)
+        ::close(fd_);
+}
+
+bool InputFile::refill()
+{
+    consumed_ += end_;
+    pos_ = end_ = 0;
+    for (;;) {
+        ssize_t n = ::read(fd_, buffer_.data(), buffer_.size());
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            throw ioError("cannot read", path_);
+        end_ = static_cast<std::size_t>(n);
+        return n > 0;
+    }
+}
+
+bool InputFile::readLine(std::string& line)
+{
+    line.clear();
+    for (;;) {
+        if (pos_ == end_ && !refill())
+            return !line.empty();
+        const char* start = buffer_.data() + pos_;
+        const void* nl = std::memchr(start, '\n', end_ - pos_);
+        if (nl) {
+            std::size_t len = static_cast<const char*>(nl) - start;
+            line.append(start, len);
+            pos_ += len + 1;
+            return true;
+        }
+        line.append(start, end_ - pos_);
+        pos_ = end_;
+    }
+}
+
+
+OutputFile::OutputFile(const std::string& path, std::size_t buffer_size)
+    : path_(path), buffer_(buffer_size)
+{
+    fd_ = path == "-" ? 1 : ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0)
+        throw ioError("cannot create", path);
+}
+
+OutputFile::~OutputFile()
+{
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void OutputFile::flush()
+{
+    const char* p = buffer_.data();
+    std::size_t n = used_;
+    while (n > 0) {
+        ssize_t w = ::write(fd_, p, n);
+        if (w < 0 && errno == EINTR)
+            continue;
+        if (w < 0)
+            throw ioError("cannot write", path_);
+        p += w;
+        n -= static_cast<std::size_t>(w);
+    }
+    written_ += used_;
+    used_ = 0;
+}
+
+void OutputFile::writeSlow(std::string_view data)
+{
+    flush();
+    if (data.size() < buffer_.size()) {
+        data.copy(buffer_.data(), data.size());
+        used_ = data.size();
+        return;
+    }
+    while (!data.empty()) {
+        ssize_t w = ::write(fd_, data.data(), data.size());
+        if (w < 0 && errno == EINTR)
+            continue;
+        if (w < 0)
+            throw ioError("cannot write", path_);
+        data.remove_prefix(static_cast<std::size_t>(w));
+        written_ += static_cast<std::uint64_t>(w);
+    }
+}
+
+void OutputFile::close()
+{
+    if (fd_ < 0)
+        return;
+    flush();
+    if (fd_ > 1)
+        ::close(fd_);
+    fd_ = -1;
+}
+
+
+}
+
+}
@@ -0,0 +1,104 @@
+#ifndef FILE_IO_HPP
+#define FILE_IO_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace ista
+{
+
+namespace io
+{
+
+
+// Large-block sequential reader. Parsers pull bytes or lines from a fixed
+// buffer, so reading a file costs one read(2) per megabyte and memory does not
+// grow with the input.
+class InputFile
+{
+public:
+    explicit InputFile(const std::string& path, std::size_t buffer_size = 1 << 20);
+    ~InputFile();
+    InputFile(const InputFile&) = delete;
+    InputFile& operator=(const InputFile&) = delete;
+
+    int get()
+    {
+        if (pos_ == end_ && !refill())
+            return -1;
+        return static_cast<unsigned char>(buffer_[pos_++]);
+    }
+    int peek()
+    {
+        if (pos_ == end_ && !refill())
+            return -1;
+        return static_cast<unsigned char>(buffer_[pos_]);
+    }
+
+    // Reads up to the next '\n' (which is consumed but not stored). Returns
+    // false only at end of input.
+    bool readLine(std::string& line);
+
+    const std::string& path() const { return path_; }
+    std::uint64_t bytesRead() const { return consumed_ + pos_; }
+
+private:
+    bool refill();
+
+    std::string path_;
+    int fd_;
+    std::vector<char> buffer_;
+    std::size_t pos_ = 0;
+    std::size_t end_ = 0;
+    std::uint64_t consumed_ = 0;
+};
+
+
+class OutputFile
+{
+public:
+    explicit OutputFile(const std::string& path, std::size_t buffer_size = 1 << 20);
+    ~OutputFile();
+    OutputFile(const OutputFile&) = delete;
+    OutputFile& operator=(const OutputFile&) = delete;
+
+    void write(std::string_view data)
+    {
+        if (data.size() > buffer_.size() - used_)
+            writeSlow(data);
+        else {
+            data.copy(buffer_.data() + used_, data.size());
+            used_ += data.size();
+        }
+    }
+    void put(char c)
+    {
+        if (used_ == buffer_.size())
+            flush();
+        buffer_[used_++] = c;
+    }
+    OutputFile& operator<<(std::string_view data) { write(data); return *this; }
+
+    void flush();
+    void close();
+    std::uint64_t bytesWritten() const { return written_ + used_; }
+
+private:
+    void writeSlow(std::string_view data);
+
+    std::string path_;
+    int fd_;
+    std::vector<char> buffer_;
+    std::size_t used_ = 0;
+    std::uint64_t written_ = 0;
+};
+
+
+}
+
+}
+
+#endif
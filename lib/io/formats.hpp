@@ -0,0 +1,35 @@
+#ifndef FORMATS_HPP
+#define FORMATS_HPP
+
+#include <memory>
+#include <string>
+
+#include "triple.hpp"
+
+
+namespace ista
+{
+
+namespace io
+{
+
+
+// Per-format constructors behind openReader()/openWriter().
+std::unique_ptr<TripleReader> makeNTriplesReader(const std::string& path);
+std::unique_ptr<TripleWriter> makeNTriplesWriter(const std::string& path);
+std::unique_ptr<TripleReader> makeTurtleReader(const std::string& path);
+std::unique_ptr<TripleWriter> makeTurtleWriter(const std::string& path);
+std::unique_ptr<TripleReader> makeRdfXmlReader(const std::string& path);
+std::unique_ptr<TripleWriter> makeRdfXmlWriter(const std::string& path);
+std::unique_ptr<TripleReader> makeFunctionalReader(const std::string& path);
+std::unique_ptr<TripleWriter> makeFunctionalWriter(const std::string& path);
+std::unique_ptr<TripleReader> makeSnapshotReader(const std::string& path);
+std::unique_ptr<TripleWriter> makeSnapshotWriter(const std::string& path);
+std::unique_ptr<TripleWriter> makeNeo4jCsvWriter(const std::string& path);
+
+
+}
+
+}
+
+#endif
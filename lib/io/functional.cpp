@@ -0,0 +1,542 @@
+#include <iostream>
+#include <unordered_map>
+
+#include "file_io.hpp"
+#include "formats.hpp"
+#include "owl2/ontology.hpp"
+#include "owl2/vocabulary.hpp"
+#include "rdf_syntax.hpp"
+#include "util/memory.hpp"
+
+namespace ista
+{
+
+namespace io
+{
+
+namespace vocab = owl2::vocab;
+
+// Triples with no functional-syntax counterpart (e.g. the parts of a class
+// expression) are written as comments with this marker followed by the
+// triple in N-Triples syntax. Other tools ignore them; our reader restores
+// them, so OFN round-trips through ista are lossless.
+static constexpr std::string_view TRIPLE_COMMENT = "# triple: ";
+
+
+// Reads the assertion/declaration subset of the OWL 2 functional syntax.
+// Axioms outside that subset (class expressions, property characteristics,
+// ...) are skipped and counted.
+class FunctionalReader : public TripleReader
+{
+public:
+    explicit FunctionalReader(const std::string& path) : in_(path) {}
+
+    ~FunctionalReader() override
+    {
+        if (skipped_ > 0)
+            std::cerr << "warning: " << in_.path() << ": skipped " << skipped_
+                      << " axioms outside the supported OWL functional syntax subset\n";
+    }
+
+    bool next(Triple& triple) override
+    {
+        while (pending_.empty()) {
+            if (!step())
+                return false;
+        }
+        pending_.pop(triple);
+        return true;
+    }
+
+    std::uint64_t bytesRead() const override { return in_.bytesRead(); }
+
+private:
+    enum class Token
+    {
+        Open,
+        Close,
+        Equals,
+        Iri,        // text holds the expanded IRI
+        Blank,      // text holds the label
+        Literal,    // literal_ holds the value
+        Name,       // keyword or prefixed name, in text
+        End,
+    };
+
+    [[noreturn]] void fail(const std::string& message) { throw ParseError(in_.path(), line_, message); }
+
+    int get()
+    {
+        int c = in_.get();
+        if (c == '\n')
+            ++line_;
+        return c;
+    }
+
+    void skipSpace()
+    {
+        for (;;) {
+            int c = in_.peek();
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+                get();
+            } else if (c == '#') {
+                comment();
+            } else {
+                return;
+            }
+        }
+    }
+
+    void comment()
+    {
+        std::string line;
+        for (int c = get(); c >= 0 && c != '\n'; c = get())
+            line.push_back(static_cast<char>(c));
+        if (line.starts_with(TRIPLE_COMMENT)) {
+            Triple t;
+            try {
+                if (parseNTriplesLine(std::string_view(line).substr(TRIPLE_COMMENT.size()), t))
+                    pending_.push(t.subject, t.predicate, t.object);
+            } catch (const std::invalid_argument& e) {
+                fail(e.what());
+            }
+        }
+    }
+
+    static bool isNameChar(int c)
+    {
+        return c > ' ' && c != '(' && c != ')' && c != '=' && c != '<' && c != '"' && c != '#';
+    }
+
+    Token token()
+    {
+        skipSpace();
+        text_.clear();
+        int c = in_.peek();
+        if (c < 0)
+            return Token::End;
+        if (c == '(') { get(); return Token::Open; }
+        if (c == ')') { get(); return Token::Close; }
+        if (c == '=') { get(); return Token::Equals; }
+        if (c == '<') {
+            get();
+            for (c = get(); c != '>'; c = get()) {
+                if (c < 0)
+                    fail("unterminated IRI");
+                text_.push_back(static_cast<char>(c));
+            }
+            return Token::Iri;
+        }
+        if (c == '"') {
+            get();
+            literal_.kind = TermKind::Literal;
+            literal_.value.clear();
+            literal_.datatype.clear();
+            literal_.language.clear();
+            for (c = get(); c != '"'; c = get()) {
+                if (c < 0)
+                    fail("unterminated literal");
+                if (c == '\\')
+                    c = get();
+                literal_.value.push_back(static_cast<char>(c));
+            }
+            if (in_.peek() == '@') {
+                get();
+                while (isNameChar(in_.peek()))
+                    literal_.language.push_back(static_cast<char>(get()));
+            } else if (in_.peek() == '^') {
+                get();
+                if (get() != '^')
+                    fail("expected '^^'");
+                Token dt = token();
+                if (dt == Token::Name)
+                    literal_.datatype = expand(text_);
+                else if (dt == Token::Iri)
+                    literal_.datatype = text_;
+                else
+                    fail("expected a datatype IRI");
+                if (literal_.datatype == vocab::XSD_STRING)
+                    literal_.datatype.clear();
+            }
+            return Token::Literal;
+        }
+        while (isNameChar(in_.peek()))
+            text_.push_back(static_cast<char>(get()));
+        if (text_.empty())
+            fail("unexpected character");
+        if (text_.starts_with("_:")) {
+            text_.erase(0, 2);
+            return Token::Blank;
+        }
+        return Token::Name;
+    }
+
+    std::string expand(const std::string& name)
+    {
+        std::size_t colon = name.find(':');
+        if (colon == std::string::npos)
+            fail("expected an IRI, got '" + name + "'");
+        auto it = prefixes_.find(name.substr(0, colon));
+        if (it == prefixes_.end())
+            fail("undeclared prefix '" + name.substr(0, colon) + "'");
+        return it->second + name.substr(colon + 1);
+    }
+
+    void skipBalanced()
+    {
+        if (token() != Token::Open)
+            fail("expected '('");
+        for (int depth = 1; depth > 0;) {
+            Token t = token();
+            if (t == Token::Open)
+                ++depth;
+            else if (t == Token::Close)
+                --depth;
+            else if (t == Token::End)
+                fail("unbalanced parentheses");
+        }
+    }
+
+    // Reads the remaining arguments of an axiom up to its closing ')',
+    // skipping axiom annotations.
+    bool arguments(std::vector<Term>& args)
+    {
+        args.clear();
+        bool simple = true;
+        for (;;) {
+            skipSpace();
+            if (in_.peek() == ')') {
+                get();
+                return simple;
+            }
+            Term term;
+            Token t = token();
+            if (t == Token::Name && in_.peek() == '(') {
+                bool is_annotation = text_ == "Annotation";
+                skipBalanced();
+                if (!is_annotation)
+                    simple = false;
+                continue;
+            }
+            switch (t) {
+            case Token::Iri: term.setIri(text_); break;
+            case Token::Name: term.setIri(expand(text_)); break;
+            case Token::Blank: term.setBlank(text_); break;
+            case Token::Literal: term = literal_; break;
+            case Token::Open:
+                simple = false;
+                for (int depth = 1; depth > 0;) {
+                    Token inner = token();
+                    depth += inner == Token::Open ? 1 : inner == Token::Close ? -1 : 0;
+                }
+                continue;
+            default: fail("unexpected token in axiom");
+            }
+            args.push_back(std::move(term));
+        }
+    }
+
+    void emit(const Term& s, std::string_view p, const Term& o) { pending_.push(s, p, o); }
+
+    void emit(const Term& s, const Term& p, const Term& o) { pending_.push(s, p, o); }
+
+    void declaration()
+    {
+        if (token() != Token::Open || token() != Token::Name)
+            fail("malformed Declaration");
+        std::string kind = text_;
+        std::vector<Term> args;
+        if (token() != Token::Open || !arguments(args) || args.size() != 1)
+            fail("malformed Declaration");
+        skipSpace();
+        if (token() != Token::Close)
+            fail("expected ')' after Declaration");
+
+        static const std::unordered_map<std::string, std::string_view> types = {
+            {"Class", vocab::OWL_CLASS},
+            {"ObjectProperty", vocab::OWL_OBJECT_PROPERTY},
+            {"DataProperty", vocab::OWL_DATATYPE_PROPERTY},
+            {"AnnotationProperty", vocab::OWL_ANNOTATION_PROPERTY},
+            {"NamedIndividual", vocab::OWL_NAMED_INDIVIDUAL},
+            {"Datatype", vocab::RDFS_DATATYPE},
+        };
+        auto it = types.find(kind);
+        if (it == types.end())
+            fail("unknown entity type '" + kind + "'");
+        Term type;
+        type.setIri(it->second);
+        emit(args[0], vocab::RDF_TYPE, type);
+    }
+
+    void axiom(const std::string& name)
+    {
+        if (name == "Declaration") {
+            declaration();
+            return;
+        }
+        skipSpace();
+        if (in_.peek() != '(')
+            fail("expected '(' after " + name);
+        get();
+        std::vector<Term> args;
+        bool simple = arguments(args);
+        if (!simple) {
+            ++skipped_;
+            return;
+        }
+        if (name == "ClassAssertion" && args.size() == 2) {
+            emit(args[1], vocab::RDF_TYPE, args[0]);
+        } else if ((name == "ObjectPropertyAssertion" || name == "DataPropertyAssertion" || name == "AnnotationAssertion")
+                   && args.size() == 3) {
+            emit(args[1], args[0], args[2]);
+        } else if (name == "SubClassOf" && args.size() == 2) {
+            emit(args[0], vocab::RDFS_SUBCLASS_OF, args[1]);
+        } else {
+            ++skipped_;
+        }
+    }
+
+    bool step()
+    {
+        if (done_)
+            return false;
+        Token t = token();
+        if (t == Token::End) {
+            if (in_ontology_)
+                fail("unterminated Ontology(");
+            done_ = true;
+            return !pending_.empty();
+        }
+        if (t == Token::Close && in_ontology_) {
+            in_ontology_ = false;
+            return true;
+        }
+        if (t != Token::Name)
+            fail("expected an axiom");
+        std::string name = text_;
+
+        if (name == "Prefix") {
+            if (token() != Token::Open || token() != Token::Name)
+                fail("malformed Prefix");
+            std::string prefix = text_;
+            if (!prefix.empty() && prefix.back() == ':')
+                prefix.pop_back();
+            Token eq = token();
+            if (eq != Token::Equals)
+                fail("malformed Prefix");
+            if (token() != Token::Iri)
+                fail("malformed Prefix");
+            prefixes_[prefix] = text_;
+            if (token() != Token::Close)
+                fail("malformed Prefix");
+        } else if (name == "Ontology") {
+            if (token() != Token::Open)
+                fail("expected '(' after Ontology");
+            in_ontology_ = true;
+            skipSpace();
+            if (in_.peek() == '<') {
+                token();
+                ontology_.setIri(text_);
+                Term type;
+                type.setIri(vocab::OWL_ONTOLOGY);
+                emit(ontology_, vocab::RDF_TYPE, type);
+                skipSpace();
+                if (in_.peek() == '<') {
+                    token();
+                    Term version;
+                    version.setIri(text_);
+                    emit(ontology_, vocab::OWL_VERSION_IRI, version);
+                }
+            }
+        } else if (name == "Import") {
+            std::vector<Term> args;
+            if (token() != Token::Open)
+                fail("malformed Import");
+            arguments(args);
+            if (args.size() == 1 && !ontology_.value.empty())
+                emit(ontology_, std::string(vocab::OWL) + "imports", args[0]);
+        } else if (name == "Annotation" && in_ontology_) {
+            std::vector<Term> args;
+            if (token() != Token::Open)
+                fail("malformed Annotation");
+            if (arguments(args) && args.size() == 2 && !ontology_.value.empty())
+                emit(ontology_, args[0], args[1]);
+        } else {
+            axiom(name);
+        }
+        return true;
+    }
+
+    InputFile in_;
+    std::uint64_t line_ = 1;
+    std::string text_;
+    Term literal_;
+    Term ontology_;
+    std::unordered_map<std::string, std::string> prefixes_;
+    TripleQueue pending_{&util::subsystemResource(util::Subsystem::Parser)};
+    std::uint64_t skipped_ = 0;
+    bool in_ontology_ = false;
+    bool done_ = false;
+};
+
+
+class FunctionalWriter : public TripleWriter
+{
+public:
+    explicit FunctionalWriter(const std::string& path) : out_(path) {}
+
+    void write(const Triple& triple) override
+    {
+        buf_.clear();
+        const Term& s = triple.subject;
+        const Term& p = triple.predicate;
+        const Term& o = triple.object;
+        bool is_type = p.value == vocab::RDF_TYPE && o.kind == TermKind::Iri;
+
+        if (!header_written_) {
+            std::string ontology_iri;
+            if (is_type && o.value == vocab::OWL_ONTOLOGY && s.kind == TermKind::Iri)
+                ontology_iri = s.value;
+            writeHeader(ontology_iri);
+            if (!ontology_iri.empty())
+                return;
+        }
+
+        owl2::AxiomKind kind = owl2::classifyTriple(p.value, o.value, o.kind == TermKind::Literal);
+        if (kind == owl2::AxiomKind::Declaration && s.kind == TermKind::Iri) {
+            buf_ += "Declaration(";
+            buf_ += declarationKeyword(o.value);
+            buf_ += "(";
+            appendTerm(s);
+            buf_ += "))\n";
+        } else if (kind == owl2::AxiomKind::ClassAssertion) {
+            buf_ += "ClassAssertion(";
+            appendTerm(o);
+            buf_ += " ";
+            appendTerm(s);
+            buf_ += ")\n";
+        } else if (kind == owl2::AxiomKind::ObjectPropertyAssertion || kind == owl2::AxiomKind::DataPropertyAssertion
+                   || kind == owl2::AxiomKind::AnnotationAssertion) {
+            buf_ += kind == owl2::AxiomKind::ObjectPropertyAssertion ? "ObjectPropertyAssertion("
+                  : kind == owl2::AxiomKind::DataPropertyAssertion ? "DataPropertyAssertion("
+                  : "AnnotationAssertion(";
+            appendTerm(p);
+            buf_ += " ";
+            appendTerm(s);
+            buf_ += " ";
+            appendTerm(o);
+            buf_ += ")\n";
+        } else if (p.value == vocab::RDFS_SUBCLASS_OF && s.kind == TermKind::Iri && o.kind == TermKind::Iri) {
+            buf_ += "SubClassOf(";
+            appendTerm(s);
+            buf_ += " ";
+            appendTerm(o);
+            buf_ += ")\n";
+        } else {
+            buf_ += TRIPLE_COMMENT;
+            appendNTriplesTerm(buf_, s);
+            buf_ += " ";
+            appendNTriplesTerm(buf_, p);
+            buf_ += " ";
+            appendNTriplesTerm(buf_, o);
+            buf_ += " .\n";
+        }
+        out_.write(buf_);
+    }
+
+    void close() override
+    {
+        if (!header_written_)
+            writeHeader({});
+        if (!closed_)
+            out_ << ")\n";
+        closed_ = true;
+        out_.close();
+    }
+
+private:
+    void writeHeader(const std::string& ontology_iri)
+    {
+        out_ << "Prefix(owl:=<" << vocab::OWL << ">)\n"
+             << "Prefix(rdf:=<" << vocab::RDF << ">)\n"
+             << "Prefix(rdfs:=<" << vocab::RDFS << ">)\n"
+             << "Prefix(xsd:=<" << vocab::XSD << ">)\n\n"
+             << "Ontology(";
+        if (!ontology_iri.empty())
+            out_ << "<" << ontology_iri << ">";
+        out_ << "\n";
+        header_written_ = true;
+    }
+
+    static std::string_view declarationKeyword(std::string_view type)
+    {
+        if (type == vocab::OWL_CLASS) return "Class";
+        if (type == vocab::OWL_OBJECT_PROPERTY) return "ObjectProperty";
+        if (type == vocab::OWL_DATATYPE_PROPERTY) return "DataProperty";
+        if (type == vocab::OWL_ANNOTATION_PROPERTY) return "AnnotationProperty";
+        if (type == vocab::OWL_NAMED_INDIVIDUAL) return "NamedIndividual";
+        return "Datatype";
+    }
+
+    void appendIri(std::string_view iri)
+    {
+        if (iri.starts_with(vocab::XSD) && iri.find_first_of("()<>\" ", vocab::XSD.size()) == std::string_view::npos) {
+            buf_ += "xsd:";
+            buf_ += iri.substr(vocab::XSD.size());
+            return;
+        }
+        buf_ += "<";
+        buf_ += iri;
+        buf_ += ">";
+    }
+
+    void appendTerm(const Term& term)
+    {
+        switch (term.kind) {
+        case TermKind::Iri:
+            appendIri(term.value);
+            break;
+        case TermKind::Blank:
+            buf_ += "_:";
+            buf_ += term.value;
+            break;
+        case TermKind::Literal:
+            buf_ += "\"";
+            for (char c : term.value) {
+                if (c == '"' || c == '\\')
+                    buf_ += '\\';
+                buf_ += c;
+            }
+            buf_ += "\"";
+            if (!term.language.empty()) {
+                buf_ += "@";
+                buf_ += term.language;
+            } else if (!term.datatype.empty()) {
+                buf_ += "^^";
+                appendIri(term.datatype);
+            }
+            break;
+        }
+    }
+
+    OutputFile out_;
+    std::string buf_;
+    bool header_written_ = false;
+    bool closed_ = false;
+};
+
+
+std::unique_ptr<TripleReader> makeFunctionalReader(const std::string& path)
+{
+    return std::make_unique<FunctionalReader>(path);
+}
+
+std::unique_ptr<TripleWriter> makeFunctionalWriter(const std::string& path)
+{
+    return std::make_unique<FunctionalWriter>(path);
+}
+
+
+}
+
+}
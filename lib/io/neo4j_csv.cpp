@@ -0,0 +1,149 @@
+#include <filesystem>
+
+#include "file_io.hpp"
+#include "formats.hpp"
+#include "owl2/ontology.hpp"
+#include "owl2/vocabulary.hpp"
+
+namespace ista
+{
+
+namespace io
+{
+
+namespace vocab = owl2::vocab;
+
+
+// Writes the ABox of a KB as CSV files for Neo4j:
+//
+//   nodes.csv          uri:ID,:LABEL          (neo4j-admin import --nodes)
+//   relationships.csv  :START_ID,:END_ID,:TYPE (neo4j-admin import --relationships)
+//   properties.csv     uri,key,value           (LOAD CSV, then SET n[row.key] = row.value)
+//
+// Node properties go to a long-format file because the set of property
+// columns is not known until the whole input has been read, and we do not
+// buffer it. Labels of consecutive triples about the same subject are merged
+// into one node row; a subject whose triples are scattered through the input
+// may appear more than once (use --skip-duplicate-nodes). Schema triples are
+// dropped, as in load_kb's post-import cleanup.
+class Neo4jCsvWriter : public TripleWriter
+{
+public:
+    explicit Neo4jCsvWriter(const std::string& dir)
+        : dir_(createDirectory(dir)),
+          nodes_(dir_ + "/nodes.csv"),
+          relationships_(dir_ + "/relationships.csv"),
+          properties_(dir_ + "/properties.csv")
+    {
+        nodes_ << "uri:ID,:LABEL\n";
+        relationships_ << ":START_ID,:END_ID,:TYPE\n";
+        properties_ << "uri,key,value\n";
+    }
+
+    void write(const Triple& triple) override
+    {
+        const Term& s = triple.subject;
+        const Term& p = triple.predicate;
+        const Term& o = triple.object;
+        if (s.value != subject_ || !has_subject_) {
+            flushNode();
+            subject_ = s.value;
+            has_subject_ = true;
+        }
+
+        owl2::AxiomKind kind = owl2::classifyTriple(p.value, o.value, o.kind == TermKind::Literal);
+        switch (kind) {
+        case owl2::AxiomKind::ClassAssertion:
+            if (!labels_.empty())
+                labels_.push_back(';');
+            labels_ += vocab::localName(o.value);
+            break;
+        case owl2::AxiomKind::ObjectPropertyAssertion:
+            buf_.clear();
+            appendField(buf_, s.value);
+            buf_.push_back(',');
+            appendField(buf_, o.value);
+            buf_.push_back(',');
+            appendField(buf_, vocab::localName(p.value));
+            buf_.push_back('\n');
+            relationships_.write(buf_);
+            break;
+        case owl2::AxiomKind::DataPropertyAssertion:
+        case owl2::AxiomKind::AnnotationAssertion:
+            buf_.clear();
+            appendField(buf_, s.value);
+            buf_.push_back(',');
+            appendField(buf_, vocab::localName(p.value));
+            buf_.push_back(',');
+            appendField(buf_, o.value);
+            buf_.push_back('\n');
+            properties_.write(buf_);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void close() override
+    {
+        flushNode();
+        has_subject_ = false;
+        nodes_.close();
+        relationships_.close();
+        properties_.close();
+    }
+
+private:
+    static std::string createDirectory(const std::string& dir)
+    {
+        std::filesystem::create_directories(dir);
+        std::string d = dir;
+        while (d.size() > 1 && d.back() == '/')
+            d.pop_back();
+        return d;
+    }
+
+    static void appendField(std::string& out, std::string_view value)
+    {
+        out.push_back('"');
+        for (char c : value) {
+            if (c == '"')
+                out.push_back('"');
+            out.push_back(c);
+        }
+        out.push_back('"');
+    }
+
+    void flushNode()
+    {
+        if (!has_subject_ || labels_.empty())
+            return;
+        buf_.clear();
+        appendField(buf_, subject_);
+        buf_.push_back(',');
+        appendField(buf_, labels_);
+        buf_.push_back('\n');
+        nodes_.write(buf_);
+        labels_.clear();
+    }
+
+    std::string dir_;
+    OutputFile nodes_;
+    OutputFile relationships_;
+    OutputFile properties_;
+    std::string buf_;
+    std::string subject_;
+    std::string labels_;
+    bool has_subject_ = false;
+};
+
+
+std::unique_ptr<TripleWriter> makeNeo4jCsvWriter(const std::string& path)
+{
+    return std::make_unique<Neo4jCsvWriter>(path);
+}
+
+
+}
+
+}
@@ -0,0 +1,80 @@
+#include <stdexcept>
+
+#include "file_io.hpp"
+#include "formats.hpp"
+#include "rdf_syntax.hpp"
+
+namespace ista
+{
+
+namespace io
+{
+
+
+class NTriplesReader : public TripleReader
+{
+public:
+    explicit NTriplesReader(const std::string& path) : in_(path) {}
+
+    bool next(Triple& triple) override
+    {
+        while (in_.readLine(line_)) {
+            ++line_number_;
+            try {
+                if (parseNTriplesLine(line_, triple))
+                    return true;
+            } catch (const std::invalid_argument& e) {
+                throw ParseError(in_.path(), line_number_, e.what());
+            }
+        }
+        return false;
+    }
+
+    std::uint64_t bytesRead() const override { return in_.bytesRead(); }
+
+private:
+    InputFile in_;
+    std::string line_;
+    std::uint64_t line_number_ = 0;
+};
+
+
+class NTriplesWriter : public TripleWriter
+{
+public:
+    explicit NTriplesWriter(const std::string& path) : out_(path) {}
+
+    void write(const Triple& triple) override
+    {
+        line_.clear();
+        appendNTriplesTerm(line_, triple.subject);
+        line_.push_back(' ');
+        appendNTriplesTerm(line_, triple.predicate);
+        line_.push_back(' ');
+        appendNTriplesTerm(line_, triple.object);
+        line_ += " .\n";
+        out_.write(line_);
+    }
+
+    void close() override { out_.close(); }
+
+private:
+    OutputFile out_;
+    std::string line_;
+};
+
+
+std::unique_ptr<TripleReader> makeNTriplesReader(const std::string& path)
+{
+    return std::make_unique<NTriplesReader>(path);
+}
+
+std::unique_ptr<TripleWriter> makeNTriplesWriter(const std::string& path)
+{
+    return std::make_unique<NTriplesWriter>(path);
+}
+
+
+}
+
+}
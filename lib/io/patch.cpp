@@ -0,0 +1,124 @@
+#include "patch.hpp"
+
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "rdf_syntax.hpp"
+
+namespace ista
+{
+
+namespace io
+{
+
+
+PatchWriter::PatchWriter(const std::string& path) : out_(path)
+{
+    out_.write("TX .\n");
+}
+
+void PatchWriter::writeRow(char op, const Triple& triple)
+{
+    line_.clear();
+    line_.push_back(op);
+    line_.push_back(' ');
+    appendNTriplesTerm(line_, triple.subject);
+    line_.push_back(' ');
+    appendNTriplesTerm(line_, triple.predicate);
+    line_.push_back(' ');
+    appendNTriplesTerm(line_, triple.object);
+    line_ += " .\n";
+    out_.write(line_);
+}
+
+void PatchWriter::close()
+{
+    if (closed_)
+        return;
+    closed_ = true;
+    out_.write("TC .\n");
+    out_.close();
+}
+
+
+PatchReader::PatchReader(const std::string& path) : in_(path)
+{
+}
+
+bool PatchReader::next(PatchOp& op, Triple& triple)
+{
+    while (in_.readLine(line_)) {
+        ++line_number_;
+        std::string_view line = line_;
+        std::size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string_view::npos || line[start] == '#')
+            continue;
+        line.remove_prefix(start);
+        std::size_t end = line.find_first_of(" \t");
+        std::string_view code = line.substr(0, end);
+        if (code == "A")
+            op = PatchOp::Add;
+        else if (code == "D")
+            op = PatchOp::Delete;
+        else if (code == "TX" || code == "TC" || code == "TA" || code == "H" || code == "PA" || code == "PD")
+            continue;
+        else
+            throw ParseError(in_.path(), line_number_, "unknown patch row '" + std::string(code) + "'");
+        try {
+            if (!parseNTriplesLine(line.substr(end), triple))
+                throw std::invalid_argument("missing triple");
+        } catch (const std::invalid_argument& e) {
+            throw ParseError(in_.path(), line_number_, e.what());
+        }
+        return true;
+    }
+    return false;
+}
+
+
+PatchResult applyPatch(owl2::Ontology& onto, const std::string& path)
+{
+    // Last row wins per triple; true means present after the patch.
+    std::unordered_map<owl2::TripleRow, bool, owl2::TripleRowHash> final_state;
+    std::vector<owl2::TripleRow> order;
+    PatchReader reader(path);
+    PatchOp op;
+    Triple triple;
+    while (reader.next(op, triple)) {
+        owl2::TripleRow row{internTerm(onto, triple.subject), internTerm(onto, triple.predicate),
+                            internTerm(onto, triple.object)};
+        auto [it, inserted] = final_state.try_emplace(row, false);
+        it->second = op == PatchOp::Add;
+        if (inserted)
+            order.push_back(row);
+    }
+
+    // One pass over the tables drops deleted rows and marks additions that
+    // are already present.
+    PatchResult result;
+    std::unordered_set<owl2::TripleRow, owl2::TripleRowHash> present;
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k) {
+        auto& rows = onto.axioms(static_cast<owl2::AxiomKind>(k));
+        result.removed += std::erase_if(rows, [&](const owl2::TripleRow& row) {
+            auto it = final_state.find(row);
+            if (it == final_state.end())
+                return false;
+            if (it->second)
+                present.insert(row);
+            return !it->second;
+        });
+    }
+    for (const owl2::TripleRow& row : order) {
+        if (final_state[row] && !present.contains(row)) {
+            onto.addAxiom(row.subject, row.predicate, row.object);
+            ++result.added;
+        }
+    }
+    return result;
+}
+
+
+}
+
+}
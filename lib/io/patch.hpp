@@ -0,0 +1,79 @@
+#ifndef PATCH_HPP
+#define PATCH_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "io/file_io.hpp"
+#include "io/triple.hpp"
+#include "owl2/ontology.hpp"
+
+
+namespace ista
+{
+
+namespace io
+{
+
+
+// Writes a change set in the RDF Patch format: one transaction ("TX ." ...
+// "TC .") holding a "D" line per removed triple and an "A" line per added
+// triple, with terms written as in N-Triples.
+class PatchWriter
+{
+public:
+    explicit PatchWriter(const std::string& path);
+
+    void add(const Triple& triple) { writeRow('A', triple); }
+    void remove(const Triple& triple) { writeRow('D', triple); }
+    // Ends the transaction and flushes. Must be called to observe errors.
+    void close();
+
+private:
+    void writeRow(char op, const Triple& triple);
+
+    OutputFile out_;
+    std::string line_;
+    bool closed_ = false;
+};
+
+
+enum class PatchOp
+{
+    Add,
+    Delete,
+};
+
+// Reads the A and D rows of an RDF Patch. Transaction markers, headers and
+// prefix rows carry nothing a triple store needs and are skipped.
+class PatchReader
+{
+public:
+    explicit PatchReader(const std::string& path);
+
+    bool next(PatchOp& op, Triple& triple);
+
+private:
+    InputFile in_;
+    std::string line_;
+    std::uint64_t line_number_ = 0;
+};
+
+struct PatchResult
+{
+    std::uint64_t added = 0;
+    std::uint64_t removed = 0;
+};
+
+// Applies a patch to an Ontology with set semantics: the last row for a
+// triple decides whether it is present, adding a present triple or deleting
+// an absent one does nothing. Terms that no longer occur in any axiom stay
+// in the dictionaries.
+PatchResult applyPatch(owl2::Ontology& onto, const std::string& path);
+
+
+}
+
+}
+
+#endif
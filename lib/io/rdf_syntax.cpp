@@ -0,0 +1,398 @@
+#include "rdf_syntax.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <utility>
+
+namespace ista
+{
+
+namespace io
+{
+
+
+void appendUtf8(std::string& out, std::uint32_t cp)
+{
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+void appendEscaped(std::string& out, std::string_view s)
+{
+    for (char c : s) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default: out.push_back(c);
+        }
+    }
+}
+
+void appendIriRef(std::string& out, std::string_view iri)
+{
+    out.push_back('<');
+    for (char c : iri) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (u <= 0x20 || c == '<' || c == '>' || c == '"' || c == '{' || c == '}' || c == '|'
+            || c == '^' || c == '`' || c == '\\') {
+            static const char hex[] = "0123456789ABCDEF";
+            out += "\\u00";
+            out.push_back(hex[u >> 4]);
+            out.push_back(hex[u & 0xF]);
+        } else {
+            out.push_back(c);
+        }
+    }
+    out.push_back('>');
+}
+
+void appendNTriplesTerm(std::string& out, const Term& term)
+{
+    switch (term.kind) {
+    case TermKind::Iri:
+        appendIriRef(out, term.value);
+        break;
+    case TermKind::Blank:
+        out += "_:";
+        out += term.value;
+        break;
+    case TermKind::Literal:
+        out.push_back('"');
+        appendEscaped(out, term.value);
+        out.push_back('"');
+        if (!term.language.empty()) {
+            out.push_back('@');
+            out += term.language;
+        } else if (!term.datatype.empty()) {
+            out += "^^";
+            appendIriRef(out, term.datatype);
+        }
+        break;
+    }
+}
+
+void appendXmlEscaped(std::string& out, std::string_view s)
+{
+    for (char c : s) {
+        switch (c) {
+        case '&': out += "&amp;"; break;
+        case '<': out += "&lt;"; break;
+        case '>': out += "&gt;"; break;
+        case '"': out += "&quot;"; break;
+        case '\r': out += "&#13;"; break;
+        default: out.push_back(c);
+        }
+    }
+}
+
+namespace
+{
+
+struct LineCursor
+{
+    std::string_view s;
+    std::size_t i = 0;
+
+    void skipSpace()
+    {
+        while (i < s.size() && (s[i] == ' ' || s[i] == '\t' || s[i] == '\r'))
+            ++i;
+    }
+    bool atEnd() const { return i >= s.size(); }
+    char peek() const { return i < s.size() ? s[i] : '\0'; }
+    [[noreturn]] void fail(const char* what) const
+    {
+        throw std::invalid_argument(std::string(what) + " at column " + std::to_string(i + 1));
+    }
+    void expect(char c)
+    {
+        if (peek() != c)
+            fail((std::string("expected '") + c + "'").c_str());
+        ++i;
+    }
+
+    std::uint32_t hexDigits(int count)
+    {
+        std::uint32_t cp = 0;
+        for (int k = 0; k < count; ++k, ++i) {
+            char c = peek();
+            cp <<= 4;
+            if (c >= '0' && c <= '9') cp |= c - '0';
+            else if (c >= 'a' && c <= 'f') cp |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') cp |= c - 'A' + 10;
+            else fail("bad hex escape");
+        }
+        return cp;
+    }
+
+    void escape(std::string& out)
+    {
+        ++i;  // backslash
+        char c = peek();
+        ++i;
+        switch (c) {
+        case 't': out.push_back('\t'); break;
+        case 'b': out.push_back('\b'); break;
+        case 'n': out.push_back('\n'); break;
+        case 'r': out.push_back('\r'); break;
+        case 'f': out.push_back('\f'); break;
+        case '"': out.push_back('"'); break;
+        case '\'': out.push_back('\''); break;
+        case '\\': out.push_back('\\'); break;
+        case 'u': appendUtf8(out, hexDigits(4)); break;
+        case 'U': appendUtf8(out, hexDigits(8)); break;
+        default: fail("unknown escape");
+        }
+    }
+
+    void iri(std::string& out)
+    {
+        out.clear();
+        expect('<');
+        while (peek() != '>') {
+            if (atEnd())
+                fail("unterminated IRI");
+            if (peek() == '\\')
+                escape(out);
+            else
+                out.push_back(s[i++]);
+        }
+        ++i;
+    }
+
+    void blank(std::string& out)
+    {
+        i += 2;
+        std::size_t start = i;
+        while (i < s.size() && s[i] != ' ' && s[i] != '\t')
+            ++i;
+        // A label may contain '.', but not as its last character.
+        while (i > start && s[i - 1] == '.')
+            --i;
+        if (i == start)
+            fail("empty blank node label");
+        out.assign(s.substr(start, i - start));
+    }
+
+    void subjectOrObject(Term& term, bool allow_literal)
+    {
+        char c = peek();
+        if (c == '<') {
+            term.kind = TermKind::Iri;
+            iri(term.value);
+        } else if (c == '_' && i + 1 < s.size() && s[i + 1] == ':') {
+            term.kind = TermKind::Blank;
+            blank(term.value);
+        } else if (c == '"' && allow_literal) {
+            term.kind = TermKind::Literal;
+            term.value.clear();
+            term.datatype.clear();
+            term.language.clear();
+            ++i;
+            while (peek() != '"') {
+                if (atEnd())
+                    fail("unterminated literal");
+                if (peek() == '\\')
+                    escape(term.value);
+                else
+                    term.value.push_back(s[i++]);
+            }
+            ++i;
+            if (peek() == '@') {
+                std::size_t start = ++i;
+                while (i < s.size() && (std::isalnum(static_cast<unsigned char>(s[i])) || s[i] == '-'))
+                    ++i;
+                term.language.assign(s.substr(start, i - start));
+            } else if (peek() == '^' && i + 1 < s.size() && s[i + 1] == '^') {
+                i += 2;
+                iri(term.datatype);
+                if (term.datatype == "http://www.w3.org/2001/XMLSchema#string")
+                    term.datatype.clear();
+            }
+        } else {
+            fail("expected a term");
+        }
+    }
+};
+
+}
+
+bool parseNTriplesLine(std::string_view line, Triple& triple)
+{
+    LineCursor cur{line};
+    cur.skipSpace();
+    if (cur.atEnd() || cur.peek() == '#')
+        return false;
+    cur.subjectOrObject(triple.subject, false);
+    cur.skipSpace();
+    triple.predicate.kind = TermKind::Iri;
+    cur.iri(triple.predicate.value);
+    cur.skipSpace();
+    cur.subjectOrObject(triple.object, true);
+    cur.skipSpace();
+    cur.expect('.');
+    cur.skipSpace();
+    if (!cur.atEnd() && cur.peek() != '#')
+        cur.fail("trailing characters");
+    return true;
+}
+
+static bool isNameStart(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_' || c >= 0x80;
+}
+
+static bool isNameChar(unsigned char c)
+{
+    return isNameStart(c) || (c >= '0' && c <= '9') || c == '-' || c == '.';
+}
+
+bool splitQName(std::string_view iri, std::string_view& ns, std::string_view& local)
+{
+    std::size_t start = iri.size();
+    while (start > 0 && isNameChar(static_cast<unsigned char>(iri[start - 1])))
+        --start;
+    while (start < iri.size() && !isNameStart(static_cast<unsigned char>(iri[start])))
+        ++start;
+    if (start == iri.size() || start == 0)
+        return false;
+    ns = iri.substr(0, start);
+    local = iri.substr(start);
+    return true;
+}
+
+static std::string_view stripFragment(std::string_view iri)
+{
+    std::size_t hash = iri.find('#');
+    return hash == std::string_view::npos ? iri : iri.substr(0, hash);
+}
+
+static void removeDotSegments(std::string& path)
+{
+    std::string out;
+    std::size_t i = 0;
+    while (i < path.size()) {
+        std::size_t next = path.find('/', i + 1);
+        if (next == std::string::npos)
+            next = path.size();
+        std::string_view seg(path.data() + i, next - i);
+        if (seg == "/." || seg == ".") {
+            if (next == path.size())
+                out.push_back('/');
+        } else if (seg == "/.." || seg == "..") {
+            std::size_t cut = out.rfind('/');
+            out.resize(cut == std::string::npos ? 0 : cut);
+            if (next == path.size())
+                out.push_back('/');
+        } else {
+            out.append(seg);
+        }
+        i = next;
+    }
+    path = out;
+}
+
+std::string resolveIri(std::string_view base, std::string_view ref)
+{
+    std::size_t colon = ref.find(':');
+    std::size_t delim = ref.find_first_of("/?#");
+    if (colon != std::string_view::npos && (delim == std::string_view::npos || colon < delim) && colon > 0)
+        return std::string(ref);
+    if (base.empty())
+        return std::string(ref);
+    if (ref.empty())
+        return std::string(stripFragment(base));
+    if (ref[0] == '#')
+        return std::string(stripFragment(base)) + std::string(ref);
+
+    std::size_t scheme_end = base.find(':');
+    std::string_view scheme = base.substr(0, scheme_end + 1);
+    if (ref.starts_with("//"))
+        return std::string(scheme) + std::string(ref);
+
+    std::size_t authority_end = scheme_end + 1;
+    if (base.substr(scheme_end + 1).starts_with("//")) {
+        authority_end = base.find_first_of("/?#", scheme_end + 3);
+        if (authority_end == std::string_view::npos)
+            authority_end = base.size();
+    }
+    std::string_view authority = base.substr(0, authority_end);
+    std::string_view base_path = stripFragment(base.substr(authority_end));
+    base_path = base_path.substr(0, base_path.find('?'));
+
+    std::string path;
+    if (ref[0] == '?') {
+        path = std::string(base_path) + std::string(ref);
+        return std::string(authority) + path;
+    }
+    if (ref[0] == '/') {
+        path = std::string(ref);
+    } else {
+        std::size_t slash = base_path.rfind('/');
+        path = slash == std::string_view::npos ? "/" : std::string(base_path.substr(0, slash + 1));
+        path += ref;
+    }
+    std::size_t tail = path.find_first_of("?#");
+    std::string suffix = tail == std::string::npos ? "" : path.substr(tail);
+    path.resize(tail == std::string::npos ? path.size() : tail);
+    removeDotSegments(path);
+    return std::string(authority) + path + suffix;
+}
+
+
+TripleQueue::TripleQueue(std::pmr::memory_resource* resource) : slots_(resource) {}
+
+Triple& TripleQueue::claim()
+{
+    if (count_ == slots_.size()) {
+        // Full: unwrap the ring so the new slot lands after the tail.
+        std::rotate(slots_.begin(), slots_.begin() + head_, slots_.end());
+        head_ = 0;
+        slots_.emplace_back();
+    }
+    return slots_[(head_ + count_++) % slots_.size()];
+}
+
+void TripleQueue::push(const Term& s, const Term& p, const Term& o)
+{
+    Triple& t = claim();
+    t.subject = s;
+    t.predicate = p;
+    t.object = o;
+}
+
+void TripleQueue::push(const Term& s, std::string_view p, const Term& o)
+{
+    Triple& t = claim();
+    t.subject = s;
+    t.predicate.setIri(p);
+    t.object = o;
+}
+
+void TripleQueue::pop(Triple& out)
+{
+    std::swap(out, slots_[head_]);
+    head_ = (head_ + 1) % slots_.size();
+    --count_;
+}
+
+}
+
+}
@@ -0,0 +1,90 @@
+#ifndef RDF_SYNTAX_HPP
+#define RDF_SYNTAX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "triple.hpp"
+
+
+namespace ista
+{
+
+namespace io
+{
+
+
+void appendUtf8(std::string& out, std::uint32_t codepoint);
+
+// N-Triples / Turtle string escaping (without the surrounding quotes).
+void appendEscaped(std::string& out, std::string_view s);
+void appendIriRef(std::string& out, std::string_view iri);
+// Appends a term in N-Triples syntax.
+void appendNTriplesTerm(std::string& out, const Term& term);
+
+// Parses one N-Triples line. Returns false for blank and comment lines and
+// throws std::invalid_argument on malformed input.
+bool parseNTriplesLine(std::string_view line, Triple& triple);
+
+void appendXmlEscaped(std::string& out, std::string_view s);
+
+// Splits an IRI into a namespace and an XML NCName local part. Returns false
+// when the IRI does not end in a valid local name.
+bool splitQName(std::string_view iri, std::string_view& ns, std::string_view& local);
+
+// RFC 3986 reference resolution (enough of it for xml:base and @base).
+std::string resolveIri(std::string_view base, std::string_view ref);
+
+// Blank node labels for parsers that create anonymous nodes ("[ ]" in
+// Turtle, nested descriptions in RDF/XML). Minted labels are "genid" and a
+// number. Any valid label can also be written in a document, so the labels a
+// document names itself go through fromDocument(), which moves those starting
+// with "genid" to "genidx..."; the two spaces never meet.
+class BlankNodeLabels
+{
+public:
+    std::string fresh() { return "genid" + std::to_string(++counter_); }
+
+    static void fromDocument(std::string& label)
+    {
+        if (label.starts_with("genid"))
+            label.insert(0, "genidx");
+    }
+
+private:
+    std::uint64_t counter_ = 0;
+};
+
+// FIFO of parsed triples for readers that produce several per statement.
+// Slots are recycled: push() copy-assigns into a slot whose strings keep
+// their capacity, and pop() swaps the slot with the caller's triple, so a
+// steady-state parse does no per-triple allocation.
+class TripleQueue
+{
+public:
+    explicit TripleQueue(std::pmr::memory_resource* resource);
+
+    bool empty() const { return count_ == 0; }
+
+    void push(const Term& s, const Term& p, const Term& o);
+    void push(const Term& s, std::string_view p, const Term& o);
+    void pop(Triple& out);
+
+private:
+    Triple& claim();
+
+    std::pmr::vector<Triple> slots_;
+    std::size_t head_ = 0;
+    std::size_t count_ = 0;
+};
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,479 @@
+
+#include "file_io.hpp"
+#include "formats.hpp"
+#include "owl2/vocabulary.hpp"
+#include "rdf_syntax.hpp"
+#include "util/memory.hpp"
+#include "xml_scanner.hpp"
+
+namespace ista
+{
+
+namespace io
+{
+
+namespace vocab = owl2::vocab;
+
+
+// Streaming RDF/XML parser (the subset of the W3C grammar produced by
+// Protege, owlready2 and friends: node and property elements, property
+// attributes, rdf:parseType Resource/Literal/Collection, xml:base, xml:lang
+// and rdf:li). Triples are emitted as soon as the element that completes
+// them is seen, so only the current element path is kept in memory.
+class RdfXmlReader : public TripleReader
+{
+public:
+    explicit RdfXmlReader(const std::string& path) : in_(path), xml_(in_) {}
+
+    bool next(Triple& triple) override
+    {
+        while (pending_.empty()) {
+            if (!step())
+                return false;
+        }
+        pending_.pop(triple);
+        return true;
+    }
+
+    std::uint64_t bytesRead() const override { return in_.bytesRead(); }
+
+private:
+    enum class FrameKind
+    {
+        Root,
+        Node,
+        Property,
+    };
+
+    enum class PropertyMode
+    {
+        Value,       // literal text or a single nested node element
+        Done,        // the object was given by attributes
+        Resource,    // rdf:parseType="Resource"
+        Collection,  // rdf:parseType="Collection"
+        Literal,     // rdf:parseType="Literal"
+    };
+
+    struct Frame
+    {
+        FrameKind kind;
+        std::string base;
+        std::string lang;
+        Term subject;               // Node: the node; Property: the owning node
+        Term predicate;             // Property only
+        PropertyMode mode = PropertyMode::Value;
+        std::string datatype;
+        std::string text;
+        bool has_object = false;
+        bool synthetic = false;     // Node frame opened by parseType="Resource"
+        int literal_depth = 0;
+        std::uint64_t li_counter = 0;
+        std::vector<Term> items;
+    };
+
+    static Frame makeFrame(FrameKind kind, const std::string& base, const std::string& lang)
+    {
+        Frame f;
+        f.kind = kind;
+        f.base = base;
+        f.lang = lang;
+        return f;
+    }
+
+    [[noreturn]] void fail(const std::string& message) { throw ParseError(in_.path(), xml_.line(), message); }
+
+    void emit(const Term& s, const Term& p, const Term& o) { pending_.push(s, p, o); }
+
+    static Term iriTerm(std::string_view iri)
+    {
+        Term t;
+        t.setIri(iri);
+        return t;
+    }
+
+    Term freshBlank()
+    {
+        Term t;
+        t.setBlank(labels_.fresh());
+        return t;
+    }
+
+    static bool isRdf(const XmlAttribute& attr, const char* local)
+    {
+        return attr.ns == vocab::RDF && attr.local == local;
+    }
+
+    bool step()
+    {
+        switch (xml_.next()) {
+        case XmlScanner::Event::End:
+            return false;
+        case XmlScanner::Event::StartElement:
+            startElement();
+            break;
+        case XmlScanner::Event::EndElement:
+            endElement();
+            break;
+        case XmlScanner::Event::Text:
+            if (!stack_.empty() && stack_.back().kind == FrameKind::Property)
+                stack_.back().text += xml_.text();
+            break;
+        }
+        return true;
+    }
+
+    void startElement()
+    {
+        if (!stack_.empty() && stack_.back().kind == FrameKind::Property && stack_.back().mode == PropertyMode::Literal) {
+            Frame& f = stack_.back();
+            f.text += "<" + xml_.qname();
+            for (const auto& attr : xml_.attributes()) {
+                f.text += " " + attr.qname + "=\"";
+                appendXmlEscaped(f.text, attr.value);
+                f.text += "\"";
+            }
+            f.text += ">";
+            ++f.literal_depth;
+            return;
+        }
+
+        std::string base = stack_.empty() ? "" : stack_.back().base;
+        std::string lang = stack_.empty() ? "" : stack_.back().lang;
+        for (const auto& attr : xml_.attributes()) {
+            if (attr.ns == vocab::XML && attr.local == "base")
+                base = resolveIri(base, attr.value);
+            else if (attr.ns == vocab::XML && attr.local == "lang")
+                lang = attr.value;
+        }
+
+        std::string element_iri = xml_.ns() + xml_.local();
+        if (stack_.empty()) {
+            Frame root = makeFrame(FrameKind::Root, base, lang);
+            stack_.push_back(std::move(root));
+            if (element_iri == std::string(vocab::RDF) + "RDF")
+                return;
+        }
+
+        FrameKind parent = stack_.back().kind;
+        if (parent == FrameKind::Node)
+            propertyElement(element_iri, base, lang);
+        else
+            nodeElement(element_iri, base, lang);
+    }
+
+    void nodeElement(const std::string& element_iri, const std::string& base, const std::string& lang)
+    {
+        Term subject;
+        bool named = false;
+        for (const auto& attr : xml_.attributes()) {
+            if (isRdf(attr, "about")) {
+                subject.setIri(resolveIri(base, attr.value));
+                named = true;
+            } else if (isRdf(attr, "ID")) {
+                subject.setIri(resolveIri(base, "#" + attr.value));
+                named = true;
+            } else if (isRdf(attr, "nodeID")) {
+                subject.setBlank(attr.value);
+                BlankNodeLabels::fromDocument(subject.value);
+                named = true;
+            }
+        }
+        if (!named)
+            subject = freshBlank();
+
+        Frame& parent = stack_.back();
+        if (parent.kind == FrameKind::Property) {
+            if (parent.mode == PropertyMode::Collection) {
+                parent.items.push_back(subject);
+            } else {
+                if (parent.has_object)
+                    fail("property element has more than one object");
+                emit(parent.subject, parent.predicate, subject);
+                parent.has_object = true;
+            }
+        }
+
+        if (element_iri != std::string(vocab::RDF) + "Description")
+            emit(subject, iriTerm(vocab::RDF_TYPE), iriTerm(element_iri));
+
+        for (const auto& attr : xml_.attributes()) {
+            if (attr.ns.empty() || attr.ns == vocab::XML)
+                continue;
+            if (attr.ns == vocab::RDF) {
+                if (attr.local == "type") {
+                    emit(subject, iriTerm(vocab::RDF_TYPE), iriTerm(resolveIri(base, attr.value)));
+                    continue;
+                }
+                if (attr.local == "about" || attr.local == "ID" || attr.local == "nodeID")
+                    continue;
+            }
+            Term value;
+            value.setLiteral(attr.value, {}, lang);
+            emit(subject, iriTerm(attr.ns + attr.local), value);
+        }
+
+        Frame f = makeFrame(FrameKind::Node, base, lang);
+        f.subject = std::move(subject);
+        stack_.push_back(std::move(f));
+    }
+
+    void propertyElement(std::string element_iri, const std::string& base, const std::string& lang)
+    {
+        Frame& node = stack_.back();
+        if (element_iri == std::string(vocab::RDF) + "li")
+            element_iri = std::string(vocab::RDF) + "_" + std::to_string(++node.li_counter);
+
+        Frame f = makeFrame(FrameKind::Property, base, lang);
+        f.subject = node.subject;
+        f.predicate.setIri(element_iri);
+
+        std::string parse_type;
+        Term object;
+        bool has_resource = false;
+        bool has_property_attributes = false;
+        for (const auto& attr : xml_.attributes()) {
+            if (isRdf(attr, "parseType")) {
+                parse_type = attr.value;
+            } else if (isRdf(attr, "resource")) {
+                object.setIri(resolveIri(base, attr.value));
+                has_resource = true;
+            } else if (isRdf(attr, "nodeID")) {
+                object.setBlank(attr.value);
+                BlankNodeLabels::fromDocument(object.value);
+                has_resource = true;
+            } else if (isRdf(attr, "datatype")) {
+                f.datatype = resolveIri(base, attr.value);
+            } else if (!attr.ns.empty() && attr.ns != vocab::XML && !isRdf(attr, "ID")) {
+                has_property_attributes = true;
+            }
+        }
+
+        if (parse_type == "Resource") {
+            Term node_term = freshBlank();
+            emit(f.subject, f.predicate, node_term);
+            f.mode = PropertyMode::Resource;
+            f.has_object = true;
+            stack_.push_back(std::move(f));
+            Frame inner = makeFrame(FrameKind::Node, base, lang);
+            inner.subject = std::move(node_term);
+            inner.synthetic = true;
+            stack_.push_back(std::move(inner));
+            return;
+        }
+        if (parse_type == "Collection") {
+            f.mode = PropertyMode::Collection;
+        } else if (!parse_type.empty()) {
+            f.mode = PropertyMode::Literal;
+        } else if (has_resource || has_property_attributes) {
+            if (!has_resource)
+                object = freshBlank();
+            emit(f.subject, f.predicate, object);
+            for (const auto& attr : xml_.attributes()) {
+                if (attr.ns.empty() || attr.ns == vocab::XML || attr.ns == vocab::RDF)
+                    continue;
+                Term value;
+                value.setLiteral(attr.value, {}, lang);
+                emit(object, iriTerm(attr.ns + attr.local), value);
+            }
+            f.mode = PropertyMode::Done;
+            f.has_object = true;
+        }
+        stack_.push_back(std::move(f));
+    }
+
+    void endElement()
+    {
+        if (stack_.empty())
+            fail("unbalanced end element");
+        Frame& top = stack_.back();
+        if (top.kind == FrameKind::Property && top.mode == PropertyMode::Literal && top.literal_depth > 0) {
+            top.text += "</" + xml_.qname() + ">";
+            --top.literal_depth;
+            return;
+        }
+
+        Frame f = std::move(stack_.back());
+        stack_.pop_back();
+        if (f.kind == FrameKind::Node && f.synthetic) {
+            // Closing a parseType="Resource" property closes both frames.
+            stack_.pop_back();
+            return;
+        }
+        if (f.kind != FrameKind::Property)
+            return;
+
+        switch (f.mode) {
+        case PropertyMode::Value:
+            if (!f.has_object) {
+                Term value;
+                value.setLiteral(f.text, f.datatype == vocab::XSD_STRING ? std::string_view() : std::string_view(f.datatype),
+                                 f.datatype.empty() ? std::string_view(f.lang) : std::string_view());
+                emit(f.subject, f.predicate, value);
+            }
+            break;
+        case PropertyMode::Literal: {
+            Term value;
+            value.setLiteral(f.text, vocab::RDF_XML_LITERAL);
+            emit(f.subject, f.predicate, value);
+            break;
+        }
+        case PropertyMode::Collection: {
+            if (f.items.empty()) {
+                emit(f.subject, f.predicate, iriTerm(vocab::RDF_NIL));
+                break;
+            }
+            Term cell = freshBlank();
+            emit(f.subject, f.predicate, cell);
+            for (std::size_t i = 0; i < f.items.size(); ++i) {
+                emit(cell, iriTerm(vocab::RDF_FIRST), f.items[i]);
+                if (i + 1 == f.items.size()) {
+                    emit(cell, iriTerm(vocab::RDF_REST), iriTerm(vocab::RDF_NIL));
+                } else {
+                    Term next_cell = freshBlank();
+                    emit(cell, iriTerm(vocab::RDF_REST), next_cell);
+                    cell = std::move(next_cell);
+                }
+            }
+            break;
+        }
+        case PropertyMode::Done:
+        case PropertyMode::Resource:
+            break;
+        }
+    }
+
+    InputFile in_;
+    XmlScanner xml_;
+    std::vector<Frame> stack_;
+    TripleQueue pending_{&util::subsystemResource(util::Subsystem::Parser)};
+    BlankNodeLabels labels_;
+};
+
+
+// Streaming RDF/XML writer. Consecutive triples with the same subject share an
+// rdf:Description element. Predicates outside the well-known vocabularies get
+// a namespace declaration on the property element itself, so nothing needs to
+// be known about the data before the first triple is written.
+class RdfXmlWriter : public TripleWriter
+{
+public:
+    explicit RdfXmlWriter(const std::string& path) : out_(path)
+    {
+        out_ << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+             << "<rdf:RDF xmlns:rdf=\"" << vocab::RDF << "\"\n"
+             << "         xmlns:rdfs=\"" << vocab::RDFS << "\"\n"
+             << "         xmlns:owl=\"" << vocab::OWL << "\"\n"
+             << "         xmlns:xsd=\"" << vocab::XSD << "\">\n";
+    }
+
+    void write(const Triple& triple) override
+    {
+        buf_.clear();
+        if (!open_ || triple.subject.kind != subject_.kind || triple.subject.value != subject_.value) {
+            if (open_)
+                buf_ += "  </rdf:Description>\n";
+            buf_ += "  <rdf:Description ";
+            if (triple.subject.kind == TermKind::Blank) {
+                buf_ += "rdf:nodeID=\"";
+                appendXmlEscaped(buf_, triple.subject.value);
+            } else {
+                buf_ += "rdf:about=\"";
+                appendXmlEscaped(buf_, triple.subject.value);
+            }
+            buf_ += "\">\n";
+            subject_ = triple.subject;
+            open_ = true;
+        }
+
+        std::string_view ns, local;
+        if (!splitQName(triple.predicate.value, ns, local))
+            throw std::runtime_error("predicate <" + triple.predicate.value + "> cannot be written as RDF/XML");
+        std::string_view prefix = knownPrefix(ns);
+        buf_ += "    <";
+        if (prefix.empty()) {
+            buf_ += "ns:";
+            buf_ += local;
+            buf_ += " xmlns:ns=\"";
+            appendXmlEscaped(buf_, ns);
+            buf_ += "\"";
+        } else {
+            buf_ += prefix;
+            buf_ += local;
+        }
+
+        const Term& o = triple.object;
+        if (o.kind == TermKind::Iri) {
+            buf_ += " rdf:resource=\"";
+            appendXmlEscaped(buf_, o.value);
+            buf_ += "\"/>\n";
+        } else if (o.kind == TermKind::Blank) {
+            buf_ += " rdf:nodeID=\"";
+            appendXmlEscaped(buf_, o.value);
+            buf_ += "\"/>\n";
+        } else {
+            if (!o.language.empty()) {
+                buf_ += " xml:lang=\"";
+                appendXmlEscaped(buf_, o.language);
+                buf_ += "\"";
+            } else if (!o.datatype.empty()) {
+                buf_ += " rdf:datatype=\"";
+                appendXmlEscaped(buf_, o.datatype);
+                buf_ += "\"";
+            }
+            buf_ += ">";
+            appendXmlEscaped(buf_, o.value);
+            buf_ += "</";
+            if (prefix.empty())
+                buf_ += "ns:";
+            else
+                buf_ += prefix;
+            buf_ += local;
+            buf_ += ">\n";
+        }
+        out_.write(buf_);
+    }
+
+    void close() override
+    {
+        if (closed_)
+            return;
+        if (open_)
+            out_ << "  </rdf:Description>\n";
+        out_ << "</rdf:RDF>\n";
+        out_.close();
+        open_ = false;
+        closed_ = true;
+    }
+
+private:
+    static std::string_view knownPrefix(std::string_view ns)
+    {
+        if (ns == vocab::RDF) return "rdf:";
+        if (ns == vocab::RDFS) return "rdfs:";
+        if (ns == vocab::OWL) return "owl:";
+        if (ns == vocab::XSD) return "xsd:";
+        return {};
+    }
+
+    OutputFile out_;
+    std::string buf_;
+    Term subject_;
+    bool open_ = false;
+    bool closed_ = false;
+};
+
+
+std::unique_ptr<TripleReader> makeRdfXmlReader(const std::string& path)
+{
+    return std::make_unique<RdfXmlReader>(path);
+}
+
+std::unique_ptr<TripleWriter> makeRdfXmlWriter(const std::string& path)
+{
+    return std::make_unique<RdfXmlWriter>(path);
+}
+
+
+}
+
+}
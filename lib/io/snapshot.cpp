@@ -0,0 +1,427 @@
+#include "snapshot.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "file_io.hpp"
+#include "formats.hpp"
+#include "util/huge_pages.hpp"
+#include "util/numa.hpp"
+#include "util/trace.hpp"
+
+namespace ista
+{
+
+namespace io
+{
+
+
+namespace
+{
+
+struct PendingSection
+{
+    SectionId id;
+    std::string_view bytes;
+};
+
+template <typename T, typename Allocator>
+std::string_view asBytes(const std::vector<T, Allocator>& v)
+{
+    return std::string_view(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+}
+
+template <typename T>
+std::span<const T> asSpan(std::span<const char> bytes)
+{
+    return std::span<const T>(reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T));
+}
+
+std::uint64_t align8(std::uint64_t n)
+{
+    return (n + 7) & ~std::uint64_t(7);
+}
+
+// The IRI hash: every IRI and blank node label to its id.
+std::vector<char> buildIriHash(const owl2::IriPool& iris)
+{
+    std::vector<std::pair<std::string_view, std::uint32_t>> entries(iris.size());
+    for (owl2::TermId id = 0; id < iris.size(); ++id)
+        entries[id] = {iris.at(id), id};
+    return util::PerfectHashIndex::build(entries);
+}
+
+// A key index section: the property id, then the hash from each lexical value
+// of the property to its subjects, in row order.
+std::vector<char> buildKeyHash(const owl2::Ontology& onto, owl2::TermId property)
+{
+    std::vector<std::pair<std::string_view, std::uint32_t>> entries;
+    for (const owl2::TripleRow& row : onto.axioms(owl2::AxiomKind::DataPropertyAssertion))
+        if (row.predicate == property && owl2::isLiteral(row.object))
+            entries.emplace_back(onto.literal(row.object).lexical, row.subject);
+    std::vector<char> hash = util::PerfectHashIndex::build(entries);
+    std::vector<char> out(sizeof(std::uint64_t) + hash.size());
+    std::uint64_t id = property;
+    std::memcpy(out.data(), &id, sizeof(id));
+    std::memcpy(out.data() + sizeof(id), hash.data(), hash.size());
+    return out;
+}
+
+}
+
+
+void writeSnapshot(const owl2::Ontology& onto, const std::string& path, const SnapshotOptions& options)
+{
+    ISTA_TRACE_SCOPE("writeSnapshot");
+    std::string metadata = onto.ontology_iri.baseIRI;
+    metadata.push_back('\0');
+    metadata += onto.version_iri.baseIRI;
+    metadata.push_back('\0');
+
+    std::string language_tags;
+    for (const auto& tag : onto.literals().languageTags()) {
+        language_tags += tag;
+        language_tags.push_back('\0');
+    }
+
+    std::vector<PendingSection> sections = {
+        {SectionId::Metadata, metadata},
+        {SectionId::IriOffsets, asBytes(onto.iris().offsets())},
+        {SectionId::IriBytes, asBytes(onto.iris().bytes())},
+        {SectionId::LiteralOffsets, asBytes(onto.literals().offsets())},
+        {SectionId::LiteralBytes, asBytes(onto.literals().bytes())},
+        {SectionId::LiteralDatatypes, asBytes(onto.literals().datatypes())},
+        {SectionId::LiteralLanguages, asBytes(onto.literals().languages())},
+        {SectionId::LanguageTags, language_tags},
+    };
+    owl2::IriDictionary::Parts dictionary;
+    if (options.iri_dictionary) {
+        dictionary = owl2::IriDictionary::build(onto.iris());
+        sections.push_back({SectionId::IriDictionary, asBytes(dictionary.bytes)});
+        sections.push_back({SectionId::IriBuckets, asBytes(dictionary.buckets)});
+        sections.push_back({SectionId::IriRanks, asBytes(dictionary.ranks)});
+        sections.push_back({SectionId::IriSortedIds, asBytes(dictionary.ids)});
+    }
+    std::vector<char> iri_hash = buildIriHash(onto.iris());
+    sections.push_back({SectionId::IriHash, asBytes(iri_hash)});
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k) {
+        SectionId id = static_cast<SectionId>(static_cast<std::uint32_t>(SectionId::Axioms) + k);
+        sections.push_back({id, asBytes(onto.axioms(static_cast<owl2::AxiomKind>(k)))});
+    }
+    std::vector<std::vector<char>> key_hashes;
+    for (const std::string& iri : options.key_properties) {
+        owl2::TermId property = onto.findIri(iri);
+        if (property != owl2::NO_TERM)
+            key_hashes.push_back(buildKeyHash(onto, property));
+    }
+    for (std::size_t k = 0; k < key_hashes.size(); ++k) {
+        SectionId id = static_cast<SectionId>(static_cast<std::uint32_t>(SectionId::KeyHashes) + k);
+        sections.push_back({id, asBytes(key_hashes[k])});
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.section_count = static_cast<std::uint32_t>(sections.size());
+
+    std::vector<SectionEntry> directory;
+    std::uint64_t offset = align8(sizeof(SnapshotHeader) + sections.size() * sizeof(SectionEntry));
+    for (const auto& s : sections) {
+        directory.push_back(SectionEntry{static_cast<std::uint32_t>(s.id), 0, offset, s.bytes.size()});
+        offset = align8(offset + s.bytes.size());
+    }
+
+    OutputFile out(path);
+    out.write(std::string_view(reinterpret_cast<const char*>(&header), sizeof(header)));
+    out.write(asBytes(directory));
+    static const char padding[8] = {};
+    std::uint64_t written = sizeof(header) + directory.size() * sizeof(SectionEntry);
+    for (std::size_t i = 0; i < sections.size(); ++i) {
+        out.write(std::string_view(padding, directory[i].offset - written));
+        out.write(sections[i].bytes);
+        written = directory[i].offset + sections[i].bytes.size();
+    }
+    out.close();
+}
+
+
+Snapshot::Snapshot(const std::string& path)
+    : file_(path)
+{
+    if (file_.size() < sizeof(SnapshotHeader))
+        throw std::runtime_error("'" + path + "' is not an ista snapshot");
+    SnapshotHeader header;
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0)
+        throw std::runtime_error("'" + path + "' is not an ista snapshot");
+    if (header.version != SNAPSHOT_VERSION)
+        throw std::runtime_error("'" + path + "' has unsupported snapshot version " + std::to_string(header.version));
+    if (sizeof(SnapshotHeader) + header.section_count * sizeof(SectionEntry) > file_.size())
+        throw std::runtime_error("'" + path + "' has a truncated section directory");
+    sections_.resize(header.section_count);
+    std::memcpy(sections_.data(), file_.data() + sizeof(SnapshotHeader), header.section_count * sizeof(SectionEntry));
+    for (const auto& s : sections_)
+        if (s.offset + s.size > file_.size() || s.offset % 8 != 0)
+            throw std::runtime_error("'" + path + "' is truncated or corrupt");
+
+    auto iri_offsets = section(SectionId::IriOffsets);
+    auto literal_offsets = section(SectionId::LiteralOffsets);
+    if (iri_offsets.size() < 8 || literal_offsets.size() < 8)
+        throw std::runtime_error("'" + path + "' is missing its term dictionaries");
+    iri_count_ = iri_offsets.size() / 8 - 1;
+    literal_count_ = literal_offsets.size() / 8 - 1;
+    iri_offsets_ = reinterpret_cast<const std::uint64_t*>(iri_offsets.data());
+    iri_bytes_ = section(SectionId::IriBytes).data();
+    literal_offsets_ = reinterpret_cast<const std::uint64_t*>(literal_offsets.data());
+    literal_bytes_ = section(SectionId::LiteralBytes).data();
+    literal_datatypes_ = reinterpret_cast<const owl2::TermId*>(section(SectionId::LiteralDatatypes).data());
+    literal_languages_ = reinterpret_cast<const std::uint32_t*>(section(SectionId::LiteralLanguages).data());
+
+    auto tags = section(SectionId::LanguageTags);
+    for (const char* p = tags.data(); p < tags.data() + tags.size(); p += std::strlen(p) + 1)
+        language_tags_.emplace_back(p);
+    if (language_tags_.empty())
+        language_tags_.emplace_back();
+    auto buckets = section(SectionId::IriBuckets);
+    if (!buckets.empty()) {
+        try {
+            iri_dictionary_ = owl2::IriDictionary(section(SectionId::IriDictionary), asSpan<std::uint64_t>(buckets),
+                                                  asSpan<owl2::TermId>(section(SectionId::IriRanks)),
+                                                  asSpan<owl2::TermId>(section(SectionId::IriSortedIds)));
+        } catch (const std::runtime_error&) {
+            throw std::runtime_error("'" + path + "' is truncated or corrupt");
+        }
+        if (iri_dictionary_.size() != iri_count_)
+            throw std::runtime_error("'" + path + "' is truncated or corrupt");
+    }
+    try {
+        auto iri_hash = section(SectionId::IriHash);
+        if (!iri_hash.empty())
+            iri_hash_ = util::PerfectHashIndex(iri_hash);
+        for (const SectionEntry& s : sections_) {
+            if (s.id < static_cast<std::uint32_t>(SectionId::KeyHashes))
+                continue;
+            std::uint64_t property;
+            if (s.size < sizeof(property))
+                throw std::runtime_error("truncated key index");
+            std::memcpy(&property, file_.data() + s.offset, sizeof(property));
+            if (property >= iri_count_)
+                throw std::runtime_error("key index of an unknown property");
+            key_hashes_.emplace_back(static_cast<owl2::TermId>(property),
+                                     util::PerfectHashIndex(std::span<const char>(
+                                         file_.data() + s.offset + sizeof(property), s.size - sizeof(property))));
+        }
+    } catch (const std::runtime_error&) {
+        throw std::runtime_error("'" + path + "' is truncated or corrupt");
+    }
+    if (!iri_hash_.empty() && iri_hash_.keyCount() != iri_count_)
+        throw std::runtime_error("'" + path + "' is truncated or corrupt");
+    if (util::hugePageMode() != util::HugePages::Off)
+        file_.adviseHugePages();
+
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k) {
+        auto rows = section(static_cast<SectionId>(static_cast<std::uint32_t>(SectionId::Axioms) + k));
+        axioms_[k] = std::span<const owl2::TripleRow>(reinterpret_cast<const owl2::TripleRow*>(rows.data()),
+                                                      rows.size() / sizeof(owl2::TripleRow));
+    }
+
+    auto metadata = section(SectionId::Metadata);
+    if (!metadata.empty()) {
+        ontology_iri_ = std::string_view(metadata.data());
+        version_iri_ = std::string_view(metadata.data() + ontology_iri_.size() + 1);
+    }
+}
+
+util::MemoryUsage Snapshot::memoryUsage() const
+{
+    util::MemoryUsage usage;
+    for (const SectionEntry& s : sections_) {
+        std::string name;
+        switch (static_cast<SectionId>(s.id)) {
+        case SectionId::Metadata: name = "metadata"; break;
+        case SectionId::IriOffsets: name = "iri offsets"; break;
+        case SectionId::IriBytes: name = "iri bytes"; break;
+        case SectionId::LiteralOffsets: name = "literal offsets"; break;
+        case SectionId::LiteralBytes: name = "literal bytes"; break;
+        case SectionId::LiteralDatatypes: name = "literal datatypes"; break;
+        case SectionId::LiteralLanguages: name = "literal languages"; break;
+        case SectionId::LanguageTags: name = "literal language tags"; break;
+        case SectionId::IriDictionary: name = "iri dictionary"; break;
+        case SectionId::IriBuckets: name = "iri dictionary buckets"; break;
+        case SectionId::IriRanks: name = "iri dictionary ranks"; break;
+        case SectionId::IriSortedIds: name = "iri dictionary ids"; break;
+        case SectionId::IriHash: name = "iri hash"; break;
+        default:
+            if (s.id >= static_cast<std::uint32_t>(SectionId::KeyHashes)) {
+                std::uint64_t property = 0;
+                std::memcpy(&property, file_.data() + s.offset, sizeof(property));
+                name = "key index " + std::string(iri(static_cast<owl2::TermId>(property)));
+            } else if (s.id >= static_cast<std::uint32_t>(SectionId::Axioms)
+                       && s.id < static_cast<std::uint32_t>(SectionId::Axioms) + owl2::AXIOM_KIND_COUNT) {
+                name = std::string(owl2::axiomKindName(
+                           static_cast<owl2::AxiomKind>(s.id - static_cast<std::uint32_t>(SectionId::Axioms))))
+                    + " table";
+            } else {
+                name = "section " + std::to_string(s.id);
+            }
+        }
+        usage.push_back(file_.memory(name, s.offset, s.size));
+    }
+    usage.push_back(util::vectorMemory("section directory", sections_));
+    usage.push_back(util::vectorMemory("language tag views", language_tags_));
+    return usage;
+}
+
+std::span<const char> Snapshot::section(SectionId id) const
+{
+    for (const auto& s : sections_)
+        if (s.id == static_cast<std::uint32_t>(id))
+            return std::span<const char>(file_.data() + s.offset, s.size);
+    return {};
+}
+
+std::size_t Snapshot::axiomCount() const
+{
+    std::size_t count = 0;
+    for (const auto& table : axioms_)
+        count += table.size();
+    return count;
+}
+
+owl2::TermId Snapshot::findIri(std::string_view iri) const
+{
+    if (iri_dictionary_.size() == iri_count_)
+        return iri_dictionary_.find(iri);
+    if (!iri_hash_.empty()) {
+        auto ids = iri_hash_.find(iri);
+        return !ids.empty() && this->iri(ids[0]) == iri ? ids[0] : owl2::NO_TERM;
+    }
+    for (owl2::TermId id = 0; id < iri_count_; ++id)
+        if (this->iri(id) == iri)
+            return id;
+    return owl2::NO_TERM;
+}
+
+std::vector<owl2::TermId> Snapshot::keyProperties() const
+{
+    std::vector<owl2::TermId> properties;
+    for (const auto& [property, hash] : key_hashes_)
+        properties.push_back(property);
+    return properties;
+}
+
+bool Snapshot::hasKeyIndex(owl2::TermId property) const
+{
+    for (const auto& [p, hash] : key_hashes_)
+        if (p == property)
+            return true;
+    return false;
+}
+
+std::span<const owl2::TermId> Snapshot::findKey(owl2::TermId property, std::string_view value) const
+{
+    for (const auto& [p, hash] : key_hashes_)
+        if (p == property)
+            return hash.find(value);
+    return {};
+}
+
+
+owl2::Ontology loadSnapshot(const std::string& path, std::pmr::memory_resource* resource)
+{
+    ISTA_TRACE_SCOPE("loadSnapshot");
+    Snapshot snap(path);
+    owl2::Ontology onto(resource);
+    if (!snap.ontologyIri().empty())
+        onto.ontology_iri = IRI(std::string(snap.ontologyIri()));
+    if (!snap.versionIri().empty())
+        onto.version_iri = IRI(std::string(snap.versionIri()));
+    for (owl2::TermId id = 0; id < snap.iriCount(); ++id)
+        if (onto.internIri(snap.iri(id)) != id)
+            throw std::runtime_error("'" + path + "' has a duplicate or reordered IRI dictionary");
+    for (owl2::TermId index = 0; index < snap.literalCount(); ++index) {
+        owl2::TermId id = owl2::makeLiteralId(index);
+        owl2::LiteralRef lit = snap.literal(id);
+        if (onto.internLiteral(lit.lexical, lit.datatype, lit.language) != id)
+            throw std::runtime_error("'" + path + "' has a duplicate literal dictionary entry");
+    }
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k) {
+        auto kind = static_cast<owl2::AxiomKind>(k);
+        auto rows = snap.axioms(kind);
+        onto.axioms(kind).assign(rows.begin(), rows.end());
+    }
+    if (util::numaPlacement())
+        onto.placeOnNodes();
+    return onto;
+}
+
+
+// Streams the tables of a mapped snapshot in kind order.
+class SnapshotReader : public TripleReader
+{
+public:
+    explicit SnapshotReader(const std::string& path) : snap_(path) { snap_.file().adviseSequential(); }
+
+    bool next(Triple& triple) override
+    {
+        while (kind_ < owl2::AXIOM_KIND_COUNT) {
+            auto rows = snap_.axioms(static_cast<owl2::AxiomKind>(kind_));
+            if (row_ < rows.size()) {
+                rowToTriple(snap_, rows[row_++], triple);
+                bytes_ += sizeof(owl2::TripleRow);
+                return true;
+            }
+            ++kind_;
+            row_ = 0;
+        }
+        return false;
+    }
+
+    std::uint64_t bytesRead() const override { return bytes_; }
+
+private:
+    Snapshot snap_;
+    std::size_t kind_ = 0;
+    std::size_t row_ = 0;
+    std::uint64_t bytes_ = 0;
+};
+
+
+// A snapshot is a dictionary-encoded column store, so unlike the text writers
+// this one has to see every triple before it can write anything.
+class SnapshotWriter : public TripleWriter
+{
+public:
+    explicit SnapshotWriter(const std::string& path) : path_(path) {}
+
+    void write(const Triple& triple) override { addTriple(onto_, triple); }
+
+    void close() override
+    {
+        if (closed_)
+            return;
+        writeSnapshot(onto_, path_);
+        closed_ = true;
+    }
+
+private:
+    std::string path_;
+    owl2::Ontology onto_;
+    bool closed_ = false;
+};
+
+
+std::unique_ptr<TripleReader> makeSnapshotReader(const std::string& path)
+{
+    return std::make_unique<SnapshotReader>(path);
+}
+
+std::unique_ptr<TripleWriter> makeSnapshotWriter(const std::string& path)
+{
+    return std::make_unique<SnapshotWriter>(path);
+}
+
+
+}
+
+}
@@ -0,0 +1,171 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "owl2/iri_dictionary.hpp"
+#include "owl2/ontology.hpp"
+#include "util/mapped_file.hpp"
+#include "util/perfect_hash.hpp"
+
+
+namespace ista
+{
+
+namespace io
+{
+
+
+// Binary snapshot layout: a header, a section directory and 8-byte aligned
+// sections holding the raw column arrays of an Ontology. Opening a snapshot
+// maps the file and points spans into it, so loading is O(1) and the page
+// cache is shared between processes reading the same KB. Writing one also
+// builds a util::PerfectHashIndex over its IRIs, plus one over the values of
+// each key property and the KB's owl2::IriDictionary when asked for them;
+// snapshots without those sections still load.
+enum class SectionId : std::uint32_t
+{
+    Metadata = 1,          // ontology IRI and version IRI, NUL-terminated
+    IriOffsets = 2,        // u64[iri_count + 1]
+    IriBytes = 3,
+    LiteralOffsets = 4,    // u64[literal_count + 1]
+    LiteralBytes = 5,
+    LiteralDatatypes = 6,  // u32[literal_count]
+    LiteralLanguages = 7,  // u32[literal_count], indexes into LanguageTags
+    LanguageTags = 8,      // NUL-terminated strings; entry 0 is ""
+    IriDictionary = 9,     // owl2::IriDictionary front-coded bytes
+    IriBuckets = 10,       // u64, and its bucket positions
+    IriRanks = 11,         // u32[iri_count], and its id -> rank map
+    IriSortedIds = 12,     // u32[iri_count], and its rank -> id map
+    IriHash = 13,          // util::PerfectHashIndex, IRI -> id
+    Axioms = 16,           // TripleRow[]; Axioms + AxiomKind
+    KeyHashes = 256,       // u64 property id | util::PerfectHashIndex, value -> subjects;
+                           // KeyHashes + k for the k-th key property
+};
+
+constexpr char SNAPSHOT_MAGIC[8] = {'I', 'S', 'T', 'A', 'S', 'N', 'P', '1'};
+constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+
+struct SnapshotHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t section_count;
+};
+
+struct SectionEntry
+{
+    std::uint32_t id;
+    std::uint32_t reserved;
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+
+// Read-only, memory-mapped view of a snapshot. Exposes the same accessors as
+// owl2::Ontology (iri, literal, axioms, counts) so analysis code can be written
+// once against either.
+class Snapshot
+{
+public:
+    explicit Snapshot(const std::string& path);
+
+    std::string_view iri(owl2::TermId id) const
+    {
+        return std::string_view(iri_bytes_ + iri_offsets_[id], iri_offsets_[id + 1] - iri_offsets_[id]);
+    }
+    owl2::LiteralRef literal(owl2::TermId id) const
+    {
+        owl2::TermId index = owl2::literalIndex(id);
+        return owl2::LiteralRef{
+            std::string_view(literal_bytes_ + literal_offsets_[index], literal_offsets_[index + 1] - literal_offsets_[index]),
+            literal_datatypes_[index],
+            language_tags_[literal_languages_[index]]
+        };
+    }
+    std::span<const owl2::TripleRow> axioms(owl2::AxiomKind kind) const { return axioms_[static_cast<std::size_t>(kind)]; }
+    std::size_t axiomCount() const;
+    std::size_t iriCount() const { return iri_count_; }
+    std::size_t literalCount() const { return literal_count_; }
+
+    std::string_view ontologyIri() const { return ontology_iri_; }
+    std::string_view versionIri() const { return version_iri_; }
+
+    // Looks an IRI up in the IRI dictionary, in O(log n), when the snapshot
+    // has one; otherwise in the IRI hash, confirming the match against the
+    // IRI bytes, or without that by a linear scan.
+    owl2::TermId findIri(std::string_view iri) const;
+    // The perfect hash over the IRIs. Its find() is two cache misses and
+    // stops at the fingerprint, so an IRI outside the KB gets a wrong id with
+    // probability 2^-32; empty for snapshots written without one.
+    const util::PerfectHashIndex& iriHash() const { return iri_hash_; }
+    // The front-coded IRIs; its at() decodes without touching the plain IRI
+    // sections, so a process that only resolves names keeps those out of
+    // memory. Empty unless the snapshot was written with iri_dictionary.
+    const owl2::IriDictionary& iriDictionary() const { return iri_dictionary_; }
+
+    // The data properties with a key index, as ids; `ista lookup --key`
+    // queries them.
+    std::vector<owl2::TermId> keyProperties() const;
+    bool hasKeyIndex(owl2::TermId property) const;
+    // The subjects whose `property` has the lexical value `value`, from the
+    // property's key index: the perfect hash lookup and its fingerprint check,
+    // without comparing the value itself. Empty if there are none or the
+    // property has no index.
+    std::span<const owl2::TermId> findKey(owl2::TermId property, std::string_view value) const;
+
+    const util::MappedFile& file() const { return file_; }
+
+    // Each mapped section, with how much of it is resident.
+    util::MemoryUsage memoryUsage() const;
+
+private:
+    std::span<const char> section(SectionId id) const;
+
+    util::MappedFile file_;
+    std::vector<SectionEntry> sections_;
+    std::size_t iri_count_ = 0;
+    std::size_t literal_count_ = 0;
+    const std::uint64_t* iri_offsets_ = nullptr;
+    const char* iri_bytes_ = nullptr;
+    const std::uint64_t* literal_offsets_ = nullptr;
+    const char* literal_bytes_ = nullptr;
+    const owl2::TermId* literal_datatypes_ = nullptr;
+    const std::uint32_t* literal_languages_ = nullptr;
+    std::vector<std::string_view> language_tags_;
+    owl2::IriDictionary iri_dictionary_;
+    util::PerfectHashIndex iri_hash_;
+    std::vector<std::pair<owl2::TermId, util::PerfectHashIndex>> key_hashes_;
+    std::array<std::span<const owl2::TripleRow>, owl2::AXIOM_KIND_COUNT> axioms_;
+    std::string_view ontology_iri_;
+    std::string_view version_iri_;
+};
+
+
+struct SnapshotOptions
+{
+    // Data property IRIs to build key indexes over, as `ista build` does
+    // for the properties its steps merge and match on. Properties the KB
+    // does not use are skipped.
+    std::vector<std::string> key_properties;
+    // Also store the front-coded IRI dictionary. It takes about a third of
+    // the plain IRI sections, which stay, since Snapshot::iri() views them.
+    bool iri_dictionary = false;
+};
+
+void writeSnapshot(const owl2::Ontology& onto, const std::string& path, const SnapshotOptions& options = {});
+// Copies a snapshot into a mutable Ontology, preserving term ids.
+owl2::Ontology loadSnapshot(const std::string& path,
+                            std::pmr::memory_resource* resource = owl2::Ontology::defaultResource());
+
+
+}
+
+}
+
+#endif
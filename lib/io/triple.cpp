@@ -0,0 +1,163 @@
+#include "triple.hpp"
+
+#include <filesystem>
+
+#include "formats.hpp"
+#include "owl2/vocabulary.hpp"
+#include "snapshot.hpp"
+#include "util/numa.hpp"
+#include "util/trace.hpp"
+
+namespace ista
+{
+
+namespace io
+{
+
+
+const char* formatName(Format format)
+{
+    switch (format) {
+    case Format::RdfXml: return "rdfxml";
+    case Format::Turtle: return "turtle";
+    case Format::NTriples: return "ntriples";
+    case Format::Functional: return "ofn";
+    case Format::Snapshot: return "snapshot";
+    case Format::Neo4jCsv: return "neo4j";
+    }
+    return "unknown";
+}
+
+Format parseFormat(std::string_view name)
+{
+    if (name == "rdfxml" || name == "rdf" || name == "owl" || name == "xml")
+        return Format::RdfXml;
+    if (name == "turtle" || name == "ttl")
+        return Format::Turtle;
+    if (name == "ntriples" || name == "nt")
+        return Format::NTriples;
+    if (name == "ofn" || name == "functional")
+        return Format::Functional;
+    if (name == "snapshot" || name == "ista")
+        return Format::Snapshot;
+    if (name == "neo4j" || name == "csv")
+        return Format::Neo4jCsv;
+    throw std::invalid_argument("unknown format '" + std::string(name) + "'");
+}
+
+Format formatFromPath(const std::string& path)
+{
+    std::filesystem::path p(path);
+    if (std::filesystem::is_directory(p) || path.ends_with("/"))
+        return Format::Neo4jCsv;
+    std::string ext = p.extension().string();
+    if (ext.empty())
+        throw std::invalid_argument("cannot infer format of '" + path + "'; pass --from/--to");
+    return parseFormat(ext.substr(1));
+}
+
+
+ParseError::ParseError(const std::string& source, std::uint64_t line, const std::string& message)
+    : std::runtime_error(source + ":" + std::to_string(line) + ": " + message)
+{
+}
+
+
+std::unique_ptr<TripleReader> openReader(const std::string& path, Format format)
+{
+    switch (format) {
+    case Format::RdfXml: return makeRdfXmlReader(path);
+    case Format::Turtle: return makeTurtleReader(path);
+    case Format::NTriples: return makeNTriplesReader(path);
+    case Format::Functional: return makeFunctionalReader(path);
+    case Format::Snapshot: return makeSnapshotReader(path);
+    case Format::Neo4jCsv: break;
+    }
+    throw std::invalid_argument(std::string(formatName(format)) + " is an output-only format");
+}
+
+std::unique_ptr<TripleWriter> openWriter(const std::string& path, Format format)
+{
+    switch (format) {
+    case Format::RdfXml: return makeRdfXmlWriter(path);
+    case Format::Turtle: return makeTurtleWriter(path);
+    case Format::NTriples: return makeNTriplesWriter(path);
+    case Format::Functional: return makeFunctionalWriter(path);
+    case Format::Snapshot: return makeSnapshotWriter(path);
+    case Format::Neo4jCsv: return makeNeo4jCsvWriter(path);
+    }
+    throw std::invalid_argument("unknown output format");
+}
+
+
+owl2::TermId internTerm(owl2::Ontology& onto, const Term& term)
+{
+    switch (term.kind) {
+    case TermKind::Iri:
+        return onto.internIri(term.value);
+    case TermKind::Blank: {
+        std::string label;
+        label.reserve(term.value.size() + 2);
+        label += "_:";
+        label += term.value;
+        return onto.internIri(label);
+    }
+    case TermKind::Literal: {
+        owl2::TermId datatype;
+        if (!term.language.empty())
+            datatype = onto.rdfLangString();
+        else if (term.datatype.empty())
+            datatype = onto.xsdString();
+        else
+            datatype = onto.internIri(term.datatype);
+        return onto.internLiteral(term.value, datatype, term.language);
+    }
+    }
+    return owl2::NO_TERM;
+}
+
+void addTriple(owl2::Ontology& onto, const Triple& triple)
+{
+    owl2::TermId s = internTerm(onto, triple.subject);
+    owl2::TermId p = internTerm(onto, triple.predicate);
+    owl2::TermId o = internTerm(onto, triple.object);
+    onto.addAxiom(s, p, o);
+}
+
+owl2::Ontology readOntology(const std::string& path, Format format, std::pmr::memory_resource* resource)
+{
+    ISTA_TRACE_SCOPE("readOntology");
+    if (format == Format::Snapshot)
+        return loadSnapshot(path, resource);
+    owl2::Ontology onto(resource);
+    auto reader = openReader(path, format);
+    Triple triple;
+    while (reader->next(triple))
+        addTriple(onto, triple);
+    if (util::numaPlacement())
+        onto.placeOnNodes();
+    return onto;
+}
+
+void writeOntology(const owl2::Ontology& onto, const std::string& path, Format format)
+{
+    ISTA_TRACE_SCOPE("writeOntology");
+    if (format == Format::Snapshot) {
+        writeSnapshot(onto, path);
+        return;
+    }
+    auto writer = openWriter(path, format);
+    Triple triple;
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k) {
+        for (const owl2::TripleRow& row : onto.axioms(static_cast<owl2::AxiomKind>(k))) {
+            rowToTriple(onto, row, triple);
+            writer->write(triple);
+        }
+    }
+    writer->close();
+}
+
+
+}
+
+}
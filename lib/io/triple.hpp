@@ -0,0 +1,148 @@
+#ifndef TRIPLE_HPP
+#define TRIPLE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "owl2/ontology.hpp"
+
+
+namespace ista
+{
+
+namespace io
+{
+
+
+enum class TermKind : std::uint8_t
+{
+    Iri,
+    Blank,      // value holds the label without the "_:" prefix
+    Literal,
+};
+
+// A term as it appears in a serialization. Readers reuse the same Triple
+// across calls to `next()`, so the string buffers are allocated once per
+// stream rather than once per triple.
+struct Term
+{
+    TermKind kind = TermKind::Iri;
+    std::string value;
+    std::string datatype;   // literals only; empty means xsd:string
+    std::string language;   // literals only
+
+    void setIri(std::string_view iri) { kind = TermKind::Iri; value.assign(iri); }
+    void setBlank(std::string_view label) { kind = TermKind::Blank; value.assign(label); }
+    void setLiteral(std::string_view lexical, std::string_view dt = {}, std::string_view lang = {})
+    {
+        kind = TermKind::Literal;
+        value.assign(lexical);
+        datatype.assign(dt);
+        language.assign(lang);
+    }
+};
+
+struct Triple
+{
+    Term subject;
+    Term predicate;
+    Term object;
+};
+
+
+enum class Format
+{
+    RdfXml,
+    Turtle,
+    NTriples,
+    Functional,
+    Snapshot,
+    Neo4jCsv,
+};
+
+const char* formatName(Format format);
+// Accepts a format name ("rdfxml", "turtle", "ntriples", "ofn", "snapshot",
+// "neo4j") or throws std::invalid_argument.
+Format parseFormat(std::string_view name);
+// Guesses a format from a file extension; directories map to Neo4j CSV.
+Format formatFromPath(const std::string& path);
+
+
+struct ParseError : std::runtime_error
+{
+    ParseError(const std::string& source, std::uint64_t line, const std::string& message);
+};
+
+
+class TripleReader
+{
+public:
+    virtual ~TripleReader() = default;
+
+    // Fills `triple` with the next triple; returns false at end of input.
+    virtual bool next(Triple& triple) = 0;
+    virtual std::uint64_t bytesRead() const = 0;
+};
+
+class TripleWriter
+{
+public:
+    virtual ~TripleWriter() = default;
+
+    virtual void write(const Triple& triple) = 0;
+    // Flushes buffered output. Must be called before destruction to observe
+    // write errors; destructors never throw.
+    virtual void close() = 0;
+};
+
+std::unique_ptr<TripleReader> openReader(const std::string& path, Format format);
+std::unique_ptr<TripleWriter> openWriter(const std::string& path, Format format);
+
+
+// Bridges between serialized terms and the ids stored in an Ontology.
+owl2::TermId internTerm(owl2::Ontology& onto, const Term& term);
+void addTriple(owl2::Ontology& onto, const Triple& triple);
+// Reads a whole file into a new Ontology whose tables allocate from
+// `resource`.
+owl2::Ontology readOntology(const std::string& path, Format format,
+                            std::pmr::memory_resource* resource = owl2::Ontology::defaultResource());
+// Writes every axiom of an Ontology, one table at a time.
+void writeOntology(const owl2::Ontology& onto, const std::string& path, Format format);
+
+// Materializes a stored row as a Triple. Works for any knowledge base type
+// exposing `iri(id)` and `literal(id)`, i.e. an Ontology or a Snapshot.
+template <typename Kb>
+void rowToTerm(const Kb& kb, owl2::TermId id, Term& term)
+{
+    if (owl2::isLiteral(id)) {
+        owl2::LiteralRef lit = kb.literal(id);
+        std::string_view dt = kb.iri(lit.datatype);
+        if (!lit.language.empty() || dt == "http://www.w3.org/2001/XMLSchema#string")
+            dt = {};
+        term.setLiteral(lit.lexical, dt, lit.language);
+        return;
+    }
+    std::string_view s = kb.iri(id);
+    if (s.starts_with("_:"))
+        term.setBlank(s.substr(2));
+    else
+        term.setIri(s);
+}
+
+template <typename Kb>
+void rowToTriple(const Kb& kb, const owl2::TripleRow& row, Triple& triple)
+{
+    rowToTerm(kb, row.subject, triple.subject);
+    rowToTerm(kb, row.predicate, triple.predicate);
+    rowToTerm(kb, row.object, triple.object);
+}
+
+
+}
+
+}
+
+#endif
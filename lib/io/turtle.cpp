@@ -0,0 +1,625 @@
+#include <cctype>
+#include <unordered_map>
+
+#include "file_io.hpp"
+#include "formats.hpp"
+#include "owl2/vocabulary.hpp"
+#include "rdf_syntax.hpp"
+#include "util/memory.hpp"
+
+namespace ista
+{
+
+namespace io
+{
+
+namespace vocab = owl2::vocab;
+
+
+// Streaming Turtle parser. Each call to next() parses at most one statement
+// into a small queue, so memory is bounded by the largest statement rather
+// than by the document.
+class TurtleReader : public TripleReader
+{
+public:
+    explicit TurtleReader(const std::string& path) : in_(path) {}
+
+    bool next(Triple& triple) override
+    {
+        while (pending_.empty()) {
+            skipWs();
+            if (peek() < 0)
+                return false;
+            statement();
+        }
+        pending_.pop(triple);
+        return true;
+    }
+
+    std::uint64_t bytesRead() const override { return in_.bytesRead(); }
+
+private:
+    int get()
+    {
+        int c;
+        if (!pushback_.empty()) {
+            c = static_cast<unsigned char>(pushback_.back());
+            pushback_.pop_back();
+        } else {
+            c = in_.get();
+        }
+        if (c == '\n')
+            ++line_;
+        return c;
+    }
+    int peek()
+    {
+        if (!pushback_.empty())
+            return static_cast<unsigned char>(pushback_.back());
+        return in_.peek();
+    }
+    void unget(char c)
+    {
+        if (c == '\n')
+            --line_;
+        pushback_.push_back(c);
+    }
+
+    [[noreturn]] void fail(const std::string& message) { throw ParseError(in_.path(), line_, message); }
+
+    void expect(char c)
+    {
+        skipWs();
+        if (get() != c)
+            fail(std::string("expected '") + c + "'");
+    }
+
+    void skipWs()
+    {
+        for (;;) {
+            int c = peek();
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+                get();
+            } else if (c == '#') {
+                while ((c = get()) >= 0 && c != '\n') {
+                }
+            } else {
+                return;
+            }
+        }
+    }
+
+    static bool isNameChar(int c)
+    {
+        return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_'
+            || c == '-' || c == '.' || c == ':' || c == '%' || c == '\\' || c >= 0x80;
+    }
+
+    // Reads a bare word: a prefixed name, a keyword or a boolean.
+    std::string word()
+    {
+        std::string w;
+        for (int c = peek(); isNameChar(c); c = peek()) {
+            get();
+            if (c == '\\') {
+                // Local name escapes such as "\-" stand for the character itself.
+                int e = get();
+                if (e < 0)
+                    fail("unterminated escape");
+                w.push_back(static_cast<char>(e));
+            } else {
+                w.push_back(static_cast<char>(c));
+            }
+        }
+        while (!w.empty() && w.back() == '.') {
+            unget('.');
+            w.pop_back();
+        }
+        return w;
+    }
+
+    std::uint32_t hex(int digits)
+    {
+        std::uint32_t cp = 0;
+        for (int k = 0; k < digits; ++k) {
+            int c = get();
+            cp <<= 4;
+            if (c >= '0' && c <= '9') cp |= c - '0';
+            else if (c >= 'a' && c <= 'f') cp |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') cp |= c - 'A' + 10;
+            else fail("bad hex escape");
+        }
+        return cp;
+    }
+
+    void escape(std::string& out)
+    {
+        int c = get();
+        switch (c) {
+        case 't': out.push_back('\t'); break;
+        case 'b': out.push_back('\b'); break;
+        case 'n': out.push_back('\n'); break;
+        case 'r': out.push_back('\r'); break;
+        case 'f': out.push_back('\f'); break;
+        case '"': out.push_back('"'); break;
+        case '\'': out.push_back('\''); break;
+        case '\\': out.push_back('\\'); break;
+        case 'u': appendUtf8(out, hex(4)); break;
+        case 'U': appendUtf8(out, hex(8)); break;
+        default: fail("unknown string escape");
+        }
+    }
+
+    std::string iriRef()
+    {
+        get();  // '<'
+        std::string iri;
+        for (int c = get(); c != '>'; c = get()) {
+            if (c < 0)
+                fail("unterminated IRI");
+            if (c == '\\') {
+                int u = get();
+                if (u != 'u' && u != 'U')
+                    fail("bad IRI escape");
+                appendUtf8(iri, hex(u == 'u' ? 4 : 8));
+            } else {
+                iri.push_back(static_cast<char>(c));
+            }
+        }
+        return resolveIri(base_, iri);
+    }
+
+    std::string expandPrefixed(const std::string& name)
+    {
+        std::size_t colon = name.find(':');
+        if (colon == std::string::npos)
+            fail("unexpected '" + name + "'");
+        auto it = prefixes_.find(name.substr(0, colon));
+        if (it == prefixes_.end())
+            fail("undeclared prefix '" + name.substr(0, colon) + "'");
+        std::string iri = it->second;
+        // Percent escapes are kept verbatim, per the Turtle spec.
+        iri.append(name, colon + 1);
+        return iri;
+    }
+
+    std::string iri()
+    {
+        skipWs();
+        if (peek() == '<')
+            return iriRef();
+        return expandPrefixed(word());
+    }
+
+    std::string stringBody(char quote)
+    {
+        std::string s;
+        bool long_form = false;
+        if (peek() == quote) {
+            get();
+            if (peek() == quote) {
+                get();
+                long_form = true;
+            } else {
+                return s;  // empty string
+            }
+        }
+        for (;;) {
+            int c = get();
+            if (c < 0)
+                fail("unterminated string");
+            if (c == '\\') {
+                escape(s);
+            } else if (c == quote) {
+                if (!long_form)
+                    return s;
+                if (peek() == quote) {
+                    get();
+                    if (peek() == quote) {
+                        get();
+                        // Up to two extra quotes may precede the closing triple.
+                        while (peek() == quote) {
+                            get();
+                            s.push_back(quote);
+                        }
+                        return s;
+                    }
+                    s.push_back(quote);
+                    s.push_back(quote);
+                } else {
+                    s.push_back(quote);
+                }
+            } else {
+                if (c == '\n' && !long_form)
+                    fail("newline in string");
+                s.push_back(static_cast<char>(c));
+            }
+        }
+    }
+
+    Term literal(char quote)
+    {
+        get();
+        Term t;
+        t.kind = TermKind::Literal;
+        t.value = stringBody(quote);
+        if (peek() == '@') {
+            get();
+            for (int c = peek(); std::isalnum(c) || c == '-'; c = peek())
+                t.language.push_back(static_cast<char>(get()));
+        } else if (peek() == '^') {
+            get();
+            if (get() != '^')
+                fail("expected '^^'");
+            t.datatype = iri();
+            if (t.datatype == vocab::XSD_STRING)
+                t.datatype.clear();
+        }
+        return t;
+    }
+
+    Term number()
+    {
+        Term t;
+        t.kind = TermKind::Literal;
+        bool decimal = false;
+        bool exponent = false;
+        for (int c = peek();; c = peek()) {
+            if (std::isdigit(c) || ((c == '+' || c == '-') && (t.value.empty() || t.value.back() == 'e' || t.value.back() == 'E'))) {
+                t.value.push_back(static_cast<char>(get()));
+            } else if (c == '.' && !decimal && !exponent) {
+                get();
+                if (!std::isdigit(peek())) {
+                    unget('.');
+                    break;
+                }
+                decimal = true;
+                t.value.push_back('.');
+            } else if ((c == 'e' || c == 'E') && !exponent) {
+                exponent = true;
+                t.value.push_back(static_cast<char>(get()));
+            } else {
+                break;
+            }
+        }
+        t.datatype = exponent ? vocab::XSD_DOUBLE : decimal ? vocab::XSD_DECIMAL : vocab::XSD_INTEGER;
+        return t;
+    }
+
+    Term blankTerm(std::string label)
+    {
+        Term t;
+        t.kind = TermKind::Blank;
+        t.value = std::move(label);
+        return t;
+    }
+
+    Term documentBlank(std::string label)
+    {
+        BlankNodeLabels::fromDocument(label);
+        return blankTerm(std::move(label));
+    }
+
+    void emit(const Term& s, const Term& p, const Term& o)
+    {
+        pending_.push(s, p, o);
+    }
+
+    Term collection()
+    {
+        get();  // '('
+        Term head;
+        head.setIri(vocab::RDF_NIL);
+        Term previous;
+        Term first_p, rest_p;
+        first_p.setIri(vocab::RDF_FIRST);
+        rest_p.setIri(vocab::RDF_REST);
+        for (;;) {
+            skipWs();
+            if (peek() == ')') {
+                get();
+                break;
+            }
+            Term node = blankTerm(labels_.fresh());
+            if (previous.value.empty())
+                head = node;
+            else
+                emit(previous, rest_p, node);
+            emit(node, first_p, object());
+            previous = node;
+        }
+        if (!previous.value.empty()) {
+            Term nil;
+            nil.setIri(vocab::RDF_NIL);
+            emit(previous, rest_p, nil);
+        }
+        return head;
+    }
+
+    Term blankPropertyList()
+    {
+        get();  // '['
+        Term node = blankTerm(labels_.fresh());
+        skipWs();
+        if (peek() != ']')
+            predicateObjectList(node);
+        expect(']');
+        return node;
+    }
+
+    Term subject()
+    {
+        skipWs();
+        int c = peek();
+        if (c == '<') {
+            Term t;
+            t.setIri(iriRef());
+            return t;
+        }
+        if (c == '(')
+            return collection();
+        std::string w = word();
+        if (w.starts_with("_:"))
+            return documentBlank(w.substr(2));
+        Term t;
+        t.setIri(expandPrefixed(w));
+        return t;
+    }
+
+    Term object()
+    {
+        skipWs();
+        int c = peek();
+        if (c == '<') {
+            Term t;
+            t.setIri(iriRef());
+            return t;
+        }
+        if (c == '"' || c == '\'')
+            return literal(static_cast<char>(c));
+        if (c == '[')
+            return blankPropertyList();
+        if (c == '(')
+            return collection();
+        if (std::isdigit(c) || c == '+' || c == '-' || c == '.')
+            return number();
+        std::string w = word();
+        if (w.starts_with("_:"))
+            return documentBlank(w.substr(2));
+        if (w == "true" || w == "false") {
+            Term t;
+            t.setLiteral(w, vocab::XSD_BOOLEAN);
+            return t;
+        }
+        Term t;
+        t.setIri(expandPrefixed(w));
+        return t;
+    }
+
+    Term verb()
+    {
+        skipWs();
+        Term t;
+        if (peek() == 'a') {
+            get();
+            int c = peek();
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '<' || c == '"' || c == '[' || c == '(') {
+                t.setIri(vocab::RDF_TYPE);
+                return t;
+            }
+            unget('a');
+        }
+        t.setIri(iri());
+        return t;
+    }
+
+    void predicateObjectList(const Term& subj)
+    {
+        for (;;) {
+            Term p = verb();
+            for (;;) {
+                Term o = object();
+                emit(subj, p, o);
+                skipWs();
+                if (peek() != ',')
+                    break;
+                get();
+            }
+            skipWs();
+            if (peek() != ';')
+                return;
+            while (peek() == ';') {
+                get();
+                skipWs();
+            }
+            int c = peek();
+            if (c == '.' || c == ']' || c < 0)
+                return;
+        }
+    }
+
+    void directive(const std::string& keyword, bool sparql_style)
+    {
+        skipWs();
+        if (keyword == "prefix") {
+            std::string name = word();
+            if (name.empty() || name.back() != ':')
+                fail("bad prefix name");
+            name.pop_back();
+            skipWs();
+            if (peek() != '<')
+                fail("expected IRI after prefix");
+            prefixes_[name] = iriRef();
+        } else {
+            skipWs();
+            if (peek() != '<')
+                fail("expected IRI after base");
+            base_ = iriRef();
+        }
+        if (!sparql_style)
+            expect('.');
+    }
+
+    void statement()
+    {
+        int c = peek();
+        if (c == '@') {
+            get();
+            std::string keyword = word();
+            if (keyword != "prefix" && keyword != "base")
+                fail("unknown directive '@" + keyword + "'");
+            directive(keyword, false);
+            return;
+        }
+        if (c == 'P' || c == 'B' || c == 'p' || c == 'b') {
+            std::string w = word();
+            std::string lower;
+            for (char ch : w)
+                lower.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(ch))));
+            if ((lower == "prefix" || lower == "base") && w.find(':') == std::string::npos) {
+                directive(lower, true);
+                return;
+            }
+            for (auto it = w.rbegin(); it != w.rend(); ++it)
+                unget(*it);
+        }
+
+        if (c == '[') {
+            Term s = blankPropertyList();
+            skipWs();
+            if (peek() != '.')
+                predicateObjectList(s);
+        } else {
+            Term s = subject();
+            predicateObjectList(s);
+        }
+        expect('.');
+    }
+
+    InputFile in_;
+    std::string pushback_;
+    std::uint64_t line_ = 1;
+    std::string base_;
+    std::unordered_map<std::string, std::string> prefixes_;
+    TripleQueue pending_{&util::subsystemResource(util::Subsystem::Parser)};
+    BlankNodeLabels labels_;
+};
+
+
+// Streaming Turtle writer. Consecutive triples that share a subject (and
+// predicate) are folded with ';' and ','. Nothing is buffered beyond the
+// current subject, so prefixes are limited to the well-known vocabularies.
+class TurtleWriter : public TripleWriter
+{
+public:
+    explicit TurtleWriter(const std::string& path) : out_(path)
+    {
+        out_ << "@prefix rdf: <" << vocab::RDF << "> .\n"
+             << "@prefix rdfs: <" << vocab::RDFS << "> .\n"
+             << "@prefix owl: <" << vocab::OWL << "> .\n"
+             << "@prefix xsd: <" << vocab::XSD << "> .\n\n";
+    }
+
+    void write(const Triple& triple) override
+    {
+        buf_.clear();
+        bool same_subject = open_ && triple.subject.kind == subject_.kind && triple.subject.value == subject_.value;
+        if (same_subject && triple.predicate.value == predicate_) {
+            buf_ += " ,\n        ";
+        } else if (same_subject) {
+            buf_ += " ;\n    ";
+            appendTerm(buf_, triple.predicate, true);
+            buf_.push_back(' ');
+            predicate_ = triple.predicate.value;
+        } else {
+            if (open_)
+                buf_ += " .\n";
+            appendTerm(buf_, triple.subject, false);
+            buf_ += "\n    ";
+            appendTerm(buf_, triple.predicate, true);
+            buf_.push_back(' ');
+            subject_ = triple.subject;
+            predicate_ = triple.predicate.value;
+            open_ = true;
+        }
+        appendTerm(buf_, triple.object, false);
+        out_.write(buf_);
+    }
+
+    void close() override
+    {
+        if (open_)
+            out_.write(" .\n");
+        open_ = false;
+        out_.close();
+    }
+
+private:
+    static bool tryPrefixed(std::string& out, std::string_view iri)
+    {
+        static constexpr std::pair<std::string_view, std::string_view> prefixes[] = {
+            {"rdf:", vocab::RDF}, {"rdfs:", vocab::RDFS}, {"owl:", vocab::OWL}, {"xsd:", vocab::XSD},
+        };
+        for (const auto& [prefix, ns] : prefixes) {
+            if (!iri.starts_with(ns))
+                continue;
+            std::string_view local = iri.substr(ns.size());
+            bool ok = !local.empty() && local.back() != '.';
+            for (char c : local)
+                ok = ok && (std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-');
+            if (!ok)
+                return false;
+            out += prefix;
+            out += local;
+            return true;
+        }
+        return false;
+    }
+
+    static void appendTerm(std::string& out, const Term& term, bool is_predicate)
+    {
+        if (term.kind == TermKind::Iri) {
+            if (is_predicate && term.value == vocab::RDF_TYPE)
+                out.push_back('a');
+            else if (!tryPrefixed(out, term.value))
+                appendIriRef(out, term.value);
+        } else if (term.kind == TermKind::Blank) {
+            out += "_:";
+            out += term.value;
+        } else {
+            out.push_back('"');
+            appendEscaped(out, term.value);
+            out.push_back('"');
+            if (!term.language.empty()) {
+                out.push_back('@');
+                out += term.language;
+            } else if (!term.datatype.empty()) {
+                out += "^^";
+                if (!tryPrefixed(out, term.datatype))
+                    appendIriRef(out, term.datatype);
+            }
+        }
+    }
+
+    OutputFile out_;
+    std::string buf_;
+    Term subject_;
+    std::string predicate_;
+    bool open_ = false;
+};
+
+
+std::unique_ptr<TripleReader> makeTurtleReader(const std::string& path)
+{
+    return std::make_unique<TurtleReader>(path);
+}
+
+std::unique_ptr<TripleWriter> makeTurtleWriter(const std::string& path)
+{
+    return std::make_unique<TurtleWriter>(path);
+}
+
+
+}
+
+}
@@ -0,0 +1,297 @@
+#include "xml_scanner.hpp"
+
+#include <cstring>
+
+#include "rdf_syntax.hpp"
+#include "triple.hpp"
+
+namespace ista
+{
+
+namespace io
+{
+
+
+static bool isSpace(int c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool isNameChar(int c)
+{
+    return c > 0 && !isSpace(c) && c != '>' && c != '/' && c != '=' && c != '<' && c != '"' && c != '\''
+        && c != ';' && c != '[' && c != ']' && c != '%' && c != '&';
+}
+
+void XmlScanner::fail(const std::string& message)
+{
+    throw ParseError(in_.path(), line_, message);
+}
+
+void XmlScanner::skipUntil(const char* terminator)
+{
+    std::size_t n = std::strlen(terminator);
+    std::size_t matched = 0;
+    while (matched < n) {
+        int c = get();
+        if (c < 0)
+            fail(std::string("unterminated construct, expected '") + terminator + "'");
+        if (c == terminator[matched])
+            ++matched;
+        else
+            matched = (c == terminator[0]) ? 1 : 0;
+    }
+}
+
+void XmlScanner::skipSpace()
+{
+    while (isSpace(peek()))
+        get();
+}
+
+std::string XmlScanner::name()
+{
+    std::string n;
+    while (isNameChar(peek()))
+        n.push_back(static_cast<char>(get()));
+    if (n.empty())
+        fail("expected a name");
+    return n;
+}
+
+void XmlScanner::entity(std::string& out)
+{
+    // The leading '&' has been consumed.
+    std::string ref;
+    for (int c = get(); c != ';'; c = get()) {
+        if (c < 0 || ref.size() > 64)
+            fail("unterminated entity reference");
+        ref.push_back(static_cast<char>(c));
+    }
+    if (ref == "lt") out.push_back('<');
+    else if (ref == "gt") out.push_back('>');
+    else if (ref == "amp") out.push_back('&');
+    else if (ref == "quot") out.push_back('"');
+    else if (ref == "apos") out.push_back('\'');
+    else if (ref.size() > 1 && ref[0] == '#') {
+        std::uint32_t cp = ref[1] == 'x' ? std::stoul(ref.substr(2), nullptr, 16) : std::stoul(ref.substr(1));
+        appendUtf8(out, cp);
+    } else {
+        auto it = entities_.find(ref);
+        if (it == entities_.end())
+            fail("undefined entity '&" + ref + ";'");
+        out += it->second;
+    }
+}
+
+void XmlScanner::doctype()
+{
+    // "<!DOCTYPE" has been consumed. Only internal ENTITY declarations matter.
+    for (;;) {
+        int c = get();
+        if (c < 0)
+            fail("unterminated DOCTYPE");
+        if (c == '>')
+            return;
+        if (c != '[')
+            continue;
+        for (;;) {
+            skipSpace();
+            c = get();
+            if (c == ']')
+                break;
+            if (c != '<')
+                fail("malformed DTD internal subset");
+            if (peek() == '!' ) {
+                get();
+                if (peek() == '-') {
+                    skipUntil("-->");
+                    continue;
+                }
+                std::string keyword = name();
+                if (keyword != "ENTITY") {
+                    skipUntil(">");
+                    continue;
+                }
+                skipSpace();
+                std::string entity_name = name();
+                skipSpace();
+                int quote = get();
+                if (quote != '"' && quote != '\'')
+                    fail("expected quoted entity value");
+                std::string value;
+                for (c = get(); c != quote; c = get()) {
+                    if (c < 0)
+                        fail("unterminated entity value");
+                    if (c == '&')
+                        entity(value);
+                    else
+                        value.push_back(static_cast<char>(c));
+                }
+                entities_[entity_name] = value;
+                skipUntil(">");
+            } else {
+                skipUntil(">");
+            }
+        }
+    }
+}
+
+void XmlScanner::resolve(const std::string& qname, bool is_attribute, std::string& ns, std::string& local)
+{
+    std::size_t colon = qname.find(':');
+    std::string prefix = colon == std::string::npos ? "" : qname.substr(0, colon);
+    local = colon == std::string::npos ? qname : qname.substr(colon + 1);
+    ns.clear();
+    if (prefix == "xml") {
+        ns = "http://www.w3.org/XML/1998/namespace";
+        return;
+    }
+    // Unprefixed attributes are in no namespace.
+    if (prefix.empty() && is_attribute)
+        return;
+    for (auto it = bindings_.rbegin(); it != bindings_.rend(); ++it) {
+        if (it->first == prefix) {
+            ns = it->second;
+            return;
+        }
+    }
+    if (!prefix.empty())
+        fail("undeclared namespace prefix '" + prefix + "'");
+}
+
+void XmlScanner::startTag()
+{
+    qname_ = name();
+    attributes_.clear();
+    scope_marks_.push_back(bindings_.size());
+    for (;;) {
+        skipSpace();
+        int c = peek();
+        if (c == '/') {
+            get();
+            if (get() != '>')
+                fail("expected '>'");
+            self_closing_ = true;
+            break;
+        }
+        if (c == '>') {
+            get();
+            self_closing_ = false;
+            break;
+        }
+        XmlAttribute attr;
+        attr.qname = name();
+        skipSpace();
+        if (get() != '=')
+            fail("expected '=' after attribute name");
+        skipSpace();
+        int quote = get();
+        if (quote != '"' && quote != '\'')
+            fail("expected quoted attribute value");
+        for (c = get(); c != quote; c = get()) {
+            if (c < 0)
+                fail("unterminated attribute value");
+            if (c == '&')
+                entity(attr.value);
+            else
+                attr.value.push_back(static_cast<char>(isSpace(c) ? ' ' : c));
+        }
+        if (attr.qname == "xmlns")
+            bindings_.emplace_back("", attr.value);
+        else if (attr.qname.starts_with("xmlns:"))
+            bindings_.emplace_back(attr.qname.substr(6), attr.value);
+        else
+            attributes_.push_back(std::move(attr));
+    }
+    resolve(qname_, false, ns_, local_);
+    for (auto& attr : attributes_)
+        resolve(attr.qname, true, attr.ns, attr.local);
+    open_elements_.push_back(qname_);
+    pending_end_ = self_closing_;
+}
+
+void XmlScanner::endTag()
+{
+    std::string n = name();
+    skipSpace();
+    if (get() != '>')
+        fail("expected '>'");
+    if (open_elements_.empty() || open_elements_.back() != n)
+        fail("mismatched end tag '</" + n + ">'");
+    qname_ = n;
+    resolve(qname_, false, ns_, local_);
+    open_elements_.pop_back();
+    bindings_.resize(scope_marks_.back());
+    scope_marks_.pop_back();
+}
+
+XmlScanner::Event XmlScanner::next()
+{
+    if (pending_end_) {
+        pending_end_ = false;
+        open_elements_.pop_back();
+        bindings_.resize(scope_marks_.back());
+        scope_marks_.pop_back();
+        return Event::EndElement;
+    }
+    for (;;) {
+        text_.clear();
+        int c;
+        while ((c = peek()) >= 0 && c != '<') {
+            get();
+            if (c == '&')
+                entity(text_);
+            else
+                text_.push_back(static_cast<char>(c));
+        }
+        if (!text_.empty())
+            return Event::Text;
+        if (c < 0) {
+            if (!open_elements_.empty())
+                fail("unexpected end of document inside <" + open_elements_.back() + ">");
+            return Event::End;
+        }
+        get();  // '<'
+        c = peek();
+        if (c == '?') {
+            skipUntil("?>");
+        } else if (c == '!') {
+            get();
+            if (peek() == '-') {
+                skipUntil("-->");
+            } else if (peek() == '[') {
+                skipUntil("CDATA[");
+                for (;;) {
+                    int d = get();
+                    if (d < 0)
+                        fail("unterminated CDATA section");
+                    text_.push_back(static_cast<char>(d));
+                    if (text_.size() >= 3 && text_.compare(text_.size() - 3, 3, "]]>") == 0) {
+                        text_.resize(text_.size() - 3);
+                        break;
+                    }
+                }
+                return Event::Text;
+            } else {
+                std::string keyword = name();
+                if (keyword == "DOCTYPE")
+                    doctype();
+                else
+                    skipUntil(">");
+            }
+        } else if (c == '/') {
+            get();
+            endTag();
+            return Event::EndElement;
+        } else {
+            startTag();
+            return Event::StartElement;
+        }
+    }
+}
+
+
+}
+
+}
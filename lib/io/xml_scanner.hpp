@@ -0,0 +1,99 @@
+#ifndef XML_SCANNER_HPP
+#define XML_SCANNER_HPP
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "file_io.hpp"
+
+
+namespace ista
+{
+
+namespace io
+{
+
+
+struct XmlAttribute
+{
+    std::string qname;
+    std::string ns;
+    std::string local;
+    std::string value;
+};
+
+// Pull-based, namespace-aware XML tokenizer. It understands exactly what
+// RDF/XML documents in the wild use: elements, attributes, character data,
+// CDATA, comments, processing instructions and internal DTD entity
+// declarations (as in `<!ENTITY owl "http://www.w3.org/2002/07/owl#">`).
+class XmlScanner
+{
+public:
+    enum class Event
+    {
+        StartElement,
+        EndElement,
+        Text,
+        End,
+    };
+
+    explicit XmlScanner(InputFile& in) : in_(in) {}
+
+    Event next();
+
+    // Valid after StartElement/EndElement.
+    const std::string& qname() const { return qname_; }
+    const std::string& ns() const { return ns_; }
+    const std::string& local() const { return local_; }
+    // Valid after StartElement.
+    const std::vector<XmlAttribute>& attributes() const { return attributes_; }
+    bool selfClosing() const { return self_closing_; }
+    // Valid after Text.
+    const std::string& text() const { return text_; }
+
+    std::uint64_t line() const { return line_; }
+
+private:
+    int get()
+    {
+        int c = in_.get();
+        if (c == '\n')
+            ++line_;
+        return c;
+    }
+    int peek() { return in_.peek(); }
+    [[noreturn]] void fail(const std::string& message);
+
+    void skipUntil(const char* terminator);
+    void skipSpace();
+    std::string name();
+    void entity(std::string& out);
+    void doctype();
+    void startTag();
+    void endTag();
+    void resolve(const std::string& qname, bool is_attribute, std::string& ns, std::string& local);
+
+    InputFile& in_;
+    std::uint64_t line_ = 1;
+    std::string qname_;
+    std::string ns_;
+    std::string local_;
+    std::string text_;
+    std::vector<XmlAttribute> attributes_;
+    bool self_closing_ = false;
+    bool pending_end_ = false;
+
+    std::vector<std::pair<std::string, std::string>> bindings_;
+    std::vector<std::size_t> scope_marks_;
+    std::vector<std::string> open_elements_;
+    std::unordered_map<std::string, std::string> entities_;
+};
+
+
+}
+
+}
+
+#endif
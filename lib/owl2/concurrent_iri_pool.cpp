@@ -0,0 +1,165 @@
+#include "concurrent_iri_pool.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "util/hash.hpp"
+
+namespace ista
+{
+
+namespace owl2
+{
+
+
+static constexpr std::size_t ARENA_BLOCK = 64 * 1024;
+
+
+ConcurrentIriPool::Table::Table(std::size_t slot_count)
+    : mask(slot_count - 1), slots(new std::atomic<std::uint64_t>[slot_count])
+{
+    for (std::size_t i = 0; i < slot_count; ++i)
+        slots[i].store(EMPTY, std::memory_order_relaxed);
+}
+
+ConcurrentIriPool::ConcurrentIriPool()
+{
+    for (Shard& shard : shards_) {
+        shard.tables.push_back(std::make_unique<Table>(256));
+        shard.table.store(shard.tables.back().get(), std::memory_order_release);
+    }
+}
+
+ConcurrentIriPool::~ConcurrentIriPool()
+{
+    for (auto& segment : segments_)
+        delete[] segment.load();
+}
+
+std::size_t ConcurrentIriPool::byteSize() const
+{
+    std::size_t total = 0;
+    for (const Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(shard.insert_mutex));
+        total += shard.bytes;
+    }
+    return total;
+}
+
+ConcurrentIriPool::Entry& ConcurrentIriPool::slotFor(TermId id)
+{
+    std::uint64_t n = std::uint64_t(id) + (std::uint64_t(1) << FIRST_SEGMENT_BITS);
+    unsigned segment = 63 - __builtin_clzll(n) - FIRST_SEGMENT_BITS;
+    Entry* entries = segments_[segment].load(std::memory_order_acquire);
+    if (!entries) {
+        // Threads in different shards can race to create a segment; one wins.
+        Entry* fresh = new Entry[std::size_t(1) << (segment + FIRST_SEGMENT_BITS)];
+        if (segments_[segment].compare_exchange_strong(entries, fresh, std::memory_order_acq_rel))
+            entries = fresh;
+        else
+            delete[] fresh;
+    }
+    return entries[n - (std::uint64_t(1) << (segment + FIRST_SEGMENT_BITS))];
+}
+
+TermId ConcurrentIriPool::probe(const Table& table, std::uint64_t h, std::string_view iri) const
+{
+    std::uint64_t tag = tagOf(h);
+    for (std::size_t i = h & table.mask;; i = (i + 1) & table.mask) {
+        std::uint64_t slot = table.slots[i].load(std::memory_order_acquire);
+        if (slot == EMPTY)
+            return NO_TERM;
+        if ((slot >> 32) == tag) {
+            TermId id = static_cast<TermId>(slot);
+            if (at(id) == iri)
+                return id;
+        }
+    }
+}
+
+TermId ConcurrentIriPool::find(std::string_view iri) const
+{
+    std::uint64_t h = util::hashBytes(iri);
+    const Shard& shard = shards_[h >> (64 - SHARD_BITS)];
+    return probe(*shard.table.load(std::memory_order_acquire), h, iri);
+}
+
+TermId ConcurrentIriPool::intern(std::string_view iri)
+{
+    std::uint64_t h = util::hashBytes(iri);
+    Shard& shard = shards_[h >> (64 - SHARD_BITS)];
+    // Most calls in real data are repeats; answer them without the lock.
+    TermId id = probe(*shard.table.load(std::memory_order_acquire), h, iri);
+    if (id != NO_TERM)
+        return id;
+
+    std::lock_guard<std::mutex> lock(shard.insert_mutex);
+    Table& table = *shard.table.load(std::memory_order_relaxed);
+    std::uint64_t tag = tagOf(h);
+    std::size_t i = h & table.mask;
+    for (;; i = (i + 1) & table.mask) {
+        std::uint64_t slot = table.slots[i].load(std::memory_order_relaxed);
+        if (slot == EMPTY)
+            break;
+        if ((slot >> 32) == tag && at(static_cast<TermId>(slot)) == iri)
+            return static_cast<TermId>(slot);
+    }
+
+    std::uint32_t next = next_id_.load(std::memory_order_relaxed);
+    do {
+        if (next >= LITERAL_BIT)
+            throw std::runtime_error("IRI pool is full");
+    } while (!next_id_.compare_exchange_weak(next, next + 1, std::memory_order_acq_rel));
+    id = next;
+    slotFor(id) = Entry{store(shard, iri), iri.size()};
+    table.slots[i].store(tag << 32 | id, std::memory_order_release);
+
+    if (++shard.count * 2 > table.mask + 1)
+        grow(shard);
+    return id;
+}
+
+const char* ConcurrentIriPool::store(Shard& shard, std::string_view iri)
+{
+    shard.bytes += iri.size();
+    if (iri.size() > shard.block_left) {
+        if (iri.size() > ARENA_BLOCK / 4) {
+            shard.blocks.emplace_back(new char[iri.size()]);
+            std::memcpy(shard.blocks.back().get(), iri.data(), iri.size());
+            return shard.blocks.back().get();
+        }
+        shard.blocks.emplace_back(new char[ARENA_BLOCK]);
+        shard.block_pos = shard.blocks.back().get();
+        shard.block_left = ARENA_BLOCK;
+    }
+    char* p = shard.block_pos;
+    std::memcpy(p, iri.data(), iri.size());
+    shard.block_pos += iri.size();
+    shard.block_left -= iri.size();
+    return p;
+}
+
+void ConcurrentIriPool::grow(Shard& shard)
+{
+    const Table& old = *shard.table.load(std::memory_order_relaxed);
+    auto table = std::make_unique<Table>((old.mask + 1) * 2);
+    for (std::size_t i = 0; i <= old.mask; ++i) {
+        std::uint64_t slot = old.slots[i].load(std::memory_order_relaxed);
+        if (slot == EMPTY)
+            continue;
+        // The tag leaves out the low bits of the hash that pick the slot, so
+        // the hash is recomputed here.
+        std::uint64_t h = util::hashBytes(at(static_cast<TermId>(slot)));
+        std::size_t j = h & table->mask;
+        while (table->slots[j].load(std::memory_order_relaxed) != EMPTY)
+            j = (j + 1) & table->mask;
+        table->slots[j].store(slot, std::memory_order_relaxed);
+    }
+    shard.table.store(table.get(), std::memory_order_release);
+    shard.tables.push_back(std::move(table));
+}
+
+
+}
+
+}
@@ -0,0 +1,114 @@
+#ifndef CONCURRENT_IRI_POOL_HPP
+#define CONCURRENT_IRI_POOL_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "term.hpp"
+
+
+namespace ista
+{
+
+namespace owl2
+{
+
+
+// IriPool for many threads at once. The table is split into shards by hash;
+// lookups probe a shard without locking, and inserts take only that shard's
+// lock, so threads interning different IRIs rarely meet. Strings are copied
+// into per-shard arenas and never move, so at() can hand out views freely.
+//
+// Ids are dense but their order depends on thread timing. An id returned to
+// one thread may be passed to at() on another once the two have synchronized
+// (a join, a queue, an atomic flag); ids found by find() are always safe.
+class ConcurrentIriPool
+{
+public:
+    ConcurrentIriPool();
+    ~ConcurrentIriPool();
+    ConcurrentIriPool(const ConcurrentIriPool&) = delete;
+    ConcurrentIriPool& operator=(const ConcurrentIriPool&) = delete;
+
+    TermId intern(std::string_view iri);
+    // Returns NO_TERM if the IRI has not been interned.
+    TermId find(std::string_view iri) const;
+    std::string_view at(TermId id) const
+    {
+        const Entry& e = entry(id);
+        return std::string_view(e.data, e.size);
+    }
+
+    std::size_t size() const { return next_id_.load(std::memory_order_acquire); }
+    std::size_t byteSize() const;
+
+private:
+    static constexpr unsigned SHARD_BITS = 6;
+    static constexpr std::size_t SHARD_COUNT = std::size_t(1) << SHARD_BITS;
+    static constexpr unsigned FIRST_SEGMENT_BITS = 12;
+    static constexpr std::size_t SEGMENT_COUNT = 33 - FIRST_SEGMENT_BITS;
+
+    struct Entry
+    {
+        const char* data;
+        std::size_t size;
+    };
+
+    // Slots pack a 32-bit hash tag above the id; EMPTY marks a free slot.
+    // The top SHARD_BITS of the hash pick the shard and so are the same for
+    // every IRI in it; the tag is the 32 bits below them, and the slot index
+    // comes from the low bits.
+    static constexpr std::uint64_t EMPTY = ~std::uint64_t(0);
+    static std::uint64_t tagOf(std::uint64_t h) { return (h >> (32 - SHARD_BITS)) & 0xFFFFFFFFu; }
+
+    struct Table
+    {
+        explicit Table(std::size_t slot_count);
+        std::size_t mask;
+        std::unique_ptr<std::atomic<std::uint64_t>[]> slots;
+    };
+
+    struct alignas(64) Shard
+    {
+        std::atomic<Table*> table{nullptr};
+        std::mutex insert_mutex;
+        std::size_t count = 0;
+        // Outgrown tables stay alive because lock-free readers may still be
+        // probing them; together they are smaller than the live table.
+        std::vector<std::unique_ptr<Table>> tables;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char* block_pos = nullptr;
+        std::size_t block_left = 0;
+        std::size_t bytes = 0;
+    };
+
+    // Entries live in segments that double in size, so growing the id space
+    // never moves an entry that another thread may be reading.
+    const Entry& entry(TermId id) const
+    {
+        std::uint64_t n = std::uint64_t(id) + (std::uint64_t(1) << FIRST_SEGMENT_BITS);
+        unsigned segment = 63 - __builtin_clzll(n) - FIRST_SEGMENT_BITS;
+        return segments_[segment].load(std::memory_order_acquire)[n - (std::uint64_t(1) << (segment + FIRST_SEGMENT_BITS))];
+    }
+    Entry& slotFor(TermId id);
+
+    TermId probe(const Table& table, std::uint64_t h, std::string_view iri) const;
+    const char* store(Shard& shard, std::string_view iri);
+    void grow(Shard& shard);
+
+    std::array<Shard, SHARD_COUNT> shards_;
+    std::array<std::atomic<Entry*>, SEGMENT_COUNT> segments_{};
+    std::atomic<std::uint32_t> next_id_{0};
+};
+
+
+}
+
+}
+
+#endif
@@ -10,6 +10,8 @@ struct IRI
     std::string abbreviatedIRI;
     std::string baseIRI;
     
+    IRI() = default;
+
     IRI(std::string base_iri);
     
     IRI(std::string base_iri, std::string prefix_name);
@@ -0,0 +1,160 @@
+#include "iri_dictionary.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "util/trace.hpp"
+
+namespace ista
+{
+
+namespace owl2
+{
+
+
+namespace
+{
+
+void putVarint(std::vector<char>& out, std::uint64_t v)
+{
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+std::uint64_t getVarint(const char*& p)
+{
+    std::uint64_t v = 0;
+    for (unsigned shift = 0;; shift += 7) {
+        auto byte = static_cast<unsigned char>(*p++);
+        v |= std::uint64_t(byte & 0x7F) << shift;
+        if (byte < 0x80)
+            return v;
+    }
+}
+
+std::size_t sharedPrefix(std::string_view a, std::string_view b)
+{
+    std::size_t n = std::min(a.size(), b.size());
+    std::size_t i = 0;
+    while (i < n && a[i] == b[i])
+        ++i;
+    return i;
+}
+
+}
+
+
+IriDictionary::Parts IriDictionary::build(const IriPool& iris)
+{
+    ISTA_TRACE_SCOPE("IriDictionary::build");
+    std::size_t n = iris.size();
+    Parts parts;
+    parts.ids.resize(n);
+    for (std::size_t id = 0; id < n; ++id)
+        parts.ids[id] = static_cast<TermId>(id);
+    std::sort(parts.ids.begin(), parts.ids.end(), [&](TermId a, TermId b) { return iris.at(a) < iris.at(b); });
+    parts.ranks.resize(n);
+    for (std::size_t rank = 0; rank < n; ++rank)
+        parts.ranks[parts.ids[rank]] = static_cast<TermId>(rank);
+
+    parts.bytes.reserve(iris.byteSize() / 2);
+    parts.buckets.reserve((n + BUCKET - 1) / BUCKET + 1);
+    std::string_view previous;
+    for (std::size_t rank = 0; rank < n; ++rank) {
+        std::string_view iri = iris.at(parts.ids[rank]);
+        if (rank % BUCKET == 0) {
+            parts.buckets.push_back(parts.bytes.size());
+            putVarint(parts.bytes, iri.size());
+            parts.bytes.insert(parts.bytes.end(), iri.begin(), iri.end());
+        } else {
+            std::size_t shared = sharedPrefix(previous, iri);
+            putVarint(parts.bytes, shared);
+            putVarint(parts.bytes, iri.size() - shared);
+            parts.bytes.insert(parts.bytes.end(), iri.begin() + shared, iri.end());
+        }
+        previous = iri;
+    }
+    parts.buckets.push_back(parts.bytes.size());
+    return parts;
+}
+
+
+IriDictionary::IriDictionary(std::span<const char> bytes, std::span<const std::uint64_t> buckets,
+                             std::span<const TermId> ranks, std::span<const TermId> ids)
+    : bytes_(bytes), buckets_(buckets), ranks_(ranks), ids_(ids)
+{
+    if (ids_.size() != ranks_.size() || buckets_.size() != (ranks_.size() + BUCKET - 1) / BUCKET + 1
+        || buckets_.back() != bytes_.size())
+        throw std::runtime_error("inconsistent IRI dictionary");
+}
+
+std::string_view IriDictionary::head(std::size_t bucket) const
+{
+    const char* p = bytes_.data() + buckets_[bucket];
+    std::uint64_t length = getVarint(p);
+    return std::string_view(p, length);
+}
+
+TermId IriDictionary::find(std::string_view iri) const
+{
+    if (buckets_.size() < 2)
+        return NO_TERM;
+    std::size_t bucket_count = buckets_.size() - 1;
+    // The last bucket whose head is not after the IRI.
+    std::size_t lo = 0, hi = bucket_count;
+    while (hi - lo > 1) {
+        std::size_t mid = lo + (hi - lo) / 2;
+        if (head(mid) <= iri)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    std::string_view first = head(lo);
+    if (first == iri)
+        return ids_[lo * BUCKET];
+    if (first > iri)
+        return NO_TERM;
+
+    thread_local std::string current;
+    current.assign(first);
+    const char* p = first.data() + first.size();
+    const char* end = bytes_.data() + buckets_[lo + 1];
+    for (std::size_t rank = lo * BUCKET + 1; p < end; ++rank) {
+        std::uint64_t shared = getVarint(p);
+        std::uint64_t length = getVarint(p);
+        current.resize(shared);
+        current.append(p, length);
+        p += length;
+        int c = std::string_view(current).compare(iri);
+        if (c == 0)
+            return ids_[rank];
+        if (c > 0)
+            break;
+    }
+    return NO_TERM;
+}
+
+std::string_view IriDictionary::at(TermId id, std::string& buffer) const
+{
+    std::size_t rank = ranks_[id];
+    std::size_t bucket = rank / BUCKET;
+    std::string_view first = head(bucket);
+    buffer.assign(first);
+    const char* p = first.data() + first.size();
+    for (std::size_t k = bucket * BUCKET; k < rank; ++k) {
+        std::uint64_t shared = getVarint(p);
+        std::uint64_t length = getVarint(p);
+        buffer.resize(shared);
+        buffer.append(p, length);
+        p += length;
+    }
+    return buffer;
+}
+
+
+}
+
+}
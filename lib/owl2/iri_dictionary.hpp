@@ -0,0 +1,79 @@
+#ifndef IRI_DICTIONARY_HPP
+#define IRI_DICTIONARY_HPP
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "iri_pool.hpp"
+#include "term.hpp"
+
+
+namespace ista
+{
+
+namespace owl2
+{
+
+
+// Static IRI dictionary for read-only KBs, built once ingestion is finished;
+// writeSnapshot() stores one when SnapshotOptions::iri_dictionary is set, and
+// Snapshot reads it in place. The IRIs are sorted and front coded in buckets
+// of BUCKET: the first IRI of a bucket is stored whole and each of the others
+// as the length of the prefix it shares with the one before and the remaining
+// suffix. KB IRIs
+// share long namespace prefixes, so this takes a fraction of the pool's
+// bytes. A lookup binary searches the bucket heads and decodes one bucket.
+// Term ids stay the pool's; two permutations map them to sorted ranks and
+// back.
+//
+//   bytes    per bucket: varint len | head | (varint shared | varint len | suffix)...
+//   buckets  u64[ceil(n / BUCKET) + 1], byte position of each bucket and the end
+//   ranks    u32[n], id -> sorted rank
+//   ids      u32[n], sorted rank -> id
+class IriDictionary
+{
+public:
+    static constexpr std::size_t BUCKET = 16;
+
+    // The sections of a built dictionary.
+    struct Parts
+    {
+        std::vector<char> bytes;
+        std::vector<std::uint64_t> buckets;
+        std::vector<TermId> ranks;
+        std::vector<TermId> ids;
+    };
+    static Parts build(const IriPool& iris);
+
+    IriDictionary() = default;
+    // Views the sections, which must outlive the dictionary; throws
+    // std::runtime_error if their sizes disagree.
+    IriDictionary(std::span<const char> bytes, std::span<const std::uint64_t> buckets, std::span<const TermId> ranks,
+                  std::span<const TermId> ids);
+    explicit IriDictionary(const Parts& parts) : IriDictionary(parts.bytes, parts.buckets, parts.ranks, parts.ids) {}
+
+    std::size_t size() const { return ranks_.size(); }
+
+    // Returns NO_TERM if the IRI is not in the dictionary.
+    TermId find(std::string_view iri) const;
+    // Decodes the IRI of `id` into `buffer` and returns a view of it.
+    std::string_view at(TermId id, std::string& buffer) const;
+
+private:
+    std::string_view head(std::size_t bucket) const;
+
+    std::span<const char> bytes_;
+    std::span<const std::uint64_t> buckets_;
+    std::span<const TermId> ranks_;
+    std::span<const TermId> ids_;
+};
+
+
+}
+
+}
+
+#endif
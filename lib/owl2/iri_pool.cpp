@@ -0,0 +1,97 @@
+#include "iri_pool.hpp"
+
+#include "util/hash.hpp"
+
+namespace ista
+{
+
+namespace owl2
+{
+
+
+IriPool::IriPool(std::pmr::memory_resource* resource)
+    : bytes_(resource), offsets_(resource), hashes_(resource), slots_(resource)
+{
+    offsets_.push_back(0);
+    slots_.assign(1024, NO_TERM);
+}
+
+void IriPool::memoryUsage(util::MemoryUsage& out) const
+{
+    out.push_back(util::vectorMemory("iri bytes", bytes_));
+    out.push_back(util::vectorMemory("iri offsets", offsets_));
+    out.push_back(util::vectorMemory("iri hashes", hashes_));
+    util::MemoryComponent index = util::vectorMemory("iri index", slots_);
+    index.size = size() * sizeof(TermId);
+    out.push_back(index);
+}
+
+void IriPool::reserve(std::size_t count, std::size_t bytes)
+{
+    bytes_.reserve(bytes);
+    offsets_.reserve(count + 1);
+    hashes_.reserve(count);
+    std::size_t slot_count = slots_.size();
+    while (slot_count < count * 2)
+        slot_count *= 2;
+    if (slot_count != slots_.size())
+        rehash(slot_count);
+}
+
+TermId IriPool::find(std::string_view iri) const
+{
+    std::uint64_t h = util::hashBytes(iri);
+    std::uint32_t tag = static_cast<std::uint32_t>(h);
+    std::size_t mask = slots_.size() - 1;
+    for (std::size_t i = (h >> 32) & mask;; i = (i + 1) & mask) {
+        TermId id = slots_[i];
+        if (id == NO_TERM)
+            return NO_TERM;
+        if (hashes_[id] == tag && at(id) == iri)
+            return id;
+    }
+}
+
+TermId IriPool::intern(std::string_view iri)
+{
+    std::uint64_t h = util::hashBytes(iri);
+    std::uint32_t tag = static_cast<std::uint32_t>(h);
+    std::size_t mask = slots_.size() - 1;
+    std::size_t i = (h >> 32) & mask;
+    for (;; i = (i + 1) & mask) {
+        TermId id = slots_[i];
+        if (id == NO_TERM)
+            break;
+        if (hashes_[id] == tag && at(id) == iri)
+            return id;
+    }
+
+    TermId id = static_cast<TermId>(size());
+    bytes_.insert(bytes_.end(), iri.begin(), iri.end());
+    offsets_.push_back(bytes_.size());
+    hashes_.push_back(tag);
+    slots_[i] = id;
+
+    // Keep the load factor at or below one half.
+    if (size() * 2 > slots_.size())
+        rehash(slots_.size() * 2);
+    return id;
+}
+
+void IriPool::rehash(std::size_t slot_count)
+{
+    slots_.assign(slot_count, NO_TERM);
+    std::size_t mask = slot_count - 1;
+    for (TermId id = 0; id < size(); ++id) {
+        std::uint64_t h = util::hashBytes(at(id));
+        std::size_t i = (h >> 32) & mask;
+        while (slots_[i] != NO_TERM)
+            i = (i + 1) & mask;
+        slots_[i] = id;
+    }
+}
+
+
+}
+
+}
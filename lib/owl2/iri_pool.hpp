@@ -0,0 +1,62 @@
+#ifndef IRI_POOL_HPP
+#define IRI_POOL_HPP
+
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+#include "term.hpp"
+#include "util/memory.hpp"
+
+
+namespace ista
+{
+
+namespace owl2
+{
+
+
+// Interns IRIs (and blank node labels, stored with their "_:" prefix) into
+// dense ids. Strings are packed into a single byte array and looked up through
+// an open-addressing table of ids, so each IRI costs its bytes plus 16 bytes of
+// bookkeeping rather than a heap-allocated std::string per entry.
+class IriPool
+{
+public:
+    explicit IriPool(std::pmr::memory_resource* resource = &util::subsystemResource(util::Subsystem::Ontology));
+
+    TermId intern(std::string_view iri);
+    // Returns NO_TERM if the IRI has not been interned.
+    TermId find(std::string_view iri) const;
+    std::string_view at(TermId id) const
+    {
+        return std::string_view(bytes_.data() + offsets_[id], offsets_[id + 1] - offsets_[id]);
+    }
+
+    std::size_t size() const { return offsets_.size() - 1; }
+    std::size_t byteSize() const { return bytes_.size(); }
+    void reserve(std::size_t count, std::size_t bytes);
+
+    // Appends the byte array, offsets, hashes and lookup table; the table's
+    // size counts occupied slots.
+    void memoryUsage(util::MemoryUsage& out) const;
+
+    const std::pmr::vector<char>& bytes() const { return bytes_; }
+    const std::pmr::vector<std::uint64_t>& offsets() const { return offsets_; }
+
+private:
+    void rehash(std::size_t slot_count);
+
+    std::pmr::vector<char> bytes_;
+    std::pmr::vector<std::uint64_t> offsets_;
+    std::pmr::vector<std::uint32_t> hashes_;
+    std::pmr::vector<TermId> slots_;
+};
+
+
+}
+
+}
+
+#endif
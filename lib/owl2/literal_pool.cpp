@@ -0,0 +1,116 @@
+#include "literal_pool.hpp"
+
+#include "util/hash.hpp"
+
+namespace ista
+{
+
+namespace owl2
+{
+
+
+LiteralPool::LiteralPool(std::pmr::memory_resource* resource)
+    : bytes_(resource), offsets_(resource), datatypes_(resource), languages_(resource), language_tags_(resource),
+      slots_(resource)
+{
+    offsets_.push_back(0);
+    language_tags_.emplace_back();
+    slots_.assign(1024, NO_TERM);
+}
+
+void LiteralPool::memoryUsage(util::MemoryUsage& out) const
+{
+    out.push_back(util::vectorMemory("literal bytes", bytes_));
+    out.push_back(util::vectorMemory("literal offsets", offsets_));
+    out.push_back(util::vectorMemory("literal datatypes", datatypes_));
+    out.push_back(util::vectorMemory("literal languages", languages_));
+    util::MemoryComponent tags = util::vectorMemory("literal language tags", language_tags_);
+    for (const std::pmr::string& tag : language_tags_) {
+        // Short tags live inside the string object itself.
+        if (tag.capacity() > std::pmr::string().capacity()) {
+            tags.size += tag.size() + 1;
+            tags.capacity += tag.capacity() + 1;
+            tags.overhead += util::allocationOverhead(tag.capacity() + 1);
+        }
+    }
+    out.push_back(tags);
+    util::MemoryComponent index = util::vectorMemory("literal index", slots_);
+    index.size = size() * sizeof(TermId);
+    out.push_back(index);
+}
+
+std::uint32_t LiteralPool::languageIndex(std::string_view language) const
+{
+    // Real data carries a handful of language tags, so a linear scan wins.
+    for (std::uint32_t i = 0; i < language_tags_.size(); ++i)
+        if (language_tags_[i] == language)
+            return i;
+    return NO_TERM;
+}
+
+std::uint64_t LiteralPool::hash(std::string_view lexical, TermId datatype, std::uint32_t language) const
+{
+    return util::hashBytes(lexical, util::mix64((static_cast<std::uint64_t>(datatype) << 32) | language));
+}
+
+TermId LiteralPool::find(std::string_view lexical, TermId datatype, std::string_view language) const
+{
+    std::uint32_t lang = languageIndex(language);
+    if (lang == NO_TERM)
+        return NO_TERM;
+    std::size_t mask = slots_.size() - 1;
+    for (std::size_t i = hash(lexical, datatype, lang) & mask;; i = (i + 1) & mask) {
+        TermId index = slots_[i];
+        if (index == NO_TERM)
+            return NO_TERM;
+        if (datatypes_[index] == datatype && languages_[index] == lang && at(index).lexical == lexical)
+            return index;
+    }
+}
+
+TermId LiteralPool::intern(std::string_view lexical, TermId datatype, std::string_view language)
+{
+    std::uint32_t lang = languageIndex(language);
+    if (lang == NO_TERM) {
+        lang = static_cast<std::uint32_t>(language_tags_.size());
+        language_tags_.emplace_back(language);
+    }
+
+    std::size_t mask = slots_.size() - 1;
+    std::size_t i = hash(lexical, datatype, lang) & mask;
+    for (;; i = (i + 1) & mask) {
+        TermId index = slots_[i];
+        if (index == NO_TERM)
+            break;
+        if (datatypes_[index] == datatype && languages_[index] == lang && at(index).lexical == lexical)
+            return index;
+    }
+
+    TermId index = static_cast<TermId>(size());
+    bytes_.insert(bytes_.end(), lexical.begin(), lexical.end());
+    offsets_.push_back(bytes_.size());
+    datatypes_.push_back(datatype);
+    languages_.push_back(lang);
+    slots_[i] = index;
+
+    if (size() * 2 > slots_.size())
+        rehash(slots_.size() * 2);
+    return index;
+}
+
+void LiteralPool::rehash(std::size_t slot_count)
+{
+    slots_.assign(slot_count, NO_TERM);
+    std::size_t mask = slot_count - 1;
+    for (TermId index = 0; index < size(); ++index) {
+        std::size_t i = hash(at(index).lexical, datatypes_[index], languages_[index]) & mask;
+        while (slots_[i] != NO_TERM)
+            i = (i + 1) & mask;
+        slots_[i] = index;
+    }
+}
+
+
+}
+
+}
@@ -0,0 +1,79 @@
+#ifndef LITERAL_POOL_HPP
+#define LITERAL_POOL_HPP
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "term.hpp"
+#include "util/memory.hpp"
+
+
+namespace ista
+{
+
+namespace owl2
+{
+
+
+struct LiteralRef
+{
+    std::string_view lexical;
+    TermId datatype;            // an id in the IRI pool
+    std::string_view language;  // empty unless the literal is language-tagged
+};
+
+
+// Column store for literal values. Identical literals (same lexical form,
+// datatype and language tag) are interned to the same index; the lexical forms
+// are packed into one byte array and datatypes/languages are parallel columns.
+class LiteralPool
+{
+public:
+    explicit LiteralPool(std::pmr::memory_resource* resource = &util::subsystemResource(util::Subsystem::Ontology));
+
+    TermId intern(std::string_view lexical, TermId datatype, std::string_view language = {});
+    TermId find(std::string_view lexical, TermId datatype, std::string_view language = {}) const;
+    LiteralRef at(TermId index) const
+    {
+        return LiteralRef{
+            std::string_view(bytes_.data() + offsets_[index], offsets_[index + 1] - offsets_[index]),
+            datatypes_[index],
+            language_tags_[languages_[index]]
+        };
+    }
+
+    std::size_t size() const { return datatypes_.size(); }
+    std::size_t byteSize() const { return bytes_.size(); }
+
+    const std::pmr::vector<char>& bytes() const { return bytes_; }
+    const std::pmr::vector<std::uint64_t>& offsets() const { return offsets_; }
+    const std::pmr::vector<TermId>& datatypes() const { return datatypes_; }
+    const std::pmr::vector<std::uint32_t>& languages() const { return languages_; }
+    const std::pmr::vector<std::pmr::string>& languageTags() const { return language_tags_; }
+
+    // Appends the lexical bytes, each column and the lookup table; the
+    // language tags include their out-of-line string buffers.
+    void memoryUsage(util::MemoryUsage& out) const;
+
+private:
+    std::uint32_t languageIndex(std::string_view language) const;
+    std::uint64_t hash(std::string_view lexical, TermId datatype, std::uint32_t language) const;
+    void rehash(std::size_t slot_count);
+
+    std::pmr::vector<char> bytes_;
+    std::pmr::vector<std::uint64_t> offsets_;
+    std::pmr::vector<TermId> datatypes_;
+    std::pmr::vector<std::uint32_t> languages_;
+    std::pmr::vector<std::pmr::string> language_tags_;  // index 0 is "no language"
+    std::pmr::vector<TermId> slots_;
+};
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,152 @@
+#include "ontology.hpp"
+
+#include <string>
+
+#include "util/numa.hpp"
+#include "vocabulary.hpp"
+
+namespace ista
+{
+
+namespace owl2
+{
+
+
+const char* axiomKindName(AxiomKind kind)
+{
+    switch (kind) {
+    case AxiomKind::Declaration: return "Declaration";
+    case AxiomKind::ClassAssertion: return "ClassAssertion";
+    case AxiomKind::ObjectPropertyAssertion: return "ObjectPropertyAssertion";
+    case AxiomKind::DataPropertyAssertion: return "DataPropertyAssertion";
+    case AxiomKind::AnnotationAssertion: return "AnnotationAssertion";
+    case AxiomKind::SchemaAxiom: return "SchemaAxiom";
+    }
+    return "Unknown";
+}
+
+AxiomKind classifyTriple(std::string_view predicate, std::string_view object, bool object_is_literal)
+{
+    if (object_is_literal)
+        return vocab::isBuiltin(predicate) ? AxiomKind::AnnotationAssertion : AxiomKind::DataPropertyAssertion;
+    if (predicate == vocab::RDF_TYPE) {
+        if (vocab::isDeclarationType(object))
+            return AxiomKind::Declaration;
+        return vocab::isBuiltin(object) ? AxiomKind::SchemaAxiom : AxiomKind::ClassAssertion;
+    }
+    return vocab::isBuiltin(predicate) ? AxiomKind::SchemaAxiom : AxiomKind::ObjectPropertyAssertion;
+}
+
+
+Ontology::Ontology()
+    : Ontology(defaultResource())
+{
+}
+
+Ontology::Ontology(std::pmr::memory_resource* resource)
+    : iris_(resource), literals_(resource),
+      axioms_{std::pmr::vector<TripleRow>(resource), std::pmr::vector<TripleRow>(resource),
+              std::pmr::vector<TripleRow>(resource), std::pmr::vector<TripleRow>(resource),
+              std::pmr::vector<TripleRow>(resource), std::pmr::vector<TripleRow>(resource)},
+      iri_flags_(resource)
+{
+    rdf_type_ = iris_.intern(vocab::RDF_TYPE);
+    xsd_string_ = iris_.intern(vocab::XSD_STRING);
+    rdf_lang_string_ = iris_.intern(vocab::RDF_LANG_STRING);
+    owl_version_iri_ = iris_.intern(vocab::OWL_VERSION_IRI);
+}
+
+Ontology::Ontology(IRI ontology_iri, IRI version_iri)
+    : Ontology()
+{
+    this->ontology_iri = ontology_iri;
+    this->version_iri = version_iri;
+}
+
+std::uint8_t Ontology::flags(TermId id)
+{
+    if (id >= iri_flags_.size()) {
+        std::size_t old_size = iri_flags_.size();
+        iri_flags_.resize(iris_.size());
+        for (std::size_t i = old_size; i < iri_flags_.size(); ++i) {
+            std::string_view s = iris_.at(static_cast<TermId>(i));
+            std::uint8_t f = 0;
+            if (vocab::isBuiltin(s))
+                f |= BUILTIN;
+            if (vocab::isDeclarationType(s))
+                f |= DECLARATION_TYPE;
+            if (s == vocab::OWL_ONTOLOGY)
+                f |= ONTOLOGY_TYPE;
+            iri_flags_[i] = f;
+        }
+    }
+    return iri_flags_[id];
+}
+
+AxiomKind Ontology::classify(TermId predicate, TermId object)
+{
+    if (isLiteral(object))
+        return (flags(predicate) & BUILTIN) ? AxiomKind::AnnotationAssertion : AxiomKind::DataPropertyAssertion;
+    if (predicate == rdf_type_) {
+        std::uint8_t f = flags(object);
+        if (f & DECLARATION_TYPE)
+            return AxiomKind::Declaration;
+        return (f & BUILTIN) ? AxiomKind::SchemaAxiom : AxiomKind::ClassAssertion;
+    }
+    return (flags(predicate) & BUILTIN) ? AxiomKind::SchemaAxiom : AxiomKind::ObjectPropertyAssertion;
+}
+
+AxiomKind Ontology::addAxiom(TermId subject, TermId predicate, TermId object)
+{
+    AxiomKind kind = classify(predicate, object);
+    if (!isLiteral(object)) {
+        if (predicate == rdf_type_) {
+            if ((flags(object) & ONTOLOGY_TYPE) && ontology_iri.baseIRI.empty())
+                ontology_iri = IRI(std::string(iris_.at(subject)));
+        } else if (predicate == owl_version_iri_ && version_iri.baseIRI.empty()) {
+            version_iri = IRI(std::string(iris_.at(object)));
+        }
+    }
+    axioms_[static_cast<std::size_t>(kind)].push_back(TripleRow{subject, predicate, object});
+    return kind;
+}
+
+std::size_t Ontology::axiomCount() const
+{
+    std::size_t count = 0;
+    for (const auto& table : axioms_)
+        count += table.size();
+    return count;
+}
+
+util::MemoryUsage Ontology::memoryUsage() const
+{
+    util::MemoryUsage usage;
+    iris_.memoryUsage(usage);
+    literals_.memoryUsage(usage);
+    for (std::size_t k = 0; k < AXIOM_KIND_COUNT; ++k)
+        usage.push_back(util::vectorMemory(std::string(axiomKindName(static_cast<AxiomKind>(k))) + " table", axioms_[k]));
+    usage.push_back(util::vectorMemory("iri flags", iri_flags_));
+    return usage;
+}
+
+void Ontology::placeOnNodes() const
+{
+    for (const auto& table : axioms_)
+        util::distributeMemory(table.data(), table.size() * sizeof(TripleRow));
+    auto interleave = [](const auto& column) {
+        util::interleaveMemory(column.data(), column.size() * sizeof(*column.data()));
+    };
+    interleave(iris_.bytes());
+    interleave(iris_.offsets());
+    interleave(literals_.bytes());
+    interleave(literals_.offsets());
+    interleave(literals_.datatypes());
+    interleave(literals_.languages());
+    interleave(iri_flags_);
+}
+
+
+}
+
+}
@@ -0,0 +1,110 @@
+#ifndef ONTOLOGY_HPP
+#define ONTOLOGY_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+#include "iri.hpp"
+#include "iri_pool.hpp"
+#include "literal_pool.hpp"
+#include "term.hpp"
+
+
+namespace ista
+{
+
+namespace owl2
+{
+
+
+// Classifies a triple by shape alone, without consulting declarations, so the
+// result does not depend on the order in which triples arrive.
+AxiomKind classifyTriple(std::string_view predicate, std::string_view object, bool object_is_literal);
+
+
+class Ontology
+{   
+public:
+    Ontology();
+    // Every pool and table allocates from `resource`, e.g. a monotonic arena
+    // for a KB that is built once and then only read.
+    explicit Ontology(std::pmr::memory_resource* resource);
+    Ontology(IRI ontology_iri, IRI version_iri);
+
+    // The Ontology subsystem's tracking resource.
+    static std::pmr::memory_resource* defaultResource()
+    {
+        return &util::subsystemResource(util::Subsystem::Ontology);
+    }
+
+    IRI ontology_iri;
+    IRI version_iri;
+
+    TermId internIri(std::string_view iri) { return iris_.intern(iri); }
+    TermId internLiteral(std::string_view lexical, TermId datatype, std::string_view language = {})
+    {
+        return makeLiteralId(literals_.intern(lexical, datatype, language));
+    }
+    TermId findIri(std::string_view iri) const { return iris_.find(iri); }
+
+    std::string_view iri(TermId id) const { return iris_.at(id); }
+    LiteralRef literal(TermId id) const { return literals_.at(literalIndex(id)); }
+
+    // Adds a triple to the table matching its shape and returns that kind.
+    AxiomKind addAxiom(TermId subject, TermId predicate, TermId object);
+    // The table addAxiom would pick, without adding anything.
+    AxiomKind classify(TermId predicate, TermId object);
+    void addAxiom(AxiomKind kind, const TripleRow& row) { axioms_[static_cast<std::size_t>(kind)].push_back(row); }
+
+    const std::pmr::vector<TripleRow>& axioms(AxiomKind kind) const { return axioms_[static_cast<std::size_t>(kind)]; }
+    std::pmr::vector<TripleRow>& axioms(AxiomKind kind) { return axioms_[static_cast<std::size_t>(kind)]; }
+    std::size_t axiomCount() const;
+
+    std::size_t iriCount() const { return iris_.size(); }
+    std::size_t literalCount() const { return literals_.size(); }
+    const IriPool& iris() const { return iris_; }
+    const LiteralPool& literals() const { return literals_; }
+    std::pmr::memory_resource* resource() const { return iri_flags_.get_allocator().resource(); }
+
+    // Bytes held by each term pool column, lookup table and axiom table.
+    util::MemoryUsage memoryUsage() const;
+
+    // NUMA placement once loading is done: each axiom table is split across
+    // the nodes in the slices util::parallelChunks() scans it in, and the
+    // term pools, which every thread reads at random, are interleaved.
+    void placeOnNodes() const;
+
+    TermId rdfType() const { return rdf_type_; }
+    TermId xsdString() const { return xsd_string_; }
+    TermId rdfLangString() const { return rdf_lang_string_; }
+
+private:
+    enum IriFlags : std::uint8_t
+    {
+        BUILTIN = 1,
+        DECLARATION_TYPE = 2,
+        ONTOLOGY_TYPE = 4,
+    };
+
+    std::uint8_t flags(TermId id);
+
+    IriPool iris_;
+    LiteralPool literals_;
+    std::array<std::pmr::vector<TripleRow>, AXIOM_KIND_COUNT> axioms_;
+    std::pmr::vector<std::uint8_t> iri_flags_;
+
+    TermId rdf_type_;
+    TermId xsd_string_;
+    TermId rdf_lang_string_;
+    TermId owl_version_iri_;
+};
+
+
+}
+
+}
+
+#endif
@@ -2,12 +2,12 @@
 #define OWL2_HPP
 
 #include <string>
-#include <unordered_set>
 #include <ostream>
 
 #include "iri.hpp"
 #include "axiom.hpp"
 #include "entity.hpp"
+#include "ontology.hpp"
 
 
 namespace ista
@@ -23,18 +23,6 @@ struct Annotation
 };
 
 
-class Ontology
-{   
-public:
-    Ontology(IRI ontology_iri, IRI version_iri);
-
-    IRI ontology_iri;
-    IRI version_iri;
-private:
-    std::unordered_set<Axiom>* axioms;
-};
-
-
 }
 
 }
@@ -0,0 +1,70 @@
+#ifndef TERM_HPP
+#define TERM_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "util/hash.hpp"
+
+
+namespace ista
+{
+
+namespace owl2
+{
+
+
+// Every IRI, blank node and literal stored in an Ontology is referred to by a
+// 32-bit id. IRIs and blank nodes share one id space (the IRI pool); literals
+// live in a separate pool and are marked by the high bit.
+using TermId = std::uint32_t;
+
+constexpr TermId LITERAL_BIT = 0x80000000u;
+constexpr TermId NO_TERM = 0xFFFFFFFFu;
+
+inline bool isLiteral(TermId id) { return (id & LITERAL_BIT) != 0 && id != NO_TERM; }
+inline TermId literalIndex(TermId id) { return id & ~LITERAL_BIT; }
+inline TermId makeLiteralId(TermId index) { return index | LITERAL_BIT; }
+
+
+// Axioms are stored as (subject, predicate, object) rows in one table per
+// kind. The kind is derived from the shape of the triple when it is added, so
+// every RDF triple lands in exactly one table and round-trips losslessly.
+enum class AxiomKind : std::uint8_t
+{
+    Declaration,
+    ClassAssertion,
+    ObjectPropertyAssertion,
+    DataPropertyAssertion,
+    AnnotationAssertion,
+    SchemaAxiom,
+};
+
+constexpr std::size_t AXIOM_KIND_COUNT = 6;
+
+const char* axiomKindName(AxiomKind kind);
+
+
+struct TripleRow
+{
+    TermId subject;
+    TermId predicate;
+    TermId object;
+
+    friend bool operator==(const TripleRow&, const TripleRow&) = default;
+};
+
+struct TripleRowHash
+{
+    std::size_t operator()(const TripleRow& r) const
+    {
+        return util::mix64((std::uint64_t(r.subject) << 32 | r.predicate) ^ util::mix64(r.object));
+    }
+};
+
+
+}
+
+}
+
+#endif
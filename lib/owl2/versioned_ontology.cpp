@@ -0,0 +1,318 @@
+#include "versioned_ontology.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "util/hash.hpp"
+#include "vocabulary.hpp"
+
+namespace ista
+{
+
+namespace owl2
+{
+
+namespace detail
+{
+
+
+template <typename T>
+Column<T>::~Column()
+{
+    std::free(data_);
+}
+
+template <typename T>
+void Column<T>::append(const T* values, std::size_t count, std::vector<void*>& outgrown)
+{
+    if (size_ + count > capacity_) {
+        std::size_t capacity = std::max<std::size_t>(capacity_ * 2, 1024 / sizeof(T) + 1);
+        while (capacity < size_ + count)
+            capacity *= 2;
+        T* data = static_cast<T*>(std::malloc(capacity * sizeof(T)));
+        if (!data)
+            throw std::bad_alloc();
+        if (size_)
+            std::memcpy(data, data_, size_ * sizeof(T));
+        if (data_)
+            outgrown.push_back(data_);
+        data_ = data;
+        capacity_ = capacity;
+    }
+    std::memcpy(data_ + size_, values, count * sizeof(T));
+    size_ += count;
+}
+
+template class Column<char>;
+template class Column<std::uint32_t>;
+template class Column<std::uint64_t>;
+template class Column<std::string_view>;
+template class Column<TripleRow>;
+
+
+}
+
+
+std::size_t OntologyView::axiomCount() const
+{
+    std::size_t count = 0;
+    for (const auto& table : data_->axioms)
+        count += table.size();
+    return count;
+}
+
+TermId OntologyView::findIri(std::string_view iri) const
+{
+    std::uint64_t h = util::hashBytes(iri);
+    std::uint32_t tag = static_cast<std::uint32_t>(h);
+    std::size_t mask = data_->iri_slot_mask;
+    for (std::size_t i = (h >> 32) & mask;; i = (i + 1) & mask) {
+        TermId id = std::atomic_ref<TermId>(data_->iri_slots[i]).load(std::memory_order_relaxed);
+        // Slots filled after this version was committed were empty when it
+        // was, so the probe sequence for an older IRI ends there.
+        if (id == NO_TERM || id >= data_->iri_count)
+            return NO_TERM;
+        if (data_->iri_hashes[id] == tag && this->iri(id) == iri)
+            return id;
+    }
+}
+
+
+VersionedOntology::VersionedOntology()
+{
+    std::uint64_t zero = 0;
+    iri_offsets_.push_back(zero, outgrown_);
+    literal_offsets_.push_back(zero, outgrown_);
+    language_storage_.emplace_back();
+    language_tags_.push_back(std::string_view(language_storage_.back()), outgrown_);
+    literal_slots_.assign(1024, NO_TERM);
+    rehashIris(1024);
+
+    rdf_type_ = internIri(vocab::RDF_TYPE);
+    internIri(vocab::XSD_STRING);
+    internIri(vocab::RDF_LANG_STRING);
+    owl_version_iri_ = internIri(vocab::OWL_VERSION_IRI);
+    commit();
+}
+
+VersionedOntology::VersionedOntology(const Ontology& onto)
+    : VersionedOntology()
+{
+    ontology_iri = onto.ontology_iri;
+    version_iri = onto.version_iri;
+    for (TermId id = 0; id < onto.iriCount(); ++id)
+        internIri(onto.iri(id));
+    for (TermId index = 0; index < onto.literalCount(); ++index) {
+        LiteralRef lit = onto.literals().at(index);
+        internLiteral(lit.lexical, lit.datatype, lit.language);
+    }
+    for (std::size_t k = 0; k < AXIOM_KIND_COUNT; ++k) {
+        const auto& rows = onto.axioms(static_cast<AxiomKind>(k));
+        axioms_[k].append(rows.data(), rows.size(), outgrown_);
+    }
+    commit();
+}
+
+VersionedOntology::~VersionedOntology()
+{
+    delete current_.load();
+    std::free(iri_slots_);
+    for (void* p : outgrown_)
+        std::free(p);
+}
+
+OntologyView VersionedOntology::view() const
+{
+    util::EpochManager::Guard guard = epochs_.pin();
+    return OntologyView(std::move(guard), current_.load(std::memory_order_acquire));
+}
+
+TermId VersionedOntology::findIri(std::string_view iri) const
+{
+    std::uint64_t h = util::hashBytes(iri);
+    std::uint32_t tag = static_cast<std::uint32_t>(h);
+    std::size_t mask = iri_slot_count_ - 1;
+    for (std::size_t i = (h >> 32) & mask;; i = (i + 1) & mask) {
+        TermId id = iri_slots_[i];
+        if (id == NO_TERM)
+            return NO_TERM;
+        if (iri_hashes_[id] == tag && this->iri(id) == iri)
+            return id;
+    }
+}
+
+TermId VersionedOntology::internIri(std::string_view iri)
+{
+    std::uint64_t h = util::hashBytes(iri);
+    std::uint32_t tag = static_cast<std::uint32_t>(h);
+    std::size_t mask = iri_slot_count_ - 1;
+    std::size_t i = (h >> 32) & mask;
+    for (;; i = (i + 1) & mask) {
+        TermId id = iri_slots_[i];
+        if (id == NO_TERM)
+            break;
+        if (iri_hashes_[id] == tag && this->iri(id) == iri)
+            return id;
+    }
+
+    TermId id = static_cast<TermId>(iriCount());
+    iri_bytes_.append(iri.data(), iri.size(), outgrown_);
+    iri_offsets_.push_back(static_cast<std::uint64_t>(iri_bytes_.size()), outgrown_);
+    iri_hashes_.push_back(tag, outgrown_);
+    std::uint8_t f = 0;
+    if (vocab::isBuiltin(iri))
+        f |= BUILTIN;
+    if (vocab::isDeclarationType(iri))
+        f |= DECLARATION_TYPE;
+    if (iri == vocab::OWL_ONTOLOGY)
+        f |= ONTOLOGY_TYPE;
+    iri_flags_.push_back(f);
+    // Readers of the committed version may be probing this table; the slot
+    // is published with an atomic store and ignored by versions that predate
+    // the id.
+    std::atomic_ref<TermId>(iri_slots_[i]).store(id, std::memory_order_relaxed);
+
+    if (iriCount() * 2 > iri_slot_count_)
+        rehashIris(iri_slot_count_ * 2);
+    return id;
+}
+
+void VersionedOntology::rehashIris(std::size_t slot_count)
+{
+    // Built off to the side: readers keep probing the old table until the
+    // next version points them at this one.
+    TermId* slots = static_cast<TermId*>(std::malloc(slot_count * sizeof(TermId)));
+    if (!slots)
+        throw std::bad_alloc();
+    std::fill(slots, slots + slot_count, NO_TERM);
+    std::size_t mask = slot_count - 1;
+    for (TermId id = 0; id < iriCount(); ++id) {
+        std::size_t i = (util::hashBytes(iri(id)) >> 32) & mask;
+        while (slots[i] != NO_TERM)
+            i = (i + 1) & mask;
+        slots[i] = id;
+    }
+    if (iri_slots_)
+        outgrown_.push_back(iri_slots_);
+    iri_slots_ = slots;
+    iri_slot_count_ = slot_count;
+}
+
+std::uint32_t VersionedOntology::languageIndex(std::string_view language)
+{
+    for (std::uint32_t i = 0; i < language_storage_.size(); ++i)
+        if (language_storage_[i] == language)
+            return i;
+    language_storage_.emplace_back(language);
+    language_tags_.push_back(std::string_view(language_storage_.back()), outgrown_);
+    return static_cast<std::uint32_t>(language_storage_.size() - 1);
+}
+
+TermId VersionedOntology::internLiteral(std::string_view lexical, TermId datatype, std::string_view language)
+{
+    std::uint32_t lang = languageIndex(language);
+    std::uint64_t h = util::hashBytes(lexical, util::mix64((static_cast<std::uint64_t>(datatype) << 32) | lang));
+    std::size_t mask = literal_slots_.size() - 1;
+    std::size_t i = h & mask;
+    for (;; i = (i + 1) & mask) {
+        TermId index = literal_slots_[i];
+        if (index == NO_TERM)
+            break;
+        if (literal_hashes_[index] == h && literal_datatypes_[index] == datatype && literal_languages_[index] == lang
+            && std::string_view(literal_bytes_.data() + literal_offsets_[index],
+                                literal_offsets_[index + 1] - literal_offsets_[index]) == lexical)
+            return makeLiteralId(index);
+    }
+
+    TermId index = static_cast<TermId>(literalCount());
+    literal_bytes_.append(lexical.data(), lexical.size(), outgrown_);
+    literal_offsets_.push_back(static_cast<std::uint64_t>(literal_bytes_.size()), outgrown_);
+    literal_datatypes_.push_back(datatype, outgrown_);
+    literal_languages_.push_back(lang, outgrown_);
+    literal_hashes_.push_back(h);
+    literal_slots_[i] = index;
+
+    if (literalCount() * 2 > literal_slots_.size())
+        rehashLiterals(literal_slots_.size() * 2);
+    return makeLiteralId(index);
+}
+
+void VersionedOntology::rehashLiterals(std::size_t slot_count)
+{
+    literal_slots_.assign(slot_count, NO_TERM);
+    std::size_t mask = slot_count - 1;
+    for (TermId index = 0; index < literalCount(); ++index) {
+        std::size_t i = literal_hashes_[index] & mask;
+        while (literal_slots_[i] != NO_TERM)
+            i = (i + 1) & mask;
+        literal_slots_[i] = index;
+    }
+}
+
+AxiomKind VersionedOntology::addAxiom(TermId subject, TermId predicate, TermId object)
+{
+    AxiomKind kind;
+    if (isLiteral(object)) {
+        kind = (iri_flags_[predicate] & BUILTIN) ? AxiomKind::AnnotationAssertion : AxiomKind::DataPropertyAssertion;
+    } else if (predicate == rdf_type_) {
+        std::uint8_t f = iri_flags_[object];
+        if (f & DECLARATION_TYPE)
+            kind = AxiomKind::Declaration;
+        else
+            kind = (f & BUILTIN) ? AxiomKind::SchemaAxiom : AxiomKind::ClassAssertion;
+        if ((f & ONTOLOGY_TYPE) && ontology_iri.baseIRI.empty())
+            ontology_iri = IRI(std::string(iri(subject)));
+    } else {
+        kind = (iri_flags_[predicate] & BUILTIN) ? AxiomKind::SchemaAxiom : AxiomKind::ObjectPropertyAssertion;
+        if (predicate == owl_version_iri_ && version_iri.baseIRI.empty())
+            version_iri = IRI(std::string(iri(object)));
+    }
+    axioms_[static_cast<std::size_t>(kind)].push_back(TripleRow{subject, predicate, object}, outgrown_);
+    return kind;
+}
+
+std::uint64_t VersionedOntology::commit()
+{
+    auto* data = new detail::VersionData;
+    data->version = ++version_;
+    data->ontology_iri = ontology_iri.baseIRI;
+    data->version_iri = version_iri.baseIRI;
+
+    data->iri_count = iriCount();
+    data->iri_bytes = iri_bytes_.data();
+    data->iri_offsets = iri_offsets_.data();
+    data->iri_hashes = iri_hashes_.data();
+    data->iri_slots = iri_slots_;
+    data->iri_slot_mask = iri_slot_count_ - 1;
+
+    data->literal_count = literalCount();
+    data->literal_bytes = literal_bytes_.data();
+    data->literal_offsets = literal_offsets_.data();
+    data->literal_datatypes = literal_datatypes_.data();
+    data->literal_languages = literal_languages_.data();
+    data->language_tags = language_tags_.data();
+
+    for (std::size_t k = 0; k < AXIOM_KIND_COUNT; ++k)
+        data->axioms[k] = std::span<const TripleRow>(axioms_[k].data(), axioms_[k].size());
+
+    // The previous version and every buffer it was the last to reference go
+    // out together, once readers pinned before the swap have moved on.
+    const detail::VersionData* old = current_.exchange(data, std::memory_order_acq_rel);
+    if (old || !outgrown_.empty()) {
+        epochs_.retire([old, buffers = std::move(outgrown_)] {
+            delete old;
+            for (void* p : buffers)
+                std::free(p);
+        });
+        outgrown_.clear();
+    }
+    epochs_.collect();
+    return version_;
+}
+
+
+}
+
+}
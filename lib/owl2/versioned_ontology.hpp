@@ -0,0 +1,218 @@
+#ifndef VERSIONED_ONTOLOGY_HPP
+#define VERSIONED_ONTOLOGY_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "literal_pool.hpp"
+#include "ontology.hpp"
+#include "term.hpp"
+#include "util/epoch.hpp"
+
+
+namespace ista
+{
+
+namespace owl2
+{
+
+namespace detail
+{
+
+
+// Append-only array of trivially copyable values. Growing moves the contents
+// to a new buffer; the old one is handed back to the caller, because
+// published versions may still point into it.
+template <typename T>
+class Column
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    Column() = default;
+    Column(const Column&) = delete;
+    Column& operator=(const Column&) = delete;
+    ~Column();
+
+    const T* data() const { return data_; }
+    T* data() { return data_; }
+    std::size_t size() const { return size_; }
+    const T& operator[](std::size_t i) const { return data_[i]; }
+
+    void append(const T* values, std::size_t count, std::vector<void*>& outgrown);
+    void push_back(const T& value, std::vector<void*>& outgrown) { append(&value, 1, outgrown); }
+
+private:
+    T* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+};
+
+
+// Everything a reader needs to see one committed version: raw pointers into
+// the writer's columns and the counts that were valid at commit time. Rows
+// below the counts are never written again, so readers need no locks.
+struct VersionData
+{
+    std::uint64_t version = 0;
+    std::string ontology_iri;
+    std::string version_iri;
+
+    std::size_t iri_count = 0;
+    const char* iri_bytes = nullptr;
+    const std::uint64_t* iri_offsets = nullptr;
+    const std::uint32_t* iri_hashes = nullptr;
+    TermId* iri_slots = nullptr;           // probed with atomic loads
+    std::size_t iri_slot_mask = 0;
+
+    std::size_t literal_count = 0;
+    const char* literal_bytes = nullptr;
+    const std::uint64_t* literal_offsets = nullptr;
+    const TermId* literal_datatypes = nullptr;
+    const std::uint32_t* literal_languages = nullptr;
+    const std::string_view* language_tags = nullptr;
+
+    std::array<std::span<const TripleRow>, AXIOM_KIND_COUNT> axioms;
+};
+
+
+}
+
+
+// A consistent, immutable view of one committed version. Holding a view pins
+// its epoch, so the memory it points into stays valid until it is destroyed;
+// views are cheap to take and never wait for the writer. Exposes the same
+// accessors as Ontology and io::Snapshot.
+class OntologyView
+{
+public:
+    OntologyView(util::EpochManager::Guard guard, const detail::VersionData* data)
+        : guard_(std::move(guard)), data_(data) {}
+    OntologyView(OntologyView&&) = default;
+    OntologyView& operator=(OntologyView&&) = default;
+
+    std::uint64_t version() const { return data_->version; }
+    std::string_view ontologyIri() const { return data_->ontology_iri; }
+    std::string_view versionIri() const { return data_->version_iri; }
+
+    std::string_view iri(TermId id) const
+    {
+        const std::uint64_t* offsets = data_->iri_offsets;
+        return std::string_view(data_->iri_bytes + offsets[id], offsets[id + 1] - offsets[id]);
+    }
+    LiteralRef literal(TermId id) const
+    {
+        TermId index = literalIndex(id);
+        const std::uint64_t* offsets = data_->literal_offsets;
+        return LiteralRef{
+            std::string_view(data_->literal_bytes + offsets[index], offsets[index + 1] - offsets[index]),
+            data_->literal_datatypes[index],
+            data_->language_tags[data_->literal_languages[index]]
+        };
+    }
+    std::span<const TripleRow> axioms(AxiomKind kind) const { return data_->axioms[static_cast<std::size_t>(kind)]; }
+    std::size_t axiomCount() const;
+    std::size_t iriCount() const { return data_->iri_count; }
+    std::size_t literalCount() const { return data_->literal_count; }
+
+    // Hash lookup; returns NO_TERM for IRIs added after this version.
+    TermId findIri(std::string_view iri) const;
+
+private:
+    util::EpochManager::Guard guard_;
+    const detail::VersionData* data_;
+};
+
+
+// Multi-version store for concurrent query and ingest. One writer thread
+// interns terms and appends axioms, then publishes them as a new version with
+// commit(); any number of reader threads take views of the latest committed
+// version at the same time. Terms and axioms are append-only, so a version is
+// a prefix of every later one and publishing is a single pointer swap.
+// Buffers that a version outgrows are reclaimed once no view can reach them.
+class VersionedOntology
+{
+public:
+    VersionedOntology();
+    // Copies `onto` preserving term ids and commits it as version 1.
+    explicit VersionedOntology(const Ontology& onto);
+    ~VersionedOntology();
+    VersionedOntology(const VersionedOntology&) = delete;
+    VersionedOntology& operator=(const VersionedOntology&) = delete;
+
+    // Reader side; safe from any thread.
+    OntologyView view() const;
+
+    // Writer side; one thread at a time. Changes are invisible to readers
+    // until commit().
+    TermId internIri(std::string_view iri);
+    TermId internLiteral(std::string_view lexical, TermId datatype, std::string_view language = {});
+    AxiomKind addAxiom(TermId subject, TermId predicate, TermId object);
+    std::uint64_t commit();
+
+    // Writer-side state of the uncommitted tip.
+    std::string_view iri(TermId id) const
+    {
+        return std::string_view(iri_bytes_.data() + iri_offsets_[id], iri_offsets_[id + 1] - iri_offsets_[id]);
+    }
+    TermId findIri(std::string_view iri) const;
+    std::size_t iriCount() const { return iri_hashes_.size(); }
+    std::size_t literalCount() const { return literal_datatypes_.size(); }
+    std::uint64_t version() const { return version_; }
+    std::size_t pendingReclaim() const { return epochs_.pending(); }
+
+    IRI ontology_iri;
+    IRI version_iri;
+
+private:
+    enum IriFlags : std::uint8_t
+    {
+        BUILTIN = 1,
+        DECLARATION_TYPE = 2,
+        ONTOLOGY_TYPE = 4,
+    };
+
+    void rehashIris(std::size_t slot_count);
+    void rehashLiterals(std::size_t slot_count);
+    std::uint32_t languageIndex(std::string_view language);
+
+    mutable util::EpochManager epochs_;
+    std::atomic<const detail::VersionData*> current_{nullptr};
+    std::uint64_t version_ = 0;
+    std::vector<void*> outgrown_;
+
+    detail::Column<char> iri_bytes_;
+    detail::Column<std::uint64_t> iri_offsets_;
+    detail::Column<std::uint32_t> iri_hashes_;
+    TermId* iri_slots_ = nullptr;
+    std::size_t iri_slot_count_ = 0;
+    std::vector<std::uint8_t> iri_flags_;
+
+    detail::Column<char> literal_bytes_;
+    detail::Column<std::uint64_t> literal_offsets_;
+    detail::Column<TermId> literal_datatypes_;
+    detail::Column<std::uint32_t> literal_languages_;
+    detail::Column<std::string_view> language_tags_;
+    std::deque<std::string> language_storage_;  // backs language_tags_
+    std::vector<std::uint64_t> literal_hashes_;
+    std::vector<TermId> literal_slots_;         // writer only
+
+    std::array<detail::Column<TripleRow>, AXIOM_KIND_COUNT> axioms_;
+
+    TermId rdf_type_;
+    TermId owl_version_iri_;
+};
+
+
+}
+
+}
+
+#endif
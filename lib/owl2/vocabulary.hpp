@@ -0,0 +1,90 @@
+#ifndef VOCABULARY_HPP
+#define VOCABULARY_HPP
+
+#include <string_view>
+
+
+namespace ista
+{
+
+namespace owl2
+{
+
+namespace vocab
+{
+
+
+constexpr std::string_view RDF = "http://www.w3.org/1999/02/22-rdf-syntax-ns#";
+constexpr std::string_view RDFS = "http://www.w3.org/2000/01/rdf-schema#";
+constexpr std::string_view OWL = "http://www.w3.org/2002/07/owl#";
+constexpr std::string_view XSD = "http://www.w3.org/2001/XMLSchema#";
+constexpr std::string_view XML = "http://www.w3.org/XML/1998/namespace";
+
+constexpr std::string_view RDF_TYPE = "http://www.w3.org/1999/02/22-rdf-syntax-ns#type";
+constexpr std::string_view RDF_FIRST = "http://www.w3.org/1999/02/22-rdf-syntax-ns#first";
+constexpr std::string_view RDF_REST = "http://www.w3.org/1999/02/22-rdf-syntax-ns#rest";
+constexpr std::string_view RDF_NIL = "http://www.w3.org/1999/02/22-rdf-syntax-ns#nil";
+constexpr std::string_view RDF_LANG_STRING = "http://www.w3.org/1999/02/22-rdf-syntax-ns#langString";
+constexpr std::string_view RDF_XML_LITERAL = "http://www.w3.org/1999/02/22-rdf-syntax-ns#XMLLiteral";
+constexpr std::string_view RDFS_SUBCLASS_OF = "http://www.w3.org/2000/01/rdf-schema#subClassOf";
+constexpr std::string_view RDFS_SUBPROPERTY_OF = "http://www.w3.org/2000/01/rdf-schema#subPropertyOf";
+constexpr std::string_view RDFS_RANGE = "http://www.w3.org/2000/01/rdf-schema#range";
+constexpr std::string_view RDFS_DOMAIN = "http://www.w3.org/2000/01/rdf-schema#domain";
+constexpr std::string_view RDFS_LABEL = "http://www.w3.org/2000/01/rdf-schema#label";
+constexpr std::string_view OWL_CLASS = "http://www.w3.org/2002/07/owl#Class";
+constexpr std::string_view OWL_THING = "http://www.w3.org/2002/07/owl#Thing";
+constexpr std::string_view OWL_UNION_OF = "http://www.w3.org/2002/07/owl#unionOf";
+constexpr std::string_view OWL_ON_PROPERTY = "http://www.w3.org/2002/07/owl#onProperty";
+constexpr std::string_view OWL_SOME_VALUES_FROM = "http://www.w3.org/2002/07/owl#someValuesFrom";
+constexpr std::string_view OWL_ALL_VALUES_FROM = "http://www.w3.org/2002/07/owl#allValuesFrom";
+constexpr std::string_view OWL_ONTOLOGY = "http://www.w3.org/2002/07/owl#Ontology";
+constexpr std::string_view OWL_OBJECT_PROPERTY = "http://www.w3.org/2002/07/owl#ObjectProperty";
+constexpr std::string_view OWL_DATATYPE_PROPERTY = "http://www.w3.org/2002/07/owl#DatatypeProperty";
+constexpr std::string_view OWL_ANNOTATION_PROPERTY = "http://www.w3.org/2002/07/owl#AnnotationProperty";
+constexpr std::string_view OWL_FUNCTIONAL_PROPERTY = "http://www.w3.org/2002/07/owl#FunctionalProperty";
+constexpr std::string_view OWL_NAMED_INDIVIDUAL = "http://www.w3.org/2002/07/owl#NamedIndividual";
+constexpr std::string_view OWL_VERSION_IRI = "http://www.w3.org/2002/07/owl#versionIRI";
+constexpr std::string_view RDFS_DATATYPE = "http://www.w3.org/2000/01/rdf-schema#Datatype";
+constexpr std::string_view XSD_STRING = "http://www.w3.org/2001/XMLSchema#string";
+constexpr std::string_view XSD_INTEGER = "http://www.w3.org/2001/XMLSchema#integer";
+constexpr std::string_view XSD_DECIMAL = "http://www.w3.org/2001/XMLSchema#decimal";
+constexpr std::string_view XSD_DOUBLE = "http://www.w3.org/2001/XMLSchema#double";
+constexpr std::string_view XSD_BOOLEAN = "http://www.w3.org/2001/XMLSchema#boolean";
+
+
+// True for IRIs in the RDF, RDFS, OWL and XSD namespaces. Triples whose
+// predicate is built in describe the schema (or annotate it) rather than
+// asserting facts about individuals.
+inline bool isBuiltin(std::string_view iri)
+{
+    return iri.starts_with(RDF) || iri.starts_with(RDFS) || iri.starts_with(OWL) || iri.starts_with(XSD);
+}
+
+// True for the rdf:type objects that declare an entity rather than assert
+// class membership.
+inline bool isDeclarationType(std::string_view iri)
+{
+    return iri == OWL_CLASS || iri == OWL_OBJECT_PROPERTY || iri == OWL_DATATYPE_PROPERTY
+        || iri == OWL_ANNOTATION_PROPERTY || iri == OWL_NAMED_INDIVIDUAL || iri == RDFS_DATATYPE;
+}
+
+inline bool isBlank(std::string_view term)
+{
+    return term.starts_with("_:");
+}
+
+// Splits an IRI after its last '#', '/' or ':' into namespace and local name.
+inline std::string_view localName(std::string_view iri)
+{
+    std::size_t pos = iri.find_last_of("#/:");
+    return pos == std::string_view::npos ? iri : iri.substr(pos + 1);
+}
+
+
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,324 @@
+#include "kb_stats.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <unordered_map>
+
+#include "io/snapshot.hpp"
+#include "owl2/ontology.hpp"
+#include "owl2/versioned_ontology.hpp"
+#include "owl2/vocabulary.hpp"
+#include "util/json_writer.hpp"
+#include "util/parallel.hpp"
+
+namespace ista
+{
+
+namespace stats
+{
+
+using owl2::AxiomKind;
+using owl2::TermId;
+using owl2::TripleRow;
+
+
+namespace
+{
+
+// Counts rows per key (the class of a ClassAssertion, the predicate of an
+// ObjectPropertyAssertion). Keys are few, so per-thread hash maps merged at
+// the end beat any shared structure.
+template <typename Kb, typename Rows, typename KeyFn>
+std::vector<TermCount> countBy(const Kb& kb, const Rows& rows, unsigned threads, KeyFn key)
+{
+    std::vector<std::unordered_map<TermId, std::uint64_t>> partial(threads);
+    const TripleRow* data = rows.data();
+    util::parallelChunks(rows.size(), threads, [&](std::size_t begin, std::size_t end, unsigned t) {
+        auto& counts = partial[t];
+        for (std::size_t i = begin; i < end; ++i)
+            ++counts[key(data[i])];
+    });
+    std::unordered_map<TermId, std::uint64_t> merged;
+    for (const auto& counts : partial)
+        for (const auto& [id, n] : counts)
+            merged[id] += n;
+
+    std::vector<TermCount> result;
+    result.reserve(merged.size());
+    for (const auto& [id, n] : merged)
+        result.push_back(TermCount{std::string(kb.iri(id)), n});
+    std::sort(result.begin(), result.end(), [](const TermCount& a, const TermCount& b) {
+        return a.count != b.count ? a.count > b.count : a.iri < b.iri;
+    });
+    return result;
+}
+
+DegreeSummary summarize(const std::vector<std::uint32_t>& degree, const std::vector<std::uint64_t>& is_node,
+                        std::uint64_t node_count, unsigned threads)
+{
+    struct Partial
+    {
+        std::uint64_t max = 0;
+        std::uint64_t sum = 0;
+        std::vector<std::uint64_t> histogram = std::vector<std::uint64_t>(33, 0);
+    };
+    std::vector<Partial> partial(threads);
+    util::parallelChunks(degree.size(), threads, [&](std::size_t begin, std::size_t end, unsigned t) {
+        Partial& p = partial[t];
+        for (std::size_t i = begin; i < end; ++i) {
+            if (!(is_node[i / 64] >> (i % 64) & 1))
+                continue;
+            std::uint32_t d = degree[i];
+            p.max = std::max<std::uint64_t>(p.max, d);
+            p.sum += d;
+            ++p.histogram[d == 0 ? 0 : 32 - __builtin_clz(d)];
+        }
+    });
+    DegreeSummary s;
+    s.log2_histogram.assign(33, 0);
+    std::uint64_t sum = 0;
+    for (const auto& p : partial) {
+        s.max = std::max(s.max, p.max);
+        sum += p.sum;
+        for (std::size_t b = 0; b < p.histogram.size(); ++b)
+            s.log2_histogram[b] += p.histogram[b];
+    }
+    while (s.log2_histogram.size() > 1 && s.log2_histogram.back() == 0)
+        s.log2_histogram.pop_back();
+    s.mean = node_count ? static_cast<double>(sum) / node_count : 0.0;
+    return s;
+}
+
+void markBit(std::vector<std::uint64_t>& bits, TermId id)
+{
+    std::atomic_ref<std::uint64_t>(bits[id / 64]).fetch_or(std::uint64_t(1) << (id % 64), std::memory_order_relaxed);
+}
+
+}
+
+
+template <typename Kb>
+KbStats computeStats(const Kb& kb, unsigned threads)
+{
+    auto start = std::chrono::steady_clock::now();
+    threads = std::max(1u, threads);
+
+    KbStats s;
+    s.iri_count = kb.iriCount();
+    s.literal_count = kb.literalCount();
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k)
+        s.axiom_counts[k] = kb.axioms(static_cast<AxiomKind>(k)).size();
+
+    const auto& class_rows = kb.axioms(AxiomKind::ClassAssertion);
+    const auto& edge_rows = kb.axioms(AxiomKind::ObjectPropertyAssertion);
+    const auto& data_rows = kb.axioms(AxiomKind::DataPropertyAssertion);
+
+    s.class_counts = countBy(kb, class_rows, threads, [](const TripleRow& r) { return r.object; });
+    s.relation_counts = countBy(kb, edge_rows, threads, [](const TripleRow& r) { return r.predicate; });
+
+    // Individuals are the subjects of class assertions plus the endpoints of
+    // object property assertions.
+    std::vector<std::uint64_t> is_node((s.iri_count + 63) / 64, 0);
+    std::vector<std::uint32_t> out_degree(s.iri_count, 0);
+    std::vector<std::uint32_t> in_degree(s.iri_count, 0);
+    util::parallelChunks(class_rows.size(), threads, [&](std::size_t begin, std::size_t end, unsigned) {
+        for (std::size_t i = begin; i < end; ++i)
+            markBit(is_node, class_rows[i].subject);
+    });
+    util::parallelChunks(edge_rows.size(), threads, [&](std::size_t begin, std::size_t end, unsigned) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const TripleRow& r = edge_rows[i];
+            markBit(is_node, r.subject);
+            markBit(is_node, r.object);
+            std::atomic_ref<std::uint32_t>(out_degree[r.subject]).fetch_add(1, std::memory_order_relaxed);
+            std::atomic_ref<std::uint32_t>(in_degree[r.object]).fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+    for (std::uint64_t word : is_node)
+        s.individual_count += __builtin_popcountll(word);
+    s.out_degree = summarize(out_degree, is_node, s.individual_count, threads);
+    s.in_degree = summarize(in_degree, is_node, s.individual_count, threads);
+
+    // Literal coverage: distinct (property, individual) pairs, found by
+    // sorting packed keys rather than keeping a subject set per property.
+    // Properties declared as annotation properties describe the schema, not
+    // the data, and are left out.
+    std::unordered_map<TermId, bool> annotation_properties;
+    for (const TripleRow& r : kb.axioms(AxiomKind::Declaration))
+        if (kb.iri(r.object) == owl2::vocab::OWL_ANNOTATION_PROPERTY)
+            annotation_properties[r.subject] = true;
+
+    std::vector<std::uint64_t> keys(data_rows.size());
+    util::parallelChunks(data_rows.size(), threads, [&](std::size_t begin, std::size_t end, unsigned) {
+        for (std::size_t i = begin; i < end; ++i)
+            keys[i] = (static_cast<std::uint64_t>(data_rows[i].predicate) << 32) | data_rows[i].subject;
+    });
+    util::parallelSort(keys, threads);
+    for (std::size_t i = 0; i < keys.size();) {
+        TermId property = static_cast<TermId>(keys[i] >> 32);
+        LiteralCoverage c;
+        c.property = std::string(kb.iri(property));
+        for (; i < keys.size() && (keys[i] >> 32) == property; ++i) {
+            ++c.assertions;
+            TermId subject = static_cast<TermId>(keys[i]);
+            if ((i == 0 || keys[i] != keys[i - 1]) && (is_node[subject / 64] >> (subject % 64) & 1))
+                ++c.subjects;
+        }
+        if (annotation_properties.count(property))
+            continue;
+        c.coverage = s.individual_count ? static_cast<double>(c.subjects) / s.individual_count : 0.0;
+        s.literal_coverage.push_back(std::move(c));
+    }
+    std::sort(s.literal_coverage.begin(), s.literal_coverage.end(), [](const LiteralCoverage& a, const LiteralCoverage& b) {
+        return a.subjects != b.subjects ? a.subjects > b.subjects : a.property < b.property;
+    });
+
+    s.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return s;
+}
+
+template KbStats computeStats<owl2::Ontology>(const owl2::Ontology&, unsigned);
+template KbStats computeStats<io::Snapshot>(const io::Snapshot&, unsigned);
+template KbStats computeStats<owl2::OntologyView>(const owl2::OntologyView&, unsigned);
+
+
+static std::string_view shortName(const std::string& iri)
+{
+    return owl2::vocab::localName(iri);
+}
+
+static void printHistogram(const char* title, const DegreeSummary& d, std::ostream& out)
+{
+    char line[128];
+    std::snprintf(line, sizeof(line), "%s (max %llu, mean %.2f):\n", title,
+                  static_cast<unsigned long long>(d.max), d.mean);
+    out << line;
+    for (std::size_t b = 0; b < d.log2_histogram.size(); ++b) {
+        if (b == 0)
+            std::snprintf(line, sizeof(line), "  %10s: %llu\n", "0", static_cast<unsigned long long>(d.log2_histogram[b]));
+        else {
+            char range[48];  // two 20-digit bounds
+            std::snprintf(range, sizeof(range), "%llu-%llu", 1ULL << (b - 1), (1ULL << b) - 1);
+            std::snprintf(line, sizeof(line), "  %10s: %llu\n", range, static_cast<unsigned long long>(d.log2_histogram[b]));
+        }
+        out << line;
+    }
+}
+
+void printStats(const KbStats& s, std::ostream& out)
+{
+    out << "\n*******************\n"
+        << "ONTOLOGY STATISTICS\n"
+        << "*******************\n\n";
+
+    out << "IRIs: " << s.iri_count << "\n"
+        << "Literals: " << s.literal_count << "\n"
+        << "Individuals: " << s.individual_count << "\n";
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k)
+        out << owl2::axiomKindName(static_cast<AxiomKind>(k)) << " axioms: " << s.axiom_counts[k] << "\n";
+
+    out << "\nIndividual counts:\n";
+    for (const auto& c : s.class_counts)
+        out << shortName(c.iri) << ": " << c.count << "\n";
+
+    out << "\nRelationship counts:\n";
+    for (const auto& c : s.relation_counts)
+        out << shortName(c.iri) << ": " << c.count << "\n";
+
+    out << "\n";
+    printHistogram("Out-degree distribution", s.out_degree, out);
+    printHistogram("In-degree distribution", s.in_degree, out);
+
+    out << "\nLiteral coverage:\n";
+    for (const auto& c : s.literal_coverage) {
+        char line[64];
+        std::snprintf(line, sizeof(line), "%.1f%%", 100.0 * c.coverage);
+        out << shortName(c.property) << ": " << c.subjects << " individuals (" << line << "), "
+            << c.assertions << " values\n";
+    }
+
+    if (!s.memory.empty()) {
+        out << "\nMemory:\n";
+        util::printMemoryUsage(s.memory, out);
+    }
+
+    char line[64];
+    std::snprintf(line, sizeof(line), "\nComputed in %.3f s\n", s.seconds);
+    out << line;
+}
+
+static void writeDegree(util::JsonWriter& json, const char* name, const DegreeSummary& d)
+{
+    json.key(name);
+    json.beginObject();
+    json.field("max", d.max);
+    json.field("mean", d.mean);
+    json.key("log2_histogram");
+    json.beginArray();
+    for (std::uint64_t n : d.log2_histogram)
+        json.value(n);
+    json.endArray();
+    json.endObject();
+}
+
+static void writeCounts(util::JsonWriter& json, const char* name, const std::vector<TermCount>& counts)
+{
+    json.key(name);
+    json.beginObject();
+    for (const auto& c : counts)
+        json.field(c.iri, c.count);
+    json.endObject();
+}
+
+void writeStatsJson(const KbStats& s, std::ostream& out)
+{
+    util::JsonWriter json(out);
+    json.beginObject();
+    json.field("iris", s.iri_count);
+    json.field("literals", s.literal_count);
+    json.field("individuals", s.individual_count);
+    json.key("axioms");
+    json.beginObject();
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k)
+        json.field(owl2::axiomKindName(static_cast<AxiomKind>(k)), s.axiom_counts[k]);
+    json.endObject();
+    writeCounts(json, "classes", s.class_counts);
+    writeCounts(json, "relations", s.relation_counts);
+    writeDegree(json, "out_degree", s.out_degree);
+    writeDegree(json, "in_degree", s.in_degree);
+    json.key("literal_coverage");
+    json.beginObject();
+    for (const auto& c : s.literal_coverage) {
+        json.key(c.property);
+        json.beginObject();
+        json.field("assertions", c.assertions);
+        json.field("subjects", c.subjects);
+        json.field("coverage", c.coverage);
+        json.endObject();
+    }
+    json.endObject();
+    if (!s.memory.empty()) {
+        json.key("memory");
+        json.beginArray();
+        for (const auto& c : s.memory) {
+            json.beginObject();
+            json.field("component", c.name);
+            json.field("kind", c.mapped ? "mapped" : "heap");
+            json.field("size", c.size);
+            json.field("capacity", c.capacity);
+            json.field("overhead", c.overhead);
+            json.field("footprint", c.footprint());
+            json.endObject();
+        }
+        json.endArray();
+    }
+    json.field("seconds", s.seconds);
+    json.endObject();
+}
+
+
+}
+
+}
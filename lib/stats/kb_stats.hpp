@@ -0,0 +1,76 @@
+#ifndef KB_STATS_HPP
+#define KB_STATS_HPP
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "owl2/term.hpp"
+#include "util/memory.hpp"
+
+
+namespace ista
+{
+
+namespace stats
+{
+
+
+struct TermCount
+{
+    std::string iri;
+    std::uint64_t count;
+};
+
+// Degree distribution of the object-property graph over all individuals.
+// Bucket 0 counts degree 0, bucket k >= 1 counts degrees in [2^(k-1), 2^k).
+struct DegreeSummary
+{
+    std::uint64_t max = 0;
+    double mean = 0.0;
+    std::vector<std::uint64_t> log2_histogram;
+};
+
+struct LiteralCoverage
+{
+    std::string property;
+    std::uint64_t assertions = 0;
+    std::uint64_t subjects = 0;    // distinct individuals with a value
+    double coverage = 0.0;         // subjects / individual_count
+};
+
+struct KbStats
+{
+    std::uint64_t iri_count = 0;
+    std::uint64_t literal_count = 0;
+    std::array<std::uint64_t, owl2::AXIOM_KIND_COUNT> axiom_counts{};
+    std::uint64_t individual_count = 0;
+    std::vector<TermCount> class_counts;      // individuals per class, descending
+    std::vector<TermCount> relation_counts;   // assertions per object property, descending
+    DegreeSummary out_degree;
+    DegreeSummary in_degree;
+    std::vector<LiteralCoverage> literal_coverage;
+    double seconds = 0.0;
+    // The KB's memoryUsage(), when the caller asked for it; not filled in
+    // by computeStats().
+    util::MemoryUsage memory;
+};
+
+// Computes summary statistics over a KB. Instantiated for owl2::Ontology,
+// io::Snapshot and owl2::OntologyView; every pass is split across `threads`
+// threads.
+template <typename Kb>
+KbStats computeStats(const Kb& kb, unsigned threads);
+
+// Human-readable report in the style of ista.util.print_onto_stats.
+void printStats(const KbStats& stats, std::ostream& out);
+void writeStatsJson(const KbStats& stats, std::ostream& out);
+
+
+}
+
+}
+
+#endif
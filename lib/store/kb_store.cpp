@@ -0,0 +1,187 @@
+#include "kb_store.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include "diff/kb_diff.hpp"
+#include "io/patch.hpp"
+#include "io/snapshot.hpp"
+
+namespace ista
+{
+
+namespace store
+{
+
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+constexpr const char* INDEX_FILE = "index.tsv";
+constexpr const char* INDEX_MAGIC = "# ista-store 1";
+
+void checkName(const std::string& name)
+{
+    bool ok = !name.empty() && name[0] != '.' && std::all_of(name.begin(), name.end(), [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '-' || c == '_';
+    });
+    if (!ok)
+        throw std::invalid_argument("invalid version name '" + name + "' (use letters, digits, '.', '-' and '_')");
+}
+
+}
+
+
+KbStore::KbStore(const std::string& dir) : dir_(dir)
+{
+    fs::path index = fs::path(dir) / INDEX_FILE;
+    std::ifstream in(index);
+    if (!in)
+        throw std::runtime_error(dir + " is not a KB store (no " + INDEX_FILE + ")");
+    std::string line;
+    if (!std::getline(in, line) || line != INDEX_MAGIC)
+        throw std::runtime_error(index.string() + ": not a KB store index");
+    while (std::getline(in, line)) {
+        if (line.empty())
+            continue;
+        std::istringstream fields(line);
+        if (line.starts_with("# rebase_every ")) {
+            rebase_every_ = static_cast<unsigned>(std::stoul(line.substr(15)));
+            continue;
+        }
+        Version v;
+        std::string kind;
+        if (!(fields >> v.name >> kind >> v.file >> v.added >> v.removed) || (kind != "base" && kind != "delta"))
+            throw std::runtime_error(index.string() + ": malformed line '" + line + "'");
+        v.base = kind == "base";
+        versions_.push_back(std::move(v));
+    }
+    if (!versions_.empty() && !versions_.front().base)
+        throw std::runtime_error(index.string() + ": the first version must be a base");
+}
+
+KbStore KbStore::create(const std::string& dir, unsigned rebase_every)
+{
+    if (fs::exists(fs::path(dir) / INDEX_FILE))
+        throw std::runtime_error(dir + " already holds a KB store");
+    fs::create_directories(dir);
+    KbStore store;
+    store.dir_ = dir;
+    store.rebase_every_ = std::max(1u, rebase_every);
+    store.save();
+    return store;
+}
+
+std::size_t KbStore::indexOf(const std::string& name) const
+{
+    for (std::size_t i = 0; i < versions_.size(); ++i)
+        if (versions_[i].name == name)
+            return i;
+    throw std::runtime_error("no version '" + name + "' in " + dir_);
+}
+
+std::string KbStore::pathOf(const Version& v) const
+{
+    return (fs::path(dir_) / v.file).string();
+}
+
+const Version& KbStore::add(const std::string& name, const owl2::Ontology& kb, unsigned threads)
+{
+    checkName(name);
+    if (std::any_of(versions_.begin(), versions_.end(), [&](const Version& v) { return v.name == name; }))
+        throw std::runtime_error("version '" + name + "' already exists in " + dir_);
+
+    std::size_t since_base = 0;
+    for (auto it = versions_.rbegin(); it != versions_.rend() && !it->base; ++it)
+        ++since_base;
+
+    Version v;
+    v.name = name;
+    v.base = versions_.empty() || since_base + 1 >= rebase_every_;
+    v.file = name + (v.base ? ".ista" : ".rdfp");
+
+    if (versions_.empty()) {
+        v.added = kb.axiomCount();
+    } else {
+        owl2::Ontology previous = materialize(versions_.size() - 1);
+        std::unique_ptr<io::PatchWriter> patch;
+        if (!v.base)
+            patch = std::make_unique<io::PatchWriter>(pathOf(v));
+        diff::KbDiff d = diff::diffKbs(previous, kb, threads, patch.get());
+        if (patch)
+            patch->close();
+        for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k) {
+            v.added += d.added[k];
+            v.removed += d.removed[k];
+        }
+    }
+    if (v.base)
+        io::writeSnapshot(kb, pathOf(v));
+
+    versions_.push_back(std::move(v));
+    save();
+    return versions_.back();
+}
+
+owl2::Ontology KbStore::materialize(std::size_t index) const
+{
+    std::size_t base = index;
+    while (!versions_[base].base)
+        --base;
+    owl2::Ontology onto = io::loadSnapshot(pathOf(versions_[base]));
+    for (std::size_t i = base + 1; i <= index; ++i)
+        io::applyPatch(onto, pathOf(versions_[i]));
+    return onto;
+}
+
+owl2::Ontology KbStore::checkout(const std::string& name) const
+{
+    return materialize(indexOf(name));
+}
+
+void KbStore::rebase(const std::string& name)
+{
+    std::size_t i = indexOf(name);
+    Version& v = versions_[i];
+    if (v.base)
+        return;
+    std::string delta = pathOf(v);
+    Version rebased = v;
+    rebased.base = true;
+    rebased.file = v.name + ".ista";
+    io::writeSnapshot(materialize(i), pathOf(rebased));
+    v = std::move(rebased);
+    save();
+    fs::remove(delta);
+}
+
+// Rewrites the index through a temporary file so a crash never leaves it
+// half written.
+void KbStore::save() const
+{
+    fs::path index = fs::path(dir_) / INDEX_FILE;
+    fs::path tmp = index;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp);
+        out << INDEX_MAGIC << "\n# rebase_every " << rebase_every_ << "\n";
+        for (const Version& v : versions_)
+            out << v.name << '\t' << (v.base ? "base" : "delta") << '\t' << v.file << '\t' << v.added << '\t'
+                << v.removed << '\n';
+        if (!out.flush())
+            throw std::runtime_error("cannot write " + tmp.string());
+    }
+    fs::rename(tmp, index);
+}
+
+
+}
+
+}
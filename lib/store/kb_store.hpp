@@ -0,0 +1,67 @@
+#ifndef KB_STORE_HPP
+#define KB_STORE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "owl2/ontology.hpp"
+
+
+namespace ista
+{
+
+namespace store
+{
+
+
+struct Version
+{
+    std::string name;
+    bool base = false;          // a full snapshot rather than a delta
+    std::string file;           // relative to the store directory
+    std::uint64_t added = 0;    // axioms, against the previous version
+    std::uint64_t removed = 0;
+};
+
+// A linear history of KB versions. Some versions are stored as full
+// snapshots ("bases"); every other version is an RDF Patch against the one
+// before it. Checking out a version loads the nearest base at or before it and
+// replays the deltas that follow. Every `rebase_every`-th version is stored
+// as a base, which bounds how many deltas a checkout replays.
+class KbStore
+{
+public:
+    // Opens an existing store.
+    explicit KbStore(const std::string& dir);
+    static KbStore create(const std::string& dir, unsigned rebase_every = 8);
+
+    const std::string& dir() const { return dir_; }
+    unsigned rebaseEvery() const { return rebase_every_; }
+    const std::vector<Version>& versions() const { return versions_; }
+
+    // Records `kb` as the newest version and returns its entry.
+    const Version& add(const std::string& name, const owl2::Ontology& kb, unsigned threads);
+    owl2::Ontology checkout(const std::string& name) const;
+    // Stores a version as a full snapshot, shortening the chains through it.
+    void rebase(const std::string& name);
+
+private:
+    KbStore() = default;
+
+    std::size_t indexOf(const std::string& name) const;
+    std::string pathOf(const Version& v) const;
+    owl2::Ontology materialize(std::size_t index) const;
+    void save() const;
+
+    std::string dir_;
+    unsigned rebase_every_ = 8;
+    std::vector<Version> versions_;
+};
+
+
+}
+
+}
+
+#endif
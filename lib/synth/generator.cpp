@@ -0,0 +1,725 @@
+#include "generator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "io/file_io.hpp"
+#include "io/rdf_syntax.hpp"
+#include "io/triple.hpp"
+#include "owl2/vocabulary.hpp"
+#include "util/hash.hpp"
+#include "util/scheduler.hpp"
+
+namespace ista
+{
+
+namespace synth
+{
+
+namespace vocab = owl2::vocab;
+using owl2::TermId;
+
+
+namespace
+{
+
+// Items (individuals or edges) per unit of work. Each block draws from its
+// own random stream, which is what makes the output thread-count free.
+constexpr std::uint64_t BLOCK = 4096;
+
+struct Job
+{
+    bool edges;             // an object property's edges, else a class's individuals
+    std::size_t index;      // property or class
+    std::uint64_t begin;
+    std::uint64_t end;
+};
+
+// Counter-based generator: cheap to seed per block and good enough for
+// shaping test data.
+class Random
+{
+public:
+    explicit Random(std::uint64_t seed) : state_(util::mix64(seed)) {}
+
+    std::uint64_t next()
+    {
+        state_ += 0x9e3779b97f4a7c15ULL;
+        return util::mix64(state_);
+    }
+    double uniform() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+    double normal()
+    {
+        double u = std::max(uniform(), 1e-300);
+        return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * uniform());
+    }
+
+private:
+    std::uint64_t state_;
+};
+
+// Ranks in [0, n) with P(rank r) roughly proportional to (r + 1)^-s, by
+// inverting the CDF of the continuous power law on [1, n + 1).
+std::uint64_t powerLawRank(std::uint64_t n, double s, double u)
+{
+    if (n <= 1)
+        return 0;
+    double x;
+    double a = 1.0 - s;
+    if (std::fabs(a) < 1e-9)
+        x = std::pow(static_cast<double>(n + 1), u);
+    else
+        x = std::pow((std::pow(static_cast<double>(n + 1), a) - 1.0) * u + 1.0, 1.0 / a);
+    return std::min<std::uint64_t>(n - 1, static_cast<std::uint64_t>(x) - 1);
+}
+
+std::uint64_t pick(const Generator::Pool& pool, std::uint64_t position)
+{
+    std::size_t k = static_cast<std::size_t>(
+        std::upper_bound(pool.cumulative.begin(), pool.cumulative.end(), position) - pool.cumulative.begin() - 1);
+    return pool.starts[k] + (position - pool.cumulative[k]);
+}
+
+std::string lowercase(std::string_view s)
+{
+    std::string out(s);
+    for (char& c : out)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return out;
+}
+
+Generator::ValueKind valueKind(std::string_view datatype)
+{
+    // Integers are valid owl:rational and owl:real values too.
+    if (datatype.starts_with(vocab::OWL))
+        return datatype.ends_with("#rational") || datatype.ends_with("#real") ? Generator::ValueKind::Integer
+                                                                             : Generator::ValueKind::String;
+    if (!datatype.starts_with(vocab::XSD))
+        return Generator::ValueKind::String;
+    std::string_view name = datatype.substr(vocab::XSD.size());
+    if (name == "boolean")
+        return Generator::ValueKind::Boolean;
+    if (name == "date" || name == "dateTime")
+        return Generator::ValueKind::Date;
+    if (name == "decimal" || name == "double" || name == "float")
+        return Generator::ValueKind::Decimal;
+    if (name.find("nteger") != std::string_view::npos || name == "int" || name == "long" || name == "short")
+        return Generator::ValueKind::Integer;
+    return Generator::ValueKind::String;
+}
+
+// Pseudo-words for string values: a fixed syllable table indexed by the
+// digits of a hashed word number, so word k is the same in every run.
+void appendWord(std::string& out, std::uint64_t k)
+{
+    static const char* syllables[] = {"ka", "lo", "mi", "ne", "ra", "tu", "vo", "zen", "gly", "pro", "ase", "tin",
+                                      "dro", "phe", "cy", "lin", "mer", "ox", "sta", "bre", "chi", "dol", "fa", "quin"};
+    constexpr std::uint64_t count = sizeof(syllables) / sizeof(syllables[0]);
+    std::uint64_t h = util::mix64(k + 1);
+    std::uint64_t length = 2 + h % 3;
+    h /= 3;
+    for (std::uint64_t i = 0; i < length; ++i, h /= count)
+        out += syllables[h % count];
+}
+
+// Days since 1970-01-01 to yyyy-mm-dd (Howard Hinnant's civil_from_days).
+void appendDate(std::string& out, std::int64_t days)
+{
+    days += 719468;
+    std::int64_t era = days / 146097;
+    std::int64_t doe = days - era * 146097;
+    std::int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    std::int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    std::int64_t mp = (5 * doy + 2) / 153;
+    std::int64_t d = doy - (153 * mp + 2) / 5 + 1;
+    std::int64_t m = mp < 10 ? mp + 3 : mp - 9;
+    std::int64_t y = yoe + era * 400 + (m <= 2);
+    char buffer[64];  // room for three full-width long longs
+    std::snprintf(buffer, sizeof(buffer), "%04lld-%02lld-%02lld", static_cast<long long>(y), static_cast<long long>(m),
+                  static_cast<long long>(d));
+    out += buffer;
+}
+
+void makeValue(const Generator::DataProperty& property, Random& rng, std::string& out)
+{
+    out.clear();
+    char buffer[32];
+    switch (property.kind) {
+    case Generator::ValueKind::String: {
+        std::uint64_t words = 1 + rng.next() % 3;
+        for (std::uint64_t w = 0; w < words; ++w) {
+            if (w)
+                out.push_back(' ');
+            appendWord(out, powerLawRank(50000, 1.0, rng.uniform()));
+        }
+        out[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(out[0])));
+        break;
+    }
+    case Generator::ValueKind::Integer:
+        out += std::to_string(static_cast<std::uint64_t>(std::exp(3.0 + 2.0 * rng.normal())) + 1);
+        break;
+    case Generator::ValueKind::Decimal:
+        std::snprintf(buffer, sizeof(buffer), "%.4f", std::exp(1.0 + 1.5 * rng.normal()));
+        out += buffer;
+        break;
+    case Generator::ValueKind::Boolean:
+        out += rng.uniform() < 0.3 ? "true" : "false";
+        break;
+    case Generator::ValueKind::Date:
+        appendDate(out, 7300 + static_cast<std::int64_t>(rng.next() % 12500));
+        if (property.datatype.ends_with("dateTime"))
+            out += "T00:00:00";
+        break;
+    }
+}
+
+
+// Generated triples as N-Triples text, one chunk per job, written in job
+// order.
+class NTriplesSink
+{
+public:
+    NTriplesSink(const Generator& gen, const std::string& ns, const std::string& path) : gen_(gen), ns_(ns), out_(path)
+    {
+        for (const auto& c : gen.classes()) {
+            class_terms_.emplace_back();
+            io::appendIriRef(class_terms_.back(), c.iri);
+            firsts_.push_back(c.first);
+        }
+        for (const auto& p : gen.objectProperties()) {
+            object_terms_.emplace_back();
+            io::appendIriRef(object_terms_.back(), p.iri);
+        }
+        for (const auto& p : gen.dataProperties()) {
+            data_terms_.emplace_back();
+            io::appendIriRef(data_terms_.back(), p.iri);
+            datatype_suffixes_.emplace_back();
+            if (!p.datatype.empty()) {
+                datatype_suffixes_.back() = "^^";
+                io::appendIriRef(datatype_suffixes_.back(), p.datatype);
+            }
+        }
+        io::appendIriRef(rdf_type_, vocab::RDF_TYPE);
+        io::appendIriRef(named_individual_, vocab::OWL_NAMED_INDIVIDUAL);
+        io::appendIriRef(label_, vocab::RDFS_LABEL);
+    }
+
+    void writeTBox(const owl2::Ontology& tbox)
+    {
+        io::Triple triple;
+        std::string line;
+        for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k) {
+            for (const owl2::TripleRow& row : tbox.axioms(static_cast<owl2::AxiomKind>(k))) {
+                io::rowToTriple(tbox, row, triple);
+                line.clear();
+                io::appendNTriplesTerm(line, triple.subject);
+                line.push_back(' ');
+                io::appendNTriplesTerm(line, triple.predicate);
+                line.push_back(' ');
+                io::appendNTriplesTerm(line, triple.object);
+                line += " .\n";
+                out_.write(line);
+            }
+        }
+    }
+
+    class Chunk
+    {
+    public:
+        explicit Chunk(NTriplesSink& sink) : sink_(&sink) {}
+
+        void typed(std::size_t c, std::uint64_t local, bool label)
+        {
+            std::size_t mark = text_.size();
+            individual(c, local);
+            std::string subject = text_.substr(mark);
+            text_ += ' ';
+            text_ += sink_->rdf_type_;
+            text_ += ' ';
+            text_ += sink_->named_individual_;
+            text_ += " .\n";
+            text_ += subject;
+            text_ += ' ';
+            text_ += sink_->rdf_type_;
+            text_ += ' ';
+            text_ += sink_->class_terms_[c];
+            text_ += " .\n";
+            triples_ += 2;
+            if (label) {
+                text_ += subject;
+                text_ += ' ';
+                text_ += sink_->label_;
+                text_ += " \"";
+                io::appendEscaped(text_, sink_->gen_.classes()[c].label);
+                text_ += ' ';
+                text_ += std::to_string(local);
+                text_ += "\" .\n";
+                ++triples_;
+            }
+            subject_ = std::move(subject);
+        }
+
+        // A value for the individual last passed to typed().
+        void value(std::size_t property, std::string_view lexical)
+        {
+            text_ += subject_;
+            text_ += ' ';
+            text_ += sink_->data_terms_[property];
+            text_ += " \"";
+            io::appendEscaped(text_, lexical);
+            text_ += '"';
+            text_ += sink_->datatype_suffixes_[property];
+            text_ += " .\n";
+            ++triples_;
+        }
+
+        void edge(std::uint64_t subject, std::size_t property, std::uint64_t object)
+        {
+            individual(subject);
+            text_ += ' ';
+            text_ += sink_->object_terms_[property];
+            text_ += ' ';
+            individual(object);
+            text_ += " .\n";
+            ++triples_;
+        }
+
+        std::uint64_t triples() const { return triples_; }
+
+    private:
+        friend class NTriplesSink;
+
+        void individual(std::uint64_t global)
+        {
+            const auto& firsts = sink_->firsts_;
+            std::size_t c = static_cast<std::size_t>(std::upper_bound(firsts.begin(), firsts.end(), global)
+                                                     - firsts.begin() - 1);
+            individual(c, global - firsts[c]);
+        }
+        void individual(std::size_t c, std::uint64_t local)
+        {
+            text_ += '<';
+            text_ += sink_->ns_;
+            text_ += sink_->gen_.classes()[c].slug;
+            text_ += '_';
+            text_ += std::to_string(local);
+            text_ += '>';
+        }
+
+        NTriplesSink* sink_;
+        std::string text_;
+        std::string subject_;
+        std::uint64_t triples_ = 0;
+    };
+
+    Chunk chunk() { return Chunk(*this); }
+    void commit(Chunk& chunk) { out_.write(chunk.text_); }
+    void close() { out_.close(); }
+
+private:
+    const Generator& gen_;
+    const std::string& ns_;
+    io::OutputFile out_;
+    std::vector<std::uint64_t> firsts_;
+    std::vector<std::string> class_terms_;
+    std::vector<std::string> object_terms_;
+    std::vector<std::string> data_terms_;
+    std::vector<std::string> datatype_suffixes_;
+    std::string rdf_type_;
+    std::string named_individual_;
+    std::string label_;
+};
+
+
+// Generated triples as rows of an Ontology. Individuals are interned up
+// front, in order, so the parallel jobs only produce ids; literals are
+// interned when a chunk is committed.
+class OntologySink
+{
+public:
+    OntologySink(const Generator& gen, const std::string& ns, owl2::Ontology& onto) : onto_(onto)
+    {
+        for (const auto& c : gen.classes()) {
+            class_ids_.push_back(onto.internIri(c.iri));
+            firsts_.push_back(c.first);
+            labels_.push_back(c.label);
+            std::string prefix = ns + c.slug + "_";
+            for (std::uint64_t i = 0; i < c.count; ++i)
+                ids_.push_back(onto.internIri(prefix + std::to_string(i)));
+        }
+        TermId rdf_type = onto.rdfType();
+        TermId named = onto.internIri(vocab::OWL_NAMED_INDIVIDUAL);
+        label_ = onto.internIri(vocab::RDFS_LABEL);
+        rdf_type_ = rdf_type;
+        named_individual_ = named;
+        for (const auto& p : gen.objectProperties())
+            object_ids_.push_back(onto.internIri(p.iri));
+        for (const auto& p : gen.dataProperties()) {
+            data_ids_.push_back(onto.internIri(p.iri));
+            datatype_ids_.push_back(p.datatype.empty() ? onto.xsdString() : onto.internIri(p.datatype));
+        }
+        if (!ids_.empty()) {
+            declaration_kind_ = onto.classify(rdf_type, named);
+            class_kind_ = class_ids_.empty() ? declaration_kind_ : onto.classify(rdf_type, class_ids_[0]);
+            edge_kind_ = object_ids_.empty() ? class_kind_ : onto.classify(object_ids_[0], ids_[0]);
+        }
+        TermId literal = onto.internLiteral("", onto.xsdString());
+        label_kind_ = onto.classify(label_, literal);
+        data_kind_ = data_ids_.empty() ? label_kind_ : onto.classify(data_ids_[0], literal);
+    }
+
+    class Chunk
+    {
+    public:
+        explicit Chunk(OntologySink& sink) : sink_(&sink) {}
+
+        void typed(std::size_t c, std::uint64_t local, bool label)
+        {
+            subject_ = sink_->ids_[sink_->firsts_[c] + local];
+            rows_.push_back({sink_->declaration_kind_, {subject_, sink_->rdf_type_, sink_->named_individual_}});
+            rows_.push_back({sink_->class_kind_, {subject_, sink_->rdf_type_, sink_->class_ids_[c]}});
+            if (label) {
+                std::string text = sink_->labels_[c] + " " + std::to_string(local);
+                literals_.push_back({subject_, sink_->label_, sink_->onto_.xsdString(), sink_->label_kind_, text});
+            }
+        }
+
+        void value(std::size_t property, std::string_view lexical)
+        {
+            literals_.push_back({subject_, sink_->data_ids_[property], sink_->datatype_ids_[property],
+                                 sink_->data_kind_, std::string(lexical)});
+        }
+
+        void edge(std::uint64_t subject, std::size_t property, std::uint64_t object)
+        {
+            rows_.push_back({sink_->edge_kind_, {sink_->ids_[subject], sink_->object_ids_[property], sink_->ids_[object]}});
+        }
+
+        std::uint64_t triples() const { return rows_.size() + literals_.size(); }
+
+    private:
+        friend class OntologySink;
+
+        struct Literal
+        {
+            TermId subject;
+            TermId predicate;
+            TermId datatype;
+            owl2::AxiomKind kind;
+            std::string lexical;
+        };
+
+        OntologySink* sink_;
+        TermId subject_ = owl2::NO_TERM;
+        std::vector<std::pair<owl2::AxiomKind, owl2::TripleRow>> rows_;
+        std::vector<Literal> literals_;
+    };
+
+    Chunk chunk() { return Chunk(*this); }
+
+    void commit(Chunk& chunk)
+    {
+        for (const auto& [kind, row] : chunk.rows_)
+            onto_.addAxiom(kind, row);
+        for (const auto& lit : chunk.literals_)
+            onto_.addAxiom(lit.kind, {lit.subject, lit.predicate, onto_.internLiteral(lit.lexical, lit.datatype)});
+    }
+
+private:
+    owl2::Ontology& onto_;
+    std::vector<TermId> ids_;
+    std::vector<std::uint64_t> firsts_;
+    std::vector<TermId> class_ids_;
+    std::vector<std::string> labels_;
+    std::vector<TermId> object_ids_;
+    std::vector<TermId> data_ids_;
+    std::vector<TermId> datatype_ids_;
+    TermId rdf_type_ = owl2::NO_TERM;
+    TermId named_individual_ = owl2::NO_TERM;
+    TermId label_ = owl2::NO_TERM;
+    owl2::AxiomKind declaration_kind_ = owl2::AxiomKind::Declaration;
+    owl2::AxiomKind class_kind_ = owl2::AxiomKind::ClassAssertion;
+    owl2::AxiomKind edge_kind_ = owl2::AxiomKind::ObjectPropertyAssertion;
+    owl2::AxiomKind label_kind_ = owl2::AxiomKind::AnnotationAssertion;
+    owl2::AxiomKind data_kind_ = owl2::AxiomKind::DataPropertyAssertion;
+};
+
+}
+
+
+Generator::Generator(const owl2::Ontology& tbox, GeneratorOptions options)
+    : tbox_(tbox), options_(std::move(options))
+{
+    if (options_.degree_exponent <= 1.0)
+        throw std::invalid_argument("degree exponent must be greater than 1");
+    namespace_ = tbox.ontology_iri.baseIRI;
+    if (namespace_.empty())
+        namespace_ = "http://example.org/synthetic";
+    if (namespace_.back() != '#' && namespace_.back() != '/')
+        namespace_ += '#';
+
+    // Named classes, properties and the subclass, subproperty, domain and
+    // range axioms between them, plus the RDF lists of owl:unionOf classes
+    // and the property restrictions classes are declared subclasses of.
+    std::map<TermId, std::vector<TermId>> children;
+    std::vector<TermId> class_ids;
+    std::vector<TermId> object_ids, data_ids;
+    std::unordered_map<TermId, TermId> domain, range, unions, firsts, rests, on_property, filler;
+    std::vector<std::pair<TermId, TermId>> restricted;
+    std::unordered_set<TermId> is_class, has_subproperty;
+    auto named = [&](TermId id) { return !owl2::isLiteral(id) && !vocab::isBlank(tbox.iri(id)); };
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k) {
+        for (const owl2::TripleRow& row : tbox.axioms(static_cast<owl2::AxiomKind>(k))) {
+            if (owl2::isLiteral(row.object))
+                continue;
+            std::string_view p = tbox.iri(row.predicate);
+            std::string_view o = tbox.iri(row.object);
+            if (p == vocab::OWL_UNION_OF)
+                unions.emplace(row.subject, row.object);
+            else if (p == vocab::RDF_FIRST)
+                firsts.emplace(row.subject, row.object);
+            else if (p == vocab::RDF_REST)
+                rests.emplace(row.subject, row.object);
+            else if (p == vocab::OWL_ON_PROPERTY)
+                on_property.emplace(row.subject, row.object);
+            else if (p == vocab::OWL_SOME_VALUES_FROM || p == vocab::OWL_ALL_VALUES_FROM)
+                filler.emplace(row.subject, row.object);
+            if (!named(row.subject))
+                continue;
+            if (p == vocab::RDF_TYPE) {
+                if (o == vocab::OWL_CLASS && tbox.iri(row.subject) != vocab::OWL_THING && is_class.insert(row.subject).second)
+                    class_ids.push_back(row.subject);
+                else if (o == vocab::OWL_OBJECT_PROPERTY)
+                    object_ids.push_back(row.subject);
+                else if (o == vocab::OWL_DATATYPE_PROPERTY)
+                    data_ids.push_back(row.subject);
+            } else if (p == vocab::RDFS_SUBCLASS_OF) {
+                if (named(row.object))
+                    children[row.object].push_back(row.subject);
+                else
+                    restricted.emplace_back(row.subject, row.object);
+            } else if (p == vocab::RDFS_SUBPROPERTY_OF) {
+                has_subproperty.insert(row.object);
+            } else if (p == vocab::RDFS_DOMAIN) {
+                domain.emplace(row.subject, row.object);
+            } else if (p == vocab::RDFS_RANGE) {
+                range.emplace(row.subject, row.object);
+            }
+        }
+    }
+    std::sort(class_ids.begin(), class_ids.end());
+
+    // Without rdfs:domain and rdfs:range, the classes restricting a
+    // property and the classes they restrict it to stand in for them.
+    std::map<TermId, std::vector<TermId>> restricted_domain, restricted_range;
+    for (const auto& [c, r] : restricted) {
+        auto it = on_property.find(r);
+        if (it == on_property.end())
+            continue;
+        restricted_domain[it->second].push_back(c);
+        if (auto f = filler.find(r); f != filler.end())
+            restricted_range[it->second].push_back(f->second);
+    }
+    std::sort(object_ids.begin(), object_ids.end());
+    object_ids.erase(std::unique(object_ids.begin(), object_ids.end()), object_ids.end());
+    std::sort(data_ids.begin(), data_ids.end());
+    data_ids.erase(std::unique(data_ids.begin(), data_ids.end()), data_ids.end());
+
+    // Leaf classes get the individuals.
+    std::unordered_map<TermId, std::size_t> leaf_index;
+    for (TermId id : class_ids) {
+        bool leaf = true;
+        for (TermId child : children[id])
+            leaf = leaf && !is_class.count(child);
+        if (!leaf)
+            continue;
+        ClassInfo c;
+        c.iri = tbox.iri(id);
+        std::string_view local = vocab::localName(c.iri);
+        c.slug = lowercase(local);
+        c.label = std::string(local);
+        c.count = options_.individuals_per_class;
+        for (const std::string& key : {c.iri, c.label}) {
+            auto it = options_.class_individuals.find(key);
+            if (it != options_.class_individuals.end())
+                c.count = it->second;
+        }
+        c.first = individuals_;
+        individuals_ += c.count;
+        leaf_index.emplace(id, classes_.size());
+        classes_.push_back(std::move(c));
+    }
+
+    // The leaves under some classes or unions of classes, or every leaf
+    // when none is known.
+    auto leavesUnder = [&](const std::vector<TermId>& roots) {
+        std::vector<TermId> stack;
+        for (TermId root : roots) {
+            if (auto it = unions.find(root); it != unions.end()) {
+                for (TermId node = it->second; firsts.count(node); node = rests.count(node) ? rests[node] : owl2::NO_TERM)
+                    if (is_class.count(firsts[node]))
+                        stack.push_back(firsts[node]);
+            } else if (is_class.count(root)) {
+                stack.push_back(root);
+            }
+        }
+        std::vector<std::size_t> leaves;
+        if (stack.empty()) {
+            for (std::size_t i = 0; i < classes_.size(); ++i)
+                leaves.push_back(i);
+            return leaves;
+        }
+        std::unordered_set<TermId> seen(stack.begin(), stack.end());
+        while (!stack.empty()) {
+            TermId id = stack.back();
+            stack.pop_back();
+            if (auto it = leaf_index.find(id); it != leaf_index.end())
+                leaves.push_back(it->second);
+            for (TermId child : children[id])
+                if (seen.insert(child).second)
+                    stack.push_back(child);
+        }
+        std::sort(leaves.begin(), leaves.end());
+        return leaves;
+    };
+    auto poolOf = [&](const std::vector<TermId>& roots) {
+        Pool pool;
+        for (std::size_t leaf : leavesUnder(roots)) {
+            if (classes_[leaf].count == 0)
+                continue;
+            pool.starts.push_back(classes_[leaf].first);
+            pool.cumulative.push_back(pool.size);
+            pool.size += classes_[leaf].count;
+        }
+        return pool;
+    };
+    auto rootsOf = [](const std::unordered_map<TermId, TermId>& declared,
+                      std::map<TermId, std::vector<TermId>>& fallback, TermId property) {
+        auto it = declared.find(property);
+        return it == declared.end() ? fallback[property] : std::vector<TermId>{it->second};
+    };
+
+    // Only the most specific properties get assertions; a superproperty's
+    // follow from its subproperties'.
+    for (TermId id : object_ids) {
+        if (has_subproperty.count(id))
+            continue;
+        ObjectProperty p;
+        p.iri = tbox.iri(id);
+        p.domain = poolOf(rootsOf(domain, restricted_domain, id));
+        p.range = poolOf(rootsOf(range, restricted_range, id));
+        if (p.domain.size == 0 || p.range.size == 0)
+            continue;
+        p.edges = static_cast<std::uint64_t>(std::llround(options_.mean_degree * static_cast<double>(p.domain.size)));
+        object_properties_.push_back(std::move(p));
+    }
+    for (TermId id : data_ids) {
+        if (has_subproperty.count(id))
+            continue;
+        DataProperty p;
+        p.iri = tbox.iri(id);
+        std::vector<TermId> datatypes = rootsOf(range, restricted_range, id);
+        if (!datatypes.empty() && named(datatypes[0]) && tbox.iri(datatypes[0]) != vocab::XSD_STRING)
+            p.datatype = tbox.iri(datatypes[0]);
+        p.kind = valueKind(p.datatype);
+        for (std::size_t leaf : leavesUnder(rootsOf(domain, restricted_domain, id)))
+            classes_[leaf].data_properties.push_back(data_properties_.size());
+        data_properties_.push_back(std::move(p));
+    }
+}
+
+template <typename Sink>
+GeneratorReport Generator::run(Sink& sink) const
+{
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Job> jobs;
+    for (std::size_t c = 0; c < classes_.size(); ++c)
+        for (std::uint64_t b = 0; b < classes_[c].count; b += BLOCK)
+            jobs.push_back(Job{false, c, b, std::min(classes_[c].count, b + BLOCK)});
+    for (std::size_t p = 0; p < object_properties_.size(); ++p)
+        for (std::uint64_t b = 0; b < object_properties_[p].edges; b += BLOCK)
+            jobs.push_back(Job{true, p, b, std::min(object_properties_[p].edges, b + BLOCK)});
+
+    // Rank exponent for a degree distribution P(d) ~ d^-gamma.
+    double s = 1.0 / (options_.degree_exponent - 1.0);
+    auto generate = [&](const Job& job, typename Sink::Chunk& chunk) {
+        Random rng(options_.seed ^ util::mix64((std::uint64_t(job.edges) << 63) ^ (std::uint64_t(job.index) << 40)
+                                               ^ (job.begin / BLOCK)));
+        if (!job.edges) {
+            const ClassInfo& c = classes_[job.index];
+            std::string value;
+            for (std::uint64_t i = job.begin; i < job.end; ++i) {
+                chunk.typed(job.index, i, options_.labels);
+                for (std::size_t d : c.data_properties) {
+                    if (rng.uniform() >= options_.data_fill)
+                        continue;
+                    makeValue(data_properties_[d], rng, value);
+                    chunk.value(d, value);
+                }
+            }
+            return;
+        }
+        // Ranks are rotated per property, so each has its own hubs.
+        const ObjectProperty& p = object_properties_[job.index];
+        std::uint64_t domain_shift = util::mix64(job.index * 2 + 1) % p.domain.size;
+        std::uint64_t range_shift = util::mix64(job.index * 2 + 2) % p.range.size;
+        for (std::uint64_t e = job.begin; e < job.end; ++e) {
+            std::uint64_t subject = (powerLawRank(p.domain.size, s, rng.uniform()) + domain_shift) % p.domain.size;
+            std::uint64_t object = (powerLawRank(p.range.size, s, rng.uniform()) + range_shift) % p.range.size;
+            chunk.edge(pick(p.domain, subject), job.index, pick(p.range, object));
+        }
+    };
+
+    GeneratorReport report;
+    report.classes = classes_.size();
+    report.object_properties = object_properties_.size();
+    report.data_properties = data_properties_.size();
+    report.individuals = individuals_;
+    std::size_t batch = std::min<std::size_t>(256, std::max(4u, options_.threads * 4));
+    for (std::size_t first = 0; first < jobs.size(); first += batch) {
+        std::size_t last = std::min(jobs.size(), first + batch);
+        std::vector<typename Sink::Chunk> chunks;
+        for (std::size_t j = first; j < last; ++j)
+            chunks.push_back(sink.chunk());
+        if (options_.threads <= 1) {
+            for (std::size_t j = first; j < last; ++j)
+                generate(jobs[j], chunks[j - first]);
+        } else {
+            util::parallelFor(first, last, [&](std::size_t b, std::size_t e) {
+                for (std::size_t j = b; j < e; ++j)
+                    generate(jobs[j], chunks[j - first]);
+            }, 1);
+        }
+        for (auto& chunk : chunks) {
+            report.triples += chunk.triples();
+            sink.commit(chunk);
+        }
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+GeneratorReport Generator::writeNTriples(const std::string& path) const
+{
+    NTriplesSink sink(*this, namespace_, path);
+    sink.writeTBox(tbox_);
+    GeneratorReport report = run(sink);
+    sink.close();
+    return report;
+}
+
+GeneratorReport Generator::populate(owl2::Ontology& onto) const
+{
+    OntologySink sink(*this, namespace_, onto);
+    return run(sink);
+}
+
+
+}
+
+}
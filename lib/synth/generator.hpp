@@ -0,0 +1,138 @@
+#ifndef SYNTH_GENERATOR_HPP
+#define SYNTH_GENERATOR_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "owl2/ontology.hpp"
+
+
+namespace ista
+{
+
+namespace synth
+{
+
+
+struct GeneratorOptions
+{
+    std::uint64_t seed = 1;
+    // Individuals generated for each leaf class (classes with no named
+    // subclass); superclasses are populated through their leaves.
+    std::uint64_t individuals_per_class = 1000;
+    // Overrides by class IRI or local name.
+    std::unordered_map<std::string, std::uint64_t> class_individuals;
+    // Object-property edges per individual of the property's domain.
+    double mean_degree = 4.0;
+    // Exponent of the power-law degree distribution; subjects and objects
+    // are both drawn from it, so out- and in-degrees are heavy tailed.
+    double degree_exponent = 2.1;
+    // Chance that an individual gets a value for each data property whose
+    // domain covers its class.
+    double data_fill = 0.8;
+    bool labels = true;
+    unsigned threads = 1;
+};
+
+struct GeneratorReport
+{
+    std::uint64_t classes = 0;              // leaf classes populated
+    std::uint64_t object_properties = 0;
+    std::uint64_t data_properties = 0;
+    std::uint64_t individuals = 0;
+    std::uint64_t triples = 0;              // generated, not counting the TBox
+    double seconds = 0.0;
+};
+
+
+// Populates a TBox with synthetic individuals for scale testing.
+//
+// Individuals are named like `ista build` names them (the ontology
+// namespace, the lowercased class name, '_' and a number) and typed with
+// their class. Object properties connect individuals of their rdfs:domain
+// and rdfs:range, both including subclasses, with missing, blank or
+// owl:Thing ends meaning any individual. Data properties get values
+// shaped by their rdfs:range: pseudo-word strings from a Zipf-distributed
+// vocabulary, log-normal numbers, booleans and dates.
+//
+// Work is cut into fixed blocks, each with its own random stream derived
+// from the seed, so the output depends on the options only and not on the
+// thread count.
+class Generator
+{
+public:
+    Generator(const owl2::Ontology& tbox, GeneratorOptions options);
+
+    // Writes the TBox followed by the generated triples as N-Triples.
+    GeneratorReport writeNTriples(const std::string& path) const;
+    // Adds the generated triples to `onto`, which must hold the TBox (for
+    // example, a copy of it).
+    GeneratorReport populate(owl2::Ontology& onto) const;
+
+    struct ClassInfo
+    {
+        std::string iri;
+        std::string slug;                    // lowercased local name
+        std::string label;
+        std::uint64_t first = 0;             // global index of the first individual
+        std::uint64_t count = 0;
+        std::vector<std::size_t> data_properties;
+    };
+
+    // Individuals of a domain or range: ranges of global indices.
+    struct Pool
+    {
+        std::vector<std::uint64_t> starts;
+        std::vector<std::uint64_t> cumulative;   // individuals before each range
+        std::uint64_t size = 0;
+    };
+
+    struct ObjectProperty
+    {
+        std::string iri;
+        Pool domain;
+        Pool range;
+        std::uint64_t edges = 0;
+    };
+
+    enum class ValueKind
+    {
+        String,
+        Integer,
+        Decimal,
+        Boolean,
+        Date,
+    };
+
+    struct DataProperty
+    {
+        std::string iri;
+        std::string datatype;   // empty for xsd:string
+        ValueKind kind = ValueKind::String;
+    };
+
+    const std::vector<ClassInfo>& classes() const { return classes_; }
+    const std::vector<ObjectProperty>& objectProperties() const { return object_properties_; }
+    const std::vector<DataProperty>& dataProperties() const { return data_properties_; }
+
+private:
+    template <typename Sink>
+    GeneratorReport run(Sink& sink) const;
+
+    const owl2::Ontology& tbox_;
+    GeneratorOptions options_;
+    std::string namespace_;
+    std::vector<ClassInfo> classes_;
+    std::vector<ObjectProperty> object_properties_;
+    std::vector<DataProperty> data_properties_;
+    std::uint64_t individuals_ = 0;
+};
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,36 @@
+#include "bloom_filter.hpp"
+
+#include <bit>
+
+namespace ista
+{
+
+namespace util
+{
+
+
+BloomFilter::BloomFilter(std::size_t expected_keys, std::pmr::memory_resource* resource)
+    : words_(resource)
+{
+    if (expected_keys == 0)
+        return;
+    // Power-of-two block count, so a block is picked with a mask.
+    std::size_t blocks = std::bit_ceil((expected_keys * BITS_PER_KEY + 511) / 512);
+    words_.assign(8 * blocks, 0);
+    block_mask_ = blocks - 1;
+    capacity_ = blocks * 512 / BITS_PER_KEY;
+}
+
+void BloomFilter::insert(std::uint64_t hash)
+{
+    std::uint64_t* block = words_.data() + 8 * ((hash >> 32) & block_mask_);
+    auto low = static_cast<std::uint32_t>(hash);
+    for (unsigned i = 0; i < 8; ++i)
+        block[i] |= bit(low, i);
+    ++size_;
+}
+
+
+}
+
+}
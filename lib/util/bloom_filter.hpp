@@ -0,0 +1,76 @@
+#ifndef BLOOM_FILTER_HPP
+#define BLOOM_FILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+#include "hash.hpp"
+
+
+namespace ista
+{
+
+namespace util
+{
+
+
+// Blocked Bloom filter (Putze, Sanders and Singler) for approximate set
+// membership of strings. A key picks one 64-byte block by its hash and sets
+// one bit in each of the block's eight words, so a query reads a single
+// cache line. At BITS_PER_KEY the false positive rate stays under 1%; a
+// filter with nothing in it rejects everything.
+class BloomFilter
+{
+public:
+    static constexpr std::size_t BITS_PER_KEY = 12;
+
+    explicit BloomFilter(std::size_t expected_keys = 0,
+                         std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    // Inserting needs a filter sized for at least one key.
+    void insert(std::string_view key) { insert(hashBytes(key)); }
+    bool mayContain(std::string_view key) const { return mayContain(hashBytes(key)); }
+
+    void insert(std::uint64_t hash);
+    bool mayContain(std::uint64_t hash) const
+    {
+        if (words_.empty())
+            return false;
+        const std::uint64_t* block = words_.data() + 8 * ((hash >> 32) & block_mask_);
+        auto low = static_cast<std::uint32_t>(hash);
+        for (unsigned i = 0; i < 8; ++i)
+            if (!(block[i] & bit(low, i)))
+                return false;
+        return true;
+    }
+
+    // Keys inserted, and how many the filter was sized for; past that the
+    // false positive rate climbs and the owner should rebuild it larger.
+    std::size_t size() const { return size_; }
+    std::size_t capacity() const { return capacity_; }
+    std::size_t byteSize() const { return words_.size() * sizeof(std::uint64_t); }
+
+private:
+    static std::uint64_t bit(std::uint32_t low, unsigned word)
+    {
+        // Odd multipliers spread the low hash half over the eight words.
+        static constexpr std::uint32_t SALT[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                                  0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+        return std::uint64_t(1) << ((low * SALT[word]) >> 26);
+    }
+
+    std::pmr::vector<std::uint64_t> words_;
+    std::uint64_t block_mask_ = 0;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = 0;
+};
+
+
+}
+
+}
+
+#endif
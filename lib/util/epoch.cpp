@@ -0,0 +1,69 @@
+#include "epoch.hpp"
+
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+namespace ista
+{
+
+namespace util
+{
+
+
+EpochManager::EpochManager() : slots_(new Slot[MAX_READERS])
+{
+}
+
+EpochManager::~EpochManager()
+{
+    for (auto& [epoch, destroy] : retired_)
+        destroy();
+}
+
+EpochManager::Guard EpochManager::pin()
+{
+    std::size_t start = std::hash<std::thread::id>()(std::this_thread::get_id());
+    for (std::size_t n = 0; n < MAX_READERS; ++n) {
+        Slot& slot = slots_[(start + n) % MAX_READERS];
+        std::uint64_t epoch = global_.load(std::memory_order_seq_cst);
+        std::uint64_t expected = 0;
+        if (!slot.epoch.compare_exchange_strong(expected, epoch, std::memory_order_seq_cst))
+            continue;
+        // The writer may have advanced between the load and the claim; make
+        // sure the slot shows an epoch that was current after it was set.
+        for (std::uint64_t now; (now = global_.load(std::memory_order_seq_cst)) != epoch; epoch = now)
+            slot.epoch.store(now, std::memory_order_seq_cst);
+        return Guard(&slot.epoch);
+    }
+    throw std::runtime_error("too many concurrent readers");
+}
+
+void EpochManager::retire(std::function<void()> destroy)
+{
+    retired_.emplace_back(global_.load(std::memory_order_relaxed), std::move(destroy));
+    global_.fetch_add(1, std::memory_order_seq_cst);
+}
+
+void EpochManager::collect()
+{
+    std::uint64_t oldest = UINT64_MAX;
+    for (std::size_t i = 0; i < MAX_READERS; ++i) {
+        std::uint64_t epoch = slots_[i].epoch.load(std::memory_order_seq_cst);
+        if (epoch != 0 && epoch < oldest)
+            oldest = epoch;
+    }
+    std::size_t kept = 0;
+    for (auto& entry : retired_) {
+        if (entry.first < oldest)
+            entry.second();
+        else
+            retired_[kept++] = std::move(entry);
+    }
+    retired_.resize(kept);
+}
+
+
+}
+
+}
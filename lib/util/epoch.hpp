@@ -0,0 +1,88 @@
+#ifndef EPOCH_HPP
+#define EPOCH_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+namespace ista
+{
+
+namespace util
+{
+
+
+// Epoch-based reclamation for one writer and any number of readers.
+//
+// A reader pins the current epoch for as long as it dereferences shared
+// pointers. The writer unpublishes an object, hands its destructor to
+// retire(), and collect() runs it once every reader pinned at or before
+// the retirement epoch has let go. Pinning is a store to a per-reader slot.
+// Readers never take a lock or wait on the writer.
+class EpochManager
+{
+public:
+    static constexpr std::size_t MAX_READERS = 1024;
+
+    class Guard
+    {
+    public:
+        Guard() = default;
+        Guard(Guard&& other) noexcept : slot_(std::exchange(other.slot_, nullptr)) {}
+        Guard& operator=(Guard&& other) noexcept
+        {
+            release();
+            slot_ = std::exchange(other.slot_, nullptr);
+            return *this;
+        }
+        ~Guard() { release(); }
+
+    private:
+        friend class EpochManager;
+        explicit Guard(std::atomic<std::uint64_t>* slot) : slot_(slot) {}
+        void release()
+        {
+            if (slot_)
+                slot_->store(0, std::memory_order_release);
+            slot_ = nullptr;
+        }
+
+        std::atomic<std::uint64_t>* slot_ = nullptr;
+    };
+
+    EpochManager();
+    ~EpochManager();
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    // Reader side; safe from any thread. Throws if MAX_READERS guards are
+    // already held.
+    Guard pin();
+
+    // Writer side. `destroy` runs once no reader can still observe the
+    // object; retire only after the object has been unpublished.
+    void retire(std::function<void()> destroy);
+    void collect();
+    std::size_t pending() const { return retired_.size(); }
+
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<std::uint64_t> epoch{0};   // 0 means free
+    };
+
+    std::atomic<std::uint64_t> global_{1};
+    std::unique_ptr<Slot[]> slots_;
+    std::vector<std::pair<std::uint64_t, std::function<void()>>> retired_;
+};
+
+
+}
+
+}
+
+#endif
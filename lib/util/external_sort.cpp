@@ -0,0 +1,66 @@
+#include "external_sort.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include <unistd.h>
+
+namespace ista
+{
+
+namespace util
+{
+
+
+static std::atomic<std::uint64_t> spill_counter{0};
+
+
+SpillFile::SpillFile(const std::string& dir)
+{
+    std::filesystem::path base = dir.empty() ? std::filesystem::temp_directory_path() : std::filesystem::path(dir);
+    std::filesystem::create_directories(base);
+    path_ = (base / ("ista-spill-" + std::to_string(::getpid()) + "-" + std::to_string(spill_counter++) + ".run")).string();
+    file_ = std::fopen(path_.c_str(), "w+b");
+    if (!file_)
+        throw std::runtime_error("cannot create spill file " + path_ + ": " + std::strerror(errno));
+    // Unlinked right away, so a crashed build leaves nothing behind.
+    std::remove(path_.c_str());
+    // Runs are written and read in whole blocks already, and a buffer per
+    // open run would not count against the sort budget.
+    std::setvbuf(file_, nullptr, _IONBF, 0);
+}
+
+SpillFile::~SpillFile()
+{
+    if (file_)
+        std::fclose(file_);
+}
+
+void SpillFile::write(const void* data, std::size_t bytes)
+{
+    if (bytes != 0 && std::fwrite(data, 1, bytes, file_) != bytes)
+        throw std::runtime_error("cannot write spill file " + path_ + ": " + std::strerror(errno));
+    size_ += bytes;
+}
+
+void SpillFile::rewind()
+{
+    if (std::fflush(file_) != 0 || std::fseek(file_, 0, SEEK_SET) != 0)
+        throw std::runtime_error("cannot rewind spill file " + path_ + ": " + std::strerror(errno));
+}
+
+std::size_t SpillFile::read(void* data, std::size_t bytes)
+{
+    std::size_t got = std::fread(data, 1, bytes, file_);
+    if (got < bytes && std::ferror(file_))
+        throw std::runtime_error("cannot read spill file " + path_ + ": " + std::strerror(errno));
+    return got;
+}
+
+
+}
+
+}
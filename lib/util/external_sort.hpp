@@ -0,0 +1,221 @@
+#ifndef EXTERNAL_SORT_HPP
+#define EXTERNAL_SORT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "parallel.hpp"
+#include "trace.hpp"
+
+
+namespace ista
+{
+
+namespace util
+{
+
+
+// A temporary binary file that is deleted when closed. Spill runs are
+// written once, rewound, and read back sequentially.
+class SpillFile
+{
+public:
+    explicit SpillFile(const std::string& dir);
+    ~SpillFile();
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    void write(const void* data, std::size_t bytes);
+    void rewind();
+    // Returns the number of bytes read; fewer than requested only at the end.
+    std::size_t read(void* data, std::size_t bytes);
+
+    const std::string& path() const { return path_; }
+    std::uint64_t size() const { return size_; }
+
+private:
+    std::string path_;
+    std::FILE* file_ = nullptr;
+    std::uint64_t size_ = 0;
+};
+
+
+// Sorts more records than fit in memory. Records are buffered until the
+// buffer reaches `budget_bytes`, then sorted and written out as a run; merge()
+// spills the tail as a run too and streams a k-way merge of all runs through
+// a callback, reading each run in blocks that together stay within the
+// budget. When there are too many runs for blocks of MERGE_BLOCK records,
+// groups of runs are first merged into longer ones. A budget of 0 never
+// spills.
+template <typename T, typename Less = std::less<T>>
+class ExternalSorter
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+    // Records per run read at a time in a merge, unless the budget is too
+    // small for two runs of that many.
+    static constexpr std::size_t MERGE_BLOCK = 4096;
+
+    ExternalSorter(std::uint64_t budget_bytes, std::string spill_dir, unsigned threads, Less less = Less())
+        : budget_(budget_bytes), dir_(std::move(spill_dir)), threads_(threads), less_(less)
+    {
+    }
+
+    void push(const T& value)
+    {
+        if (budget_ != 0 && buffer_.capacity() == 0)
+            buffer_.reserve(std::max<std::size_t>(1, budget_ / sizeof(T)));
+        buffer_.push_back(value);
+        if (budget_ != 0 && buffer_.size() * sizeof(T) >= budget_)
+            spill();
+    }
+
+    std::uint64_t size() const { return count_ + buffer_.size(); }
+    std::size_t runCount() const { return runs_.size(); }
+    std::uint64_t spilledBytes() const { return spilled_; }
+
+    // Calls fn(const T&) on every record in sorted order; records that compare
+    // equal keep no particular order. The sorter is empty afterwards.
+    template <typename Fn>
+    void merge(Fn&& fn)
+    {
+        ISTA_TRACE_SCOPE("sort merge");
+        if (runs_.empty()) {
+            parallelSort(buffer_, threads_, less_);
+            for (const T& value : buffer_)
+                fn(value);
+            clear();
+            return;
+        }
+        // The tail becomes a run as well, so the merge blocks have the whole
+        // budget to themselves.
+        if (!buffer_.empty())
+            spill();
+        buffer_ = std::vector<T>();
+
+        std::size_t fan_in = std::max<std::uint64_t>(2, budget_ / (MERGE_BLOCK * sizeof(T)));
+        while (runs_.size() > fan_in) {
+            ISTA_TRACE_SCOPE("sort merge pass");
+            std::vector<std::unique_ptr<SpillFile>> merged;
+            for (std::size_t first = 0; first < runs_.size(); first += fan_in) {
+                std::size_t last = std::min(runs_.size(), first + fan_in);
+                if (last - first == 1) {
+                    merged.push_back(std::move(runs_[first]));
+                    continue;
+                }
+                // The output block takes one share of the budget.
+                auto out = std::make_unique<SpillFile>(dir_);
+                std::vector<T> pending;
+                pending.reserve(blockSize(last - first + 1));
+                mergeRuns(first, last, last - first + 1, [&](const T& value) {
+                    pending.push_back(value);
+                    if (pending.size() == pending.capacity()) {
+                        out->write(pending.data(), pending.size() * sizeof(T));
+                        pending.clear();
+                    }
+                });
+                out->write(pending.data(), pending.size() * sizeof(T));
+                merged.push_back(std::move(out));
+            }
+            runs_ = std::move(merged);
+        }
+        mergeRuns(0, runs_.size(), runs_.size(), fn);
+        clear();
+    }
+
+private:
+    void spill()
+    {
+        ISTA_TRACE_SCOPE("sort spill");
+        parallelSort(buffer_, threads_, less_);
+        runs_.push_back(std::make_unique<SpillFile>(dir_));
+        runs_.back()->write(buffer_.data(), buffer_.size() * sizeof(T));
+        spilled_ += buffer_.size() * sizeof(T);
+        count_ += buffer_.size();
+        buffer_.clear();
+    }
+
+    std::size_t blockSize(std::size_t shares) const
+    {
+        return std::max<std::uint64_t>(1, budget_ / (shares * sizeof(T)));
+    }
+
+    // Streams a k-way merge of runs_[first, last) through fn, with each run
+    // read in blocks of one of `shares` equal parts of the budget. The runs
+    // are deleted afterwards.
+    template <typename Fn>
+    void mergeRuns(std::size_t first, std::size_t last, std::size_t shares, Fn&& fn)
+    {
+        std::size_t block = blockSize(shares);
+        struct Cursor
+        {
+            SpillFile* file;
+            std::vector<T> data;
+            std::size_t pos = 0;
+        };
+        std::vector<Cursor> cursors;
+        auto refill = [&](Cursor& c) {
+            c.pos = 0;
+            c.data.resize(block);
+            std::size_t got = c.file->read(c.data.data(), block * sizeof(T)) / sizeof(T);
+            c.data.resize(got);
+            return got != 0;
+        };
+        for (std::size_t r = first; r < last; ++r) {
+            runs_[r]->rewind();
+            cursors.push_back(Cursor{runs_[r].get(), {}, 0});
+            refill(cursors.back());
+        }
+
+        auto greater = [&](std::size_t a, std::size_t b) {
+            return less_(cursors[b].data[cursors[b].pos], cursors[a].data[cursors[a].pos]);
+        };
+        std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(greater)> heap(greater);
+        for (std::size_t i = 0; i < cursors.size(); ++i)
+            if (!cursors[i].data.empty())
+                heap.push(i);
+        while (!heap.empty()) {
+            std::size_t i = heap.top();
+            heap.pop();
+            Cursor& c = cursors[i];
+            fn(c.data[c.pos]);
+            if (++c.pos == c.data.size() && !refill(c))
+                continue;
+            heap.push(i);
+        }
+        for (std::size_t r = first; r < last; ++r)
+            runs_[r].reset();
+    }
+
+    void clear()
+    {
+        buffer_ = std::vector<T>();
+        runs_.clear();
+        count_ = 0;
+    }
+
+    std::uint64_t budget_;
+    std::string dir_;
+    unsigned threads_;
+    Less less_;
+    std::vector<T> buffer_;
+    std::vector<std::unique_ptr<SpillFile>> runs_;
+    std::uint64_t count_ = 0;
+    std::uint64_t spilled_ = 0;
+};
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef HASH_HPP
+#define HASH_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+
+namespace ista
+{
+
+namespace util
+{
+
+
+inline std::uint64_t mix64(std::uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// Word-at-a-time string hash. IRIs share long namespace prefixes, so the
+// whole string is consumed rather than a sample of it.
+inline std::uint64_t hashBytes(std::string_view s, std::uint64_t seed = 0x9e3779b97f4a7c15ULL)
+{
+    const char* p = s.data();
+    std::size_t n = s.size();
+    std::uint64_t h = seed ^ (n * 0x100000001b3ULL);
+    while (n >= 8) {
+        std::uint64_t w;
+        std::memcpy(&w, p, 8);
+        h = (h ^ mix64(w)) * 0x9fb21c651e98df25ULL;
+        p += 8;
+        n -= 8;
+    }
+    std::uint64_t tail = 0;
+    std::memcpy(&tail, p, n);
+    h = (h ^ mix64(tail ^ n)) * 0x9fb21c651e98df25ULL;
+    return mix64(h);
+}
+
+
+}
+
+}
+
+#endif
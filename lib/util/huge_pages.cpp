@@ -0,0 +1,146 @@
+#include "huge_pages.hpp"
+
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+
+namespace ista
+{
+
+namespace util
+{
+
+
+const char* hugePagesName(HugePages mode)
+{
+    switch (mode) {
+    case HugePages::Off: return "off";
+    case HugePages::Transparent: return "thp";
+    case HugePages::Explicit: return "hugetlb";
+    }
+    return "off";
+}
+
+HugePages parseHugePages(std::string_view text)
+{
+    if (text == "off" || text == "0")
+        return HugePages::Off;
+    if (text == "thp" || text == "transparent" || text == "1")
+        return HugePages::Transparent;
+    if (text == "hugetlb" || text == "explicit")
+        return HugePages::Explicit;
+    throw std::invalid_argument("unknown huge page mode '" + std::string(text) + "' (expected off, thp or hugetlb)");
+}
+
+static HugePages envHugePages()
+{
+    if (const char* env = std::getenv("ISTA_HUGE_PAGES")) {
+        try {
+            return parseHugePages(env);
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    return HugePages::Off;
+}
+
+static std::atomic<HugePages>& modeSlot()
+{
+    static std::atomic<HugePages> mode{envHugePages()};
+    return mode;
+}
+
+HugePages hugePageMode()
+{
+    return modeSlot().load(std::memory_order_relaxed);
+}
+
+void setHugePageMode(HugePages mode)
+{
+    modeSlot().store(mode, std::memory_order_relaxed);
+}
+
+
+static std::size_t roundUpToHugePage(std::size_t n)
+{
+    return (n + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+
+void* mapHuge(std::size_t bytes, HugePages mode)
+{
+    std::size_t length = roundUpToHugePage(bytes);
+#ifdef MAP_HUGETLB
+    if (mode == HugePages::Explicit) {
+        void* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+            return p;
+        mode = HugePages::Transparent;
+    }
+#endif
+    // Over-map by one huge page and trim both ends, so the block starts on
+    // a 2 MiB boundary and every page of it can be collapsed.
+    void* raw = ::mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        throw std::bad_alloc();
+    auto start = reinterpret_cast<std::uintptr_t>(raw);
+    std::uintptr_t aligned = roundUpToHugePage(start);
+    if (aligned > start)
+        ::munmap(raw, aligned - start);
+    if (std::size_t tail = start + HUGE_PAGE_SIZE - aligned)
+        ::munmap(reinterpret_cast<void*>(aligned + length), tail);
+#ifdef MADV_HUGEPAGE
+    if (mode == HugePages::Transparent)
+        ::madvise(reinterpret_cast<void*>(aligned), length, MADV_HUGEPAGE);
+#endif
+    return reinterpret_cast<void*>(aligned);
+}
+
+void unmapHuge(void* p, std::size_t bytes)
+{
+    if (p)
+        ::munmap(p, roundUpToHugePage(bytes));
+}
+
+
+void* HugePageResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    HugePages mode = hugePageMode();
+    if (mode == HugePages::Off || bytes < threshold_ || alignment > HUGE_PAGE_SIZE)
+        return upstream_->allocate(bytes, alignment);
+    void* p = mapHuge(bytes, mode);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        mapped_.insert(p);
+    }
+    mapped_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    return p;
+}
+
+void HugePageResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+{
+    bool mapped = false;
+    if (bytes >= threshold_ && alignment <= HUGE_PAGE_SIZE) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        mapped = mapped_.erase(p) != 0;
+    }
+    if (!mapped) {
+        upstream_->deallocate(p, bytes, alignment);
+        return;
+    }
+    unmapHuge(p, bytes);
+    mapped_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+HugePageResource& hugePageResource()
+{
+    // Never destroyed, like the subsystem resources that allocate from it.
+    static auto* resource = new HugePageResource();
+    return *resource;
+}
+
+
+}
+
+}
@@ -0,0 +1,85 @@
+#ifndef HUGE_PAGES_HPP
+#define HUGE_PAGES_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <string_view>
+#include <unordered_set>
+
+
+namespace ista
+{
+
+namespace util
+{
+
+
+constexpr std::size_t HUGE_PAGE_SIZE = std::size_t(2) << 20;
+
+// How large arrays are backed. Random access over a multi-GB column touches
+// a new 4 KiB page on almost every load, so the TLB misses dominate; 2 MiB
+// pages cover 512 times as much per entry.
+//
+// Transparent maps 2 MiB-aligned anonymous memory and asks the kernel for
+// THP with madvise(MADV_HUGEPAGE). Explicit takes pages from the reserved
+// hugetlbfs pool with MAP_HUGETLB and falls back to Transparent when the
+// pool is empty. Linux only; elsewhere every mode behaves like Off.
+enum class HugePages
+{
+    Off,
+    Transparent,
+    Explicit,
+};
+
+const char* hugePagesName(HugePages mode);
+// Accepts off, thp (or transparent) and hugetlb (or explicit).
+HugePages parseHugePages(std::string_view text);
+
+// The process-wide mode, initially from the ISTA_HUGE_PAGES environment
+// variable (default off).
+HugePages hugePageMode();
+void setHugePageMode(HugePages mode);
+
+// Anonymous zero-filled mapping of at least `bytes`, backed as `mode` asks.
+// Release it with unmapHuge(p, bytes).
+void* mapHuge(std::size_t bytes, HugePages mode);
+void unmapHuge(void* p, std::size_t bytes);
+
+// Serves allocations of at least `threshold` bytes from mapHuge() in the
+// process-wide mode and passes smaller ones, and every one while the mode is
+// Off, upstream. The mapped blocks are remembered, so a block is released
+// the same way it was allocated even if the mode changes in between.
+class HugePageResource : public std::pmr::memory_resource
+{
+public:
+    explicit HugePageResource(std::size_t threshold = HUGE_PAGE_SIZE,
+                              std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : threshold_(threshold), upstream_(upstream) {}
+
+    // Bytes currently held in mapped blocks.
+    std::uint64_t mappedBytes() const { return mapped_bytes_.load(std::memory_order_relaxed); }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    std::size_t threshold_;
+    std::pmr::memory_resource* upstream_;
+    std::atomic<std::uint64_t> mapped_bytes_{0};
+    std::mutex mutex_;
+    std::unordered_set<void*> mapped_;
+};
+
+// The resource the subsystem TrackingResources allocate from.
+HugePageResource& hugePageResource();
+
+
+}
+
+}
+
+#endif
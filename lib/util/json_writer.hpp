@@ -0,0 +1,150 @@
+#ifndef JSON_WRITER_HPP
+#define JSON_WRITER_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace ista
+{
+
+namespace util
+{
+
+
+// Minimal streaming JSON emitter for reports (stats, diffs, metrics). Commas
+// and indentation are tracked on a small stack; callers only say what to
+// write.
+class JsonWriter
+{
+public:
+    explicit JsonWriter(std::ostream& out, bool pretty = true) : out_(out), pretty_(pretty) {}
+
+    void beginObject() { open('{'); }
+    void endObject() { close('}'); }
+    void beginArray() { open('['); }
+    void endArray() { close(']'); }
+
+    void key(std::string_view k)
+    {
+        separator();
+        writeString(k);
+        out_ << (pretty_ ? ": " : ":");
+        after_key_ = true;
+    }
+
+    void value(std::string_view v) { separator(); writeString(v); }
+    void value(const char* v) { value(std::string_view(v)); }
+    void value(bool v) { separator(); out_ << (v ? "true" : "false"); }
+    void value(std::uint64_t v) { separator(); out_ << v; }
+    void value(std::int64_t v) { separator(); out_ << v; }
+    void value(unsigned v) { value(static_cast<std::uint64_t>(v)); }
+    void value(int v) { value(static_cast<std::int64_t>(v)); }
+    void value(double v)
+    {
+        separator();
+        if (!std::isfinite(v)) {
+            out_ << "null";
+            return;
+        }
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.6g", v);
+        out_ << buf;
+    }
+    void null() { separator(); out_ << "null"; }
+
+    template <typename T>
+    void field(std::string_view k, const T& v)
+    {
+        key(k);
+        value(v);
+    }
+
+    static void escape(std::string& out, std::string_view s)
+    {
+        for (char c : s) {
+            unsigned char u = static_cast<unsigned char>(c);
+            switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (u < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", u);
+                    out += buf;
+                } else {
+                    out.push_back(c);
+                }
+            }
+        }
+    }
+
+private:
+    void writeString(std::string_view s)
+    {
+        scratch_.clear();
+        scratch_.push_back('"');
+        escape(scratch_, s);
+        scratch_.push_back('"');
+        out_ << scratch_;
+    }
+
+    void separator()
+    {
+        if (after_key_) {
+            after_key_ = false;
+            return;
+        }
+        if (!first_.empty()) {
+            if (!first_.back())
+                out_ << ',';
+            first_.back() = false;
+            newline();
+        }
+    }
+
+    void newline()
+    {
+        if (pretty_)
+            out_ << '\n' << std::string(2 * first_.size(), ' ');
+    }
+
+    void open(char c)
+    {
+        separator();
+        out_ << c;
+        first_.push_back(true);
+    }
+
+    void close(char c)
+    {
+        bool empty = first_.back();
+        first_.pop_back();
+        if (!empty)
+            newline();
+        out_ << c;
+        if (first_.empty() && pretty_)
+            out_ << '\n';
+    }
+
+    std::ostream& out_;
+    bool pretty_;
+    bool after_key_ = false;
+    std::vector<bool> first_;
+    std::string scratch_;
+};
+
+
+}
+
+}
+
+#endif
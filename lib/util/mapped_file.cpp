@@ -0,0 +1,148 @@
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ista
+{
+
+namespace util
+{
+
+
+MappedFile::MappedFile(const std::string& path)
+    : path_(path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open '" + path + "': " + std::strerror(errno));
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("cannot stat '" + path + "': " + std::strerror(errno));
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ > 0) {
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("cannot map '" + path + "': " + std::strerror(errno));
+        }
+        data_ = static_cast<const char*>(p);
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+        ::munmap(const_cast<char*>(data_), size_);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : path_(std::move(other.path_)),
+      data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        if (data_)
+            ::munmap(const_cast<char*>(data_), size_);
+        path_ = std::move(other.path_);
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+void MappedFile::adviseSequential() const
+{
+    if (data_)
+        ::madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+}
+
+void MappedFile::adviseRandom() const
+{
+    if (data_)
+        ::madvise(const_cast<char*>(data_), size_, MADV_RANDOM);
+}
+
+void MappedFile::adviseWillNeed() const
+{
+    if (data_)
+        ::madvise(const_cast<char*>(data_), size_, MADV_WILLNEED);
+}
+
+void MappedFile::adviseHugePages() const
+{
+#ifdef MADV_HUGEPAGE
+    if (data_)
+        ::madvise(const_cast<char*>(data_), size_, MADV_HUGEPAGE);
+#endif
+}
+
+static void adviseRange(const char* data, std::size_t size, std::size_t offset, std::size_t length, int advice)
+{
+    if (!data || offset >= size || length == 0)
+        return;
+    std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    std::size_t begin = offset / page * page;
+    std::size_t end = std::min(size, offset + length);
+    ::madvise(const_cast<char*>(data) + begin, end - begin, advice);
+}
+
+void MappedFile::adviseWillNeed(std::size_t offset, std::size_t length) const
+{
+    adviseRange(data_, size_, offset, length, MADV_WILLNEED);
+}
+
+void MappedFile::release(std::size_t offset, std::size_t length) const
+{
+    adviseRange(data_, size_, offset, length, MADV_DONTNEED);
+}
+
+std::size_t MappedFile::residentBytes(std::size_t offset, std::size_t length) const
+{
+    if (!data_ || offset >= size_ || length == 0)
+        return 0;
+    std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    std::size_t begin = offset / page * page;
+    std::size_t end = std::min(size_, offset + length);
+    std::vector<unsigned char> in_core((end - begin + page - 1) / page);
+    if (::mincore(const_cast<char*>(data_) + begin, end - begin, in_core.data()) != 0)
+        return 0;
+    std::size_t resident = 0;
+    for (std::size_t k = 0; k < in_core.size(); ++k) {
+        if (in_core[k] & 1)
+            resident += std::min(end, begin + (k + 1) * page) - std::max(offset, begin + k * page);
+    }
+    return resident;
+}
+
+MemoryComponent MappedFile::memory(std::string name, std::size_t offset, std::size_t length) const
+{
+    MemoryComponent c;
+    c.name = std::move(name);
+    c.size = length;
+    c.capacity = length;
+    c.mapped = true;
+    c.resident = residentBytes(offset, length);
+    return c;
+}
+
+
+}
+
+}
@@ -0,0 +1,61 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+#include "memory.hpp"
+
+
+namespace ista
+{
+
+namespace util
+{
+
+
+// Read-only memory mapping of a whole file. Move-only; unmaps on destruction.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    const std::string& path() const { return path_; }
+
+    void adviseSequential() const;
+    void adviseRandom() const;
+    void adviseWillNeed() const;
+    // Range variants for streaming access, widened to whole pages: prefetch a
+    // window ahead of the reader and drop the one behind it, so a pass over a
+    // file larger than RAM evicts its own pages rather than everyone else's.
+    void adviseWillNeed(std::size_t offset, std::size_t length) const;
+    void release(std::size_t offset, std::size_t length) const;
+    // Asks for transparent huge pages on the mapping. Read-only file THP
+    // needs kernel support; where it is missing this does nothing.
+    void adviseHugePages() const;
+
+    // Bytes of [offset, offset + length) in the page cache, by whole pages.
+    std::size_t residentBytes(std::size_t offset, std::size_t length) const;
+    // The range as a mapped part of a memoryUsage() breakdown.
+    MemoryComponent memory(std::string name, std::size_t offset, std::size_t length) const;
+
+private:
+    std::string path_;
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,126 @@
+#include "memory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <iomanip>
+#include <string_view>
+
+#include "huge_pages.hpp"
+#include "resource_usage.hpp"
+
+namespace ista
+{
+
+namespace util
+{
+
+
+void* TrackingResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    void* p = upstream_->allocate(bytes, alignment);
+    allocated_.fetch_add(bytes, std::memory_order_relaxed);
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+    std::uint64_t now = in_use_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    std::uint64_t peak = peak_.load(std::memory_order_relaxed);
+    while (now > peak && !peak_.compare_exchange_weak(peak, now, std::memory_order_relaxed))
+        ;
+    return p;
+}
+
+void TrackingResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+{
+    upstream_->deallocate(p, bytes, alignment);
+    in_use_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+
+const char* subsystemName(Subsystem s)
+{
+    switch (s) {
+    case Subsystem::Ontology: return "ontology";
+    case Subsystem::Parser: return "parser";
+    case Subsystem::Graph: return "graph";
+    case Subsystem::Build: return "build";
+    }
+    return "unknown";
+}
+
+TrackingResource& subsystemResource(Subsystem s)
+{
+    // Never destroyed: containers with static storage may release memory
+    // after this translation unit's destructors would have run. Large
+    // blocks get huge pages when ISTA_HUGE_PAGES asks for them.
+    static auto* resources = new std::array<TrackingResource, SUBSYSTEM_COUNT>{
+        TrackingResource(subsystemName(Subsystem::Ontology), &hugePageResource()),
+        TrackingResource(subsystemName(Subsystem::Parser), &hugePageResource()),
+        TrackingResource(subsystemName(Subsystem::Graph), &hugePageResource()),
+        TrackingResource(subsystemName(Subsystem::Build), &hugePageResource()),
+    };
+    return (*resources)[static_cast<std::size_t>(s)];
+}
+
+std::vector<AllocationStats> allocationReport()
+{
+    std::vector<AllocationStats> report;
+    for (std::size_t i = 0; i < SUBSYSTEM_COUNT; ++i) {
+        const TrackingResource& r = subsystemResource(static_cast<Subsystem>(i));
+        report.push_back(AllocationStats{r.name(), r.bytesAllocated(), r.bytesInUse(), r.peakBytes(), r.allocations()});
+    }
+    return report;
+}
+
+void printAllocationReport(std::ostream& out)
+{
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-10s %14s %14s %14s %12s\n", "subsystem", "allocated", "in use", "peak",
+                  "allocations");
+    out << line;
+    for (const AllocationStats& s : allocationReport()) {
+        std::snprintf(line, sizeof(line), "%-10s %14s %14s %14s %12llu\n", s.name, formatBytes(s.allocated).c_str(),
+                      formatBytes(s.in_use).c_str(), formatBytes(s.peak).c_str(),
+                      static_cast<unsigned long long>(s.allocations));
+        out << line;
+    }
+}
+
+
+std::uint64_t allocationOverhead(std::uint64_t bytes)
+{
+    if (bytes == 0)
+        return 0;
+    if (bytes >= HUGE_PAGE_SIZE && hugePageMode() != HugePages::Off)
+        return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE - bytes;
+    std::uint64_t chunk = std::max<std::uint64_t>(32, (bytes + 8 + 15) / 16 * 16);
+    return chunk - bytes;
+}
+
+void printMemoryUsage(const MemoryUsage& usage, std::ostream& out)
+{
+    // The component column fits the longest name, key index IRIs included.
+    std::size_t width = std::string_view("component").size();
+    for (const MemoryComponent& c : usage)
+        width = std::max(width, c.name.size());
+    auto row = [&](std::string_view name, std::string_view kind, const std::array<std::string, 4>& columns) {
+        out << std::left << std::setw(static_cast<int>(width)) << name << " " << std::setw(6) << kind << std::right;
+        for (const std::string& column : columns)
+            out << " " << std::setw(12) << column;
+        out << "\n";
+    };
+    row("component", "kind", {"size", "capacity", "overhead", "footprint"});
+    std::uint64_t size = 0, capacity = 0, overhead = 0, footprint = 0;
+    for (const MemoryComponent& c : usage) {
+        row(c.name, c.mapped ? "mapped" : "heap",
+            {formatBytes(c.size), formatBytes(c.capacity), formatBytes(c.overhead), formatBytes(c.footprint())});
+        size += c.size;
+        capacity += c.capacity;
+        overhead += c.overhead;
+        footprint += c.footprint();
+    }
+    row("total", "", {formatBytes(size), formatBytes(capacity), formatBytes(overhead), formatBytes(footprint)});
+}
+
+
+}
+
+}
@@ -0,0 +1,127 @@
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace ista
+{
+
+namespace util
+{
+
+
+// Counts what passes through it and forwards to an upstream resource.
+// Counters are atomics, so one instance can be shared across threads as long
+// as the upstream is thread safe.
+class TrackingResource : public std::pmr::memory_resource
+{
+public:
+    explicit TrackingResource(const char* name,
+                              std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : name_(name), upstream_(upstream) {}
+
+    const char* name() const { return name_; }
+    std::pmr::memory_resource* upstream() const { return upstream_; }
+
+    std::uint64_t bytesAllocated() const { return allocated_.load(std::memory_order_relaxed); }
+    std::uint64_t bytesInUse() const { return in_use_.load(std::memory_order_relaxed); }
+    std::uint64_t peakBytes() const { return peak_.load(std::memory_order_relaxed); }
+    std::uint64_t allocations() const { return allocations_.load(std::memory_order_relaxed); }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    const char* name_;
+    std::pmr::memory_resource* upstream_;
+    std::atomic<std::uint64_t> allocated_{0};
+    std::atomic<std::uint64_t> in_use_{0};
+    std::atomic<std::uint64_t> peak_{0};
+    std::atomic<std::uint64_t> allocations_{0};
+};
+
+
+// The parts of libista that allocate in bulk. Each has a process-wide
+// TrackingResource that its containers default to, so a report shows where
+// a run's memory went; pass another resource (a monotonic arena for
+// build-once data, a pool for small objects) to a constructor to override.
+enum class Subsystem
+{
+    Ontology,   // term pools and axiom tables
+    Parser,     // reader scratch state
+    Graph,      // CSR construction and per-vertex state
+    Build,      // ista build key indexes and assembly
+};
+
+constexpr std::size_t SUBSYSTEM_COUNT = 4;
+
+const char* subsystemName(Subsystem s);
+TrackingResource& subsystemResource(Subsystem s);
+
+struct AllocationStats
+{
+    const char* name;
+    std::uint64_t allocated;
+    std::uint64_t in_use;
+    std::uint64_t peak;
+    std::uint64_t allocations;
+};
+
+std::vector<AllocationStats> allocationReport();
+void printAllocationReport(std::ostream& out);
+
+
+// One part of an object's footprint, from its memoryUsage(). A heap part
+// reports the bytes its live elements use, the bytes reserved for them and
+// what the allocator adds on top; a mapped part (a snapshot or CSR section)
+// reports its length in the file and how much of it is in the page cache.
+struct MemoryComponent
+{
+    std::string name;
+    std::uint64_t size = 0;
+    std::uint64_t capacity = 0;
+    std::uint64_t overhead = 0;
+    bool mapped = false;
+    std::uint64_t resident = 0;
+
+    // What the part costs in RAM right now.
+    std::uint64_t footprint() const { return mapped ? resident : capacity + overhead; }
+};
+
+using MemoryUsage = std::vector<MemoryComponent>;
+
+// Estimated bytes the subsystem resources add to a block of `bytes`: whole
+// huge pages for blocks served by mapHuge() while huge pages are on, a glibc
+// malloc chunk header and rounding otherwise. Containers given another resource (an arena, a pool)
+// pay something else.
+std::uint64_t allocationOverhead(std::uint64_t bytes);
+
+template <typename Vector>
+MemoryComponent vectorMemory(std::string name, const Vector& v)
+{
+    using T = typename Vector::value_type;
+    MemoryComponent c;
+    c.name = std::move(name);
+    c.size = v.size() * sizeof(T);
+    c.capacity = v.capacity() * sizeof(T);
+    c.overhead = allocationOverhead(c.capacity);
+    return c;
+}
+
+void printMemoryUsage(const MemoryUsage& usage, std::ostream& out);
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,171 @@
+#include "numa.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ista
+{
+
+namespace util
+{
+
+
+// Parses a sysfs list such as "0-3,8-11".
+static std::vector<int> parseList(const std::string& text)
+{
+    std::vector<int> out;
+    std::stringstream in(text);
+    std::string part;
+    while (std::getline(in, part, ',')) {
+        if (part.empty() || part == "\n")
+            continue;
+        std::size_t dash = part.find('-');
+        int lo = std::stoi(part.substr(0, dash));
+        int hi = dash == std::string::npos ? lo : std::stoi(part.substr(dash + 1));
+        for (int i = lo; i <= hi; ++i)
+            out.push_back(i);
+    }
+    return out;
+}
+
+static std::string readLine(const std::string& path)
+{
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+static std::vector<NumaNode> detectNodes()
+{
+    std::vector<NumaNode> nodes;
+    try {
+        for (int id : parseList(readLine("/sys/devices/system/node/online"))) {
+            std::vector<int> cpus =
+                parseList(readLine("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist"));
+            if (!cpus.empty())
+                nodes.push_back(NumaNode{id, std::move(cpus)});
+        }
+    } catch (const std::exception&) {
+        nodes.clear();
+    }
+    if (nodes.empty()) {
+        NumaNode all{0, {}};
+        unsigned n = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned c = 0; c < n; ++c)
+            all.cpus.push_back(static_cast<int>(c));
+        nodes.push_back(std::move(all));
+    }
+    return nodes;
+}
+
+const std::vector<NumaNode>& numaNodes()
+{
+    static const std::vector<NumaNode> nodes = detectNodes();
+    return nodes;
+}
+
+
+static std::atomic<bool>& placementSlot()
+{
+    static std::atomic<bool> on{[] {
+        const char* env = std::getenv("ISTA_NUMA");
+        return env && std::string(env) == "1";
+    }()};
+    return on;
+}
+
+bool numaPlacement()
+{
+    return placementSlot().load(std::memory_order_relaxed);
+}
+
+void setNumaPlacement(bool on)
+{
+    placementSlot().store(on, std::memory_order_relaxed);
+}
+
+
+#ifdef __linux__
+static void applyPolicy(const void* p, std::size_t bytes, int mode, const std::vector<int>& node_ids)
+{
+    if (!p || bytes == 0)
+        return;
+    constexpr std::size_t MASK_BITS = 1024;
+    unsigned long mask[MASK_BITS / (8 * sizeof(unsigned long))] = {};
+    constexpr std::size_t word_bits = 8 * sizeof(unsigned long);
+    for (int id : node_ids)
+        if (id >= 0 && static_cast<std::size_t>(id) < MASK_BITS)
+            mask[id / word_bits] |= 1ul << (id % word_bits);
+    // mbind works on whole pages; only the pages entirely inside the range
+    // are moved, so neighbouring ranges never fight over a shared page.
+    auto page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+    auto begin = (reinterpret_cast<std::uintptr_t>(p) + page - 1) / page * page;
+    auto end = (reinterpret_cast<std::uintptr_t>(p) + bytes) / page * page;
+    if (begin >= end)
+        return;
+    // The kernel reads maxnode - 1 bits.
+    ::syscall(SYS_mbind, begin, end - begin, mode, mask, MASK_BITS + 1, MPOL_MF_MOVE);
+}
+#endif
+
+void interleaveMemory(const void* p, std::size_t bytes)
+{
+#ifdef __linux__
+    const auto& nodes = numaNodes();
+    if (nodes.size() < 2)
+        return;
+    std::vector<int> ids;
+    for (const NumaNode& node : nodes)
+        ids.push_back(node.id);
+    applyPolicy(p, bytes, MPOL_INTERLEAVE, ids);
+#else
+    (void)p;
+    (void)bytes;
+#endif
+}
+
+void bindMemory(const void* p, std::size_t bytes, std::size_t node)
+{
+#ifdef __linux__
+    const auto& nodes = numaNodes();
+    if (nodes.size() < 2 || node >= nodes.size())
+        return;
+    // Preferred rather than strict, so a full node spills instead of failing.
+    applyPolicy(p, bytes, MPOL_PREFERRED, {nodes[node].id});
+#else
+    (void)p;
+    (void)bytes;
+    (void)node;
+#endif
+}
+
+void distributeMemory(const void* p, std::size_t bytes)
+{
+    std::size_t n = numaNodeCount();
+    if (n < 2)
+        return;
+    const char* base = static_cast<const char*>(p);
+    for (std::size_t k = 0; k < n; ++k) {
+        std::size_t begin = bytes * k / n, end = bytes * (k + 1) / n;
+        bindMemory(base + begin, end - begin, k);
+    }
+}
+
+
+}
+
+}
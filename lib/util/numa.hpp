@@ -0,0 +1,58 @@
+#ifndef NUMA_HPP
+#define NUMA_HPP
+
+#include <cstddef>
+#include <vector>
+
+
+namespace ista
+{
+
+namespace util
+{
+
+
+// The NUMA nodes that have CPUs, from /sys/devices/system/node. A kernel
+// without NUMA support, or a single-socket box, is one node holding every
+// CPU, so every caller below works unchanged there.
+struct NumaNode
+{
+    int id;
+    std::vector<int> cpus;
+};
+
+const std::vector<NumaNode>& numaNodes();
+inline std::size_t numaNodeCount() { return numaNodes().size(); }
+
+// Whether libista places workers and data by node: workers are bound to
+// their node's CPUs and steal from that node first, contiguous slices of
+// partitioned data go to the node whose workers scan them, and shared
+// read-mostly data is interleaved. From ISTA_NUMA=1 by default; read by the
+// scheduler when it starts, so configure() it again after changing this.
+bool numaPlacement();
+void setNumaPlacement(bool on);
+
+// Node (an index into numaNodes()) that owns slice `index` of `count`
+// contiguous slices. Data distributed with distributeMemory() and work
+// split the same way meet on the same node.
+inline std::size_t nodeOfSlice(std::size_t index, std::size_t count)
+{
+    return count == 0 ? 0 : index * numaNodeCount() / count;
+}
+
+// Memory policy for anonymous memory, through mbind(2). Pages already
+// touched are migrated. Best effort: nothing happens on one node, for
+// file-backed mappings (the page cache follows the faulting thread), or
+// when the kernel refuses.
+void interleaveMemory(const void* p, std::size_t bytes);
+void bindMemory(const void* p, std::size_t bytes, std::size_t node);
+// Binds numaNodeCount() equal contiguous slices of the range to the nodes
+// in order, matching nodeOfSlice().
+void distributeMemory(const void* p, std::size_t bytes);
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "scheduler.hpp"
+
+
+namespace ista
+{
+
+namespace util
+{
+
+
+// The shared scheduler's thread count, which ISTA_NUM_THREADS caps.
+inline unsigned defaultThreadCount()
+{
+    return Scheduler::instance().threadCount();
+}
+
+// Splits [0, n) into one contiguous chunk per thread and calls
+// fn(begin, end, chunk_index) on each, as tasks on the shared scheduler.
+// Runs inline when one thread suffices. With NUMA placement each chunk is
+// queued on a worker of the node that owns it under nodeOfSlice().
+template <typename Fn>
+void parallelChunks(std::size_t n, unsigned threads, Fn&& fn)
+{
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>((n + 4095) / 4096)));
+    if (threads <= 1) {
+        fn(std::size_t(0), n, 0u);
+        return;
+    }
+    Scheduler& scheduler = Scheduler::instance();
+    TaskGroup group;
+    std::size_t chunk = (n + threads - 1) / threads;
+    for (unsigned t = 0; t < threads; ++t) {
+        std::size_t begin = std::min(n, t * chunk);
+        std::size_t end = std::min(n, begin + chunk);
+        int hint = scheduler.byNode() ? scheduler.nodeWorker(nodeOfSlice(t, threads), t) : -1;
+        group.run([&fn, begin, end, t] { fn(begin, end, t); }, hint);
+    }
+    group.wait();
+}
+
+// Sorts chunks in parallel, then merges neighbouring runs pairwise, halving
+// the number of runs (and doubling the work per merge) each round.
+template <typename T, typename Compare = std::less<T>>
+void parallelSort(std::vector<T>& v, unsigned threads, Compare comp = Compare())
+{
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(v.size() / 65536 + 1)));
+    if (threads <= 1) {
+        std::sort(v.begin(), v.end(), comp);
+        return;
+    }
+    std::size_t chunk = (v.size() + threads - 1) / threads;
+    parallelChunks(v.size(), threads, [&](std::size_t begin, std::size_t end, unsigned) {
+        std::sort(v.begin() + begin, v.begin() + end, comp);
+    });
+    for (std::size_t width = chunk; width < v.size(); width *= 2) {
+        std::size_t pairs = (v.size() + 2 * width - 1) / (2 * width);
+        TaskGroup group;
+        for (std::size_t k = 0; k < pairs; ++k) {
+            std::size_t lo = k * 2 * width;
+            std::size_t mid = std::min(v.size(), lo + width);
+            std::size_t hi = std::min(v.size(), lo + 2 * width);
+            if (mid < hi)
+                group.run([&v, &comp, lo, mid, hi] {
+                    std::inplace_merge(v.begin() + lo, v.begin() + mid, v.begin() + hi, comp);
+                });
+        }
+        group.wait();
+    }
+}
+
+
+}
+
+}
+
+#endif
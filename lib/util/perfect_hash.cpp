@@ -0,0 +1,251 @@
+#include "perfect_hash.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "hash.hpp"
+#include "trace.hpp"
+
+namespace ista
+{
+
+namespace util
+{
+
+
+namespace
+{
+
+// Pilots tried per bucket before giving up on a seed.
+constexpr std::uint32_t MAX_PILOT = 1u << 20;
+constexpr std::uint64_t SEEDS = 16;
+
+struct IndexHeader
+{
+    std::uint64_t key_count;
+    std::uint64_t table_size;
+    std::uint64_t bucket_count;
+    std::uint64_t dense_buckets;
+    std::uint64_t seed;
+    std::uint64_t overflow_count;
+};
+
+constexpr std::uint32_t OVERFLOW_BIT = 0x80000000u;
+
+std::uint32_t fingerprint(std::uint64_t hash)
+{
+    return static_cast<std::uint32_t>(mix64(hash ^ 0x5851f42d4c957f2dULL));
+}
+
+std::size_t align8(std::size_t n)
+{
+    return (n + 7) & ~std::size_t(7);
+}
+
+// Copies an array into `out` at `pos` and moves `pos` to the next 8-byte
+// boundary after it.
+template <typename T>
+void put(std::vector<char>& out, std::size_t& pos, const T* data, std::size_t count)
+{
+    if (count > 0)
+        std::memcpy(out.data() + pos, data, count * sizeof(T));
+    pos += align8(count * sizeof(T));
+}
+
+}
+
+
+std::uint64_t PerfectHash::bucket(std::uint64_t hash, std::uint64_t dense_buckets, std::uint64_t bucket_count)
+{
+    std::uint64_t x = mix64(hash);
+    auto low = static_cast<std::uint32_t>(x);
+    // 60% of the keys, by the high half, go to the dense buckets.
+    if ((x >> 32) < 0x99999999ULL)
+        return low % dense_buckets;
+    return dense_buckets + low % (bucket_count - dense_buckets);
+}
+
+std::uint64_t PerfectHash::slot(std::uint64_t hash, std::uint32_t pilot, std::uint64_t table_size)
+{
+    return (hash ^ mix64(pilot + 0x2545f4914f6cdd1dULL)) % table_size;
+}
+
+bool PerfectHash::build(std::span<const std::uint64_t> hashes, Parts& parts)
+{
+    ISTA_TRACE_SCOPE("PerfectHash::build");
+    std::uint64_t n = hashes.size();
+    parts = Parts();
+    parts.key_count = n;
+    if (n == 0)
+        return true;
+    // About four keys a bucket; 0.98 load.
+    std::uint64_t bucket_count = std::max<std::uint64_t>(2, (n + 3) / 4);
+    parts.dense_buckets = std::max<std::uint64_t>(1, bucket_count * 3 / 10);
+    parts.table_size = std::max<std::uint64_t>(n, n * 100 / 98);
+    parts.pilots.assign(bucket_count, 0);
+
+    // Keys sorted by bucket, then buckets by size, largest first.
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> keys(n);
+    for (std::uint64_t i = 0; i < n; ++i)
+        keys[i] = {bucket(hashes[i], parts.dense_buckets, bucket_count), hashes[i]};
+    std::sort(keys.begin(), keys.end());
+    for (std::uint64_t i = 1; i < n; ++i)
+        if (keys[i] == keys[i - 1])
+            return false;
+    struct Range
+    {
+        std::uint64_t begin, end;
+    };
+    std::vector<Range> buckets;
+    for (std::uint64_t i = 0; i < n;) {
+        std::uint64_t j = i;
+        while (j < n && keys[j].first == keys[i].first)
+            ++j;
+        buckets.push_back({i, j});
+        i = j;
+    }
+    std::stable_sort(buckets.begin(), buckets.end(),
+                     [](const Range& a, const Range& b) { return a.end - a.begin > b.end - b.begin; });
+
+    std::vector<bool> taken(parts.table_size, false);
+    std::vector<std::uint64_t> positions;
+    for (const Range& range : buckets) {
+        std::uint32_t pilot = 0;
+        for (;; ++pilot) {
+            if (pilot == MAX_PILOT)
+                return false;
+            positions.clear();
+            bool fits = true;
+            for (std::uint64_t k = range.begin; k < range.end && fits; ++k) {
+                std::uint64_t p = slot(keys[k].second, pilot, parts.table_size);
+                fits = !taken[p] && std::find(positions.begin(), positions.end(), p) == positions.end();
+                positions.push_back(p);
+            }
+            if (fits)
+                break;
+        }
+        for (std::uint64_t p : positions)
+            taken[p] = true;
+        parts.pilots[keys[range.begin].first] = pilot;
+    }
+
+    // Slots past the end move into the holes below it.
+    parts.remap.assign(parts.table_size - n, 0);
+    std::uint64_t hole = 0;
+    for (std::uint64_t p = n; p < parts.table_size; ++p) {
+        if (!taken[p])
+            continue;
+        while (taken[hole])
+            ++hole;
+        parts.remap[p - n] = static_cast<std::uint32_t>(hole++);
+    }
+    return true;
+}
+
+
+std::vector<char> PerfectHashIndex::build(std::span<const std::pair<std::string_view, std::uint32_t>> entries)
+{
+    ISTA_TRACE_SCOPE("PerfectHashIndex::build");
+    // Distinct keys, each with its values in entry order.
+    std::unordered_map<std::string_view, std::size_t> key_of;
+    std::vector<std::string_view> keys;
+    std::vector<std::vector<std::uint32_t>> values;
+    for (const auto& [key, value] : entries) {
+        auto [it, inserted] = key_of.try_emplace(key, keys.size());
+        if (inserted) {
+            keys.push_back(key);
+            values.emplace_back();
+        }
+        values[it->second].push_back(value);
+    }
+    if (keys.size() >= OVERFLOW_BIT)
+        throw std::runtime_error("too many keys for a perfect hash index");
+
+    PerfectHash::Parts parts;
+    std::vector<std::uint64_t> hashes(keys.size());
+    std::uint64_t seed = 0;
+    for (;; ++seed) {
+        if (seed == SEEDS)
+            throw std::runtime_error("cannot build perfect hash index");
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            hashes[i] = hashBytes(keys[i], mix64(seed + 1));
+        if (PerfectHash::build(hashes, parts))
+            break;
+    }
+    PerfectHash hash(parts.key_count, parts.table_size, parts.dense_buckets, parts.pilots, parts.remap);
+
+    std::vector<Slot> slots(keys.size());
+    std::vector<std::uint32_t> overflow;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        Slot& slot = slots[hash(hashes[i])];
+        slot.fingerprint = fingerprint(hashes[i]);
+        if (values[i].size() == 1) {
+            slot.value = values[i][0];
+            if (slot.value & OVERFLOW_BIT)
+                throw std::runtime_error("perfect hash index value out of range");
+        } else {
+            slot.value = OVERFLOW_BIT | static_cast<std::uint32_t>(overflow.size());
+            overflow.push_back(static_cast<std::uint32_t>(values[i].size()));
+            overflow.insert(overflow.end(), values[i].begin(), values[i].end());
+        }
+    }
+
+    IndexHeader header{parts.key_count, parts.table_size, parts.pilots.size(), parts.dense_buckets, seed,
+                       overflow.size()};
+    std::vector<char> out(sizeof(header) + align8(parts.pilots.size() * sizeof(std::uint32_t))
+                          + align8(parts.remap.size() * sizeof(std::uint32_t)) + slots.size() * sizeof(Slot)
+                          + align8(overflow.size() * sizeof(std::uint32_t)), 0);
+    std::size_t pos = 0;
+    put(out, pos, &header, 1);
+    put(out, pos, parts.pilots.data(), parts.pilots.size());
+    put(out, pos, parts.remap.data(), parts.remap.size());
+    put(out, pos, slots.data(), slots.size());
+    put(out, pos, overflow.data(), overflow.size());
+    return out;
+}
+
+PerfectHashIndex::PerfectHashIndex(std::span<const char> bytes)
+{
+    IndexHeader header;
+    if (bytes.size() < sizeof(header))
+        throw std::runtime_error("truncated perfect hash index");
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    std::size_t pilots_pos = sizeof(header);
+    std::size_t remap_pos = pilots_pos + align8(header.bucket_count * sizeof(std::uint32_t));
+    std::size_t slots_pos = remap_pos + align8((header.table_size - header.key_count) * sizeof(std::uint32_t));
+    std::size_t overflow_pos = slots_pos + header.key_count * sizeof(Slot);
+    std::size_t end = overflow_pos + align8(header.overflow_count * sizeof(std::uint32_t));
+    if (header.table_size < header.key_count || header.dense_buckets > header.bucket_count
+        || (header.key_count > 0 && (header.dense_buckets == 0 || header.dense_buckets == header.bucket_count))
+        || end != bytes.size())
+        throw std::runtime_error("inconsistent perfect hash index");
+
+    auto at = [&](std::size_t pos) { return bytes.data() + pos; };
+    seed_ = header.seed;
+    hash_ = PerfectHash(header.key_count, header.table_size, header.dense_buckets,
+                        {reinterpret_cast<const std::uint32_t*>(at(pilots_pos)), header.bucket_count},
+                        {reinterpret_cast<const std::uint32_t*>(at(remap_pos)), header.table_size - header.key_count});
+    slots_ = {reinterpret_cast<const Slot*>(at(slots_pos)), header.key_count};
+    overflow_ = {reinterpret_cast<const std::uint32_t*>(at(overflow_pos)), header.overflow_count};
+}
+
+std::span<const std::uint32_t> PerfectHashIndex::find(std::string_view key) const
+{
+    if (slots_.empty())
+        return {};
+    std::uint64_t h = hashBytes(key, mix64(seed_ + 1));
+    const Slot& slot = slots_[hash_(h)];
+    if (slot.fingerprint != fingerprint(h))
+        return {};
+    if (!(slot.value & OVERFLOW_BIT))
+        return {&slot.value, 1};
+    std::size_t pos = slot.value & ~OVERFLOW_BIT;
+    return overflow_.subspan(pos + 1, overflow_[pos]);
+}
+
+
+}
+
+}
@@ -0,0 +1,115 @@
+#ifndef PERFECT_HASH_HPP
+#define PERFECT_HASH_HPP
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+namespace ista
+{
+
+namespace util
+{
+
+
+// Minimal perfect hash function over a fixed set of 64-bit key hashes, in the
+// manner of PTHash (Pibiri and Trani): keys are split into buckets, skewed so
+// that the first 30% of buckets get 60% of the keys, and each bucket gets a
+// pilot that sends all of its keys to free slots of a table 2% larger than
+// the key set. Slots past the end are remapped onto the holes below it.
+// Evaluating it reads one pilot and, for about 2% of keys, one remap entry.
+// Keys outside the set map to arbitrary positions.
+class PerfectHash
+{
+public:
+    struct Parts
+    {
+        std::uint64_t key_count = 0;
+        std::uint64_t table_size = 0;
+        std::uint64_t dense_buckets = 0;
+        std::vector<std::uint32_t> pilots;
+        std::vector<std::uint32_t> remap;   // table_size - key_count entries
+    };
+    // Returns false when the hashes are not distinct, or no pilot is found
+    // for some bucket; hash the keys with another seed and try again.
+    static bool build(std::span<const std::uint64_t> hashes, Parts& parts);
+
+    PerfectHash() = default;
+    PerfectHash(std::uint64_t key_count, std::uint64_t table_size, std::uint64_t dense_buckets,
+                std::span<const std::uint32_t> pilots, std::span<const std::uint32_t> remap)
+        : key_count_(key_count), table_size_(table_size), dense_buckets_(dense_buckets), pilots_(pilots), remap_(remap)
+    {
+    }
+
+    std::uint64_t keyCount() const { return key_count_; }
+
+    // A position in [0, keyCount()), distinct for each key of the set.
+    std::uint64_t operator()(std::uint64_t hash) const
+    {
+        std::uint64_t p = slot(hash, pilots_[bucket(hash, dense_buckets_, pilots_.size())], table_size_);
+        return p < key_count_ ? p : remap_[p - key_count_];
+    }
+
+    static std::uint64_t bucket(std::uint64_t hash, std::uint64_t dense_buckets, std::uint64_t bucket_count);
+    static std::uint64_t slot(std::uint64_t hash, std::uint32_t pilot, std::uint64_t table_size);
+
+private:
+    std::uint64_t key_count_ = 0;
+    std::uint64_t table_size_ = 0;
+    std::uint64_t dense_buckets_ = 0;
+    std::span<const std::uint32_t> pilots_;
+    std::span<const std::uint32_t> remap_;
+};
+
+
+// Read-only map from strings to u32 values (several per key allowed) for
+// frozen KBs, built on a PerfectHash. Each slot holds a value and a 32-bit
+// fingerprint of its key, so a lookup is the pilot and the slot: two cache
+// misses. The keys themselves are not stored; a string outside the key set
+// passes the fingerprint with probability 2^-32, so callers that must be
+// exact compare against their own copy of the key.
+//
+//   header | pilots u32[] | remap u32[] | slots {u32 value, u32 fingerprint}[n]
+//          | overflow u32[]   (count, values... for keys with several values)
+//
+// The serialized form is 8-byte aligned and meant to be mapped in place.
+class PerfectHashIndex
+{
+public:
+    // Serializes the index of `entries`; the values of a repeated key are
+    // kept in entry order.
+    static std::vector<char> build(std::span<const std::pair<std::string_view, std::uint32_t>> entries);
+
+    PerfectHashIndex() = default;
+    // Views a serialized index, which must outlive it and be 8-byte aligned;
+    // throws std::runtime_error if it is malformed.
+    explicit PerfectHashIndex(std::span<const char> bytes);
+
+    bool empty() const { return slots_.empty(); }
+    std::uint64_t keyCount() const { return slots_.size(); }
+
+    // The values of `key`, or nothing.
+    std::span<const std::uint32_t> find(std::string_view key) const;
+
+private:
+    struct Slot
+    {
+        std::uint32_t value;
+        std::uint32_t fingerprint;
+    };
+
+    std::uint64_t seed_ = 0;
+    PerfectHash hash_;
+    std::span<const Slot> slots_;
+    std::span<const std::uint32_t> overflow_;
+};
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,70 @@
+#include "resource_usage.hpp"
+
+#include <cctype>
+#include <cstdio>
+#include <stdexcept>
+
+#include <sys/resource.h>
+
+namespace ista
+{
+
+namespace util
+{
+
+
+std::uint64_t peakRssBytes()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    // Linux reports ru_maxrss in kilobytes.
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+}
+
+std::string formatBytes(std::uint64_t bytes)
+{
+    static const char* units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+    double value = static_cast<double>(bytes);
+    int unit = 0;
+    while (value >= 1024.0 && unit < 4) {
+        value /= 1024.0;
+        ++unit;
+    }
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), unit == 0 ? "%.0f %s" : "%.1f %s", value, units[unit]);
+    return buf;
+}
+
+std::uint64_t parseBytes(std::string_view text)
+{
+    std::size_t digits = 0;
+    std::uint64_t value = 0;
+    while (digits < text.size() && std::isdigit(static_cast<unsigned char>(text[digits]))) {
+        value = value * 10 + static_cast<std::uint64_t>(text[digits] - '0');
+        ++digits;
+    }
+    std::string_view suffix = text.substr(digits);
+    if (!suffix.empty() && (suffix.back() == 'B' || suffix.back() == 'b'))
+        suffix.remove_suffix(1);
+    if (!suffix.empty() && (suffix.back() == 'i'))
+        suffix.remove_suffix(1);
+    if (digits == 0 || suffix.size() > 1)
+        throw std::invalid_argument("invalid size '" + std::string(text) + "'");
+    int shift = 0;
+    if (!suffix.empty()) {
+        switch (std::toupper(static_cast<unsigned char>(suffix[0]))) {
+        case 'K': shift = 10; break;
+        case 'M': shift = 20; break;
+        case 'G': shift = 30; break;
+        case 'T': shift = 40; break;
+        default: throw std::invalid_argument("invalid size '" + std::string(text) + "'");
+        }
+    }
+    return value << shift;
+}
+
+
+}
+
+}
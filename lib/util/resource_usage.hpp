@@ -0,0 +1,30 @@
+#ifndef RESOURCE_USAGE_HPP
+#define RESOURCE_USAGE_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+
+namespace ista
+{
+
+namespace util
+{
+
+
+// Peak resident set size of this process, in bytes.
+std::uint64_t peakRssBytes();
+
+// Formats a byte count as e.g. "12.3 MiB".
+std::string formatBytes(std::uint64_t bytes);
+// Parses a byte count with an optional K, M, G or T suffix (powers of 1024),
+// e.g. "512M" or "8G". Throws std::invalid_argument on anything else.
+std::uint64_t parseBytes(std::string_view text);
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,295 @@
+#include "scheduler.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "trace.hpp"
+
+namespace ista
+{
+
+namespace util
+{
+
+
+static thread_local int current_worker = -1;
+
+static unsigned envThreadCount()
+{
+    if (const char* env = std::getenv("ISTA_NUM_THREADS")) {
+        try {
+            unsigned long n = std::stoul(env);
+            if (n > 0)
+                return static_cast<unsigned>(n);
+        } catch (const std::exception&) {
+        }
+    }
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+static bool envPinWorkers()
+{
+    const char* env = std::getenv("ISTA_PIN_THREADS");
+    return env && std::string(env) == "1";
+}
+
+
+Scheduler& Scheduler::instance()
+{
+    static Scheduler scheduler;
+    return scheduler;
+}
+
+Scheduler::Scheduler()
+{
+    start(envThreadCount(), envPinWorkers());
+}
+
+Scheduler::~Scheduler()
+{
+    stop();
+}
+
+int Scheduler::currentWorker()
+{
+    return current_worker;
+}
+
+void Scheduler::configure(unsigned threads, bool pin_workers)
+{
+    stop();
+    start(threads == 0 ? envThreadCount() : threads, pin_workers);
+}
+
+int Scheduler::nodeWorker(std::size_t node, std::size_t k) const
+{
+    if (node >= node_workers_.size() || node_workers_[node].empty())
+        return -1;
+    return node_workers_[node][k % node_workers_[node].size()];
+}
+
+void Scheduler::start(unsigned threads, bool pin_workers)
+{
+    threads_ = threads;
+    stopping_.store(false);
+    queues_.clear();
+    for (unsigned i = 1; i < threads; ++i)
+        queues_.push_back(std::make_unique<Queue>());
+    // Contiguous blocks of workers per node, matching nodeOfSlice().
+    by_node_ = numaPlacement();
+    worker_node_.clear();
+    node_workers_.assign(numaNodeCount(), {});
+    for (unsigned i = 0; i + 1 < threads; ++i) {
+        std::size_t node = by_node_ ? nodeOfSlice(i, threads - 1) : 0;
+        worker_node_.push_back(node);
+        node_workers_[node].push_back(static_cast<int>(i));
+    }
+    for (unsigned i = 0; i + 1 < threads; ++i)
+        workers_.emplace_back([this, i, pin_workers] { workerLoop(i, pin_workers); });
+}
+
+void Scheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_.store(true);
+    }
+    sleep_cv_.notify_all();
+    for (auto& w : workers_)
+        w.join();
+    workers_.clear();
+    // Anything still queued moves to the injection queue, where waiters and
+    // the next set of workers will find it.
+    for (auto& queue : queues_)
+        for (Task& task : queue->tasks)
+            injection_.tasks.push_back(std::move(task));
+}
+
+void Scheduler::notifyAll()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    sleep_cv_.notify_all();
+}
+
+void Scheduler::submit(Task task, int hint)
+{
+    Queue* queue = &injection_;
+    if (!queues_.empty()) {
+        if (hint >= 0)
+            queue = queues_[static_cast<std::size_t>(hint) % queues_.size()].get();
+        else if (current_worker >= 0)
+            queue = queues_[current_worker].get();
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->tasks.push_back(std::move(task));
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    sleep_cv_.notify_one();
+}
+
+bool Scheduler::take(int self, Task& task)
+{
+    auto pop = [&](Queue& queue, bool back) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+        if (back) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        return true;
+    };
+
+    // Own work newest first for locality, then outside work, then steal the
+    // oldest (and typically largest) task from a neighbour, on this node
+    // before the others.
+    if (self >= 0 && pop(*queues_[self], true))
+        return true;
+    if (pop(injection_, false))
+        return true;
+    std::size_t n = queues_.size();
+    std::size_t start = self >= 0 ? static_cast<std::size_t>(self) + 1 : 0;
+    bool local_first = by_node_ && self >= 0;
+    std::size_t home = self >= 0 ? worker_node_[self] : 0;
+    for (int pass = 0; pass < (local_first ? 2 : 1); ++pass) {
+        for (std::size_t k = 0; k < n; ++k) {
+            std::size_t victim = (start + k) % n;
+            if (static_cast<int>(victim) == self)
+                continue;
+            if (local_first && (worker_node_[victim] == home) != (pass == 0))
+                continue;
+            if (pop(*queues_[victim], false))
+                return true;
+        }
+    }
+    return false;
+}
+
+bool Scheduler::runOne(int self)
+{
+    if (queued_.load(std::memory_order_acquire) == 0)
+        return false;
+    Task task;
+    if (!take(self, task))
+        return false;
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    std::exception_ptr error;
+    if (!task.group->cancelled()) {
+        ISTA_TRACE_SCOPE("task");
+        try {
+            task.fn();
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+    task.fn = nullptr;
+    task.group->finish(error);
+    return true;
+}
+
+void Scheduler::workerLoop(unsigned index, bool pin)
+{
+    current_worker = static_cast<int>(index);
+    ISTA_TRACE_THREAD("worker " + std::to_string(index));
+#ifdef __linux__
+    if (by_node_) {
+        // The whole node, or one CPU of it when pinning too.
+        const NumaNode& node = numaNodes()[worker_node_[index]];
+        const std::vector<int>& peers = node_workers_[worker_node_[index]];
+        std::size_t rank = static_cast<std::size_t>(std::find(peers.begin(), peers.end(), int(index)) - peers.begin());
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (pin)
+            CPU_SET(node.cpus[rank % node.cpus.size()] % CPU_SETSIZE, &set);
+        else
+            for (int cpu : node.cpus)
+                CPU_SET(cpu % CPU_SETSIZE, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    } else if (pin) {
+        // The caller usually runs on CPU 0, so workers start at CPU 1.
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET((index + 1) % CPU_SETSIZE, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#else
+    (void)pin;
+#endif
+    while (true) {
+        if (runOne(current_worker))
+            continue;
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.wait(lock, [this] { return stopping_.load() || queued_.load(std::memory_order_acquire) > 0; });
+        if (stopping_.load())
+            return;
+    }
+}
+
+
+TaskGroup::~TaskGroup()
+{
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::run(std::function<void()> fn, int hint)
+{
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    Scheduler::instance().submit(Scheduler::Task{std::move(fn), this}, hint);
+}
+
+void TaskGroup::finish(std::exception_ptr error)
+{
+    if (error) {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if (!error_)
+            error_ = error;
+        cancel();
+    }
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        Scheduler::instance().notifyAll();
+}
+
+void TaskGroup::wait()
+{
+    Scheduler& scheduler = Scheduler::instance();
+    while (pending_.load(std::memory_order_acquire) != 0) {
+        if (scheduler.runOne(Scheduler::currentWorker()))
+            continue;
+        std::unique_lock<std::mutex> lock(scheduler.sleep_mutex_);
+        scheduler.sleep_cv_.wait(lock, [&] {
+            return pending_.load(std::memory_order_acquire) == 0 || scheduler.queued_.load(std::memory_order_acquire) > 0;
+        });
+    }
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        error = std::exchange(error_, nullptr);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+
+}
+
+}
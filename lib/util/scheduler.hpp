@@ -0,0 +1,225 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "numa.hpp"
+
+
+namespace ista
+{
+
+namespace util
+{
+
+
+class TaskGroup;
+
+
+// The one thread pool in the process. Every parallel pass in libista runs
+// its work here, so nested or concurrent passes share a fixed number of
+// threads instead of each spawning its own.
+//
+// Each worker owns a deque: it pushes and pops its own tasks at the back
+// and steals from the front of the others when it runs dry. A thread that
+// waits on a TaskGroup runs tasks too, so `threadCount()` threads are busy
+// at most: the workers plus the one waiting caller.
+//
+// The thread count defaults to the ISTA_NUM_THREADS environment variable,
+// or to the hardware concurrency; ISTA_PIN_THREADS=1 binds worker i to CPU i.
+// With NUMA placement on (ISTA_NUMA=1) workers are spread over the nodes in
+// contiguous blocks, bound to their node's CPUs, and steal from their own
+// node before crossing to another.
+class Scheduler
+{
+public:
+    static Scheduler& instance();
+
+    unsigned threadCount() const { return threads_; }
+    // Restarts the pool. Call between workloads, not while tasks are queued;
+    // 0 restores the default.
+    void configure(unsigned threads, bool pin_workers = false);
+
+    // Index of the calling worker, or -1 on a thread outside the pool.
+    static int currentWorker();
+
+    // Whether the pool was started with NUMA placement.
+    bool byNode() const { return by_node_; }
+    // A hint for TaskGroup::run() naming the k-th worker (modulo their
+    // count) on `node`, or -1 when the node has none.
+    int nodeWorker(std::size_t node, std::size_t k) const;
+
+private:
+    friend class TaskGroup;
+
+    struct Task
+    {
+        std::function<void()> fn;
+        TaskGroup* group;
+    };
+
+    struct alignas(64) Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    Scheduler();
+    ~Scheduler();
+
+    void start(unsigned threads, bool pin_workers);
+    void stop();
+    void submit(Task task, int hint);
+    bool runOne(int self);
+    bool take(int self, Task& task);
+    void workerLoop(unsigned index, bool pin);
+    void notifyAll();
+
+    unsigned threads_ = 1;
+    bool by_node_ = false;
+    std::vector<std::size_t> worker_node_;          // node of each worker
+    std::vector<std::vector<int>> node_workers_;   // workers of each node
+    std::vector<std::unique_ptr<Queue>> queues_;   // one per worker
+    Queue injection_;                              // tasks from outside the pool
+    std::vector<std::thread> workers_;
+    std::atomic<std::size_t> queued_{0};
+    std::atomic<bool> stopping_{false};
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+};
+
+
+// A set of tasks that finish together. wait() returns once all of them
+// have run, executing queued tasks while it waits so groups nest freely.
+// The first exception a task throws cancels the group and is rethrown by
+// wait(); tasks of a cancelled group that have not started are skipped, and
+// long-running ones can poll cancelled() to stop early.
+class TaskGroup
+{
+public:
+    TaskGroup() = default;
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+    ~TaskGroup();
+
+    // `hint` asks for the task to run on a particular worker (taken modulo
+    // the worker count), e.g. to keep passes over the same data together.
+    void run(std::function<void()> fn, int hint = -1);
+    void wait();
+
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+private:
+    friend class Scheduler;
+
+    void finish(std::exception_ptr error);
+
+    std::atomic<std::size_t> pending_{0};
+    std::atomic<bool> cancelled_{false};
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+
+// Calls fn(begin, end) over [first, last) split into pieces of at least
+// `grain` indices; a zero grain picks one that gives each thread a few
+// pieces to balance load.
+template <typename Fn>
+void parallelFor(std::size_t first, std::size_t last, Fn&& fn, std::size_t grain = 0)
+{
+    if (first >= last)
+        return;
+    std::size_t n = last - first;
+    unsigned threads = Scheduler::instance().threadCount();
+    if (grain == 0)
+        grain = std::max<std::size_t>(1, n / (std::size_t(threads) * 4));
+    if (threads <= 1 || n <= grain) {
+        fn(first, last);
+        return;
+    }
+    TaskGroup group;
+    for (std::size_t begin = first; begin < last; begin += grain) {
+        std::size_t end = std::min(last, begin + grain);
+        group.run([&fn, begin, end] { fn(begin, end); });
+    }
+    group.wait();
+}
+
+// parallelFor with [first, last) cut into one contiguous slice per NUMA
+// node and each slice's pieces queued on that node's workers, so data laid
+// out by distributeMemory(), or first touched the same way, is read where
+// it lives. Without NUMA placement this is parallelFor.
+template <typename Fn>
+void parallelForByNode(std::size_t first, std::size_t last, Fn&& fn, std::size_t grain = 0)
+{
+    Scheduler& scheduler = Scheduler::instance();
+    if (!scheduler.byNode()) {
+        parallelFor(first, last, std::forward<Fn>(fn), grain);
+        return;
+    }
+    if (first >= last)
+        return;
+    std::size_t n = last - first;
+    unsigned threads = scheduler.threadCount();
+    if (grain == 0)
+        grain = std::max<std::size_t>(1, n / (std::size_t(threads) * 4));
+    if (threads <= 1 || n <= grain) {
+        fn(first, last);
+        return;
+    }
+    std::size_t nodes = numaNodeCount();
+    TaskGroup group;
+    for (std::size_t node = 0; node < nodes; ++node) {
+        std::size_t slice_end = first + n * (node + 1) / nodes;
+        std::size_t k = 0;
+        for (std::size_t begin = first + n * node / nodes; begin < slice_end; begin += grain) {
+            std::size_t end = std::min(slice_end, begin + grain);
+            group.run([&fn, begin, end] { fn(begin, end); }, scheduler.nodeWorker(node, k++));
+        }
+    }
+    group.wait();
+}
+
+// Maps each piece of [first, last) to a T with map(begin, end) and folds the
+// results left to right with combine, so a non-commutative combine sees the
+// pieces in order.
+template <typename T, typename Map, typename Combine>
+T parallelReduce(std::size_t first, std::size_t last, T identity, Map&& map, Combine&& combine, std::size_t grain = 0)
+{
+    if (first >= last)
+        return identity;
+    std::size_t n = last - first;
+    unsigned threads = Scheduler::instance().threadCount();
+    if (grain == 0)
+        grain = std::max<std::size_t>(1, n / (std::size_t(threads) * 4));
+    std::size_t pieces = (n + grain - 1) / grain;
+    std::vector<T> partial(pieces, identity);
+    parallelFor(0, pieces, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t k = begin; k < end; ++k)
+            partial[k] = map(first + k * grain, std::min(last, first + (k + 1) * grain));
+    }, 1);
+    T result = std::move(identity);
+    for (T& value : partial)
+        result = combine(std::move(result), std::move(value));
+    return result;
+}
+
+
+}
+
+}
+
+#endif
@@ -0,0 +1,133 @@
+#include "stream_vbyte.hpp"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define ISTA_STREAM_VBYTE_SSSE3 1
+#endif
+
+namespace ista
+{
+
+namespace util
+{
+
+
+namespace
+{
+
+struct Tables
+{
+    // Total data bytes of the four values a control byte describes.
+    std::array<std::uint8_t, 256> length;
+    // pshufb masks spreading those bytes into four little-endian u32 lanes;
+    // 0x80 zeroes a lane byte.
+    std::array<std::array<std::uint8_t, 16>, 256> shuffle;
+
+    constexpr Tables() : length(), shuffle()
+    {
+        for (unsigned c = 0; c < 256; ++c) {
+            std::uint8_t at = 0;
+            for (unsigned lane = 0; lane < 4; ++lane) {
+                unsigned bytes = ((c >> (2 * lane)) & 3) + 1;
+                for (unsigned b = 0; b < 4; ++b)
+                    shuffle[c][4 * lane + b] = b < bytes ? static_cast<std::uint8_t>(at + b) : 0x80;
+                at = static_cast<std::uint8_t>(at + bytes);
+            }
+            length[c] = at;
+        }
+    }
+};
+
+constexpr Tables TABLES;
+
+unsigned lengthCode(std::uint32_t v)
+{
+    return v < (1u << 8) ? 0 : v < (1u << 16) ? 1 : v < (1u << 24) ? 2 : 3;
+}
+
+// Decodes the values of the partial control byte at the end, if any.
+const std::uint8_t* decodeTail(const std::uint8_t* control, const std::uint8_t* data, std::size_t from,
+                               std::size_t count, std::uint32_t* out)
+{
+    for (std::size_t i = from; i < count; ++i) {
+        unsigned bytes = ((control[i / 4] >> (2 * (i % 4))) & 3) + 1;
+        std::uint32_t v = 0;
+        std::memcpy(&v, data, bytes);
+        out[i] = v;
+        data += bytes;
+    }
+    return data;
+}
+
+#ifdef ISTA_STREAM_VBYTE_SSSE3
+__attribute__((target("ssse3"))) std::size_t decodeSsse3(const std::uint8_t* in, std::size_t count,
+                                                         std::uint32_t* out)
+{
+    const std::uint8_t* data = in + (count + 3) / 4;
+    std::size_t groups = count / 4;
+    for (std::size_t k = 0; k < groups; ++k) {
+        std::uint8_t c = in[k];
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(TABLES.shuffle[c].data()));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * k), _mm_shuffle_epi8(bytes, mask));
+        data += TABLES.length[c];
+    }
+    data = decodeTail(in, data, groups * 4, count, out);
+    return static_cast<std::size_t>(data - in);
+}
+
+const bool HAVE_SSSE3 = __builtin_cpu_supports("ssse3");
+#endif
+
+}
+
+
+std::size_t streamVByteEncode(const std::uint32_t* in, std::size_t count, std::uint8_t* out)
+{
+    std::uint8_t* control = out;
+    std::uint8_t* data = out + (count + 3) / 4;
+    std::memset(control, 0, (count + 3) / 4);
+    for (std::size_t i = 0; i < count; ++i) {
+        unsigned code = lengthCode(in[i]);
+        control[i / 4] |= static_cast<std::uint8_t>(code << (2 * (i % 4)));
+        // Little-endian: the low code + 1 bytes are the value.
+        std::uint32_t v = in[i];
+        std::memcpy(data, &v, 4);
+        data += code + 1;
+    }
+    return static_cast<std::size_t>(data - out);
+}
+
+std::size_t streamVByteDecode(const std::uint8_t* in, std::size_t count, std::uint32_t* out)
+{
+#ifdef ISTA_STREAM_VBYTE_SSSE3
+    if (HAVE_SSSE3)
+        return decodeSsse3(in, count, out);
+#endif
+    return streamVByteDecodeScalar(in, count, out);
+}
+
+std::size_t streamVByteDecodeScalar(const std::uint8_t* in, std::size_t count, std::uint32_t* out)
+{
+    const std::uint8_t* data = decodeTail(in, in + (count + 3) / 4, 0, count, out);
+    return static_cast<std::size_t>(data - in);
+}
+
+std::size_t streamVByteSize(const std::uint8_t* in, std::size_t count)
+{
+    std::size_t control = (count + 3) / 4;
+    std::size_t size = control;
+    for (std::size_t k = 0; k < count / 4; ++k)
+        size += TABLES.length[in[k]];
+    for (std::size_t i = count / 4 * 4; i < count; ++i)
+        size += ((in[i / 4] >> (2 * (i % 4))) & 3) + 1;
+    return size;
+}
+
+
+}
+
+}
@@ -0,0 +1,51 @@
+#ifndef STREAM_VBYTE_HPP
+#define STREAM_VBYTE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace ista
+{
+
+namespace util
+{
+
+
+// Stream VByte (Lemire, Kurz and Rupp): `count` u32 values stored as 2-bit
+// byte lengths, four to a control byte, followed by the 1-4 low bytes of each
+// value. With the lengths kept apart from the data, SSSE3 decodes four values
+// per control byte with one table lookup and a byte shuffle; other CPUs take
+// a scalar loop over the same format.
+//
+//   control u8[(count + 3) / 4] | data u8[sum of lengths]
+
+// The decoders may read up to this many bytes past the end of the data, so
+// buffers and file sections holding encoded values end in this much slack.
+constexpr std::size_t STREAM_VBYTE_PADDING = 16;
+
+// An upper bound on the encoding of `count` values.
+constexpr std::size_t streamVByteMaxBytes(std::size_t count)
+{
+    return (count + 3) / 4 + 4 * count;
+}
+
+// Encodes into `out`, which holds streamVByteMaxBytes(count) bytes; returns
+// the bytes used.
+std::size_t streamVByteEncode(const std::uint32_t* in, std::size_t count, std::uint8_t* out);
+
+// Decodes `count` values into `out`; returns the bytes consumed.
+std::size_t streamVByteDecode(const std::uint8_t* in, std::size_t count, std::uint32_t* out);
+// The scalar loop streamVByteDecode() falls back to without SSSE3, callable
+// directly so the two can be checked against each other.
+std::size_t streamVByteDecodeScalar(const std::uint8_t* in, std::size_t count, std::uint32_t* out);
+
+// The bytes taken by `count` encoded values, from their control bytes alone.
+std::size_t streamVByteSize(const std::uint8_t* in, std::size_t count);
+
+
+}
+
+}
+
+#endif
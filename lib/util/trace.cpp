@@ -0,0 +1,151 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "json_writer.hpp"
+
+namespace ista
+{
+
+namespace util
+{
+
+namespace trace
+{
+
+
+std::atomic<bool> recording{false};
+
+
+namespace
+{
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+};
+
+// Never destroyed: threads may still push while static destructors run.
+Registry& registry()
+{
+    static Registry* r = new Registry;
+    return *r;
+}
+
+void writeMicros(std::ostream& out, std::uint64_t ns)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%llu.%03llu", static_cast<unsigned long long>(ns / 1000),
+                  static_cast<unsigned long long>(ns % 1000));
+    out << buf;
+}
+
+}
+
+
+void setEnabled(bool on)
+{
+    recording.store(on, std::memory_order_relaxed);
+}
+
+Ring& registerThread()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.rings.push_back(std::make_unique<Ring>(static_cast<std::uint32_t>(r.rings.size() + 1)));
+    return *r.rings.back();
+}
+
+void setThreadName(std::string_view name)
+{
+    Ring& ring = threadRing();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    ring.name = name;
+}
+
+void clear()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto& ring : r.rings)
+        ring->tail = ring->head();
+}
+
+std::size_t eventCount()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::size_t n = 0;
+    for (auto& ring : r.rings)
+        n += std::min<std::uint64_t>(ring->head() - ring->tail, Ring::CAPACITY);
+    return n;
+}
+
+void writeChromeTrace(std::ostream& out)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    // Only the newest CAPACITY events of a ring survive a wrap.
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> ranges;
+    std::uint64_t origin = std::numeric_limits<std::uint64_t>::max();
+    for (auto& ring : r.rings) {
+        std::uint64_t head = ring->head();
+        std::uint64_t first = std::max<std::uint64_t>(ring->tail, head > Ring::CAPACITY ? head - Ring::CAPACITY : 0);
+        ranges.emplace_back(first, head);
+        for (std::uint64_t i = first; i < head; ++i)
+            origin = std::min(origin, ring->slot(i).begin_ns);
+    }
+
+    std::string name;
+    bool first_event = true;
+    auto separator = [&] {
+        out << (first_event ? "\n" : ",\n");
+        first_event = false;
+    };
+    out << "{\"traceEvents\":[";
+    for (std::size_t k = 0; k < r.rings.size(); ++k) {
+        const Ring& ring = *r.rings[k];
+        if (!ring.name.empty()) {
+            name.clear();
+            JsonWriter::escape(name, ring.name);
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring.tid()
+                << ",\"args\":{\"name\":\"" << name << "\"}}";
+        }
+        for (std::uint64_t i = ranges[k].first; i < ranges[k].second; ++i) {
+            const Event& e = ring.slot(i);
+            name.clear();
+            JsonWriter::escape(name, e.name);
+            separator();
+            out << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring.tid() << ",\"ts\":";
+            writeMicros(out, e.begin_ns - origin);
+            out << ",\"dur\":";
+            writeMicros(out, e.end_ns - e.begin_ns);
+            out << '}';
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+void writeChromeTrace(const std::string& path)
+{
+    std::ofstream out(path);
+    if (!out)
+        throw std::runtime_error("cannot write " + path);
+    writeChromeTrace(out);
+}
+
+
+}
+
+}
+
+}
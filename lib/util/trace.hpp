@@ -0,0 +1,157 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+
+namespace ista
+{
+
+namespace util
+{
+
+namespace trace
+{
+
+
+// Timed spans for finding where a run spends its time, viewable in
+// chrome://tracing or Perfetto. Spans are only compiled in when libista is
+// configured with -DISTA_TRACING=ON; otherwise ISTA_TRACE_SCOPE expands to
+// nothing and costs nothing. When compiled in, a span is two clock reads and
+// a store into the calling thread's ring buffer while recording is enabled,
+// and one relaxed load while it is not.
+#ifdef ISTA_TRACING
+constexpr bool COMPILED = true;
+#else
+constexpr bool COMPILED = false;
+#endif
+
+struct Event
+{
+    const char* name;   // a string literal; only the pointer is kept
+    std::uint64_t begin_ns;
+    std::uint64_t end_ns;
+};
+
+// A single-producer ring of the newest CAPACITY events of one thread. The
+// owning thread writes a slot and then publishes it by advancing `head`;
+// readers take `head` with acquire and may run concurrently with the
+// writer, but slots the writer has since wrapped over read torn, so export
+// traces once the traced work has finished.
+class Ring
+{
+public:
+    static constexpr std::size_t CAPACITY = std::size_t(1) << 16;
+
+    Ring(std::uint32_t tid) : tid_(tid), slots_(new Event[CAPACITY]) {}
+
+    void push(const Event& e)
+    {
+        std::uint64_t h = head_.load(std::memory_order_relaxed);
+        slots_[h & (CAPACITY - 1)] = e;
+        head_.store(h + 1, std::memory_order_release);
+    }
+
+    std::uint32_t tid() const { return tid_; }
+    std::uint64_t head() const { return head_.load(std::memory_order_acquire); }
+    const Event& slot(std::uint64_t i) const { return slots_[i & (CAPACITY - 1)]; }
+
+    // Events before this one have been cleared; only the reader side moves it.
+    std::uint64_t tail = 0;
+    std::string name;
+
+private:
+    std::uint32_t tid_;
+    std::unique_ptr<Event[]> slots_;
+    std::atomic<std::uint64_t> head_{0};
+};
+
+extern std::atomic<bool> recording;
+
+inline bool enabled() { return recording.load(std::memory_order_relaxed); }
+void setEnabled(bool on);
+
+inline std::uint64_t now()
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+// The calling thread's ring, registered on first use. Rings are owned by a
+// process-wide registry, so events of threads that have exited still export.
+Ring& registerThread();
+
+inline Ring& threadRing()
+{
+    thread_local Ring* ring = nullptr;
+    if (!ring)
+        ring = &registerThread();
+    return *ring;
+}
+
+// Labels the calling thread in exported traces ("main", "worker 3").
+void setThreadName(std::string_view name);
+
+// Drops every recorded event.
+void clear();
+std::size_t eventCount();
+
+// Chrome trace_event JSON: a complete ("X") event per span and a thread_name
+// metadata event per named thread, timestamps in microseconds from the
+// earliest span.
+void writeChromeTrace(std::ostream& out);
+void writeChromeTrace(const std::string& path);
+
+
+class Span
+{
+public:
+    explicit Span(const char* name) : name_(enabled() ? name : nullptr)
+    {
+        if (name_)
+            begin_ = now();
+    }
+    ~Span()
+    {
+        if (name_)
+            threadRing().push(Event{name_, begin_, now()});
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* name_;
+    std::uint64_t begin_ = 0;
+};
+
+
+}
+
+}
+
+}
+
+
+#define ISTA_TRACE_CONCAT_(a, b) a##b
+#define ISTA_TRACE_CONCAT(a, b) ISTA_TRACE_CONCAT_(a, b)
+
+// ISTA_TRACE_SCOPE("name") times the rest of the enclosing block; the name
+// must be a string literal. ISTA_TRACE_THREAD("name") labels the thread.
+#ifdef ISTA_TRACING
+#define ISTA_TRACE_SCOPE(name) ::ista::util::trace::Span ISTA_TRACE_CONCAT(ista_trace_span_, __LINE__)(name)
+#define ISTA_TRACE_THREAD(name) ::ista::util::trace::setThreadName(name)
+#else
+#define ISTA_TRACE_SCOPE(name) ((void)0)
+#define ISTA_TRACE_THREAD(name) ((void)0)
+#endif
+
+#endif
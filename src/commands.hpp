@@ -0,0 +1,19 @@
+#ifndef COMMANDS_HPP
+#define COMMANDS_HPP
+
+
+// Subcommands of the `ista` executable. Each receives argv starting at the
+// subcommand name and returns the process exit code.
+int runApplyPatch(int argc, char* argv[]);
+int runBuild(int argc, char* argv[]);
+int runCheckout(int argc, char* argv[]);
+int runConvert(int argc, char* argv[]);
+int runDiff(int argc, char* argv[]);
+int runGenerate(int argc, char* argv[]);
+int runGraph(int argc, char* argv[]);
+int runLookup(int argc, char* argv[]);
+int runStats(int argc, char* argv[]);
+int runStore(int argc, char* argv[]);
+
+
+#endif
@@ -0,0 +1,98 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "commands.hpp"
+#include "diff/kb_diff.hpp"
+#include "io/snapshot.hpp"
+#include "io/triple.hpp"
+#include "util/parallel.hpp"
+#include "util/resource_usage.hpp"
+
+using namespace ista;
+
+static void printDiffUsage()
+{
+    std::cerr << "usage: ista diff [--json] [--threads N] [--patch FILE] [--from FORMAT] <old> <new>\n"
+              << "\n"
+              << "Reports the individuals, class assertions, relationships and literal values\n"
+              << "added or removed between two KBs. With --patch, also writes the removed and\n"
+              << "added triples to FILE in RDF Patch format. Snapshots (.ista) are memory-\n"
+              << "mapped; other formats are parsed first.\n"
+              << "\n"
+              << "Blank nodes are matched by their outgoing triples, not their labels, so\n"
+              << "renumbered genids do not show up as changes.\n";
+}
+
+// Opens a KB the cheapest way its format allows and passes it to `fn`.
+template <typename Fn>
+static void withKb(const std::string& path, std::optional<io::Format> from, Fn&& fn)
+{
+    io::Format format = from ? *from : io::formatFromPath(path);
+    if (format == io::Format::Snapshot) {
+        io::Snapshot snap(path);
+        fn(snap);
+    } else {
+        owl2::Ontology onto = io::readOntology(path, format);
+        fn(onto);
+    }
+}
+
+int runDiff(int argc, char* argv[])
+{
+    std::optional<io::Format> from;
+    bool json = false;
+    unsigned threads = util::defaultThreadCount();
+    std::string patch_path, old_path, new_path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printDiffUsage();
+            return 0;
+        } else if (arg == "--json") {
+            json = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--patch" && i + 1 < argc) {
+            patch_path = argv[++i];
+        } else if (arg == "--from" && i + 1 < argc) {
+            from = io::parseFormat(argv[++i]);
+        } else if (old_path.empty()) {
+            old_path = arg;
+        } else if (new_path.empty()) {
+            new_path = arg;
+        } else {
+            printDiffUsage();
+            return 1;
+        }
+    }
+    if (old_path.empty() || new_path.empty()) {
+        printDiffUsage();
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<io::PatchWriter> patch;
+    if (!patch_path.empty())
+        patch = std::make_unique<io::PatchWriter>(patch_path);
+    diff::KbDiff result;
+    withKb(old_path, from, [&](const auto& old_kb) {
+        withKb(new_path, from, [&](const auto& new_kb) {
+            result = diff::diffKbs(old_kb, new_kb, threads, patch.get());
+        });
+    });
+    if (patch)
+        patch->close();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (json)
+        diff::writeDiffJson(result, std::cout);
+    else
+        diff::printDiff(result, std::cout);
+    std::fprintf(stderr, "loaded and compared %s and %s in %.3f s using %u threads, peak RSS %s\n", old_path.c_str(),
+                 new_path.c_str(), seconds, threads, util::formatBytes(util::peakRssBytes()).c_str());
+    return 0;
+}
@@ -1,12 +1,103 @@
+#include <cstdlib>
+#include <exception>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
 
-#include "owl2/owl2.hpp"
+#include "commands.hpp"
+#include "util/memory.hpp"
+#include "util/trace.hpp"
+
+static void printUsage()
+{
+    std::cerr << "usage: ista <command> [options]\n"
+              << "\n"
+              << "commands:\n"
+              << "  apply-patch  apply an RDF Patch to a KB\n"
+              << "  build        populate an ontology from the flat files in a build manifest\n"
+              << "  checkout     materialize a KB version from a store\n"
+              << "  convert      convert a KB between RDF/XML, Turtle, N-Triples, OFN, snapshot and Neo4j CSV\n"
+              << "  diff         report what changed between two KBs, optionally as an RDF Patch\n"
+              << "  generate     populate a TBox with synthetic individuals for scale testing\n"
+              << "  graph        build a memory-mapped CSR graph and run BFS, PageRank or components\n"
+              << "  lookup       find IRIs, or individuals by a key property value, in a snapshot\n"
+              << "  stats        summarize the classes, relations, degrees and literals of a KB\n"
+              << "  store        keep KB versions as snapshots plus delta chains\n"
+              << "\n"
+              << "Run `ista <command> --help` for command options.\n";
+}
+
+// Returns nothing for an unknown command.
+static std::optional<int> dispatch(std::string_view command, int argc, char* argv[])
+{
+    if (command == "apply-patch")
+        return runApplyPatch(argc, argv);
+    if (command == "build")
+        return runBuild(argc, argv);
+    if (command == "checkout")
+        return runCheckout(argc, argv);
+    if (command == "convert")
+        return runConvert(argc, argv);
+    if (command == "diff")
+        return runDiff(argc, argv);
+    if (command == "generate")
+        return runGenerate(argc, argv);
+    if (command == "graph")
+        return runGraph(argc, argv);
+    if (command == "lookup")
+        return runLookup(argc, argv);
+    if (command == "stats")
+        return runStats(argc, argv);
+    if (command == "store")
+        return runStore(argc, argv);
+    if (command == "-h" || command == "--help" || command == "help") {
+        printUsage();
+        return 0;
+    }
+    return std::nullopt;
+}
 
 int main(int argc, char* argv[])
 {
-    IRI my_test_iri = IRI("https://comptox.ai/comptox.rdf");
-    
-    std::cout << "Hello, Ista!\n";
-    std::cout << my_test_iri.fullIRI << "\n";
-    return 0;
-}
\ No newline at end of file
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    std::string_view command = argv[1];
+    // ISTA_TRACE=FILE records tracing spans and writes them to FILE as a
+    // Chrome trace, in builds configured with -DISTA_TRACING=ON.
+    const char* trace = std::getenv("ISTA_TRACE");
+    if (trace && *trace) {
+        if (ista::util::trace::COMPILED) {
+            ISTA_TRACE_THREAD("main");
+            ista::util::trace::setEnabled(true);
+        } else {
+            std::cerr << "ista: ISTA_TRACE is set but tracing was not compiled in (-DISTA_TRACING=ON)\n";
+        }
+    }
+    try {
+        if (std::optional<int> status = dispatch(command, argc - 1, argv + 1)) {
+            if (trace && *trace && ista::util::trace::COMPILED)
+                ista::util::trace::writeChromeTrace(std::string(trace));
+            // ISTA_MEMORY_REPORT=1 prints what each subsystem allocated.
+            if (const char* report = std::getenv("ISTA_MEMORY_REPORT"); report && *report && *report != '0')
+                ista::util::printAllocationReport(std::cerr);
+            return *status;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "ista " << command << ": error: " << e.what() << "\n";
+        // The spans leading up to a failure are worth keeping too.
+        if (trace && *trace && ista::util::trace::COMPILED) {
+            try {
+                ista::util::trace::writeChromeTrace(std::string(trace));
+            } catch (const std::exception& trace_error) {
+                std::cerr << "ista: " << trace_error.what() << "\n";
+            }
+        }
+        return 1;
+    }
+    std::cerr << "ista: unknown command '" << command << "'\n\n";
+    printUsage();
+    return 1;
+}
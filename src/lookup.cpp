@@ -0,0 +1,107 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "commands.hpp"
+#include "io/snapshot.hpp"
+#include "io/triple.hpp"
+
+using namespace ista;
+
+static void printLookupUsage()
+{
+    std::cerr << "usage: ista lookup [--key PROPERTY] <kb.ista> <term>...\n"
+              << "\n"
+              << "Prints the term id of each IRI in a snapshot, found through its IRI hash.\n"
+              << "With --key, each term is a lexical value of the data property PROPERTY\n"
+              << "instead, and the individuals that have it are printed, found through the\n"
+              << "key index `ista build` writes for the properties its steps merge and match\n"
+              << "on. PROPERTY is an IRI or its local name, such as xrefNCBIGene.\n"
+              << "\n"
+              << "Key indexes do not store the values themselves: a value no individual has\n"
+              << "matches nothing, except with probability 2^-32. Exits with 1 if any term\n"
+              << "is not found.\n";
+}
+
+// The text after the last '#' or '/'.
+static std::string_view localName(std::string_view iri)
+{
+    std::size_t pos = iri.find_last_of("#/");
+    return pos == std::string_view::npos ? iri : iri.substr(pos + 1);
+}
+
+// The key-indexed property named by `name`, as an IRI or a local name.
+static owl2::TermId keyProperty(const io::Snapshot& snap, const std::string& path, std::string_view name)
+{
+    owl2::TermId property = snap.findIri(name);
+    if (property != owl2::NO_TERM && snap.hasKeyIndex(property))
+        return property;
+    std::vector<owl2::TermId> matches;
+    for (owl2::TermId p : snap.keyProperties())
+        if (localName(snap.iri(p)) == name)
+            matches.push_back(p);
+    if (matches.size() == 1)
+        return matches[0];
+    std::string indexed;
+    for (owl2::TermId p : snap.keyProperties())
+        indexed += std::string(indexed.empty() ? "" : ", ") + std::string(snap.iri(p));
+    if (matches.size() > 1)
+        throw std::runtime_error("'" + std::string(name) + "' names several key properties of '" + path
+                                 + "'; give the IRI: " + indexed);
+    throw std::runtime_error("'" + path + "' has no key index for '" + std::string(name) + "'"
+                             + (indexed.empty() ? std::string() : "; it has indexes for " + indexed));
+}
+
+int runLookup(int argc, char* argv[])
+{
+    std::string key, input;
+    std::vector<std::string> terms;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printLookupUsage();
+            return 0;
+        } else if (arg == "--key" && i + 1 < argc) {
+            key = argv[++i];
+        } else if (input.empty()) {
+            input = arg;
+        } else {
+            terms.push_back(arg);
+        }
+    }
+    if (input.empty() || terms.empty()) {
+        printLookupUsage();
+        return 1;
+    }
+    if (io::formatFromPath(input) != io::Format::Snapshot)
+        throw std::runtime_error("'" + input + "' is not a snapshot; write one with `ista convert` or `ista build`");
+
+    io::Snapshot snap(input);
+    bool all_found = true;
+    if (key.empty()) {
+        for (const std::string& iri : terms) {
+            owl2::TermId id = snap.findIri(iri);
+            if (id == owl2::NO_TERM) {
+                std::cerr << "not found: " << iri << "\n";
+                all_found = false;
+            } else {
+                std::cout << id << "\t" << iri << "\n";
+            }
+        }
+        return all_found ? 0 : 1;
+    }
+
+    owl2::TermId property = keyProperty(snap, input, key);
+    for (const std::string& value : terms) {
+        auto subjects = snap.findKey(property, value);
+        if (subjects.empty()) {
+            std::cerr << "not found: " << value << "\n";
+            all_found = false;
+        }
+        for (owl2::TermId subject : subjects)
+            std::cout << value << "\t" << snap.iri(subject) << "\n";
+    }
+    return all_found ? 0 : 1;
+}
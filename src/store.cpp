@@ -0,0 +1,160 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "commands.hpp"
+#include "io/patch.hpp"
+#include "io/triple.hpp"
+#include "store/kb_store.hpp"
+#include "util/parallel.hpp"
+#include "util/resource_usage.hpp"
+
+using namespace ista;
+
+static void printStoreUsage()
+{
+    std::cerr << "usage: ista store init [--rebase-every N] <store>\n"
+              << "       ista store add [--threads N] [--from FORMAT] <store> <version> <kb>\n"
+              << "       ista store log <store>\n"
+              << "       ista store rebase <store> <version>\n"
+              << "\n"
+              << "Keeps every version of a KB as a full snapshot or as an RDF Patch against\n"
+              << "the previous version. Every N-th version (default 8) is stored in full so\n"
+              << "`ista checkout` never replays more than N-1 patches.\n";
+}
+
+static void printCheckoutUsage()
+{
+    std::cerr << "usage: ista checkout [--to FORMAT] <store> <version> <output>\n"
+              << "\n"
+              << "Materializes a stored KB version and writes it to <output>.\n";
+}
+
+static void printApplyPatchUsage()
+{
+    std::cerr << "usage: ista apply-patch [--from FORMAT] [--to FORMAT] <kb> <patch> <output>\n"
+              << "\n"
+              << "Applies an RDF Patch (as written by `ista diff --patch`) to a KB.\n";
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int runStore(int argc, char* argv[])
+{
+    if (argc < 2 || std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help") {
+        printStoreUsage();
+        return argc < 2 ? 1 : 0;
+    }
+    std::string action = argv[1];
+    unsigned rebase_every = 8;
+    unsigned threads = util::defaultThreadCount();
+    std::optional<io::Format> from;
+    std::vector<std::string> args;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--rebase-every" && i + 1 < argc)
+            rebase_every = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        else if (arg == "--from" && i + 1 < argc)
+            from = io::parseFormat(argv[++i]);
+        else
+            args.push_back(arg);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (action == "init" && args.size() == 1) {
+        store::KbStore::create(args[0], rebase_every);
+        return 0;
+    }
+    if (action == "add" && args.size() == 3) {
+        store::KbStore kbs(args[0]);
+        owl2::Ontology kb = io::readOntology(args[2], from ? *from : io::formatFromPath(args[2]));
+        const store::Version& v = kbs.add(args[1], kb, threads);
+        std::fprintf(stderr, "added %s as a %s (+%llu -%llu axioms) in %.3f s, peak RSS %s\n", v.name.c_str(),
+                     v.base ? "full snapshot" : "delta", static_cast<unsigned long long>(v.added),
+                     static_cast<unsigned long long>(v.removed), secondsSince(start),
+                     util::formatBytes(util::peakRssBytes()).c_str());
+        return 0;
+    }
+    if (action == "log" && args.size() == 1) {
+        store::KbStore kbs(args[0]);
+        for (const store::Version& v : kbs.versions())
+            std::cout << v.name << "\t" << (v.base ? "base" : "delta") << "\t+" << v.added << " -" << v.removed << "\n";
+        return 0;
+    }
+    if (action == "rebase" && args.size() == 2) {
+        store::KbStore kbs(args[0]);
+        kbs.rebase(args[1]);
+        return 0;
+    }
+    printStoreUsage();
+    return 1;
+}
+
+int runCheckout(int argc, char* argv[])
+{
+    std::optional<io::Format> to;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printCheckoutUsage();
+            return 0;
+        } else if (arg == "--to" && i + 1 < argc) {
+            to = io::parseFormat(argv[++i]);
+        } else {
+            args.push_back(arg);
+        }
+    }
+    if (args.size() != 3) {
+        printCheckoutUsage();
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    store::KbStore kbs(args[0]);
+    owl2::Ontology kb = kbs.checkout(args[1]);
+    io::writeOntology(kb, args[2], to ? *to : io::formatFromPath(args[2]));
+    std::fprintf(stderr, "checked out %s (%zu axioms) in %.3f s, peak RSS %s\n", args[1].c_str(), kb.axiomCount(),
+                 secondsSince(start), util::formatBytes(util::peakRssBytes()).c_str());
+    return 0;
+}
+
+int runApplyPatch(int argc, char* argv[])
+{
+    std::optional<io::Format> from, to;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printApplyPatchUsage();
+            return 0;
+        } else if (arg == "--from" && i + 1 < argc) {
+            from = io::parseFormat(argv[++i]);
+        } else if (arg == "--to" && i + 1 < argc) {
+            to = io::parseFormat(argv[++i]);
+        } else {
+            args.push_back(arg);
+        }
+    }
+    if (args.size() != 3) {
+        printApplyPatchUsage();
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    owl2::Ontology kb = io::readOntology(args[0], from ? *from : io::formatFromPath(args[0]));
+    io::PatchResult result = io::applyPatch(kb, args[1]);
+    io::writeOntology(kb, args[2], to ? *to : io::formatFromPath(args[2]));
+    std::fprintf(stderr, "applied %s: +%llu -%llu axioms in %.3f s\n", args[1].c_str(),
+                 static_cast<unsigned long long>(result.added), static_cast<unsigned long long>(result.removed),
+                 secondsSince(start));
+    return 0;
+}
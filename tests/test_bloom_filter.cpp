@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "build/step.hpp"
+#include "util/bloom_filter.hpp"
+
+using namespace ista;
+
+
+namespace
+{
+
+std::string keyOf(std::size_t i)
+{
+    return "NCBIGene:" + std::to_string(i * 7919 + 13);
+}
+
+}
+
+
+TEST(BloomFilter, EmptyRejectsEverything)
+{
+    util::BloomFilter filter;
+    EXPECT_FALSE(filter.mayContain("anything"));
+    EXPECT_FALSE(filter.mayContain(std::string()));
+    EXPECT_EQ(filter.byteSize(), 0u);
+}
+
+TEST(BloomFilter, NoFalseNegatives)
+{
+    const std::size_t n = 100000;
+    util::BloomFilter filter(n);
+    for (std::size_t i = 0; i < n; ++i)
+        filter.insert(keyOf(i));
+    EXPECT_EQ(filter.size(), n);
+    for (std::size_t i = 0; i < n; ++i)
+        ASSERT_TRUE(filter.mayContain(keyOf(i))) << keyOf(i);
+}
+
+// The rate a filter of `blocks` blocks holding `keys` keys should show: each
+// block's load is Poisson, and each of its eight words is a one-hash Bloom
+// filter of 64 bits.
+double expectedFalsePositiveRate(std::size_t keys, std::size_t blocks)
+{
+    double lambda = double(keys) / blocks, rate = 0.0, p = std::exp(-lambda);
+    for (std::size_t load = 0; load < 20 * lambda + 50; ++load) {
+        rate += p * std::pow(1.0 - std::pow(63.0 / 64.0, double(load)), 8.0);
+        p *= lambda / (load + 1);
+    }
+    return rate;
+}
+
+// Filled to capacity, a filter has BITS_PER_KEY bits per key; the rate must
+// match the model and stay under the 1% the class comment promises.
+TEST(BloomFilter, FalsePositiveRateAtCapacity)
+{
+    for (std::size_t expected_keys : {1000u, 50000u, 400000u}) {
+        util::BloomFilter filter(expected_keys);
+        std::size_t n = filter.capacity();
+        for (std::size_t i = 0; i < n; ++i)
+            filter.insert(keyOf(i));
+        ASSERT_EQ(n, filter.byteSize() * 8 / util::BloomFilter::BITS_PER_KEY);
+
+        const std::size_t probes = 1000000;
+        std::size_t hits = 0;
+        for (std::size_t i = n; i < n + probes; ++i)
+            hits += filter.mayContain(keyOf(i));
+        double rate = double(hits) / probes;
+        double expected = expectedFalsePositiveRate(n, filter.byteSize() / 64);
+        EXPECT_LT(rate, 0.01) << n << " keys";
+        EXPECT_NEAR(rate, expected, 0.25 * expected) << n << " keys";
+    }
+}
+
+// KeyIndex grows each property's filter by rescanning the map once it is
+// full; nothing added before or after a rescan may be turned away.
+TEST(KeyIndex, FilterKeepsEveryValueAcrossGrowth)
+{
+    build::KeyIndex keys;
+    const std::size_t n = 20000;
+    for (std::size_t i = 0; i < n; ++i) {
+        keys.add("http://example.org/symbol", keyOf(i), "http://example.org/gene" + std::to_string(i));
+        if (i % 3 == 0)
+            keys.add("http://example.org/xref", keyOf(i), "http://example.org/gene" + std::to_string(i));
+        // Repeats add matches, not values.
+        if (i % 5 == 0)
+            keys.add("http://example.org/symbol", keyOf(i / 2), "http://example.org/other" + std::to_string(i));
+        if (i % 997 == 0) {
+            const util::BloomFilter& filter = keys.filter("http://example.org/symbol");
+            for (std::size_t j = 0; j <= i; ++j)
+                ASSERT_TRUE(filter.mayContain(keyOf(j))) << "after " << i << " values, " << keyOf(j);
+        }
+    }
+    const util::BloomFilter& symbol = keys.filter("http://example.org/symbol");
+    const util::BloomFilter& xref = keys.filter("http://example.org/xref");
+    EXPECT_EQ(symbol.size(), n);
+    EXPECT_GE(symbol.capacity(), n);
+    for (std::size_t i = 0; i < n; ++i) {
+        ASSERT_TRUE(symbol.mayContain(keyOf(i))) << keyOf(i);
+        ASSERT_NE(keys.find("http://example.org/symbol", keyOf(i)), nullptr);
+        if (i % 3 == 0)
+            ASSERT_TRUE(xref.mayContain(keyOf(i))) << keyOf(i);
+    }
+    EXPECT_FALSE(keys.filter("http://example.org/unknown").mayContain(keyOf(0)));
+    // An empty value is a value too.
+    keys.add("http://example.org/symbol", "", "http://example.org/blank");
+    EXPECT_TRUE(keys.filter("http://example.org/symbol").mayContain(""));
+}
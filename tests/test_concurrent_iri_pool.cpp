@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "owl2/concurrent_iri_pool.hpp"
+
+using namespace ista;
+
+
+namespace
+{
+
+std::vector<std::string> makeIris(std::size_t n)
+{
+    std::vector<std::string> iris;
+    for (std::size_t i = 0; i < n; ++i)
+        iris.push_back("http://example.org/ontology#entity_" + std::to_string(i));
+    return iris;
+}
+
+}
+
+
+TEST(ConcurrentIriPool, InternFindAt)
+{
+    owl2::ConcurrentIriPool pool;
+    owl2::TermId a = pool.intern("http://example.org/a");
+    owl2::TermId b = pool.intern("http://example.org/b");
+    EXPECT_NE(a, b);
+    EXPECT_EQ(pool.intern("http://example.org/a"), a);
+    EXPECT_EQ(pool.find("http://example.org/b"), b);
+    EXPECT_EQ(pool.find("http://example.org/c"), owl2::NO_TERM);
+    EXPECT_EQ(pool.at(a), "http://example.org/a");
+    EXPECT_EQ(pool.size(), 2u);
+}
+
+// Threads intern the same IRIs in different orders, racing on every insert
+// and every shard growth; each IRI must get one id, the same on every
+// thread, and the ids must be dense.
+TEST(ConcurrentIriPool, SameIriGetsSameIdAcrossThreads)
+{
+    const std::size_t n = 60000;
+    const unsigned threads = 8;
+    auto iris = makeIris(n);
+    owl2::ConcurrentIriPool pool;
+    std::vector<std::vector<owl2::TermId>> ids(threads, std::vector<owl2::TermId>(n));
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::vector<std::size_t> order(n);
+            std::iota(order.begin(), order.end(), 0);
+            std::shuffle(order.begin(), order.end(), std::mt19937_64(t));
+            for (std::size_t i : order)
+                ids[t][i] = pool.intern(iris[i]);
+        });
+    }
+    for (auto& w : workers)
+        w.join();
+
+    ASSERT_EQ(pool.size(), n);
+    for (unsigned t = 1; t < threads; ++t)
+        EXPECT_EQ(ids[t], ids[0]) << "thread " << t;
+    std::vector<owl2::TermId> sorted = ids[0];
+    std::sort(sorted.begin(), sorted.end());
+    for (std::size_t i = 0; i < n; ++i)
+        ASSERT_EQ(sorted[i], i);
+    for (std::size_t i = 0; i < n; ++i) {
+        ASSERT_EQ(pool.at(ids[0][i]), iris[i]);
+        ASSERT_EQ(pool.find(iris[i]), ids[0][i]);
+    }
+}
+
+// Readers look up IRIs while writers add them; a hit must be the IRI asked
+// for, and once an IRI's id is published every later find sees it.
+TEST(ConcurrentIriPool, FindDuringInterning)
+{
+    const std::size_t n = 40000;
+    auto iris = makeIris(n);
+    owl2::ConcurrentIriPool pool;
+    std::vector<std::atomic<owl2::TermId>> published(n);
+    for (auto& id : published)
+        id.store(owl2::NO_TERM);
+    std::atomic<std::size_t> failures{0};
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < 2; ++t) {
+        workers.emplace_back([&, t] {
+            for (std::size_t i = t; i < n; i += 2)
+                published[i].store(pool.intern(iris[i]), std::memory_order_release);
+        });
+    }
+    for (unsigned t = 0; t < 2; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937_64 rng(100 + t);
+            for (std::size_t k = 0; k < 4 * n; ++k) {
+                std::size_t i = rng() % n;
+                owl2::TermId before = published[i].load(std::memory_order_acquire);
+                owl2::TermId found = pool.find(iris[i]);
+                if (found != owl2::NO_TERM && pool.at(found) != iris[i])
+                    failures.fetch_add(1);
+                if (before != owl2::NO_TERM && found != before)
+                    failures.fetch_add(1);
+            }
+        });
+    }
+    for (auto& w : workers)
+        w.join();
+    EXPECT_EQ(failures.load(), 0u);
+    EXPECT_EQ(pool.size(), n);
+}
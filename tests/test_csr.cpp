@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "graph/csr.hpp"
+#include "owl2/ontology.hpp"
+
+using namespace ista;
+namespace fs = std::filesystem;
+
+
+namespace
+{
+
+std::vector<std::vector<owl2::TermId>> neighborLists(const graph::MappedCsr& g)
+{
+    std::vector<std::vector<owl2::TermId>> lists;
+    graph::NeighborCursor cursor(g);
+    for (owl2::TermId v = 0; v < g.vertexCount(); ++v) {
+        auto targets = cursor.next();
+        lists.emplace_back(targets.begin(), targets.end());
+    }
+    return lists;
+}
+
+}
+
+
+// Compressed lists store each list's first target as a zigzag gap from the
+// vertex id, so targets below the source wrap negative; lists around them
+// are empty, single, long, or cross chunk boundaries.
+TEST(Csr, CompressedListsMatchPlain)
+{
+    owl2::Ontology kb;
+    owl2::TermId p = kb.internIri("http://example.org/p");
+    std::vector<owl2::TermId> v;
+    for (int i = 0; i < 400; ++i)
+        v.push_back(kb.internIri("http://example.org/v" + std::to_string(i)));
+    auto edge = [&](int s, int o) { kb.addAxiom(v[s], p, v[o]); };
+    edge(100, 3);          // first target far below the source
+    edge(100, 150);
+    edge(102, 102);        // 101 in between has no edges
+    edge(103, 0);
+    edge(103, 399);
+    edge(63, 64);          // last vertex of a chunk, first of the next
+    edge(64, 63);
+    edge(399, 0);          // the last vertex, down to the first
+    std::mt19937_64 rng(5);
+    for (int i = 0; i < 3000; ++i)
+        edge(200 + rng() % 40, rng() % 400);   // long lists, many repeats
+    // Vertices 256-319 form a chunk with no edges at all.
+
+    fs::path dir = fs::temp_directory_path() / "ista_csr_test";
+    fs::create_directories(dir);
+    std::string plain_path = (dir / "plain.csr").string(), compressed_path = (dir / "compressed.csr").string();
+    graph::buildCsr(kb, plain_path);
+    graph::CsrBuildOptions options;
+    options.compress = true;
+    graph::buildCsr(kb, compressed_path, options);
+    {
+        graph::MappedCsr plain(plain_path), compressed(compressed_path);
+        ASSERT_FALSE(plain.compressed());
+        ASSERT_TRUE(compressed.compressed());
+        EXPECT_LT(compressed.targetsSize(), plain.targetsSize());
+        auto expected = neighborLists(plain);
+        EXPECT_EQ(neighborLists(compressed), expected);
+        EXPECT_EQ(expected[v[100]], (std::vector<owl2::TermId>{v[3], v[150]}));
+        EXPECT_TRUE(expected[v[101]].empty());
+
+        // Random access: seeking decodes the right chunk whatever came before.
+        graph::NeighborCursor cursor(compressed);
+        for (owl2::TermId u : {v[399], v[0], v[103], v[64], v[63], v[300], v[100]}) {
+            cursor.seek(u);
+            auto targets = cursor.next();
+            EXPECT_EQ(std::vector<owl2::TermId>(targets.begin(), targets.end()), expected[u]) << "vertex " << u;
+        }
+    }
+    fs::remove_all(dir);
+}
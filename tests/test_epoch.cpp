@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "util/epoch.hpp"
+
+using namespace ista;
+
+
+TEST(EpochManager, PinnedReaderHoldsBackRetirement)
+{
+    util::EpochManager epochs;
+    int destroyed = 0;
+    {
+        auto guard = epochs.pin();
+        epochs.retire([&] { ++destroyed; });
+        epochs.collect();
+        EXPECT_EQ(destroyed, 0);
+        EXPECT_EQ(epochs.pending(), 1u);
+    }
+    epochs.collect();
+    EXPECT_EQ(destroyed, 1);
+    EXPECT_EQ(epochs.pending(), 0u);
+}
+
+TEST(EpochManager, LaterReadersDoNotHoldBackRetirement)
+{
+    util::EpochManager epochs;
+    int destroyed = 0;
+    epochs.retire([&] { ++destroyed; });
+    auto guard = epochs.pin();
+    epochs.collect();
+    EXPECT_EQ(destroyed, 1);
+}
+
+TEST(EpochManager, DestructorRunsPendingRetirements)
+{
+    int destroyed = 0;
+    {
+        util::EpochManager epochs;
+        auto guard = epochs.pin();
+        epochs.retire([&] { ++destroyed; });
+        epochs.retire([&] { ++destroyed; });
+        epochs.collect();
+        EXPECT_EQ(destroyed, 0);
+    }
+    EXPECT_EQ(destroyed, 2);
+}
+
+TEST(EpochManager, MovedGuardReleasesOnce)
+{
+    util::EpochManager epochs;
+    int destroyed = 0;
+    auto a = epochs.pin();
+    epochs.retire([&] { ++destroyed; });
+    util::EpochManager::Guard b = std::move(a);
+    epochs.collect();
+    EXPECT_EQ(destroyed, 0);
+    b = util::EpochManager::Guard();
+    epochs.collect();
+    EXPECT_EQ(destroyed, 1);
+}
+
+TEST(EpochManager, TooManyReadersThrows)
+{
+    util::EpochManager epochs;
+    std::vector<util::EpochManager::Guard> guards;
+    for (std::size_t i = 0; i < util::EpochManager::MAX_READERS; ++i)
+        guards.push_back(epochs.pin());
+    EXPECT_THROW(epochs.pin(), std::runtime_error);
+    guards.pop_back();
+    EXPECT_NO_THROW(epochs.pin());
+}
+
+// One writer swaps a shared object and retires the old one; readers check
+// that what they reach while pinned has not been destroyed. Destruction
+// marks the object dead rather than freeing it, so a premature reclamation
+// fails here and not only under ASAN.
+TEST(EpochManager, ConcurrentReadersNeverSeeReclaimedObjects)
+{
+    struct Object
+    {
+        std::atomic<bool> alive{true};
+        std::uint64_t value;
+    };
+    util::EpochManager epochs;
+    std::vector<std::unique_ptr<Object>> graveyard;
+    graveyard.push_back(std::make_unique<Object>());
+    graveyard.back()->value = 0;
+    std::atomic<Object*> current{graveyard.back().get()};
+    std::atomic<bool> done{false};
+    std::atomic<std::uint64_t> failures{0}, reads{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&] {
+            std::uint64_t last = 0;
+            while (!done.load()) {
+                auto guard = epochs.pin();
+                Object* o = current.load(std::memory_order_acquire);
+                for (int spin = 0; spin < 16; ++spin)
+                    if (!o->alive.load(std::memory_order_acquire))
+                        failures.fetch_add(1);
+                if (o->value < last)
+                    failures.fetch_add(1);
+                last = o->value;
+                reads.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    const std::uint64_t rounds = 20000;
+    for (std::uint64_t i = 1; i <= rounds; ++i) {
+        graveyard.push_back(std::make_unique<Object>());
+        graveyard.back()->value = i;
+        Object* old = current.exchange(graveyard.back().get(), std::memory_order_acq_rel);
+        epochs.retire([old] { old->alive.store(false, std::memory_order_release); });
+        epochs.collect();
+    }
+    done.store(true);
+    for (auto& t : readers)
+        t.join();
+    epochs.collect();
+
+    EXPECT_EQ(failures.load(), 0u);
+    EXPECT_GT(reads.load(), 0u);
+    EXPECT_EQ(epochs.pending(), 0u);
+    // Every object but the current one has been reclaimed.
+    for (std::size_t i = 0; i + 1 < graveyard.size(); ++i)
+        EXPECT_FALSE(graveyard[i]->alive.load());
+}
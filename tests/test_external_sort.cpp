@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "util/external_sort.hpp"
+
+using namespace ista;
+
+
+namespace
+{
+
+std::vector<std::uint64_t> randomValues(std::size_t n, std::uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::vector<std::uint64_t> values(n);
+    for (auto& v : values)
+        v = rng() % (n / 2);
+    return values;
+}
+
+std::vector<std::uint64_t> sortAll(std::uint64_t budget, const std::vector<std::uint64_t>& values,
+                                   std::size_t* runs = nullptr)
+{
+    util::ExternalSorter<std::uint64_t> sorter(budget, "", 2);
+    for (std::uint64_t v : values)
+        sorter.push(v);
+    if (runs)
+        *runs = sorter.runCount();
+    std::vector<std::uint64_t> out;
+    sorter.merge([&](std::uint64_t v) { out.push_back(v); });
+    EXPECT_EQ(sorter.size(), 0u);
+    return out;
+}
+
+}
+
+
+TEST(ExternalSorter, InMemory)
+{
+    auto values = randomValues(10000, 1);
+    std::size_t runs = 1;
+    auto out = sortAll(0, values, &runs);
+    EXPECT_EQ(runs, 0u);
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(out, values);
+}
+
+TEST(ExternalSorter, SingleMergePass)
+{
+    using Sorter = util::ExternalSorter<std::uint64_t>;
+    // Room for eight runs' blocks.
+    std::uint64_t budget = 8 * Sorter::MERGE_BLOCK * sizeof(std::uint64_t);
+    auto values = randomValues(200000, 2);
+    std::size_t runs = 0;
+    auto out = sortAll(budget, values, &runs);
+    EXPECT_GT(runs, 1u);
+    EXPECT_LE(runs + 1, 8u);
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(out, values);
+}
+
+// More runs than the budget can give MERGE_BLOCK records each, so runs are
+// merged in several passes first.
+TEST(ExternalSorter, MultiPassMerge)
+{
+    using Sorter = util::ExternalSorter<std::uint64_t>;
+    std::uint64_t budget = 2 * Sorter::MERGE_BLOCK * sizeof(std::uint64_t);
+    auto values = randomValues(300000, 3);
+    std::size_t runs = 0;
+    auto out = sortAll(budget, values, &runs);
+    EXPECT_GT(runs, 30u);
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(out, values);
+}
+
+TEST(ExternalSorter, TinyBudget)
+{
+    auto values = randomValues(5000, 4);
+    std::size_t runs = 0;
+    auto out = sortAll(64, values, &runs);
+    EXPECT_GT(runs, 500u);
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(out, values);
+}
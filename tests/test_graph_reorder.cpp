@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "graph/csr.hpp"
+#include "graph/reorder.hpp"
+#include "owl2/ontology.hpp"
+
+using namespace ista;
+namespace fs = std::filesystem;
+
+
+namespace
+{
+
+using Edge = std::tuple<owl2::TermId, owl2::TermId, owl2::TermId>;   // source, target, label
+
+// A few components of random edges under three properties, with hubs,
+// self loops, repeated edges and vertices that have no edges at all.
+owl2::Ontology makeKb()
+{
+    owl2::Ontology kb;
+    std::vector<owl2::TermId> properties;
+    for (int p = 0; p < 3; ++p)
+        properties.push_back(kb.internIri("http://example.org/p" + std::to_string(p)));
+    std::vector<owl2::TermId> vertices;
+    for (int v = 0; v < 600; ++v)
+        vertices.push_back(kb.internIri("http://example.org/v" + std::to_string(v)));
+    std::mt19937_64 rng(7);
+    for (int component = 0; component < 3; ++component) {
+        std::size_t base = component * 180, size = 150;
+        for (int e = 0; e < 900; ++e) {
+            std::size_t s = base + rng() % size;
+            std::size_t o = base + (e % 5 == 0 ? 0 : rng() % size);
+            kb.addAxiom(vertices[s], properties[rng() % 3], vertices[o]);
+        }
+    }
+    kb.addAxiom(vertices[599], properties[0], vertices[599]);
+    return kb;
+}
+
+// Every edge, in KB ids.
+std::vector<Edge> edgesOf(const graph::MappedCsr& g)
+{
+    std::vector<Edge> edges;
+    graph::NeighborCursor cursor(g);
+    for (owl2::TermId v = 0; v < g.vertexCount(); ++v) {
+        auto targets = cursor.next();
+        for (std::size_t i = 0; i < targets.size(); ++i)
+            edges.emplace_back(g.originalId(v), g.originalId(targets[i]),
+                               g.originalId(g.labels()[g.offsets()[v] + i]));
+    }
+    std::sort(edges.begin(), edges.end());
+    return edges;
+}
+
+class ReorderTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        dir_ = fs::temp_directory_path() / ("ista_reorder_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+        fs::create_directories(dir_);
+        graph::buildCsr(kb_, path("plain.csr"));
+        graph::CsrBuildOptions compress;
+        compress.compress = true;
+        graph::buildCsr(kb_, path("compressed.csr"), compress);
+    }
+    void TearDown() override { fs::remove_all(dir_); }
+
+    std::string path(const std::string& name) const { return (dir_ / name).string(); }
+
+    owl2::Ontology kb_ = makeKb();
+    fs::path dir_;
+};
+
+const graph::VertexOrder ORDERS[] = {graph::VertexOrder::Degree, graph::VertexOrder::Bfs, graph::VertexOrder::Rcm};
+
+}
+
+
+TEST_F(ReorderTest, SameGraphUnderEveryOrder)
+{
+    graph::MappedCsr plain(path("plain.csr"));
+    std::vector<Edge> expected = edgesOf(plain);
+    ASSERT_EQ(expected.size(), kb_.axioms(owl2::AxiomKind::ObjectPropertyAssertion).size());
+
+    for (graph::VertexOrder order : ORDERS) {
+        for (bool compress : {false, true}) {
+            SCOPED_TRACE(std::string(graph::vertexOrderName(order)) + (compress ? " compressed" : " plain"));
+            graph::CsrBuildOptions options;
+            options.compress = compress;
+            std::string out = path(std::string(graph::vertexOrderName(order)) + ".csr");
+            graph::reorderCsr(plain, out, order, options);
+            graph::MappedCsr g(out);
+            EXPECT_EQ(g.order(), order);
+            EXPECT_EQ(g.compressed(), compress);
+            ASSERT_EQ(g.vertexCount(), plain.vertexCount());
+            EXPECT_EQ(edgesOf(g), expected);
+
+            // A permutation of the vertices, each named after its KB IRI.
+            std::vector<owl2::TermId> seen;
+            for (owl2::TermId v = 0; v < g.vertexCount(); ++v) {
+                EXPECT_EQ(g.name(v), kb_.iri(g.originalId(v)));
+                seen.push_back(g.originalId(v));
+            }
+            std::sort(seen.begin(), seen.end());
+            for (owl2::TermId v = 0; v < seen.size(); ++v)
+                ASSERT_EQ(seen[v], v);
+        }
+    }
+}
+
+// Reordering a reordered graph composes, and going back to Original without
+// compression gives the plain graph in KB order.
+TEST_F(ReorderTest, ReorderWithoutCompressRestoresPlainGraph)
+{
+    graph::MappedCsr plain(path("plain.csr"));
+    graph::MappedCsr compressed(path("compressed.csr"));
+    std::vector<Edge> expected = edgesOf(plain);
+    EXPECT_EQ(edgesOf(compressed), expected);
+
+    for (graph::VertexOrder order : ORDERS) {
+        SCOPED_TRACE(graph::vertexOrderName(order));
+        graph::CsrBuildOptions compress;
+        compress.compress = true;
+        graph::reorderCsr(compressed, path("step1.csr"), order, compress);
+        graph::MappedCsr step1(path("step1.csr"));
+        ASSERT_TRUE(step1.compressed());
+
+        graph::reorderCsr(step1, path("step2.csr"), graph::VertexOrder::Original);
+        graph::MappedCsr step2(path("step2.csr"));
+        EXPECT_FALSE(step2.compressed());
+        ASSERT_NE(step2.targets(), nullptr);
+        EXPECT_EQ(edgesOf(step2), expected);
+        for (owl2::TermId v = 0; v < step2.vertexCount(); ++v) {
+            ASSERT_EQ(step2.originalId(v), v);
+            ASSERT_EQ(step2.degree(v), plain.degree(v));
+            ASSERT_EQ(step2.name(v), plain.name(v));
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory_resource>
+
+#include "util/huge_pages.hpp"
+
+using namespace ista;
+
+
+namespace
+{
+
+// Counts what reaches the upstream resource.
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    std::size_t allocated = 0;
+    std::size_t deallocated = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        ++allocated;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+    {
+        ++deallocated;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+class HugePageResourceTest : public ::testing::Test
+{
+protected:
+    void SetUp() override { saved_ = util::hugePageMode(); }
+    void TearDown() override { util::setHugePageMode(saved_); }
+
+    util::HugePages saved_ = util::HugePages::Off;
+};
+
+const std::size_t LARGE = 3 * util::HUGE_PAGE_SIZE;
+
+}
+
+
+TEST_F(HugePageResourceTest, OffForwardsUpstream)
+{
+    util::setHugePageMode(util::HugePages::Off);
+    CountingResource upstream;
+    util::HugePageResource resource(util::HUGE_PAGE_SIZE, &upstream);
+    void* p = resource.allocate(LARGE);
+    EXPECT_EQ(upstream.allocated, 1u);
+    EXPECT_EQ(resource.mappedBytes(), 0u);
+    resource.deallocate(p, LARGE);
+    EXPECT_EQ(upstream.deallocated, 1u);
+}
+
+TEST_F(HugePageResourceTest, TransparentMapsLargeBlocks)
+{
+    util::setHugePageMode(util::HugePages::Transparent);
+    CountingResource upstream;
+    util::HugePageResource resource(util::HUGE_PAGE_SIZE, &upstream);
+    void* small = resource.allocate(64);
+    void* large = resource.allocate(LARGE);
+    EXPECT_EQ(upstream.allocated, 1u);
+    EXPECT_EQ(resource.mappedBytes(), LARGE);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(large) % util::HUGE_PAGE_SIZE, 0u);
+    std::memset(large, 1, LARGE);
+    resource.deallocate(large, LARGE);
+    resource.deallocate(small, 64);
+    EXPECT_EQ(upstream.deallocated, 1u);
+    EXPECT_EQ(resource.mappedBytes(), 0u);
+}
+
+// Each block is released the way it was allocated, whatever the mode is by
+// then.
+TEST_F(HugePageResourceTest, ModeChangeBetweenAllocateAndDeallocate)
+{
+    CountingResource upstream;
+    util::HugePageResource resource(util::HUGE_PAGE_SIZE, &upstream);
+    util::setHugePageMode(util::HugePages::Transparent);
+    void* mapped = resource.allocate(LARGE);
+    util::setHugePageMode(util::HugePages::Off);
+    void* forwarded = resource.allocate(LARGE);
+    EXPECT_EQ(upstream.allocated, 1u);
+
+    util::setHugePageMode(util::HugePages::Transparent);
+    resource.deallocate(forwarded, LARGE);
+    EXPECT_EQ(upstream.deallocated, 1u);
+    EXPECT_EQ(resource.mappedBytes(), LARGE);
+    util::setHugePageMode(util::HugePages::Off);
+    resource.deallocate(mapped, LARGE);
+    EXPECT_EQ(upstream.deallocated, 1u);
+    EXPECT_EQ(resource.mappedBytes(), 0u);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "io/snapshot.hpp"
+#include "owl2/iri_dictionary.hpp"
+#include "owl2/ontology.hpp"
+
+using namespace ista;
+namespace fs = std::filesystem;
+
+
+namespace
+{
+
+// Every id decodes to its IRI and every IRI finds its id.
+void expectRoundTrip(const owl2::IriPool& pool, const owl2::IriDictionary& dictionary)
+{
+    ASSERT_EQ(dictionary.size(), pool.size());
+    std::string buffer;
+    for (owl2::TermId id = 0; id < pool.size(); ++id) {
+        EXPECT_EQ(dictionary.at(id, buffer), pool.at(id)) << "id " << id;
+        EXPECT_EQ(dictionary.find(pool.at(id)), id) << pool.at(id);
+    }
+}
+
+owl2::IriPool numberedPool(std::size_t count)
+{
+    owl2::IriPool pool;
+    for (std::size_t i = 0; i < count; ++i)
+        pool.intern("http://example.org/gene/" + std::to_string(i * 7919 % 100003));
+    return pool;
+}
+
+}
+
+
+// Sizes around the bucket width: empty, one, a bucket short, exactly full,
+// one past, and a last bucket holding a single IRI.
+TEST(IriDictionary, RoundTripsAroundBucketBoundaries)
+{
+    constexpr std::size_t B = owl2::IriDictionary::BUCKET;
+    for (std::size_t count : std::vector<std::size_t>{0, 1, 2, B - 1, B, B + 1, 2 * B, 2 * B + 1, 1000}) {
+        owl2::IriPool pool = numberedPool(count);
+        owl2::IriDictionary::Parts parts = owl2::IriDictionary::build(pool);
+        EXPECT_EQ(parts.buckets.size(), (count + B - 1) / B + 1) << count;
+        expectRoundTrip(pool, owl2::IriDictionary(parts));
+    }
+}
+
+TEST(IriDictionary, SharedPrefixEdgeCases)
+{
+    owl2::IriPool pool;
+    std::string long_prefix = "http://example.org/" + std::string(300, 'a');   // shared length needs two varint bytes
+    for (std::string iri : {std::string(""), std::string("h"), std::string("http://example.org/"),
+                            std::string("http://example.org/a"), std::string("http://example.org/ab"),
+                            std::string("http://example.org/b"), long_prefix, long_prefix + "x", long_prefix + "y",
+                            long_prefix + "xz", std::string("http://example.org/\xc3\xa9"),
+                            std::string("http://example.org/\x7f")})
+        pool.intern(iri);
+    // Enough same-prefix IRIs that some bucket heads are prefixes of the IRIs
+    // before them in other buckets.
+    for (int i = 0; i < 40; ++i)
+        pool.intern(long_prefix + std::string(i % 7, 'x') + std::to_string(i));
+    expectRoundTrip(pool, owl2::IriDictionary(owl2::IriDictionary::build(pool)));
+}
+
+TEST(IriDictionary, AbsentIrisAreNotFound)
+{
+    owl2::IriPool pool = numberedPool(100);
+    owl2::IriDictionary::Parts parts = owl2::IriDictionary::build(pool);
+    owl2::IriDictionary dictionary(parts);
+    for (std::string iri : {std::string(""), std::string("a"), std::string("zzz"), std::string("http://example.org/"),
+                            std::string("http://example.org/gene/"), std::string("http://example.org/gene/00"),
+                            std::string(pool.at(5)) + "0", std::string(pool.at(5)).substr(0, pool.at(5).size() - 1)})
+        if (pool.find(iri) == owl2::NO_TERM)
+            EXPECT_EQ(dictionary.find(iri), owl2::NO_TERM) << iri;
+
+    owl2::IriDictionary empty(owl2::IriDictionary::build(owl2::IriPool()));
+    EXPECT_EQ(empty.find(""), owl2::NO_TERM);
+    EXPECT_EQ(empty.find("http://example.org/"), owl2::NO_TERM);
+}
+
+TEST(IriDictionary, InconsistentSectionsThrow)
+{
+    owl2::IriPool pool = numberedPool(40);
+    owl2::IriDictionary::Parts parts = owl2::IriDictionary::build(pool);
+    parts.ids.pop_back();
+    EXPECT_THROW(owl2::IriDictionary{parts}, std::runtime_error);
+}
+
+// Snapshots carry the dictionary only when asked, and findIri() answers the
+// same from it as from the IRI hash.
+TEST(IriDictionary, SnapshotStoresItOnRequest)
+{
+    fs::path dir = fs::temp_directory_path()
+        / ("ista_iri_dictionary_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    fs::create_directories(dir);
+    owl2::Ontology kb;
+    for (int i = 0; i < 50; ++i)
+        kb.addAxiom(kb.internIri("http://example.org/s" + std::to_string(i)), kb.internIri("http://example.org/p"),
+                    kb.internIri("http://example.org/o" + std::to_string(i % 9)));
+
+    std::string plain = (dir / "plain.ista").string(), dictionary = (dir / "dictionary.ista").string();
+    io::writeSnapshot(kb, plain);
+    io::SnapshotOptions options;
+    options.iri_dictionary = true;
+    io::writeSnapshot(kb, dictionary, options);
+    {
+        io::Snapshot without(plain), with(dictionary);
+        EXPECT_EQ(without.iriDictionary().size(), 0u);
+        ASSERT_EQ(with.iriDictionary().size(), kb.iris().size());
+        expectRoundTrip(kb.iris(), with.iriDictionary());
+        for (owl2::TermId id = 0; id < kb.iris().size(); ++id) {
+            EXPECT_EQ(with.findIri(kb.iri(id)), id);
+            EXPECT_EQ(without.findIri(kb.iri(id)), id);
+        }
+        EXPECT_EQ(with.findIri("http://example.org/s50"), owl2::NO_TERM);
+        EXPECT_EQ(without.findIri("http://example.org/s50"), owl2::NO_TERM);
+    }
+    fs::remove_all(dir);
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "diff/kb_diff.hpp"
+#include "owl2/ontology.hpp"
+#include "owl2/vocabulary.hpp"
+
+using namespace ista;
+
+
+namespace
+{
+
+const std::string EX = "http://example.org/";
+
+// Adds `Class subClassOf (onProperty p, someValuesFrom list(a, b, ...))`,
+// with the restriction and the list cells as blank nodes named from `prefix`.
+void addRestriction(owl2::Ontology& kb, const std::string& prefix, const std::string& cls,
+                    const std::vector<std::string>& members)
+{
+    auto iri = [&](std::string_view s) { return kb.internIri(s); };
+    owl2::TermId restriction = iri("_:" + prefix + "r");
+    kb.addAxiom(iri(EX + cls), iri("http://www.w3.org/2000/01/rdf-schema#subClassOf"), restriction);
+    kb.addAxiom(restriction, iri(owl2::vocab::OWL_ON_PROPERTY), iri(EX + "p"));
+    owl2::TermId cell = iri("_:" + prefix + "l0");
+    kb.addAxiom(restriction, iri("http://www.w3.org/2002/07/owl#someValuesFrom"), cell);
+    for (std::size_t i = 0; i < members.size(); ++i) {
+        kb.addAxiom(cell, iri(owl2::vocab::RDF_FIRST), iri(EX + members[i]));
+        owl2::TermId next = i + 1 == members.size() ? iri(owl2::vocab::RDF_NIL)
+                                                    : iri("_:" + prefix + "l" + std::to_string(i + 1));
+        kb.addAxiom(cell, iri(owl2::vocab::RDF_REST), next);
+        cell = next;
+    }
+}
+
+std::uint64_t changes(const diff::KbDiff& d)
+{
+    std::uint64_t n = 0;
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k)
+        n += d.added[k] + d.removed[k];
+    return n;
+}
+
+}
+
+
+TEST(KbDiff, BlankNodeLabelsDoNotMatter)
+{
+    owl2::Ontology a, b;
+    addRestriction(a, "genid1", "A", {"x", "y", "z"});
+    addRestriction(a, "genid2", "B", {"x", "y"});
+    addRestriction(b, "other9", "B", {"x", "y"});
+    addRestriction(b, "other3", "A", {"x", "y", "z"});
+    diff::KbDiff d = diff::diffKbs(a, b, 2);
+    EXPECT_TRUE(d.empty());
+}
+
+// An extra anonymous restriction shifts every later genid; only its own
+// triples are reported.
+TEST(KbDiff, RenumberedBlankNodesAreNotChanges)
+{
+    owl2::Ontology a, b;
+    addRestriction(a, "genid1", "A", {"x"});
+    addRestriction(a, "genid2", "B", {"y"});
+    addRestriction(b, "genid1", "C", {"z"});
+    addRestriction(b, "genid2", "A", {"x"});
+    addRestriction(b, "genid3", "B", {"y"});
+    diff::KbDiff d = diff::diffKbs(a, b, 1);
+    // subClassOf, onProperty, someValuesFrom, first and rest.
+    EXPECT_EQ(changes(d), 5u);
+    std::uint64_t removed = 0;
+    for (std::uint64_t r : d.removed)
+        removed += r;
+    EXPECT_EQ(removed, 0u);
+}
+
+// A change deep inside a list changes every blank node above it.
+TEST(KbDiff, NestedChangeReachesEnclosingBlankNodes)
+{
+    owl2::Ontology a, b;
+    addRestriction(a, "genid1", "A", {"x", "y", "z"});
+    addRestriction(b, "genid1", "A", {"x", "y", "w"});
+    diff::KbDiff d = diff::diffKbs(a, b, 1);
+    // Each side: subClassOf, onProperty, someValuesFrom and three cells of
+    // first and rest, all under blank nodes that now differ.
+    EXPECT_EQ(changes(d), 2u * 9u);
+}
+
+TEST(KbDiff, BlankNodeCyclesTerminate)
+{
+    owl2::Ontology a, b;
+    for (owl2::Ontology* kb : {&a, &b}) {
+        owl2::TermId p = kb->internIri(EX + "p");
+        owl2::TermId x = kb->internIri("_:x"), y = kb->internIri("_:y");
+        kb->addAxiom(x, p, y);
+        kb->addAxiom(y, p, x);
+        kb->addAxiom(x, kb->internIri(EX + "q"), kb->internIri(EX + "z"));
+    }
+    EXPECT_TRUE(diff::diffKbs(a, b, 1).empty());
+}
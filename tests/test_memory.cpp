@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "util/memory.hpp"
+
+using namespace ista;
+
+
+// Every row keeps its line and the kind column starts at the same offset,
+// however long the component names are.
+TEST(MemoryUsage, LongNamesWidenTheTable)
+{
+    util::MemoryUsage usage;
+    usage.push_back(util::MemoryComponent{"short", 10, 10, 0, false, 0});
+    usage.push_back(util::MemoryComponent{"key index http://example.org/" + std::string(150, 'x'), 1 << 20, 1 << 20,
+                                          0, true, 4096});
+    std::ostringstream out;
+    util::printMemoryUsage(usage, out);
+
+    std::vector<std::string> lines;
+    std::istringstream in(out.str());
+    for (std::string line; std::getline(in, line);)
+        lines.push_back(line);
+    ASSERT_EQ(lines.size(), 4u);
+    std::size_t kind = lines[0].find("kind");
+    ASSERT_NE(kind, std::string::npos);
+    EXPECT_GT(kind, 150u);
+    EXPECT_EQ(lines[1].find("heap"), kind);
+    EXPECT_EQ(lines[2].find("mapped"), kind);
+    EXPECT_EQ(lines[2].find(std::string(150, 'x')), 29u);
+    EXPECT_EQ(lines[3].rfind("total", 0), 0u);
+    for (const std::string& line : lines)
+        EXPECT_EQ(line.size(), lines[0].size());
+}
@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "io/snapshot.hpp"
+#include "owl2/ontology.hpp"
+#include "owl2/vocabulary.hpp"
+#include "util/hash.hpp"
+#include "util/perfect_hash.hpp"
+
+using namespace ista;
+namespace fs = std::filesystem;
+
+
+namespace
+{
+
+using Entries = std::vector<std::pair<std::string_view, std::uint32_t>>;
+
+std::vector<std::string> numberedKeys(std::size_t count, const std::string& prefix)
+{
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < count; ++i)
+        keys.push_back(prefix + std::to_string(i));
+    return keys;
+}
+
+// Builds an index mapping the i-th key to i and checks every key finds it.
+std::vector<char> expectRoundTrip(const std::vector<std::string>& keys)
+{
+    Entries entries;
+    for (std::size_t i = 0; i < keys.size(); ++i)
+        entries.emplace_back(keys[i], static_cast<std::uint32_t>(i));
+    std::vector<char> bytes = util::PerfectHashIndex::build(entries);
+    util::PerfectHashIndex index(bytes);
+    EXPECT_EQ(index.keyCount(), keys.size());
+    EXPECT_EQ(index.empty(), keys.empty());
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        auto values = index.find(keys[i]);
+        EXPECT_EQ(values.size(), 1u) << keys[i];
+        if (values.size() == 1)
+            EXPECT_EQ(values[0], i) << keys[i];
+    }
+    return bytes;
+}
+
+}
+
+
+TEST(PerfectHashIndex, TinyKeySets)
+{
+    for (std::size_t n : {0, 1, 2}) {
+        std::vector<std::string> keys = numberedKeys(n, "key");
+        std::vector<char> bytes = expectRoundTrip(keys);
+        util::PerfectHashIndex index(bytes);
+        EXPECT_TRUE(index.find("absent").empty()) << n;
+        EXPECT_TRUE(index.find("").empty()) << n;
+    }
+}
+
+TEST(PerfectHashIndex, EveryIdRoundTrips)
+{
+    expectRoundTrip(numberedKeys(100000, "http://example.org/gene/"));
+}
+
+// Keys outside the set land on some slot, and the fingerprint turns them
+// away; each would pass with probability 2^-32.
+TEST(PerfectHashIndex, FingerprintRejectsAbsentKeys)
+{
+    std::vector<std::string> keys = numberedKeys(20000, "http://example.org/gene/");
+    Entries entries;
+    for (std::size_t i = 0; i < keys.size(); ++i)
+        entries.emplace_back(keys[i], static_cast<std::uint32_t>(i));
+    std::vector<char> bytes = util::PerfectHashIndex::build(entries);
+    util::PerfectHashIndex index(bytes);
+    std::size_t passed = 0;
+    for (const std::string& absent : numberedKeys(200000, "http://example.org/protein/"))
+        passed += !index.find(absent).empty();
+    EXPECT_EQ(passed, 0u);
+}
+
+TEST(PerfectHashIndex, RepeatedKeysKeepEntryOrder)
+{
+    Entries entries = {{"a", 5}, {"b", 1}, {"a", 3}, {"c", 9}, {"a", 7}, {"b", 2}};
+    std::vector<char> bytes = util::PerfectHashIndex::build(entries);
+    util::PerfectHashIndex index(bytes);
+    EXPECT_EQ(index.keyCount(), 3u);
+    auto a = index.find("a"), b = index.find("b"), c = index.find("c");
+    EXPECT_EQ(std::vector<std::uint32_t>(a.begin(), a.end()), (std::vector<std::uint32_t>{5, 3, 7}));
+    EXPECT_EQ(std::vector<std::uint32_t>(b.begin(), b.end()), (std::vector<std::uint32_t>{1, 2}));
+    EXPECT_EQ(std::vector<std::uint32_t>(c.begin(), c.end()), (std::vector<std::uint32_t>{9}));
+}
+
+TEST(PerfectHashIndex, MalformedBytesThrow)
+{
+    std::vector<char> bytes = expectRoundTrip(numberedKeys(100, "k"));
+    EXPECT_THROW(util::PerfectHashIndex(std::span<const char>(bytes.data(), 16)), std::runtime_error);
+    bytes.resize(bytes.size() - 8);
+    EXPECT_THROW(util::PerfectHashIndex{bytes}, std::runtime_error);
+}
+
+// The table is 2% larger than the key set; keys whose pilot sends them past
+// the end are remapped onto the free slots below it, and every key still
+// gets a distinct position.
+TEST(PerfectHash, RemapFillsTheHoles)
+{
+    constexpr std::uint64_t N = 5000;
+    std::vector<std::uint64_t> hashes;
+    for (std::uint64_t i = 0; i < N; ++i)
+        hashes.push_back(util::mix64(i + 1));
+    util::PerfectHash::Parts parts;
+    ASSERT_TRUE(util::PerfectHash::build(hashes, parts));
+    ASSERT_GT(parts.table_size, N);
+    EXPECT_EQ(parts.remap.size(), parts.table_size - N);
+    util::PerfectHash hash(parts.key_count, parts.table_size, parts.dense_buckets, parts.pilots, parts.remap);
+
+    std::size_t remapped = 0;
+    std::vector<bool> seen(N, false);
+    for (std::uint64_t h : hashes) {
+        std::uint64_t bucket = util::PerfectHash::bucket(h, parts.dense_buckets, parts.pilots.size());
+        remapped += util::PerfectHash::slot(h, parts.pilots[bucket], parts.table_size) >= N;
+        std::uint64_t p = hash(h);
+        ASSERT_LT(p, N);
+        EXPECT_FALSE(seen[p]) << "position " << p << " taken twice";
+        seen[p] = true;
+    }
+    EXPECT_GT(remapped, 0u);
+}
+
+TEST(PerfectHash, DuplicateHashesFail)
+{
+    std::vector<std::uint64_t> hashes = {1, 2, 3, 2};
+    util::PerfectHash::Parts parts;
+    EXPECT_FALSE(util::PerfectHash::build(hashes, parts));
+}
+
+// `ista build` writes a key index per merge or match property; the snapshot
+// finds each subject by its value, with repeated values giving several.
+TEST(PerfectHashIndex, SnapshotKeyIndex)
+{
+    fs::path dir = fs::temp_directory_path()
+        / ("ista_perfect_hash_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    fs::create_directories(dir);
+    const std::string ex = "http://example.org/";
+    owl2::Ontology kb;
+    owl2::TermId symbol = kb.internIri(ex + "geneSymbol");
+    owl2::TermId datatype = kb.internIri(owl2::vocab::XSD_STRING);
+    std::vector<owl2::TermId> genes;
+    for (int i = 0; i < 300; ++i) {
+        genes.push_back(kb.internIri(ex + "gene" + std::to_string(i)));
+        std::string value = i == 299 ? "G0" : "G" + std::to_string(i);
+        kb.addAxiom(genes.back(), symbol, kb.internLiteral(value, datatype, ""));
+    }
+
+    std::string path = (dir / "kb.ista").string();
+    io::SnapshotOptions options;
+    options.key_properties = {ex + "geneSymbol", ex + "unused"};
+    io::writeSnapshot(kb, path, options);
+    {
+        io::Snapshot snap(path);
+        ASSERT_EQ(snap.keyProperties(), std::vector<owl2::TermId>{symbol});
+        EXPECT_TRUE(snap.hasKeyIndex(symbol));
+        EXPECT_FALSE(snap.hasKeyIndex(genes[0]));
+        for (int i = 1; i < 299; ++i) {
+            auto subjects = snap.findKey(symbol, "G" + std::to_string(i));
+            ASSERT_EQ(subjects.size(), 1u) << i;
+            EXPECT_EQ(subjects[0], genes[i]);
+        }
+        auto g0 = snap.findKey(symbol, "G0");
+        EXPECT_EQ(std::vector<owl2::TermId>(g0.begin(), g0.end()), (std::vector<owl2::TermId>{genes[0], genes[299]}));
+        EXPECT_TRUE(snap.findKey(symbol, "G299").empty());
+        EXPECT_TRUE(snap.findKey(genes[0], "G1").empty());
+    }
+    fs::remove_all(dir);
+}
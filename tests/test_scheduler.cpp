@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "util/scheduler.hpp"
+
+using namespace ista;
+
+
+namespace
+{
+
+class SchedulerTest : public ::testing::Test
+{
+protected:
+    void TearDown() override { util::Scheduler::instance().configure(0); }
+
+    static void threads(unsigned n) { util::Scheduler::instance().configure(n); }
+};
+
+// Each level runs its two halves as tasks and waits on them, so every
+// worker ends up waiting inside a task while its children are still queued.
+std::uint64_t nestedCount(unsigned depth)
+{
+    if (depth == 0)
+        return 1;
+    std::uint64_t left = 0, right = 0;
+    util::TaskGroup group;
+    group.run([&] { left = nestedCount(depth - 1); });
+    group.run([&] { right = nestedCount(depth - 1); });
+    group.wait();
+    return left + right;
+}
+
+}
+
+
+TEST_F(SchedulerTest, RunsEveryTask)
+{
+    threads(4);
+    std::atomic<int> count{0};
+    util::TaskGroup group;
+    for (int i = 0; i < 1000; ++i)
+        group.run([&] { count.fetch_add(1); });
+    group.wait();
+    EXPECT_EQ(count.load(), 1000);
+}
+
+TEST_F(SchedulerTest, ExceptionReachesWait)
+{
+    threads(4);
+    std::atomic<int> count{0};
+    util::TaskGroup group;
+    for (int i = 0; i < 200; ++i) {
+        group.run([&, i] {
+            if (i == 50)
+                throw std::runtime_error("task 50 failed");
+            count.fetch_add(1);
+        });
+    }
+    try {
+        group.wait();
+        FAIL() << "wait() did not rethrow";
+    } catch (const std::runtime_error& e) {
+        EXPECT_STREQ(e.what(), "task 50 failed");
+    }
+    EXPECT_TRUE(group.cancelled());
+    EXPECT_LT(count.load(), 200);
+
+    // The pool is still usable afterwards.
+    util::TaskGroup next;
+    std::atomic<int> again{0};
+    for (int i = 0; i < 100; ++i)
+        next.run([&] { again.fetch_add(1); });
+    next.wait();
+    EXPECT_EQ(again.load(), 100);
+}
+
+TEST_F(SchedulerTest, OnlyFirstExceptionIsRethrown)
+{
+    threads(4);
+    util::TaskGroup group;
+    for (int i = 0; i < 50; ++i)
+        group.run([] { throw std::runtime_error("failed"); });
+    EXPECT_THROW(group.wait(), std::runtime_error);
+    // The error was consumed by the first wait.
+    EXPECT_NO_THROW(group.wait());
+}
+
+// Without workers tasks run in wait(), oldest first, so the failure comes
+// before every other task and cancels them all.
+TEST_F(SchedulerTest, ExceptionSkipsUnstartedTasks)
+{
+    threads(1);
+    std::atomic<int> count{0};
+    util::TaskGroup group;
+    group.run([] { throw std::logic_error("first"); });
+    for (int i = 0; i < 100; ++i)
+        group.run([&] { count.fetch_add(1); });
+    EXPECT_THROW(group.wait(), std::logic_error);
+    EXPECT_EQ(count.load(), 0);
+}
+
+TEST_F(SchedulerTest, CancelSkipsUnstartedTasks)
+{
+    threads(1);
+    std::atomic<int> count{0};
+    util::TaskGroup group;
+    for (int i = 0; i < 100; ++i)
+        group.run([&] { count.fetch_add(1); });
+    group.cancel();
+    EXPECT_NO_THROW(group.wait());
+    EXPECT_EQ(count.load(), 0);
+}
+
+TEST_F(SchedulerTest, RunningTasksSeeCancellation)
+{
+    threads(4);
+    std::atomic<int> stopped{0};
+    util::TaskGroup group;
+    for (int i = 0; i < 3; ++i) {
+        group.run([&] {
+            while (!group.cancelled())
+                std::this_thread::yield();
+            stopped.fetch_add(1);
+        });
+    }
+    group.run([&] { group.cancel(); });
+    group.wait();
+    // Pollers that started before the cancel stopped; the rest were skipped.
+    EXPECT_LE(stopped.load(), 3);
+}
+
+TEST_F(SchedulerTest, NestedWaitsDoNotDeadlock)
+{
+    for (unsigned n : {1u, 2u, 4u}) {
+        threads(n);
+        EXPECT_EQ(nestedCount(10), 1024u) << n << " threads";
+    }
+}
+
+TEST_F(SchedulerTest, NestedExceptionPropagatesOutward)
+{
+    threads(4);
+    util::TaskGroup outer;
+    for (int i = 0; i < 8; ++i) {
+        outer.run([i] {
+            util::TaskGroup inner;
+            for (int j = 0; j < 8; ++j) {
+                inner.run([i, j] {
+                    if (i == 3 && j == 5)
+                        throw std::runtime_error("inner 3/5");
+                });
+            }
+            inner.wait();
+        });
+    }
+    try {
+        outer.wait();
+        FAIL() << "wait() did not rethrow";
+    } catch (const std::runtime_error& e) {
+        EXPECT_STREQ(e.what(), "inner 3/5");
+    }
+}
+
+TEST_F(SchedulerTest, ParallelForCoversRangeOnce)
+{
+    threads(4);
+    std::vector<std::atomic<int>> hits(10007);
+    util::parallelFor(0, hits.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+            hits[i].fetch_add(1);
+    }, 13);
+    for (const auto& h : hits)
+        ASSERT_EQ(h.load(), 1);
+}
+
+TEST_F(SchedulerTest, ParallelReduceKeepsOrder)
+{
+    threads(4);
+    std::string joined = util::parallelReduce(0, 26, std::string(),
+        [](std::size_t begin, std::size_t end) {
+            std::string s;
+            for (std::size_t i = begin; i < end; ++i)
+                s.push_back(static_cast<char>('a' + i));
+            return s;
+        },
+        [](std::string a, std::string b) { return a + b; }, 3);
+    EXPECT_EQ(joined, "abcdefghijklmnopqrstuvwxyz");
+}
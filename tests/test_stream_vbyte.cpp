@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "util/stream_vbyte.hpp"
+
+using namespace ista;
+
+
+namespace
+{
+
+// Values on both sides of each length boundary.
+const std::vector<std::uint32_t> BOUNDARIES = {
+    0, 1, 0xFF, 0x100, 0xFFFF, 0x10000, 0xFFFFFF, 0x1000000, 0xFFFFFFFE, UINT32_MAX,
+};
+
+// Encodes `values`, then checks both decoders and streamVByteSize against
+// the encoding and each other.
+void roundTrip(const std::vector<std::uint32_t>& values)
+{
+    std::size_t n = values.size();
+    std::vector<std::uint8_t> encoded(util::streamVByteMaxBytes(n) + util::STREAM_VBYTE_PADDING);
+    std::size_t bytes = util::streamVByteEncode(values.data(), n, encoded.data());
+    ASSERT_LE(bytes, util::streamVByteMaxBytes(n));
+    EXPECT_EQ(util::streamVByteSize(encoded.data(), n), bytes);
+
+    std::vector<std::uint32_t> fast(n + 4, 0xDEADBEEF), scalar(n + 4, 0xDEADBEEF);
+    EXPECT_EQ(util::streamVByteDecode(encoded.data(), n, fast.data()), bytes);
+    EXPECT_EQ(util::streamVByteDecodeScalar(encoded.data(), n, scalar.data()), bytes);
+    for (std::size_t i = 0; i < n; ++i) {
+        ASSERT_EQ(fast[i], values[i]) << "at " << i << " of " << n;
+        ASSERT_EQ(scalar[i], values[i]) << "at " << i << " of " << n;
+    }
+    // Nothing past the count is written.
+    EXPECT_EQ(fast[n], 0xDEADBEEF);
+    EXPECT_EQ(scalar[n], 0xDEADBEEF);
+}
+
+}
+
+
+TEST(StreamVByte, Empty)
+{
+    roundTrip({});
+}
+
+TEST(StreamVByte, LengthBoundaries)
+{
+    roundTrip(BOUNDARIES);
+    EXPECT_EQ(util::streamVByteMaxBytes(1), 5u);
+    // One control byte, then 1 + 2 + 3 + 4 data bytes.
+    std::vector<std::uint32_t> values = {0xFF, 0xFFFF, 0xFFFFFF, UINT32_MAX};
+    std::vector<std::uint8_t> encoded(util::streamVByteMaxBytes(4));
+    EXPECT_EQ(util::streamVByteEncode(values.data(), 4, encoded.data()), 11u);
+    EXPECT_EQ(encoded[0], 0b11100100);
+}
+
+// Every count up to a few groups, so the partial control byte at the end is
+// covered at each of its fill levels, with every boundary value in every
+// lane.
+TEST(StreamVByte, CountsNotAMultipleOfFour)
+{
+    for (std::size_t n = 1; n <= 23; ++n) {
+        for (std::size_t shift = 0; shift < BOUNDARIES.size(); ++shift) {
+            std::vector<std::uint32_t> values(n);
+            for (std::size_t i = 0; i < n; ++i)
+                values[i] = BOUNDARIES[(i + shift) % BOUNDARIES.size()];
+            roundTrip(values);
+        }
+    }
+}
+
+TEST(StreamVByte, RandomLengthsMatchScalar)
+{
+    std::mt19937_64 rng(11);
+    for (int round = 0; round < 50; ++round) {
+        std::vector<std::uint32_t> values(rng() % 2000);
+        for (auto& v : values)
+            v = static_cast<std::uint32_t>(rng()) >> (8 * (rng() % 4));
+        roundTrip(values);
+    }
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "owl2/versioned_ontology.hpp"
+#include "owl2/vocabulary.hpp"
+
+using namespace ista;
+
+
+namespace
+{
+
+std::string iriOf(std::uint64_t round, std::uint64_t k)
+{
+    return "http://example.org/r" + std::to_string(round) + "/i" + std::to_string(k);
+}
+
+struct Counts
+{
+    std::size_t iris = 0;
+    std::size_t literals = 0;
+    std::size_t axioms = 0;
+};
+
+std::uint64_t checksum(const owl2::OntologyView& view)
+{
+    std::uint64_t sum = 0;
+    for (std::size_t k = 0; k < owl2::AXIOM_KIND_COUNT; ++k)
+        for (const owl2::TripleRow& row : view.axioms(static_cast<owl2::AxiomKind>(k)))
+            sum = sum * 31 + row.subject * 7 + row.predicate * 3 + row.object;
+    for (owl2::TermId id = 0; id < view.iriCount(); ++id)
+        sum = sum * 31 + view.iri(id).size();
+    return sum;
+}
+
+}
+
+
+TEST(VersionedOntology, ViewsAreSnapshots)
+{
+    owl2::VersionedOntology onto;
+    owl2::TermId p = onto.internIri("http://example.org/p");
+    owl2::TermId a = onto.internIri("http://example.org/a");
+    onto.addAxiom(a, p, a);
+    onto.commit();
+
+    owl2::OntologyView before = onto.view();
+    owl2::TermId b = onto.internIri("http://example.org/b");
+    onto.addAxiom(b, p, a);
+    // Uncommitted changes are invisible.
+    EXPECT_EQ(before.findIri("http://example.org/b"), owl2::NO_TERM);
+    onto.commit();
+
+    owl2::OntologyView after = onto.view();
+    EXPECT_EQ(after.version(), before.version() + 1);
+    EXPECT_EQ(after.findIri("http://example.org/b"), b);
+    EXPECT_EQ(before.findIri("http://example.org/b"), owl2::NO_TERM);
+    EXPECT_EQ(before.findIri("http://example.org/a"), a);
+    EXPECT_EQ(after.axiomCount(), before.axiomCount() + 1);
+}
+
+TEST(VersionedOntology, HeldViewDefersReclamation)
+{
+    owl2::VersionedOntology onto;
+    {
+        owl2::OntologyView view = onto.view();
+        std::uint64_t sum = checksum(view);
+        // Enough growth that every column outgrows its buffer.
+        owl2::TermId p = onto.internIri("http://example.org/p");
+        for (std::uint64_t i = 0; i < 20000; ++i) {
+            owl2::TermId s = onto.internIri(iriOf(0, i));
+            onto.addAxiom(s, p, s);
+            if (i % 1000 == 0)
+                onto.commit();
+        }
+        onto.commit();
+        EXPECT_GT(onto.pendingReclaim(), 0u);
+        EXPECT_EQ(checksum(view), sum);
+        EXPECT_EQ(view.findIri(owl2::vocab::RDF_TYPE), onto.findIri(owl2::vocab::RDF_TYPE));
+    }
+    onto.commit();
+    EXPECT_EQ(onto.pendingReclaim(), 0u);
+}
+
+// One writer commits rounds of IRIs, literals and axioms while readers take
+// views. Each view must match the counts recorded for its version, find every
+// IRI it holds and none from later rounds, and stay unchanged while held.
+// Run under -DISTA_SANITIZE=thread and address as well.
+TEST(VersionedOntology, ConcurrentReadersSeeCommittedVersions)
+{
+    const std::uint64_t rounds = 300;
+    const std::uint64_t per_round = 64;
+    owl2::VersionedOntology onto;
+    owl2::TermId predicate = onto.internIri("http://example.org/value");
+    owl2::TermId xsd_string = onto.findIri(owl2::vocab::XSD_STRING);
+    onto.commit();
+
+    // Written before the version is committed, read after a view of it is
+    // taken, so publication orders the two.
+    std::vector<Counts> expected(onto.version() + rounds + 1);
+    std::vector<std::uint64_t> round_of(onto.version() + rounds + 1, 0);
+    {
+        owl2::OntologyView view = onto.view();
+        expected[view.version()] = {view.iriCount(), view.literalCount(), view.axiomCount()};
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<std::uint64_t> failures{0}, views{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&] {
+            std::uint64_t last = 0;
+            while (!done.load()) {
+                owl2::OntologyView view = onto.view();
+                std::uint64_t v = view.version();
+                const Counts& want = expected[v];
+                bool ok = v >= last && view.iriCount() == want.iris && view.literalCount() == want.literals
+                    && view.axiomCount() == want.axioms;
+                last = v;
+                std::uint64_t round = round_of[v];
+                for (std::uint64_t k = 0; k < per_round && ok; k += 7) {
+                    owl2::TermId id = view.findIri(iriOf(round, k));
+                    ok = round == 0 || (id != owl2::NO_TERM && view.iri(id) == iriOf(round, k));
+                }
+                ok = ok && view.findIri(iriOf(round + 1, 0)) == owl2::NO_TERM;
+                for (const owl2::TripleRow& row : view.axioms(owl2::AxiomKind::DataPropertyAssertion))
+                    ok = ok && row.subject < view.iriCount() && owl2::literalIndex(row.object) < view.literalCount();
+                std::uint64_t sum = checksum(view);
+                std::this_thread::yield();
+                ok = ok && checksum(view) == sum;
+                if (!ok)
+                    failures.fetch_add(1);
+                views.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    for (std::uint64_t round = 1; round <= rounds; ++round) {
+        for (std::uint64_t k = 0; k < per_round; ++k) {
+            owl2::TermId s = onto.internIri(iriOf(round, k));
+            owl2::TermId o = onto.internLiteral("value " + std::to_string(round * per_round + k), xsd_string);
+            onto.addAxiom(s, predicate, o);
+        }
+        std::uint64_t v = onto.version() + 1;
+        round_of[v] = round;
+        expected[v] = {expected[v - 1].iris + per_round, expected[v - 1].literals + per_round,
+                       expected[v - 1].axioms + per_round};
+        EXPECT_EQ(onto.commit(), v);
+        // Let readers in between commits on machines with few cores.
+        std::this_thread::yield();
+    }
+    done.store(true);
+    for (auto& t : readers)
+        t.join();
+
+    EXPECT_EQ(failures.load(), 0u);
+    EXPECT_GT(views.load(), 0u);
+    // With every view gone, the next commit reclaims everything retired.
+    onto.commit();
+    EXPECT_EQ(onto.pendingReclaim(), 0u);
+}